@@ -0,0 +1,1908 @@
+
+// STD
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+// Qt
+#include <QElapsedTimer>
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QThread>
+#include <QCoreApplication>
+
+// Project
+#include "GraphBenchmark.h"
+#include "GraphCommandLine.h"
+#include "GraphTools.h"
+#include "GraphIO.h"
+#include "GraphCsr.h"
+#include "GraphThreadPool.h"
+#include "GraphOrdering.h"
+#include "GraphCompressed.h"
+#include "GraphKernels.h"
+#include "GraphBuilder.h"
+#include "GraphDynamic.h"
+#include "GraphVersioned.h"
+#include "GraphContraction.h"
+#include "GraphExactColoring.h"
+#include "GraphScheduler.h"
+#include "GraphExternal.h"
+#include "GraphServer.h"
+#include "GraphWeighted.h"
+#include "GraphSpanningTree.h"
+#include "GraphUnionFind.h"
+#include "GraphCentrality.h"
+#include "GraphKShortestPaths.h"
+#include "GraphPerfCounters.h"
+#include "GraphTriangles.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+static const int BENCHMARK_ITERATIONS = 10;
+
+//******************************************************************************
+/*!
+ * \brief MeasureNodeBandwidth method measures the read bandwidth of memory placed on a node from another node
+ * \return GB/s, a single pinned worker of readerNode reads a buffer first-touched by a worker of ownerNode
+ */
+double MeasureNodeBandwidth(ThreadPool & pool, int ownerWorker, int readerWorker)
+{
+    static const int BUFFER_SIZE = 1 << 25; // 256 MB of quint64
+    NumaArray<quint64> buffer;
+    if (!buffer.allocate(BUFFER_SIZE, NUMA_DEFAULT))
+        return 0.0;
+
+    RunParallel(pool, [&](int worker)
+    {
+        if (worker != ownerWorker)
+            return;
+        for (int i=0; i<BUFFER_SIZE; i++)
+            buffer[i] = i;
+    });
+
+    volatile quint64 sink = 0;
+    QElapsedTimer timer;
+    timer.start();
+    RunParallel(pool, [&](int worker)
+    {
+        if (worker != readerWorker)
+            return;
+        quint64 sum = 0;
+        const quint64 * data = buffer.data();
+        for (int i=0; i<BUFFER_SIZE; i++)
+            sum += data[i];
+        sink = sum;
+    });
+    qint64 ns = qMax(qint64(1), timer.nsecsElapsed());
+    Q_UNUSED(sink)
+    return double(BUFFER_SIZE) * sizeof(quint64) / ns;
+}
+
+//******************************************************************************
+/*!
+ * \brief MeasureNeighborSweep method times weighted neighbor sums over the whole graph
+ * \return seconds for BENCHMARK_ITERATIONS sweeps
+ *
+ * Each worker sweeps its workerRange() of vertices : result[v] = sum(weight * value[target]).
+ */
+double MeasureNeighborSweep(const Graph & graph, ThreadPool & pool, NumaPlacement placement)
+{
+    CsrGraph csr;
+    csr.build(graph, placement, placement == NUMA_FIRST_TOUCH ? &pool : 0);
+    int n = csr.nbVertices();
+
+    NumaArray<double> values, results;
+    values.allocate(n, placement);
+    results.allocate(n, placement);
+    if (placement == NUMA_FIRST_TOUCH)
+    {
+        RunParallel(pool, [&](int worker)
+        {
+            int begin, end;
+            pool.workerRange(worker, n, &begin, &end);
+            for (int v=begin; v<end; v++)
+            {
+                values[v] = 1.0;
+                results[v] = 0.0;
+            }
+        });
+    }
+    else
+    {
+        for (int v=0; v<n; v++)
+        {
+            values[v] = 1.0;
+            results[v] = 0.0;
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int iteration=0; iteration<BENCHMARK_ITERATIONS; iteration++)
+    {
+        RunParallel(pool, [&](int worker)
+        {
+            int begin, end;
+            pool.workerRange(worker, n, &begin, &end);
+            const int * offsets = csr.offsets();
+            const int * targets = csr.targets();
+            const double * weights = csr.weights();
+            for (int v=begin; v<end; v++)
+            {
+                double sum = 0.0;
+                for (int e=offsets[v]; e<offsets[v+1]; e++)
+                    sum += weights[e] * values[targets[e]];
+                results[v] = sum;
+            }
+        });
+    }
+    return timer.nsecsElapsed() * 1e-9;
+}
+
+//******************************************************************************
+/*!
+ * \brief RunNumaBenchmark method reports node to node bandwidth and the neighbor sweep speedup of pinned workers
+ * \param arguments : ggc --bench-numa [nbThreads] [file.ggc]
+ */
+int RunNumaBenchmark(const QStringList & arguments)
+{
+    int nbThreads = arguments.value(2, "0").toInt();
+    GraphDocument doc;
+    if (!LoadCommandLineGraph(arguments, 3, &doc, 500000, 4000000))
+        return 1;
+    Graph graph;
+    if (!SetupGraph(doc, &graph))
+        return 1;
+
+    ThreadPool pinnedPool(nbThreads, true);
+    const NumaTopology & topology = pinnedPool.topology();
+    std::cout << "NUMA nodes : " << topology.nbNodes() << ", CPUs : " << topology.nbCpus()
+              << ", threads : " << pinnedPool.nbThreads() << std::endl;
+
+    // local / remote bandwidth :
+    QVector<int> nodeWorkers(topology.nbNodes(), -1);
+    for (int worker=pinnedPool.nbThreads()-1; worker>=0; worker--)
+        nodeWorkers[pinnedPool.workerNode(worker)] = worker;
+    for (int owner=0; owner<topology.nbNodes(); owner++)
+    {
+        for (int reader=0; reader<topology.nbNodes(); reader++)
+        {
+            if (nodeWorkers[owner] < 0 || nodeWorkers[reader] < 0)
+                continue;
+            double bandwidth = MeasureNodeBandwidth(pinnedPool, nodeWorkers[owner], nodeWorkers[reader]);
+            std::cout << "Memory of node " << owner << " read from node " << reader << " ("
+                      << (owner == reader ? "local" : "remote") << ") : " << bandwidth << " GB/s" << std::endl;
+        }
+    }
+
+    // neighbor sweep :
+    std::cout << "Graph : " << graph.vertices.size() << " vertices, " << graph.nbArcs() << " directed edges" << std::endl;
+    ThreadPool unpinnedPool(nbThreads, false);
+    double unpinnedTime = MeasureNeighborSweep(graph, unpinnedPool, NUMA_DEFAULT);
+    double firstTouchTime = MeasureNeighborSweep(graph, pinnedPool, NUMA_FIRST_TOUCH);
+    double interleavedTime = MeasureNeighborSweep(graph, pinnedPool, NUMA_INTERLEAVED);
+    double edges = double(graph.nbArcs()) * BENCHMARK_ITERATIONS;
+
+    std::cout << "Unpinned, default placement : " << unpinnedTime << " s, " << edges / unpinnedTime * 1e-6 << " Medges/s" << std::endl;
+    std::cout << "Pinned, first touch : " << firstTouchTime << " s, " << edges / firstTouchTime * 1e-6 << " Medges/s"
+              << ", speedup " << unpinnedTime / firstTouchTime << std::endl;
+    std::cout << "Pinned, interleaved : " << interleavedTime << " s, " << edges / interleavedTime * 1e-6 << " Medges/s"
+              << ", speedup " << unpinnedTime / interleavedTime << std::endl;
+    return 0;
+}
+
+//******************************************************************************
+/*!
+ * \brief CsrBreadthFirstSweep method visits the whole graph breadth-first from vertex 0
+ * \return number of visited vertices
+ */
+int CsrBreadthFirstSweep(const CsrGraph & csr, QVector<int> * levels)
+{
+    int n = csr.nbVertices();
+    levels->fill(-1, n);
+    QVector<int> queue;
+    queue.reserve(n);
+    const int * offsets = csr.offsets();
+    const int * targets = csr.targets();
+    for (int root=0; root<n; root++)
+    {
+        if ((*levels)[root] >= 0)
+            continue;
+        (*levels)[root] = 0;
+        queue << root;
+        for (int head=queue.size()-1; head<queue.size(); head++)
+        {
+            int v = queue[head];
+            for (int e=offsets[v]; e<offsets[v+1]; e++)
+            {
+                int t = targets[e];
+                if ((*levels)[t] < 0)
+                {
+                    (*levels)[t] = (*levels)[v] + 1;
+                    queue << t;
+                }
+            }
+        }
+    }
+    return queue.size();
+}
+
+//******************************************************************************
+/*!
+ * \brief OrderingTimes struct keeps the best of BENCHMARK_REPEATS times of each traversal, in ms
+ */
+struct OrderingTimes
+{
+    OrderingTimes() :
+        ordering(0.0),
+        coloring(std::numeric_limits<double>::max()),
+        components(std::numeric_limits<double>::max()),
+        shortestPath(std::numeric_limits<double>::max()),
+        breadthFirst(std::numeric_limits<double>::max())
+    {
+    }
+    double ordering;
+    double coloring;
+    double components;
+    double shortestPath;
+    double breadthFirst;
+};
+
+//******************************************************************************
+/*!
+ * \brief RunOrderingBenchmark method times the graph traversals for each vertex ordering
+ * \param arguments : ggc --bench-order [file.ggc], a shuffled 300 x 300 grid by default
+ *
+ * Results are computed on the reordered graphs and translated back to the original ids,
+ * shortest path distances and component counts are checked against the original order.
+ */
+int RunOrderingBenchmark(const QStringList & arguments)
+{
+    static const int BENCHMARK_REPEATS = 3;
+    GraphDocument doc;
+    if (arguments.size() > 2)
+    {
+        if (!LoadCommandLineGraph(arguments, 2, &doc))
+            return 1;
+    }
+    else
+    {
+        GenerateShuffledGridDocument(300, 300, 1, &doc);
+    }
+    Graph graph;
+    if (!SetupGraph(doc, &graph) || graph.vertices.isEmpty())
+        return 1;
+    int n = graph.vertices.size();
+    std::cout << "Graph : " << n << " vertices, " << doc.nbEdges() << " edges" << std::endl;
+
+    bool ok = true;
+    QElapsedTimer timer;
+    QVector<OrderingTimes> times(ORDER_NB_ORDERINGS);
+    double referenceDistance = 0.0;
+    int referenceNbComponents = 0;
+    for (int o=0; o<ORDER_NB_ORDERINGS; o++)
+    {
+        VertexOrdering ordering = VertexOrdering(o);
+        OrderingTimes & t = times[o];
+
+        ReorderedGraph reordered;
+        timer.start();
+        if (!reordered.setup(graph, ordering))
+            return 1;
+        t.ordering = timer.nsecsElapsed() * 1e-6;
+
+        CsrGraph csr;
+        csr.build(reordered.graph());
+        QVector<int> levels;
+
+        double distance = 0.0;
+        int nbComponents = 0;
+        for (int r=0; r<BENCHMARK_REPEATS; r++)
+        {
+            for (int i=0; i<n; i++)
+                graph.vertices[i].color = -1;
+            timer.start();
+            reordered.greedyGraphColoring(&graph);
+            t.coloring = qMin(t.coloring, timer.nsecsElapsed() * 1e-6);
+
+            for (int i=0; i<n; i++)
+                graph.vertices[i].color = -1;
+            ConnectedComponents components;
+            timer.start();
+            reordered.colorConnectedVertices(graph, &components);
+            t.components = qMin(t.components, timer.nsecsElapsed() * 1e-6);
+            nbComponents = components.nbComponents();
+
+            QList<int> path;
+            timer.start();
+            distance = reordered.computeMinDistance(0, n-1, &path);
+            t.shortestPath = qMin(t.shortestPath, timer.nsecsElapsed() * 1e-6);
+
+            timer.start();
+            CsrBreadthFirstSweep(csr, &levels);
+            t.breadthFirst = qMin(t.breadthFirst, timer.nsecsElapsed() * 1e-6);
+        }
+
+        if (ordering == ORDER_ORIGINAL)
+        {
+            referenceDistance = distance;
+            referenceNbComponents = nbComponents;
+        }
+        bool same = distance == referenceDistance && nbComponents == referenceNbComponents;
+        ok &= same;
+
+        const OrderingTimes & r = times[ORDER_ORIGINAL];
+        std::cout << VertexOrderingName(ordering) << " : ordering " << t.ordering << " ms, mean edge span "
+                  << MeanEdgeSpan(reordered.graph()) << std::endl
+                  << "  coloring " << t.coloring << " ms (x" << r.coloring / t.coloring << ")"
+                  << ", components " << t.components << " ms (x" << r.components / t.components << ")"
+                  << ", shortest path " << t.shortestPath << " ms (x" << r.shortestPath / t.shortestPath << ")"
+                  << ", CSR breadth-first " << t.breadthFirst << " ms (x" << r.breadthFirst / t.breadthFirst << ")"
+                  << (same ? "" : " : MISMATCH") << std::endl;
+    }
+    return ok ? 0 : 1;
+}
+
+//******************************************************************************
+/*!
+ * \brief KernelResults struct keeps the traversal kernel outputs and their best time in ms
+ */
+struct KernelResults
+{
+    KernelResults() :
+        coloring(std::numeric_limits<double>::max()),
+        breadthFirst(std::numeric_limits<double>::max()),
+        components(std::numeric_limits<double>::max())
+    {
+    }
+    bool operator==(const KernelResults & other) const
+    { return colors == other.colors && levels == other.levels && labels == other.labels; }
+
+    double coloring;
+    double breadthFirst;
+    double components;
+    QVector<int> colors;
+    QVector<int> levels;
+    QVector<int> labels;
+};
+
+//******************************************************************************
+
+template<class Adjacency>
+void MeasureKernels(const Adjacency & adjacency, KernelResults * results)
+{
+    static const int BENCHMARK_REPEATS = 3;
+    QElapsedTimer timer;
+    for (int r=0; r<BENCHMARK_REPEATS; r++)
+    {
+        timer.start();
+        GreedyColoringKernel(adjacency, &results->colors);
+        results->coloring = qMin(results->coloring, timer.nsecsElapsed() * 1e-6);
+
+        timer.start();
+        BreadthFirstKernel(adjacency, 0, &results->levels);
+        results->breadthFirst = qMin(results->breadthFirst, timer.nsecsElapsed() * 1e-6);
+
+        timer.start();
+        ConnectedComponentsKernel(adjacency, &results->labels);
+        results->components = qMin(results->components, timer.nsecsElapsed() * 1e-6);
+    }
+}
+
+//******************************************************************************
+
+void PrintKernelResults(const char * name, qint64 bytes, int nbEdges, const KernelResults & results, const KernelResults & reference)
+{
+    std::cout << "  " << name << " : " << bytes / double(1 << 20) << " MB, " << double(bytes) / qMax(1, nbEdges) << " bytes/edge"
+              << ", coloring " << results.coloring << " ms"
+              << ", breadth-first " << nbEdges / results.breadthFirst * 1e-3 << " Medges/s"
+              << ", components " << nbEdges / results.components * 1e-3 << " Medges/s"
+              << (results == reference ? "" : " : MISMATCH") << std::endl;
+}
+
+//******************************************************************************
+/*!
+ * \brief RunCompressionBenchmark method compares the compressed adjacency with the CSR one
+ * \param arguments : ggc --bench-compressed [file.ggc]
+ *
+ * Gaps are small when neighbors have close ids, so the graph is also measured after RCM ordering.
+ */
+int RunCompressionBenchmark(const QStringList & arguments)
+{
+    GraphDocument doc;
+    if (!LoadCommandLineGraph(arguments, 2, &doc, 200000, 1000000))
+        return 1;
+    Graph graph;
+    if (!SetupGraph(doc, &graph) || graph.vertices.isEmpty())
+        return 1;
+
+    // current QHash / QList adjacency : pointer to a heap node holding the pair, plus the allocator overhead
+    qint64 listEntries = 0;
+    foreach (const QList<EdgeConnection> & connections, graph.getEdgeConnections())
+        listEntries += connections.size();
+    qint64 listBytes = listEntries * (sizeof(void*) + sizeof(EdgeConnection) + 16);
+    std::cout << "Graph : " << graph.vertices.size() << " vertices, " << graph.nbArcs() << " directed edges" << std::endl
+              << "QList adjacency (estimate) : " << listBytes / double(1 << 20) << " MB for " << listEntries << " entries" << std::endl;
+
+    bool ok = true;
+    VertexOrdering orderings[2] = { ORDER_ORIGINAL, ORDER_RCM };
+    for (int o=0; o<2; o++)
+    {
+        ReorderedGraph reordered;
+        if (!reordered.setup(graph, orderings[o]))
+            return 1;
+        std::cout << VertexOrderingName(orderings[o]) << " order :" << std::endl;
+
+        CsrGraph csr;
+        csr.build(reordered.graph());
+        int nbEdges = csr.nbEdges();
+        qint64 csrBytes = qint64(csr.nbVertices() + 1) * sizeof(int) + qint64(nbEdges) * (sizeof(int) + sizeof(double));
+        KernelResults csrResults;
+        MeasureKernels(csr, &csrResults);
+        PrintKernelResults("CSR", csrBytes, nbEdges, csrResults, csrResults);
+
+        AdjacencyEncoding encodings[2] = { ENCODING_VARINT, ENCODING_GROUP_VARINT };
+        const char * names[2] = { "varint", "group varint" };
+        for (int e=0; e<2; e++)
+        {
+            CompressedGraph compressed;
+            compressed.build(reordered.graph(), encodings[e]);
+            KernelResults results;
+            MeasureKernels(compressed, &results);
+            PrintKernelResults(names[e], compressed.compressedBytes(), nbEdges, results, csrResults);
+            std::cout << "    compression ratio : x" << double(csrBytes) / compressed.compressedBytes() << " versus CSR, x"
+                      << double(listBytes) / compressed.compressedBytes() << " versus QList" << std::endl;
+            ok &= results == csrResults;
+        }
+    }
+    return ok ? 0 : 1;
+}
+
+//******************************************************************************
+
+bool IsSameCsrGraph(const CsrGraph & a, const CsrGraph & b)
+{
+    if (a.nbVertices() != b.nbVertices() || a.nbEdges() != b.nbEdges())
+        return false;
+    for (int v=0; v<=a.nbVertices(); v++)
+    {
+        if (a.offsets()[v] != b.offsets()[v])
+            return false;
+    }
+    for (int e=0; e<a.nbEdges(); e++)
+    {
+        if (a.targets()[e] != b.targets()[e] || a.weights()[e] != b.weights()[e])
+            return false;
+    }
+    return true;
+}
+
+//******************************************************************************
+/*!
+ * \brief RunBuildBenchmark method compares the radix sort CSR builder with Graph::setEdges + CsrGraph::build
+ * \param arguments : ggc --bench-build [nbEdges] [nbThreads]
+ *
+ * The random edge list has about 5% repeated edges and 1% self-loops. The current build path
+ * keeps them, it is skipped above 2e7 edges.
+ */
+int RunBuildBenchmark(const QStringList & arguments)
+{
+    int nbEdges = arguments.value(2, "10000000").toInt();
+    int nbThreads = arguments.value(3, "0").toInt();
+    int nbVertices = qMax(2, nbEdges / 8);
+    if (nbEdges < 1)
+        return 1;
+
+    GraphDocument doc;
+    doc.positions.resize(nbVertices);
+    doc.edgeVertices.resize(2 * nbEdges);
+    doc.edgeWeights.resize(nbEdges);
+    quint32 seed = 1;
+    for (int i=0; i<nbEdges; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        int a = (seed >> 8) % nbVertices;
+        seed = seed * 1664525u + 1013904223u;
+        int b = (seed >> 8) % nbVertices;
+        seed = seed * 1664525u + 1013904223u;
+        int kind = (seed >> 8) % 100;
+        if (kind < 5 && i > 0)
+        {
+            int j = (seed >> 12) % i;
+            a = doc.edgeVertices[2*j + 1];
+            b = doc.edgeVertices[2*j];
+        }
+        else if (kind == 5)
+        {
+            b = a;
+        }
+        doc.edgeVertices[2*i] = a;
+        doc.edgeVertices[2*i + 1] = b;
+        doc.edgeWeights[i] = 1 + int((seed >> 8) % 9);
+    }
+    std::cout << "Edge list : " << nbVertices << " vertices, " << nbEdges << " undirected edges" << std::endl;
+
+    QElapsedTimer timer;
+    if (nbEdges <= 20000000)
+    {
+        timer.start();
+        Graph graph;
+        CsrGraph csr;
+        if (!SetupGraph(doc, &graph) || !csr.build(graph))
+            return 1;
+        double seconds = timer.nsecsElapsed() * 1e-9;
+        std::cout << "Graph::setEdges + CsrGraph::build : " << seconds << " s, "
+                  << nbEdges / seconds * 1e-6 << " Medges/s, " << csr.nbEdges() << " arcs" << std::endl;
+    }
+
+    bool ok = true;
+    CsrGraph reference;
+    const char * mergeNames[3] = { "min weight", "sum of weights", "keep first" };
+    ThreadPool singlePool(1, true);
+    ThreadPool pool(nbThreads, true);
+    ThreadPool * pools[2] = { &singlePool, &pool };
+    for (int p=0; p<2; p++)
+    {
+        for (int merge=MERGE_MIN_WEIGHT; merge<=MERGE_KEEP_FIRST; merge++)
+        {
+            CsrGraph csr;
+            CsrBuildStatistics statistics;
+            timer.start();
+            if (!BuildCsrGraph(nbVertices, doc.edgeVertices, doc.edgeWeights, false, DuplicateEdgeMerge(merge),
+                               &csr, pools[p], NUMA_DEFAULT, &statistics))
+                return 1;
+            double seconds = timer.nsecsElapsed() * 1e-9;
+
+            bool same = true;
+            if (p == 0 && merge == MERGE_MIN_WEIGHT)
+                reference.allocate(csr.nbVertices(), csr.offsets());
+            if (merge == MERGE_MIN_WEIGHT)
+            {
+                if (p == 0)
+                {
+                    std::copy(csr.targets(), csr.targets() + csr.nbEdges(), reference.targets());
+                    std::copy(csr.weights(), csr.weights() + csr.nbEdges(), reference.weights());
+                }
+                same = IsSameCsrGraph(csr, reference);
+                ok &= same;
+            }
+            std::cout << "Radix sort builder, " << pools[p]->nbThreads() << " threads, " << mergeNames[merge] << " : "
+                      << seconds << " s, " << nbEdges / seconds * 1e-6 << " Medges/s, " << statistics.nbArcs << " arcs, "
+                      << statistics.nbSelfLoops << " self-loops, " << statistics.nbDuplicateArcs << " duplicate arcs"
+                      << (same ? "" : " : MISMATCH") << std::endl;
+        }
+    }
+    return ok ? 0 : 1;
+}
+
+//******************************************************************************
+/*!
+ * \brief RunDynamicBenchmark method times batched edge updates against rebuilding the graph
+ * \param arguments : ggc --bench-dynamic [nbEdges] [batchSize]
+ *
+ * Batches mix 60% insertions, 30% deletions of existing edges and 10% weight changes.
+ * The rebuild path is the current one : Graph::setEdges on the new edge list and CsrGraph::build.
+ */
+int RunDynamicBenchmark(const QStringList & arguments)
+{
+    static const int NB_BATCHES = 100;
+    int nbEdges = arguments.value(2, "1000000").toInt();
+    int batchSize = arguments.value(3, "1000").toInt();
+    if (nbEdges < 1 || batchSize < 1)
+        return 1;
+    GraphDocument doc;
+    GenerateRandomDocument(qMax(2, nbEdges / 5), nbEdges, 1, &doc);
+    Graph graph;
+    if (!SetupGraph(doc, &graph))
+        return 1;
+    int n = graph.vertices.size();
+
+    QElapsedTimer timer;
+    timer.start();
+    DynamicGraph dynamic;
+    dynamic.build(graph);
+    std::cout << "Graph : " << n << " vertices, " << graph.getEdges().size() << " edges, built in "
+              << timer.nsecsElapsed() * 1e-6 << " ms" << std::endl;
+
+    // batches :
+    quint32 seed = 3;
+    double batchTime = 0.0;
+    DynamicBatchStatistics total;
+    for (int batchIndex=0; batchIndex<NB_BATCHES; batchIndex++)
+    {
+        QVector<EdgeUpdate> batch;
+        for (int i=0; i<batchSize; i++)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            int kind = (seed >> 8) % 10;
+            seed = seed * 1664525u + 1013904223u;
+            int a = (seed >> 8) % n;
+            seed = seed * 1664525u + 1013904223u;
+            int b = (seed >> 8) % n;
+            double weight = 1 + int((seed >> 4) % 9);
+            if (kind >= 6 && dynamic.degree(a) > 0)
+            {
+                // an existing edge of a
+                DynamicGraph::Snapshot::NeighborIterator it = dynamic.snapshot().neighbors(a);
+                for (int k=(seed >> 8) % dynamic.degree(a); k>0; k--)
+                    it.next();
+                b = it.target();
+            }
+            batch << EdgeUpdate(kind < 6 ? EDGE_INSERT : kind < 9 ? EDGE_DELETE : EDGE_SET_WEIGHT, a, b, weight);
+        }
+        DynamicBatchStatistics statistics;
+        timer.start();
+        dynamic.applyBatch(batch, &statistics);
+        batchTime += timer.nsecsElapsed() * 1e-6;
+        total.nbInserted += statistics.nbInserted;
+        total.nbDeleted += statistics.nbDeleted;
+        total.nbUpdated += statistics.nbUpdated;
+        total.nbIgnored += statistics.nbIgnored;
+    }
+    std::cout << "Dynamic graph : " << batchTime / NB_BATCHES << " ms per batch of " << batchSize << " updates, "
+              << total.nbInserted << " inserted, " << total.nbDeleted << " deleted, " << total.nbUpdated << " updated, "
+              << total.nbIgnored << " ignored" << std::endl;
+
+    // rebuild path, one time :
+    Graph updated;
+    timer.start();
+    dynamic.toGraph(&updated);
+    double copyTime = timer.nsecsElapsed() * 1e-6;
+    CsrGraph csr;
+    timer.start();
+    Graph rebuilt(false);
+    rebuilt.vertices = updated.vertices;
+    QVector<Edge> edges = updated.getEdges();
+    for (int i=0; i<edges.size(); i++)
+    {
+        edges[i].a = &rebuilt.vertices[edges[i].a->id];
+        edges[i].b = &rebuilt.vertices[edges[i].b->id];
+    }
+    rebuilt.setEdges(edges);
+    csr.build(rebuilt);
+    double rebuildTime = timer.nsecsElapsed() * 1e-6;
+    std::cout << "Rebuild (Graph::setEdges + CsrGraph::build) : " << rebuildTime << " ms per batch, x"
+              << rebuildTime / qMax(1e-6, batchTime / NB_BATCHES) << " slower (copy to GT::Graph " << copyTime << " ms)" << std::endl;
+
+    // traversal on the snapshot :
+    KernelResults csrResults, snapshotResults;
+    MeasureKernels(csr, &csrResults);
+    MeasureKernels(dynamic.snapshot(), &snapshotResults);
+    bool same = csrResults.levels == snapshotResults.levels && csrResults.labels == snapshotResults.labels;
+    std::cout << "Breadth-first : CSR " << csrResults.breadthFirst << " ms, snapshot " << snapshotResults.breadthFirst << " ms" << std::endl
+              << "Components : CSR " << csrResults.components << " ms, snapshot " << snapshotResults.components << " ms"
+              << (same ? "" : " : MISMATCH") << std::endl;
+    return same ? 0 : 1;
+}
+
+//******************************************************************************
+/*!
+ * \brief VersionWeightSum method returns the sum of the arc weights of a version, the readers check it does not change
+ */
+double VersionWeightSum(const GraphVersion & version)
+{
+    double sum = 0.0;
+    for (int v=0; v<version.nbVertices(); v++)
+    {
+        for (GraphVersion::NeighborIterator it = version.neighbors(v); !it.atEnd(); it.next())
+            sum += it.weight();
+    }
+    return sum;
+}
+
+//******************************************************************************
+/*!
+ * \brief RunVersionedBenchmark method runs readers sweeping pinned versions while a writer publishes weight changes
+ *
+ * Each publication moves one unit of weight from an edge to another one, so every version has
+ * the same total weight : a reader seeing a partially published batch reports a mismatch.
+ */
+int RunVersionedBenchmark(const QStringList & arguments)
+{
+    static const int NB_PUBLICATIONS = 2000;
+    int nbReaders = arguments.value(2, "3").toInt();
+    int nbEdges = arguments.value(3, "200000").toInt();
+    if (nbReaders < 1 || nbEdges < 1)
+        return 1;
+    GraphDocument doc;
+    GenerateRandomDocument(qMax(2, nbEdges / 5), nbEdges, 1, &doc);
+    Graph graph;
+    if (!SetupGraph(doc, &graph))
+        return 1;
+
+    VersionedGraph versions;
+    QElapsedTimer timer;
+    timer.start();
+    versions.build(graph);
+    double totalWeight = 0.0;
+    {
+        VersionedGraph::ReadGuard guard(versions);
+        totalWeight = VersionWeightSum(guard.version());
+        std::cout << "Graph : " << guard.version().nbVertices() << " vertices, " << guard.version().nbArcs()
+                  << " arcs, built in " << timer.nsecsElapsed() * 1e-6 << " ms" << std::endl;
+    }
+
+    ThreadPool pool(nbReaders + 1, false);
+    QAtomicInt done(0);
+    QVector<int> reads(nbReaders + 1, 0);
+    QVector<int> mismatches(nbReaders + 1, 0);
+    double publishTime = 0.0;
+    int nbCopiedBlocks = 0;
+    RunParallel(pool, [&](int worker)
+    {
+        if (worker == 0)
+        {
+            quint32 seed = 7;
+            QElapsedTimer writeTimer;
+            for (int i=0; i<NB_PUBLICATIONS; i++)
+            {
+                seed = seed * 1664525u + 1013904223u;
+                const Edge & from = graph.getEdges()[(seed >> 8) % graph.getEdges().size()];
+                seed = seed * 1664525u + 1013904223u;
+                const Edge & to = graph.getEdges()[(seed >> 8) % graph.getEdges().size()];
+                if (from.a == from.b || to.a == to.b
+                        || (from.a == to.a && from.b == to.b) || (from.a == to.b && from.b == to.a))
+                    continue;
+                VersionedGraph::ReadGuard guard(versions);
+                const GraphVersion & previous = guard.version();
+                QVector<EdgeUpdate> batch;
+                batch << EdgeUpdate(EDGE_SET_WEIGHT, from.a->id, from.b->id, previous.weight(from.a->id, from.b->id) - 1)
+                      << EdgeUpdate(EDGE_SET_WEIGHT, to.a->id, to.b->id, previous.weight(to.a->id, to.b->id) + 1);
+                writeTimer.start();
+                versions.publish(batch);
+                publishTime += writeTimer.nsecsElapsed() * 1e-6;
+                VersionedGraph::ReadGuard next(versions);
+                nbCopiedBlocks += (next.version().nbVertices() + VERSION_BLOCK_SIZE - 1) / VERSION_BLOCK_SIZE
+                        - next.version().nbSharedBlocks(previous);
+            }
+            done.storeRelease(1);
+            return;
+        }
+        while (!done.loadAcquire())
+        {
+            VersionedGraph::ReadGuard guard(versions);
+            if (VersionWeightSum(guard.version()) != totalWeight)
+                mismatches[worker]++;
+            reads[worker]++;
+        }
+    });
+    double elapsed = timer.nsecsElapsed() * 1e-9;
+
+    int nbReads = 0, nbMismatches = 0;
+    for (int i=0; i<reads.size(); i++)
+    {
+        nbReads += reads[i];
+        nbMismatches += mismatches[i];
+    }
+    std::cout << "Writer : " << publishTime / NB_PUBLICATIONS << " ms per publication, "
+              << double(nbCopiedBlocks) / NB_PUBLICATIONS << " blocks copied per publication" << std::endl
+              << "Readers : " << nbReaders << " threads, " << nbReads << " full sweeps, "
+              << nbReads / qMax(1e-9, elapsed) << " sweeps/s, " << nbMismatches << " inconsistent versions" << std::endl
+              << "Retired versions not reclaimed yet : " << versions.nbRetiredVersions() << std::endl;
+    return nbMismatches == 0 ? 0 : 1;
+}
+
+//******************************************************************************
+/*!
+ * \brief RunContractionBenchmark method compares contraction hierarchy queries with ComputeMinDistance
+ *
+ * Without a graph file, a shuffled 150 x 150 grid is used, close to a road network. The
+ * hierarchy is also written to memory and read back, queries are answered by the read copy.
+ */
+int RunContractionBenchmark(const QStringList & arguments)
+{
+    static const int NB_REFERENCE_QUERIES = 20;
+    int nbQueries = arguments.value(2, "1000").toInt();
+    if (nbQueries < 1)
+        return 1;
+    GraphDocument doc;
+    if (arguments.size() > 3)
+    {
+        if (!LoadCommandLineGraph(arguments, 3, &doc))
+            return 1;
+    }
+    else
+    {
+        GenerateShuffledGridDocument(150, 150, 1, &doc);
+    }
+    Graph graph;
+    if (!SetupGraph(doc, &graph) || graph.vertices.size() < 2)
+        return 1;
+    int n = graph.vertices.size();
+
+    QElapsedTimer timer;
+    timer.start();
+    ContractionHierarchy built;
+    if (!built.build(graph))
+        return 1;
+    std::cout << "Graph : " << n << " vertices, " << graph.getEdges().size() << " edges" << std::endl
+              << "Preprocessing : " << timer.nsecsElapsed() * 1e-6 << " ms, " << built.nbShortcuts() << " shortcuts, "
+              << ThreadPool::instance().nbThreads() << " threads" << std::endl;
+
+    QBuffer buffer;
+    buffer.open(QIODevice::ReadWrite);
+    ContractionHierarchy hierarchy;
+    if (!built.write(&buffer) || !buffer.seek(0) || !hierarchy.read(&buffer))
+    {
+        std::cerr << "Failed to write and read the contraction hierarchy" << std::endl;
+        return 1;
+    }
+    std::cout << "Serialized size : " << buffer.size() / 1024 << " KB" << std::endl;
+
+    quint32 seed = 11;
+    QVector<int> starts(nbQueries), ends(nbQueries);
+    for (int i=0; i<nbQueries; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        starts[i] = (seed >> 8) % n;
+        seed = seed * 1664525u + 1013904223u;
+        ends[i] = (seed >> 8) % n;
+    }
+
+    QVector<double> distances(nbQueries);
+    qint64 nbSettled = 0;
+    timer.start();
+    for (int i=0; i<nbQueries; i++)
+    {
+        QList<int> path;
+        int settled = 0;
+        distances[i] = hierarchy.computeMinDistance(starts[i], ends[i], &path, &settled);
+        nbSettled += settled;
+    }
+    double queryTime = timer.nsecsElapsed() * 1e-6 / nbQueries;
+
+    int nbReferences = qMin(nbQueries, NB_REFERENCE_QUERIES);
+    int nbMismatches = 0;
+    timer.start();
+    for (int i=0; i<nbReferences; i++)
+    {
+        QList<int> path;
+        if (ComputeMinDistance(graph, starts[i], ends[i], &path) != distances[i])
+            nbMismatches++;
+    }
+    double referenceTime = timer.nsecsElapsed() * 1e-6 / nbReferences;
+
+    std::cout << "Hierarchy query : " << queryTime << " ms, " << double(nbSettled) / nbQueries << " settled vertices" << std::endl
+              << "ComputeMinDistance : " << referenceTime << " ms, x" << referenceTime / qMax(1e-9, queryTime) << " slower, "
+              << nbMismatches << " different distances out of " << nbReferences << std::endl;
+    return nbMismatches == 0 ? 0 : 1;
+}
+
+//******************************************************************************
+
+int CountColors(const Graph & graph)
+{
+    int nbColors = 0;
+    foreach (const Vertex & vertex, graph.vertices)
+        nbColors = qMax(nbColors, vertex.color + 1);
+    return nbColors;
+}
+
+//******************************************************************************
+
+bool IsProperColoring(const Graph & graph)
+{
+    foreach (const Vertex & vertex, graph.vertices)
+    {
+        if (vertex.color < 0)
+            return false;
+    }
+    foreach (const Edge & edge, graph.getEdges())
+    {
+        if (edge.a != edge.b && edge.a->color == edge.b->color)
+            return false;
+    }
+    return true;
+}
+
+//******************************************************************************
+
+int RunExactColoringBenchmark(const QStringList & arguments)
+{
+    int nbVertices = arguments.value(2, "200").toInt();
+    int timeBudgetMs = arguments.value(3, "10000").toInt();
+    if (nbVertices < 2 || timeBudgetMs < 0)
+        return 1;
+    GraphDocument doc;
+    GenerateRandomDocument(nbVertices, nbVertices * 4, 1, &doc);
+    Graph greedy;
+    if (!SetupGraph(doc, &greedy))
+        return 1;
+    if (!ExactColoringFits(greedy))
+    {
+        std::cerr << "Exact coloring : the graph needs more than " << (EXACT_COLORING_MAX_MEMORY >> 20) << " MB" << std::endl;
+        return 1;
+    }
+    GreedyGraphColoring(&greedy);
+    std::cout << "Graph : " << nbVertices << " vertices, " << greedy.getEdges().size() << " edges" << std::endl
+              << "GreedyGraphColoring : " << CountColors(greedy) << " colors" << std::endl;
+
+    ThreadPool single(1, false);
+    QList<ThreadPool*> pools;
+    pools << &single << &ThreadPool::instance();
+    bool isValid = true;
+    foreach (ThreadPool * pool, pools)
+    {
+        Graph graph;
+        SetupGraph(doc, &graph);
+        ExactColoringStatistics statistics;
+        ExactGraphColoring(&graph, timeBudgetMs, pool, &statistics);
+        isValid = isValid && IsProperColoring(graph) && CountColors(graph) == statistics.nbColors;
+        std::cout << pool->nbThreads() << " threads : " << statistics.nbColors << " colors"
+                  << (statistics.isOptimal ? " (optimal)" : " (time budget expired)")
+                  << ", clique " << statistics.lowerBound << ", DSatur " << statistics.initialNbColors
+                  << ", " << statistics.nbNodes << " nodes, " << statistics.nbSteals << " steals, "
+                  << statistics.elapsedMs << " ms" << std::endl;
+    }
+    if (!isValid)
+        std::cerr << "Invalid exact coloring" << std::endl;
+    return isValid ? 0 : 1;
+}
+
+//******************************************************************************
+/*!
+ * \brief NeighborChecksum method sums the neighbor ids of the vertices [begin, end), its cost is their degree
+ */
+qint64 NeighborChecksum(const CsrGraph & csr, int begin, int end)
+{
+    qint64 sum = 0;
+    for (int v=begin; v<end; v++)
+    {
+        for (CsrGraph::NeighborIterator it = csr.neighbors(v); !it.atEnd(); it.next())
+            sum += it.target();
+    }
+    return sum;
+}
+
+//******************************************************************************
+
+void PrintSchedule(const char * name, double ms, qint64 checksum, qint64 reference, double imbalance)
+{
+    std::cout << name << " : " << ms << " ms, imbalance " << imbalance
+              << (checksum == reference ? "" : ", WRONG CHECKSUM") << std::endl;
+}
+
+//******************************************************************************
+
+int RunSchedulerBenchmark(const QStringList & arguments)
+{
+    static const int NB_EMPTY_RUNS = 1000;
+    int nbVertices = arguments.value(2, "500000").toInt();
+    int nbThreads = arguments.value(3, "0").toInt();
+    if (nbVertices < 2 || nbThreads < 0)
+        return 1;
+    ThreadPool pool(nbThreads, false);
+
+    // skewed degrees : the first endpoint is drawn as n*u^4, low ids are hubs
+    int nbEdges = 8 * nbVertices;
+    QVector<int> edgeVertices(2 * nbEdges);
+    QVector<double> edgeWeights(nbEdges, 1.0);
+    quint32 seed = 5;
+    for (int i=0; i<nbEdges; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        double u = (seed >> 8) / double(1 << 24);
+        seed = seed * 1664525u + 1013904223u;
+        edgeVertices[2*i] = qMin(nbVertices - 1, int(nbVertices * u * u * u * u));
+        edgeVertices[2*i + 1] = (seed >> 8) % nbVertices;
+    }
+    CsrGraph csr;
+    if (!BuildCsrGraph(nbVertices, edgeVertices, edgeWeights, false, MERGE_MIN_WEIGHT, &csr, &pool))
+        return 1;
+    int maxDegree = 0;
+    for (int v=0; v<nbVertices; v++)
+        maxDegree = qMax(maxDegree, csr.degree(v));
+    std::cout << "Skewed graph : " << nbVertices << " vertices, " << csr.nbEdges() << " arcs, max degree "
+              << maxDegree << ", " << pool.nbThreads() << " threads" << std::endl;
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 reference = NeighborChecksum(csr, 0, nbVertices);
+    PrintSchedule("Sequential", timer.nsecsElapsed() * 1e-6, reference, reference, 1.0);
+
+    // static partition : equal vertex ranges
+    WorkerLocal<qint64> sums(pool, 0);
+    ParallelForStatistics busy;
+    busy.workerBusyNs.fill(0, pool.nbThreads());
+    timer.start();
+    RunParallel(pool, [&](int worker)
+    {
+        QElapsedTimer workerTimer;
+        workerTimer.start();
+        int begin, end;
+        pool.workerRange(worker, nbVertices, &begin, &end);
+        sums[worker] = NeighborChecksum(csr, begin, end);
+        busy.workerBusyNs[worker] = workerTimer.nsecsElapsed();
+    });
+    double ms = timer.nsecsElapsed() * 1e-6;
+    qint64 checksum = 0;
+    for (int worker=0; worker<pool.nbThreads(); worker++)
+        checksum += sums[worker];
+    PrintSchedule("Static ranges", ms, checksum, reference, busy.imbalance());
+
+    // work stealing, adaptive then fixed grains
+    bool isValid = true;
+    int grains[] = { 0, 1, 256 };
+    for (int g=0; g<3; g++)
+    {
+        for (int worker=0; worker<pool.nbThreads(); worker++)
+            sums[worker] = 0;
+        ParallelForStatistics statistics;
+        timer.start();
+        ParallelFor(pool, nbVertices, [&](int begin, int end, int worker)
+        {
+            sums[worker] += NeighborChecksum(csr, begin, end);
+        }, grains[g], 0, &statistics);
+        ms = timer.nsecsElapsed() * 1e-6;
+        checksum = 0;
+        for (int worker=0; worker<pool.nbThreads(); worker++)
+            checksum += sums[worker];
+        isValid = isValid && checksum == reference;
+        QString name = grains[g] == 0 ? QString("ParallelFor adaptive grain") :
+                                        QString("ParallelFor grain %1").arg(grains[g]);
+        PrintSchedule(name.toLocal8Bit().constData(), ms, checksum, reference, statistics.imbalance());
+        std::cout << "    " << statistics.nbChunks << " chunks, " << statistics.nbSplits << " splits, "
+                  << statistics.nbSteals << " steals" << std::endl;
+    }
+
+    // scheduling overhead : empty chunks and empty pool runs
+    ParallelForStatistics statistics;
+    timer.start();
+    ParallelFor(pool, nbVertices, [&](int, int, int) {}, 1, 0, &statistics);
+    std::cout << "Empty chunk : " << timer.nsecsElapsed() / qMax(1, statistics.nbChunks) << " ns" << std::endl;
+    timer.start();
+    for (int i=0; i<NB_EMPTY_RUNS; i++)
+        RunParallel(pool, [&](int) {});
+    std::cout << "Empty RunParallel : " << timer.nsecsElapsed() * 1e-3 / NB_EMPTY_RUNS << " us" << std::endl;
+    return isValid ? 0 : 1;
+}
+
+//******************************************************************************
+/*!
+ * \brief SequentialReadBandwidth method measures one sweep of the stream without processing, from disk if the cache can be dropped
+ * \return MB/s
+ */
+double SequentialReadBandwidth(EdgeStream & stream)
+{
+    stream.dropCache();
+    stream.resetStatistics();
+    stream.rewind();
+    qint64 nbRead = 0;
+    int nbEdges = 0;
+    while (stream.nextBlock(&nbEdges))
+        nbRead += nbEdges;
+    if (nbRead != stream.nbEdges())
+        std::cerr << "Edge file read " << nbRead << " edges out of " << stream.nbEdges() << std::endl;
+    return stream.statistics().throughput();
+}
+
+//******************************************************************************
+
+void PrintStreamStatistics(const char * name, const EdgeStreamStatistics & statistics, double readBandwidth)
+{
+    std::cout << name << " : " << statistics.elapsedNs * 1e-6 << " ms, " << statistics.nbSweeps << " sweeps, "
+              << statistics.throughput() << " MB/s (" << 100.0 * statistics.throughput() / qMax(1e-9, readBandwidth)
+              << " % of the sequential read), waiting for blocks " << statistics.waitNs * 1e-6 << " ms" << std::endl;
+}
+
+//******************************************************************************
+/*!
+ * \brief RunExternalBenchmark method streams a generated edge file through the out-of-core algorithms
+ * \return 0 if the results match the in-memory algorithms, when the graph is small enough to check them
+ *
+ * The file is written edge by edge in the temporary directory. The cache of the file is dropped
+ * before each algorithm, the sweeps after the first one are served from the page cache when the
+ * file fits in memory.
+ */
+int RunExternalBenchmark(const QStringList & arguments)
+{
+    static const int MAX_CHECKED_EDGES = 1000000;
+    static const int NB_CHECKED_TARGETS = 3;
+    int nbVertices = arguments.value(2, "1000000").toInt();
+    qint64 nbEdges = arguments.value(3, "8000000").toLongLong();
+    if (nbVertices < 2 || nbEdges < 1)
+        return 1;
+
+    QString fileName = QDir(QDir::tempPath()).filePath("ggc_bench_external.edges");
+    QElapsedTimer timer;
+    timer.start();
+    EdgeFileWriter writer;
+    if (!writer.open(fileName, nbVertices, false))
+        return 1;
+    quint32 seed = 5;
+    for (qint64 i=0; i<nbEdges; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        int a = (seed >> 8) % nbVertices;
+        seed = seed * 1664525u + 1013904223u;
+        int b = (seed >> 8) % nbVertices;
+        writer.append(a, b, 1 + (seed >> 4) % 9);
+    }
+    if (!writer.close())
+        return 1;
+
+    EdgeStream stream;
+    if (!stream.open(fileName))
+        return 1;
+    std::cout << "Edge file : " << nbVertices << " vertices, " << stream.nbEdges() << " edges, "
+              << stream.fileBytes() / (1024 * 1024) << " MB written in " << timer.elapsed() << " ms" << std::endl;
+
+    double readBandwidth = SequentialReadBandwidth(stream);
+    std::cout << "Sequential read : " << readBandwidth << " MB/s" << std::endl;
+
+    ConnectedComponents components;
+    stream.dropCache();
+    stream.resetStatistics();
+    int nbComponents = ExternalConnectedComponents(stream, &components);
+    PrintStreamStatistics("Semi-external components", stream.statistics(), readBandwidth);
+
+    QVector<double> distances;
+    stream.dropCache();
+    stream.resetStatistics();
+    bool converged = ExternalBellmanFord(stream, 0, &distances);
+    PrintStreamStatistics("Streaming Bellman-Ford", stream.statistics(), readBandwidth);
+
+    bool ok = nbComponents > 0 && converged;
+    if (ok && nbEdges <= MAX_CHECKED_EDGES)
+    {
+        Graph graph;
+        graph.vertices.resize(nbVertices);
+        for (int i=0; i<nbVertices; i++)
+            graph.vertices[i].id = i;
+        QVector<Edge> edges;
+        edges.reserve(nbEdges);
+        stream.rewind();
+        int count = 0;
+        const ExternalEdge * block = 0;
+        while ((block = stream.nextBlock(&count)))
+        {
+            for (int i=0; i<count; i++)
+            {
+                Edge edge;
+                edge.a = &graph.vertices[block[i].a];
+                edge.b = &graph.vertices[block[i].b];
+                edge.weight = block[i].weight;
+                edges << edge;
+            }
+        }
+        graph.setEdges(edges);
+
+        ConnectedComponents reference;
+        ColorConnectedVertices(graph, &reference);
+        bool same = reference.labels() == components.labels();
+        for (int t=0; t<NB_CHECKED_TARGETS; t++)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            int target = (seed >> 8) % nbVertices;
+            QList<int> path;
+            same &= ComputeMinDistance(graph, 0, target, &path) == distances[target];
+        }
+        std::cout << "In-memory check : " << (same ? "same" : "MISMATCH") << std::endl;
+        ok &= same;
+    }
+    std::cout << nbComponents << " components, " << (converged ? "distances converged" : "distances did not converge") << std::endl;
+
+    stream.close();
+    QFile::remove(fileName);
+    return ok ? 0 : 1;
+}
+
+//******************************************************************************
+/*!
+ * \brief ServerBenchmarkClient class sends queries to the benchmark server from its own connection
+ *
+ * Shortest path queries start from a few hot sources, as when several services ask for routes
+ * from the same places, component and color answers are checked against the reference.
+ */
+class ServerBenchmarkClient : public QThread
+{
+public:
+    static const int PIPELINE = 4; //!< queries sent before reading the answers
+    static const int NB_SOURCES = 8;
+
+    ServerBenchmarkClient(const QString & serverName, int nbQueries, quint32 seed,
+                          const QVector<int> & labels, const QVector<int> & colors) :
+        nbErrors(0),
+        _serverName(serverName),
+        _nbQueries(nbQueries),
+        _seed(seed),
+        _labels(labels),
+        _colors(colors)
+    {
+    }
+
+    QVector<qint64> latenciesNs;
+    QVector<ServerQuery> paths; //!< shortest path queries, answer in distances
+    QVector<double> distances;
+    int nbErrors;
+
+protected:
+    void run()
+    {
+        GraphClient client;
+        if (!client.connectToServer(_serverName))
+        {
+            nbErrors = _nbQueries;
+            return;
+        }
+        int n = _labels.size();
+        QVector<ServerQuery> window;
+        QElapsedTimer timer;
+        for (int i=0; i<_nbQueries; i+=PIPELINE)
+        {
+            window.clear();
+            for (int j=i; j<qMin(_nbQueries, i + PIPELINE); j++)
+            {
+                _seed = _seed * 1664525u + 1013904223u;
+                int a = (_seed >> 8) % n;
+                _seed = _seed * 1664525u + 1013904223u;
+                int b = (_seed >> 8) % n;
+                if (j % 4 < 2)
+                    window << ServerQuery(j, SQ_SHORTEST_PATH, a % NB_SOURCES, b);
+                else
+                    window << ServerQuery(j, j % 4 == 2 ? SQ_COMPONENT : SQ_COLOR, a);
+            }
+            timer.start();
+            foreach (const ServerQuery & query, window)
+                client.send(query);
+            foreach (const ServerQuery & query, window)
+            {
+                ServerAnswer answer;
+                if (!client.receive(&answer) || answer.id != query.id)
+                {
+                    nbErrors++;
+                    return;
+                }
+                latenciesNs << timer.nsecsElapsed();
+                if (query.type == SQ_SHORTEST_PATH)
+                {
+                    paths << query;
+                    distances << answer.value;
+                    if (answer.status == SS_OK && (answer.items.isEmpty() || answer.items.first() != query.a || answer.items.last() != query.b))
+                        nbErrors++;
+                }
+                else
+                {
+                    const QVector<int> & expected = query.type == SQ_COMPONENT ? _labels : _colors;
+                    if (answer.status != SS_OK || answer.value != expected[query.a])
+                        nbErrors++;
+                }
+            }
+        }
+    }
+
+private:
+    QString _serverName;
+    int _nbQueries;
+    quint32 _seed;
+    QVector<int> _labels;
+    QVector<int> _colors;
+};
+
+//******************************************************************************
+
+double LatencyPercentile(QVector<qint64> latencies, int percent)
+{
+    if (latencies.isEmpty())
+        return 0.0;
+    std::sort(latencies.begin(), latencies.end());
+    return latencies[qMin(latencies.size() - 1, latencies.size() * percent / 100)] * 1e-3;
+}
+
+//******************************************************************************
+/*!
+ * \brief RunServerBenchmark method runs the query server on a local socket and clients in threads of this process
+ * \return 0 if all answers are right
+ *
+ * Runs once without batching (one query per batch) and once with batching, client latencies are
+ * measured from the send of a query to the read of its answer.
+ */
+int RunServerBenchmark(const QStringList & arguments)
+{
+    static const int NB_CHECKED_PATHS = 20;
+    int nbClients = arguments.value(2, "8").toInt();
+    int nbQueries = arguments.value(3, "2000").toInt();
+    if (nbClients < 1 || nbQueries < 1)
+        return 1;
+
+    GraphDocument doc;
+    GenerateRandomDocument(20000, 60000, 3, &doc);
+    Graph graph;
+    if (!SetupGraph(doc, &graph))
+        return 1;
+    int n = graph.vertices.size();
+    ConnectedComponents components;
+    ColorConnectedVertices(graph, &components);
+    for (int i=0; i<n; i++)
+        graph.vertices[i].color = -1;
+    GreedyGraphColoring(&graph);
+    QVector<int> colors(n);
+    for (int i=0; i<n; i++)
+        colors[i] = graph.vertices[i].color;
+    std::cout << "Graph : " << n << " vertices, " << doc.nbEdges() << " edges, " << nbClients << " clients x "
+              << nbQueries << " queries, " << ThreadPool::instance().nbThreads() << " threads" << std::endl;
+
+    bool ok = true;
+    QString serverName = QString("ggc-bench-server-%1").arg(QCoreApplication::applicationPid());
+    int batchSizes[2] = { 1, SERVER_MAX_BATCH };
+    for (int b=0; b<2; b++)
+    {
+        GraphServer server;
+        server.setMaxBatchSize(batchSizes[b]);
+        if (!server.load(doc) || !server.start(serverName))
+            return 1;
+
+        QList<ServerBenchmarkClient*> clients;
+        for (int c=0; c<nbClients; c++)
+            clients << new ServerBenchmarkClient(serverName, nbQueries, 100 + c, components.labels(), colors);
+        QElapsedTimer timer;
+        timer.start();
+        foreach (ServerBenchmarkClient * client, clients)
+            client->start();
+        foreach (ServerBenchmarkClient * client, clients)
+            client->wait();
+        double seconds = timer.nsecsElapsed() * 1e-9;
+        ServerStatistics statistics = server.statistics();
+        server.stop();
+
+        QVector<qint64> latencies;
+        int nbErrors = 0;
+        foreach (ServerBenchmarkClient * client, clients)
+        {
+            latencies << client->latenciesNs;
+            nbErrors += client->nbErrors;
+        }
+        const ServerBenchmarkClient & first = *clients.first();
+        for (int i=0; i<qMin(NB_CHECKED_PATHS, first.paths.size()); i++)
+        {
+            QList<int> path;
+            if (ComputeMinDistance(graph, first.paths[i].a, first.paths[i].b, &path) != first.distances[i])
+                nbErrors++;
+        }
+        qDeleteAll(clients);
+
+        std::cout << (batchSizes[b] == 1 ? "Without batching" : "With batching") << " : "
+                  << latencies.size() / seconds << " queries/s, client latency p50 " << LatencyPercentile(latencies, 50)
+                  << " us, p99 " << LatencyPercentile(latencies, 99) << " us" << std::endl
+                  << "  server : " << statistics.nbBatches << " batches of " << statistics.meanBatchSize()
+                  << " queries, latency p50 " << statistics.p50Us << " us, p99 " << statistics.p99Us << " us, "
+                  << nbErrors << " wrong answers" << std::endl;
+        ok &= nbErrors == 0 && latencies.size() == nbClients * nbQueries;
+    }
+    return ok ? 0 : 1;
+}
+
+//******************************************************************************
+/*!
+ * \brief MeasureShortestPaths method runs a full search from each source, returns the best time per search in ms
+ * \param checksum sum of the reached distances of all searches
+ */
+template<class Adjacency>
+double MeasureShortestPaths(const Adjacency & adjacency, const QVector<int> & sources, bool forceHeap, double * checksum)
+{
+    static const int BENCHMARK_REPEATS = 3;
+    typedef WeightTraits<typename Adjacency::Weight> Traits;
+    QVector<typename Traits::Distance> distances;
+    double best = std::numeric_limits<double>::max();
+    QElapsedTimer timer;
+    for (int r=0; r<BENCHMARK_REPEATS; r++)
+    {
+        *checksum = 0.0;
+        timer.start();
+        for (int i=0; i<sources.size(); i++)
+        {
+            if (forceHeap)
+                HeapShortestPathKernel(adjacency, sources[i], -1, &distances, 0);
+            else
+                ShortestPathKernel(adjacency, sources[i], -1, &distances);
+            for (int v=0; v<distances.size(); v++)
+            {
+                if (distances[v] != Traits::infinity())
+                    *checksum += double(distances[v]);
+            }
+        }
+        best = qMin(best, timer.nsecsElapsed() * 1e-6 / sources.size());
+    }
+    return best;
+}
+
+//******************************************************************************
+
+void PrintShortestPaths(const char * name, qint64 bytes, int nbEdges, double ms, double checksum, double reference)
+{
+    std::cout << "  " << name << " : " << double(bytes) / qMax(1, nbEdges) << " bytes/edge, " << ms << " ms per search, "
+              << nbEdges / ms * 1e-3 << " Medges/s" << (checksum == reference ? "" : " : MISMATCH") << std::endl;
+}
+
+//******************************************************************************
+/*!
+ * \brief RunWeightBenchmark method compares the shortest path kernels over the weight types and graph backends
+ * \param arguments : ggc --bench-weights [nbVertices] [nbEdges]
+ *
+ * Random weights are integers in [1, 9], exact in every weight type : all searches give the same
+ * distances. A dense graph of unit weights compares the bit matrix with the narrowest CSR.
+ */
+int RunWeightBenchmark(const QStringList & arguments)
+{
+    static const int NB_SOURCES = 8;
+    static const int DENSE_VERTICES = 2000;
+    int nbVertices = arguments.value(2, "200000").toInt();
+    int nbEdges = arguments.value(3, "1000000").toInt();
+    if (nbVertices < 2 || nbEdges < 1)
+        return 1;
+    GraphDocument doc;
+    GenerateRandomDocument(nbVertices, nbEdges, 1, &doc);
+    Graph graph;
+    if (!SetupGraph(doc, &graph))
+        return 1;
+    QVector<int> sources;
+    for (int i=0; i<NB_SOURCES; i++)
+        sources << int(qint64(i) * nbVertices / NB_SOURCES);
+
+    std::cout << "Graph : " << nbVertices << " vertices, " << graph.nbArcs() << " arcs, weights "
+              << WeightTypeName(SelectWeightType(graph)) << std::endl;
+
+    bool ok = true;
+    double reference = 0.0, checksum = 0.0;
+    CsrGraph csr;
+    csr.build(graph);
+    qint64 csrBytes = qint64(csr.nbVertices() + 1) * sizeof(int) + qint64(csr.nbEdges()) * (sizeof(int) + sizeof(double));
+    double ms = MeasureShortestPaths(csr, sources, false, &reference);
+    PrintShortestPaths("CsrGraph, binary heap", csrBytes, csr.nbEdges(), ms, reference, reference);
+
+    CompressedGraph compressed;
+    compressed.build(graph);
+    ms = MeasureShortestPaths(compressed, sources, false, &checksum);
+    PrintShortestPaths("CompressedGraph, binary heap", compressed.compressedBytes(), compressed.nbEdges(), ms, checksum, reference);
+    ok &= checksum == reference;
+
+    WeightedCsrGraph<double> doubleCsr;
+    WeightedCsrGraph<float> floatCsr;
+    WeightedCsrGraph<quint32> uint32Csr;
+    WeightedCsrGraph<quint8> uint8Csr;
+    if (!doubleCsr.build(graph) || !floatCsr.build(graph) || !uint32Csr.build(graph) || !uint8Csr.build(graph))
+        return 1;
+    ms = MeasureShortestPaths(doubleCsr, sources, false, &checksum);
+    PrintShortestPaths("double weights, binary heap", doubleCsr.bytes(), doubleCsr.nbEdges(), ms, checksum, reference);
+    ok &= checksum == reference;
+    ms = MeasureShortestPaths(floatCsr, sources, false, &checksum);
+    PrintShortestPaths("float weights, binary heap", floatCsr.bytes(), floatCsr.nbEdges(), ms, checksum, reference);
+    ok &= checksum == reference;
+    ms = MeasureShortestPaths(uint32Csr, sources, true, &checksum);
+    PrintShortestPaths("uint32 weights, binary heap", uint32Csr.bytes(), uint32Csr.nbEdges(), ms, checksum, reference);
+    ok &= checksum == reference;
+    ms = MeasureShortestPaths(uint32Csr, sources, false, &checksum);
+    PrintShortestPaths("uint32 weights, bucket queue", uint32Csr.bytes(), uint32Csr.nbEdges(), ms, checksum, reference);
+    ok &= checksum == reference;
+    ms = MeasureShortestPaths(uint8Csr, sources, false, &checksum);
+    PrintShortestPaths("uint8 weights, bucket queue", uint8Csr.bytes(), uint8Csr.nbEdges(), ms, checksum, reference);
+    ok &= checksum == reference;
+
+    // dense graph of unit weights, 10% of the vertex pairs
+    GenerateRandomDocument(DENSE_VERTICES, DENSE_VERTICES * DENSE_VERTICES / 20, 2, &doc);
+    doc.edgeWeights.fill(1.0);
+    Graph dense;
+    if (!SetupGraph(doc, &dense))
+        return 1;
+    std::cout << "Dense graph : " << DENSE_VERTICES << " vertices, " << dense.nbArcs() << " arcs, weights "
+              << WeightTypeName(SelectWeightType(dense)) << std::endl;
+    WeightedCsrGraph<quint8> denseCsr;
+    BitMatrixGraph matrix;
+    if (!denseCsr.build(dense) || !matrix.build(dense))
+        return 1;
+    ms = MeasureShortestPaths(denseCsr, sources.mid(0, 1), false, &reference);
+    PrintShortestPaths("uint8 weights, bucket queue", denseCsr.bytes(), denseCsr.nbEdges(), ms, reference, reference);
+    ms = MeasureShortestPaths(matrix, sources.mid(0, 1), false, &checksum);
+    PrintShortestPaths("bit matrix, bucket queue", matrix.bytes(), matrix.nbEdges(), ms, checksum, reference);
+    ok &= checksum == reference;
+
+    QList<int> path;
+    QElapsedTimer timer;
+    timer.start();
+    double distance = ComputeMinDistance(graph, 0, nbVertices - 1, &path);
+    std::cout << "ComputeMinDistance : " << timer.nsecsElapsed() * 1e-6 << " ms, distance " << distance << std::endl;
+    return ok ? 0 : 1;
+}
+
+//******************************************************************************
+
+void PrintSpanningForest(const char * name, double ms, const SpanningForest & forest, const SpanningForest & reference)
+{
+    std::cout << name << " : " << ms << " ms, " << forest.nbRounds << " rounds"
+              << (forest.edges == reference.edges && forest.totalWeight == reference.totalWeight ? "" : " : DIFFERENT FOREST")
+              << std::endl;
+}
+
+//******************************************************************************
+/*!
+ * \brief RunSpanningTreeBenchmark method compares the minimum spanning forest algorithms with a plain Kruskal
+ * \param arguments : ggc --bench-mst [nbVertices] [nbEdges]
+ *
+ * Edges are generated as arrays, without GT::Graph, so 10^8 edges fit in a few GB.
+ */
+int RunSpanningTreeBenchmark(const QStringList & arguments)
+{
+    int nbVertices = arguments.value(2, "1000000").toInt();
+    int nbEdges = arguments.value(3, "10000000").toInt();
+    if (nbVertices < 2 || nbEdges < 1)
+        return 1;
+
+    QVector<int> edgeVertices(2 * nbEdges);
+    QVector<double> edgeWeights(nbEdges);
+    quint32 seed = 3;
+    for (int i=0; i<nbEdges; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        edgeVertices[2*i] = (seed >> 8) % nbVertices;
+        seed = seed * 1664525u + 1013904223u;
+        edgeVertices[2*i + 1] = (seed >> 8) % nbVertices;
+        seed = seed * 1664525u + 1013904223u;
+        edgeWeights[i] = 1 + int((seed >> 8) % 1000);
+    }
+    ThreadPool & pool = ThreadPool::instance();
+    ThreadPool single(1, false);
+    std::cout << "Graph : " << nbVertices << " vertices, " << nbEdges << " edges, " << pool.nbThreads() << " threads" << std::endl;
+
+    // plain Kruskal : all edges sorted by (weight, index)
+    QElapsedTimer timer;
+    timer.start();
+    SpanningForest reference;
+    QVector<int> order(nbEdges);
+    for (int e=0; e<nbEdges; e++)
+        order[e] = e;
+    const double * weights = edgeWeights.constData();
+    std::sort(order.begin(), order.end(), [weights](int e, int f)
+    { return weights[e] < weights[f] || (weights[e] == weights[f] && e < f); });
+    UnionFind sets(nbVertices);
+    for (int i=0; i<nbEdges && sets.nbSets() > 1; i++)
+    {
+        if (sets.unite(edgeVertices[2 * order[i]], edgeVertices[2 * order[i] + 1]))
+            reference.edges << order[i];
+    }
+    std::sort(reference.edges.begin(), reference.edges.end());
+    for (int i=0; i<reference.edges.size(); i++)
+        reference.totalWeight += edgeWeights[reference.edges[i]];
+    reference.nbTrees = nbVertices - reference.edges.size();
+    PrintSpanningForest("Kruskal", timer.nsecsElapsed() * 1e-6, reference, reference);
+    std::cout << "  total weight " << reference.totalWeight << ", " << reference.edges.size() << " edges, "
+              << reference.nbTrees << " trees" << std::endl;
+
+    bool ok = true;
+    SpanningTreeAlgorithm algorithms[2] = { SPANNING_TREE_FILTER_KRUSKAL, SPANNING_TREE_BORUVKA };
+    for (int a=0; a<2; a++)
+    {
+        for (int p=0; p<2; p++)
+        {
+            SpanningForest forest;
+            timer.start();
+            if (!MinimumSpanningForest(nbVertices, edgeVertices, edgeWeights, &forest, algorithms[a], p == 0 ? &single : &pool))
+                return 1;
+            double ms = timer.nsecsElapsed() * 1e-6;
+            QString name = QString("%1, %2 threads").arg(SpanningTreeAlgorithmName(algorithms[a])).arg(p == 0 ? 1 : pool.nbThreads());
+            PrintSpanningForest(name.toLocal8Bit().constData(), ms, forest, reference);
+            ok &= forest.edges == reference.edges && forest.totalWeight == reference.totalWeight;
+        }
+    }
+    return ok ? 0 : 1;
+}
+
+//******************************************************************************
+
+double MaxScoreError(const QVector<double> & scores, const QVector<double> & reference)
+{
+    double error = 0.0;
+    for (int i=0; i<scores.size(); i++)
+        error = qMax(error, qAbs(scores[i] - reference[i]));
+    return error;
+}
+
+//******************************************************************************
+/*!
+ * \brief RunCentralityBenchmark method measures the exact and the sampled centrality, on 1 and on all threads
+ * \param arguments : ggc --bench-centrality [nbVertices] [nbEdges]
+ *
+ * The generated graph is run with its weights (Dijkstra searches) and with unit weights
+ * (breadth-first searches). A tenth of the sources are sampled, the betweenness error is
+ * compared with its bound.
+ */
+int RunCentralityBenchmark(const QStringList & arguments)
+{
+    int nbVertices = arguments.value(2, "5000").toInt();
+    int nbEdges = arguments.value(3, "20000").toInt();
+    if (nbVertices < 3 || nbEdges < 1)
+        return 1;
+
+    ThreadPool & pool = ThreadPool::instance();
+    ThreadPool single(1, false);
+    std::cout << "Graph : " << nbVertices << " vertices, " << nbEdges << " edges, " << pool.nbThreads() << " threads" << std::endl;
+    int nbSamples = qMax(1, nbVertices / 10);
+
+    bool ok = true;
+    for (int unit=0; unit<2; unit++)
+    {
+        GraphDocument doc;
+        GenerateRandomDocument(nbVertices, nbEdges, 5, &doc);
+        if (unit)
+            doc.edgeWeights.fill(1.0);
+        Graph graph;
+        if (!SetupGraph(doc, &graph))
+            return 1;
+        std::cout << (unit ? "Unit weights :" : "Weights 1 to 9 :") << std::endl;
+
+        CentralityScores reference;
+        QElapsedTimer timer;
+        timer.start();
+        if (!ComputeCentrality(graph, &reference, 0, &single))
+            return 1;
+        double singleMs = timer.nsecsElapsed() * 1e-6;
+        std::cout << "  exact, 1 thread : " << singleMs << " ms, " << reference.nbSources << " sources" << std::endl;
+
+        CentralityScores scores;
+        timer.start();
+        ComputeCentrality(graph, &scores, 0, &pool);
+        double ms = timer.nsecsElapsed() * 1e-6;
+        double error = qMax(MaxScoreError(scores.betweenness, reference.betweenness),
+                            MaxScoreError(scores.closeness, reference.closeness));
+        std::cout << "  exact, " << pool.nbThreads() << " threads : " << ms << " ms, speedup " << singleMs / ms
+                  << (error < 1e-9 ? "" : " : DIFFERENT SCORES") << std::endl;
+        ok &= error < 1e-9;
+
+        timer.start();
+        ComputeCentrality(graph, &scores, nbSamples, &pool);
+        ms = timer.nsecsElapsed() * 1e-6;
+        error = MaxScoreError(scores.betweenness, reference.betweenness);
+        std::cout << "  sampled, " << scores.nbSources << " sources : " << ms << " ms, betweenness error "
+                  << error << " (bound " << scores.errorBound << ")" << std::endl;
+    }
+    return ok ? 0 : 1;
+}
+
+//******************************************************************************
+/*!
+ * \brief RunKShortestPathsBenchmark method measures Yen's algorithm on 1 and on all threads, and the walk enumeration
+ * \param arguments : ggc --bench-kpaths [nbVertices] [nbEdges] [k]
+ *
+ * Paths go from vertex 0 to the last vertex of a generated graph. The spur searches are
+ * reported with the vertices they settle, against nbVertices for a plain Dijkstra per spur.
+ */
+int RunKShortestPathsBenchmark(const QStringList & arguments)
+{
+    int nbVertices = arguments.value(2, "100000").toInt();
+    int nbEdges = arguments.value(3, "400000").toInt();
+    int k = arguments.value(4, "100").toInt();
+    if (nbVertices < 2 || nbEdges < 1 || k < 1)
+        return 1;
+
+    GraphDocument doc;
+    GenerateRandomDocument(nbVertices, nbEdges, 9, &doc);
+    Graph graph;
+    if (!SetupGraph(doc, &graph))
+        return 1;
+    ThreadPool & pool = ThreadPool::instance();
+    ThreadPool single(1, false);
+    std::cout << "Graph : " << nbVertices << " vertices, " << nbEdges << " edges, k = " << k << ", "
+              << pool.nbThreads() << " threads" << std::endl;
+
+    QList<WeightedPath> reference;
+    KShortestPathStatistics statistics;
+    QElapsedTimer timer;
+    timer.start();
+    if (!ComputeKShortestPaths(graph, 0, nbVertices - 1, k, &reference, K_SHORTEST_SIMPLE, &single, &statistics))
+        return 1;
+    double singleMs = timer.nsecsElapsed() * 1e-6;
+    if (reference.isEmpty())
+    {
+        std::cout << "No path between vertices" << std::endl;
+        return 0;
+    }
+    std::cout << "Yen, 1 thread : " << singleMs << " ms, " << reference.size() << " paths, distances "
+              << reference.first().distance << " to " << reference.last().distance << std::endl;
+    std::cout << "  " << statistics.nbSpurPaths << " spur paths, " << statistics.nbTreeSpurPaths << " from the tree, "
+              << double(statistics.nbSettled) / qMax(1, statistics.nbSpurPaths) << " vertices settled per spur" << std::endl;
+
+    QList<WeightedPath> paths;
+    timer.start();
+    ComputeKShortestPaths(graph, 0, nbVertices - 1, k, &paths, K_SHORTEST_SIMPLE, &pool);
+    double ms = timer.nsecsElapsed() * 1e-6;
+    bool ok = paths.size() == reference.size();
+    for (int i=0; ok && i<paths.size(); i++)
+        ok = paths[i].distance == reference[i].distance;
+    std::cout << "Yen, " << pool.nbThreads() << " threads : " << ms << " ms, speedup " << singleMs / ms
+              << (ok ? "" : " : DIFFERENT DISTANCES") << std::endl;
+
+    timer.start();
+    ComputeKShortestPaths(graph, 0, nbVertices - 1, k, &paths, K_SHORTEST_WALKS);
+    ms = timer.nsecsElapsed() * 1e-6;
+    std::cout << "Walks : " << ms << " ms, " << paths.size() << " walks, distances "
+              << paths.first().distance << " to " << paths.last().distance << std::endl;
+    // loopless paths are walks too
+    ok &= paths.size() == reference.size() && paths.last().distance <= reference.last().distance;
+    return ok ? 0 : 1;
+}
+
+//******************************************************************************
+
+static const int CACHE_LINE_BYTES = 64; //!< memory traffic of a last level cache miss
+
+QString PerEdge(const HardwareCounts & counts, HardwareCounter counter, int nbEdges)
+{
+    return counts.has(counter) ? QString::number(double(counts.values[counter]) / nbEdges, 'g', 3) : QString("n/a");
+}
+
+//******************************************************************************
+/*!
+ * \brief MeasurePhase method runs function() between the counter reads and prints the time and the derived metrics
+ *
+ * Metrics are per edge of the graph, whatever the number of sweeps of the phase : the same
+ * phase can be compared between layouts and orderings. Bytes per edge are the LLC misses
+ * times the cache line size, the memory traffic not served by the caches.
+ */
+template<class Function>
+void MeasurePhase(HardwareCounters & counters, const char * name, int nbEdges, const Function & function)
+{
+    HardwareCounts counts;
+    QElapsedTimer timer;
+    timer.start();
+    counters.start();
+    function();
+    counters.stop(&counts);
+    double ms = timer.nsecsElapsed() * 1e-6;
+
+    nbEdges = qMax(1, nbEdges);
+    std::cout << "  " << name << " : " << ms << " ms";
+    if (counters.isAvailable())
+    {
+        double ipc = counts.ipc();
+        QString bytes = counts.has(HC_LLC_MISSES) ?
+                    QString::number(double(counts.values[HC_LLC_MISSES]) * CACHE_LINE_BYTES / nbEdges, 'g', 3) :
+                    QString("n/a");
+        std::cout << ", IPC " << (ipc < 0.0 ? QString("n/a") : QString::number(ipc, 'g', 3)).toLocal8Bit().constData()
+                  << ", per edge : LLC misses " << PerEdge(counts, HC_LLC_MISSES, nbEdges).toLocal8Bit().constData()
+                  << " (" << bytes.toLocal8Bit().constData() << " bytes)"
+                  << ", dTLB misses " << PerEdge(counts, HC_DTLB_MISSES, nbEdges).toLocal8Bit().constData()
+                  << ", branch misses " << PerEdge(counts, HC_BRANCH_MISSES, nbEdges).toLocal8Bit().constData();
+    }
+    std::cout << std::endl;
+}
+
+//******************************************************************************
+/*!
+ * \brief RunPerfCounterBenchmark method reads the hardware counters of the graph algorithms for each vertex ordering
+ * \param arguments : ggc --bench-perf [file.ggc], a shuffled 200 x 200 grid by default
+ *
+ * Phases run on the calling thread : greedy coloring neighbor scans, Bellman-Ford edge list
+ * sweeps, Dijkstra on the CSR copy and the connected components. Without counters (no
+ * permission, virtual machine, not Linux) the times are still printed.
+ */
+int RunPerfCounterBenchmark(const QStringList & arguments)
+{
+    GraphDocument doc;
+    if (arguments.size() > 2)
+    {
+        if (!LoadCommandLineGraph(arguments, 2, &doc))
+            return 1;
+    }
+    else
+    {
+        GenerateShuffledGridDocument(200, 200, 1, &doc);
+    }
+    Graph graph;
+    if (!SetupGraph(doc, &graph) || graph.vertices.isEmpty())
+        return 1;
+    int n = graph.vertices.size();
+    int nbEdges = doc.nbEdges();
+    std::cout << "Graph : " << n << " vertices, " << nbEdges << " edges" << std::endl;
+
+    HardwareCounters counters;
+    if (!counters.isAvailable())
+        std::cout << "Hardware counters unavailable, " << counters.error().toLocal8Bit().constData()
+                  << " : times only" << std::endl;
+    else if (!counters.error().isEmpty())
+        std::cout << "Some hardware counters are unavailable, " << counters.error().toLocal8Bit().constData() << std::endl;
+
+    for (int o=0; o<ORDER_NB_ORDERINGS; o++)
+    {
+        VertexOrdering ordering = VertexOrdering(o);
+        VertexPermutation permutation;
+        Graph permuted;
+        if (!ComputeVertexOrdering(graph, ordering, &permutation) || !PermuteGraph(graph, permutation, &permuted))
+            return 1;
+        std::cout << VertexOrderingName(ordering) << ", mean edge span " << MeanEdgeSpan(permuted) << " :" << std::endl;
+        int source = permutation.toNew(0);
+        int target = permutation.toNew(n - 1);
+
+        MeasurePhase(counters, "greedy coloring", nbEdges, [&]()
+        {
+            for (int i=0; i<n; i++)
+                permuted.vertices[i].color = -1;
+            GreedyGraphColoring(&permuted);
+        });
+        MeasurePhase(counters, "Bellman-Ford", nbEdges, [&]()
+        {
+            QList<int> path;
+            BellmanFordMinDistance(permuted, source, target, &path);
+        });
+        CsrGraph csr;
+        csr.build(permuted);
+        MeasurePhase(counters, "Dijkstra (CSR)", nbEdges, [&]()
+        {
+            QVector<double> distances;
+            ShortestPathKernel(csr, source, -1, &distances);
+        });
+        MeasurePhase(counters, "connected components", nbEdges, [&]()
+        {
+            for (int i=0; i<n; i++)
+                permuted.vertices[i].color = -1;
+            ConnectedComponents components;
+            ColorConnectedVertices(permuted, &components);
+        });
+    }
+    return 0;
+}
+
+//******************************************************************************
+/*!
+ * \brief RunTriangleBenchmark method measures each intersection kernel of CountTriangles on 1 and on all threads
+ * \param arguments : ggc --bench-triangles [nbVertices] [nbEdges]
+ *
+ * The graph has skewed degrees (first endpoint drawn as n*u^4) so that the hash kernel has
+ * high degree vertices to work on. Throughput is in distinct edges per second, orientation included.
+ */
+int RunTriangleBenchmark(const QStringList & arguments)
+{
+    int nbVertices = arguments.value(2, "200000").toInt();
+    int nbEdges = arguments.value(3, "2000000").toInt();
+    if (nbVertices < 3 || nbEdges < 1)
+        return 1;
+
+    QVector<int> edgeVertices(2 * nbEdges);
+    quint32 seed = 5;
+    for (int i=0; i<nbEdges; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        double u = (seed >> 8) / double(1 << 24);
+        seed = seed * 1664525u + 1013904223u;
+        edgeVertices[2*i] = qMin(nbVertices - 1, int(nbVertices * u * u * u * u));
+        edgeVertices[2*i + 1] = (seed >> 8) % nbVertices;
+    }
+
+    ThreadPool & pool = ThreadPool::instance();
+    ThreadPool single(1, false);
+    TriangleCounts reference;
+    if (!CountTriangles(nbVertices, edgeVertices, &reference, INTERSECT_MERGE, &single))
+        return 1;
+    std::cout << "Skewed graph : " << nbVertices << " vertices, " << reference.nbEdges << " edges, "
+              << reference.nbTriangles << " triangles, clustering " << reference.globalClustering
+              << " global, " << reference.averageClustering << " average" << std::endl;
+
+    bool ok = true;
+    for (int k=0; k<INTERSECT_NB_KERNELS; k++)
+    {
+        IntersectionKernel kernel = IntersectionKernel(k);
+        for (int p=0; p<2; p++)
+        {
+            ThreadPool * workers = p ? &pool : &single;
+            TriangleCounts counts;
+            QElapsedTimer timer;
+            timer.start();
+            CountTriangles(nbVertices, edgeVertices, &counts, kernel, workers);
+            double ms = timer.nsecsElapsed() * 1e-6;
+            bool isSame = counts.nbTriangles == reference.nbTriangles && counts.vertexTriangles == reference.vertexTriangles;
+            ok &= isSame;
+            std::cout << "  " << IntersectionKernelName(kernel) << ", " << workers->nbThreads() << " thread(s) : "
+                      << ms << " ms, " << (ms > 0.0 ? reference.nbEdges / (ms * 1e3) : 0.0) << " Medges/s"
+                      << (isSame ? "" : " : DIFFERENT COUNTS") << std::endl;
+        }
+    }
+    return ok ? 0 : 1;
+}
+
+//******************************************************************************
+
+}
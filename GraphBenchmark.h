@@ -0,0 +1,53 @@
+#ifndef GRAPHBENCHMARK_H
+#define GRAPHBENCHMARK_H
+
+// Qt
+#include <QStringList>
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+int RunNumaBenchmark(const QStringList & arguments);
+
+int RunOrderingBenchmark(const QStringList & arguments);
+
+int RunCompressionBenchmark(const QStringList & arguments);
+
+int RunBuildBenchmark(const QStringList & arguments);
+
+int RunDynamicBenchmark(const QStringList & arguments);
+
+int RunVersionedBenchmark(const QStringList & arguments);
+
+int RunContractionBenchmark(const QStringList & arguments);
+
+int RunExactColoringBenchmark(const QStringList & arguments);
+
+int RunSchedulerBenchmark(const QStringList & arguments);
+
+int RunExternalBenchmark(const QStringList & arguments);
+
+int RunServerBenchmark(const QStringList & arguments);
+
+int RunWeightBenchmark(const QStringList & arguments);
+
+int RunSpanningTreeBenchmark(const QStringList & arguments);
+
+int RunCentralityBenchmark(const QStringList & arguments);
+
+int RunKShortestPathsBenchmark(const QStringList & arguments);
+
+int RunPerfCounterBenchmark(const QStringList & arguments);
+
+int RunTriangleBenchmark(const QStringList & arguments);
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHBENCHMARK_H
@@ -0,0 +1,263 @@
+
+// STD
+#include <iostream>
+
+// Qt
+
+// Project
+#include "GraphBuilder.h"
+#include "GraphCsr.h"
+#include "GraphThreadPool.h"
+#include "GraphProfiler.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+/*!
+ * \brief ParallelRadixSort method sorts (key, value) pairs by key, stable LSD radix sort on 8 bit digits
+ * \param pool
+ * \param keys
+ * \param values
+ * \param nbKeyBits only the low nbKeyBits bits of the keys are used
+ *
+ * For each digit, workers count the digits of their range, counts are scanned digit by digit
+ * then worker by worker, and each worker scatters its range to the positions it got. Worker
+ * ranges are in input order, so equal keys keep their input order.
+ */
+void ParallelRadixSort(ThreadPool & pool, QVector<quint64> & keys, QVector<int> & values, int nbKeyBits)
+{
+    GT_PROFILE_SCOPE("ParallelRadixSort");
+    int size = keys.size();
+    int nbWorkers = pool.nbThreads();
+    QVector<quint64> keyBuffer(size);
+    QVector<int> valueBuffer(size);
+    QVector<int> counts(256 * nbWorkers);
+
+    for (int shift=0; shift<nbKeyBits; shift+=8)
+    {
+        const quint64 * inKeys = keys.constData();
+        const int * inValues = values.constData();
+        quint64 * outKeys = keyBuffer.data();
+        int * outValues = valueBuffer.data();
+        int * positions = counts.data();
+
+        counts.fill(0);
+        RunParallel(pool, [&](int worker)
+        {
+            int begin, end;
+            pool.workerRange(worker, size, &begin, &end);
+            int * workerCounts = positions + 256 * worker;
+            for (int i=begin; i<end; i++)
+                workerCounts[(inKeys[i] >> shift) & 0xFF]++;
+        });
+
+        // a digit shared by all keys does not change the order
+        bool isSorted = false;
+        int position = 0;
+        for (int digit=0; digit<256; digit++)
+        {
+            int digitCount = 0;
+            for (int worker=0; worker<nbWorkers; worker++)
+            {
+                int count = positions[256 * worker + digit];
+                positions[256 * worker + digit] = position;
+                position += count;
+                digitCount += count;
+            }
+            isSorted |= digitCount == size;
+        }
+        if (isSorted)
+            continue;
+
+        RunParallel(pool, [&](int worker)
+        {
+            int begin, end;
+            pool.workerRange(worker, size, &begin, &end);
+            int * workerPositions = positions + 256 * worker;
+            for (int i=begin; i<end; i++)
+            {
+                int p = workerPositions[(inKeys[i] >> shift) & 0xFF]++;
+                outKeys[p] = inKeys[i];
+                outValues[p] = inValues[i];
+            }
+        });
+        keys.swap(keyBuffer);
+        values.swap(valueBuffer);
+    }
+}
+
+//******************************************************************************
+/*!
+ * \brief BuildCsrGraph method builds a CSR graph from an edge list, without self-loops and parallel edges
+ * \param nbVertices
+ * \param edgeVertices edge i connects edgeVertices[2*i] and edgeVertices[2*i+1] (GraphDocument layout)
+ * \param edgeWeights
+ * \param directed if false, each edge gives two arcs
+ * \param merge weight of the arcs given several times
+ * \param csr output
+ * \param pool ThreadPool::instance() if null
+ * \param placement NUMA placement of the CSR arrays
+ * \param statistics optional output, number of dropped self-loops and merged arcs
+ * \return false if a vertex id is invalid or the graph does not fit the CSR arrays
+ *
+ * Pipeline : arcs are packed as (source, target) keys, sorted with ParallelRadixSort, the first
+ * arc of each run of equal keys is flagged, a parallel prefix sum of the flags gives the
+ * position of each unique arc and the row offsets, then each run is merged into its position.
+ */
+bool BuildCsrGraph(int nbVertices, const QVector<int> & edgeVertices, const QVector<double> & edgeWeights,
+                   bool directed, DuplicateEdgeMerge merge, CsrGraph * csr,
+                   ThreadPool * pool, NumaPlacement placement, CsrBuildStatistics * statistics)
+{
+    GT_PROFILE_SCOPE("BuildCsrGraph");
+    if (!csr || nbVertices < 0 || edgeVertices.size() != 2 * edgeWeights.size())
+        return false;
+    int nbEdges = edgeWeights.size();
+    if (!directed && nbEdges > (1 << 30) - 1)
+    {
+        std::cerr << "BuildCsrGraph : too many edges" << std::endl;
+        return false;
+    }
+    ThreadPool & workers = pool ? *pool : ThreadPool::instance();
+    int nbWorkers = workers.nbThreads();
+    int arcsPerEdge = directed ? 1 : 2;
+
+    int vertexBits = 1;
+    while (vertexBits < 31 && (1 << vertexBits) < nbVertices)
+        vertexBits++;
+    quint64 targetMask = (quint64(1) << vertexBits) - 1;
+
+    // arcs, self-loops dropped :
+    const int * vertices = edgeVertices.constData();
+    QVector<int> workerArcs(nbWorkers + 1, 0);
+    QVector<int> workerInvalid(nbWorkers, 0);
+    RunParallel(workers, [&](int worker)
+    {
+        int begin, end;
+        workers.workerRange(worker, nbEdges, &begin, &end);
+        int count = 0;
+        for (int i=begin; i<end; i++)
+        {
+            int a = vertices[2*i];
+            int b = vertices[2*i+1];
+            if (a < 0 || a >= nbVertices || b < 0 || b >= nbVertices)
+                workerInvalid[worker]++;
+            else if (a != b)
+                count += arcsPerEdge;
+        }
+        workerArcs[worker + 1] = count;
+    });
+    for (int worker=0; worker<nbWorkers; worker++)
+    {
+        if (workerInvalid[worker] > 0)
+        {
+            std::cerr << "BuildCsrGraph : invalid vertex id in the edge list" << std::endl;
+            return false;
+        }
+        workerArcs[worker + 1] += workerArcs[worker];
+    }
+    int nbInputArcs = workerArcs.last();
+
+    QVector<quint64> keys(nbInputArcs);
+    QVector<int> arcEdges(nbInputArcs);
+    quint64 * keyData = keys.data();
+    int * arcEdgeData = arcEdges.data();
+    RunParallel(workers, [&](int worker)
+    {
+        int begin, end;
+        workers.workerRange(worker, nbEdges, &begin, &end);
+        int position = workerArcs[worker];
+        for (int i=begin; i<end; i++)
+        {
+            quint64 a = vertices[2*i];
+            quint64 b = vertices[2*i+1];
+            if (a == b)
+                continue;
+            keyData[position] = (a << vertexBits) | b;
+            arcEdgeData[position++] = i;
+            if (!directed)
+            {
+                keyData[position] = (b << vertexBits) | a;
+                arcEdgeData[position++] = i;
+            }
+        }
+    });
+
+    ParallelRadixSort(workers, keys, arcEdges, 2 * vertexBits);
+    const quint64 * sortedKeys = keys.constData();
+    const int * sortedEdges = arcEdges.constData();
+
+    // unique arc positions :
+    QVector<int> positions(nbInputArcs);
+    int * positionData = positions.data();
+    RunParallel(workers, [&](int worker)
+    {
+        int begin, end;
+        workers.workerRange(worker, nbInputArcs, &begin, &end);
+        for (int i=begin; i<end; i++)
+            positionData[i] = i == 0 || sortedKeys[i] != sortedKeys[i-1] ? 1 : 0;
+    });
+    int nbArcs = ParallelExclusiveScan(workers, positionData, nbInputArcs);
+
+    // row offsets : vertices in (source of arc i-1, source of arc i] start at the position of arc i
+    QVector<int> offsets(nbVertices + 1);
+    int * offsetData = offsets.data();
+    RunParallel(workers, [&](int worker)
+    {
+        int begin, end;
+        workers.workerRange(worker, nbInputArcs, &begin, &end);
+        for (int i=begin; i<end; i++)
+        {
+            int source = int(sortedKeys[i] >> vertexBits);
+            int previous = i == 0 ? -1 : int(sortedKeys[i-1] >> vertexBits);
+            for (int v=previous+1; v<=source; v++)
+                offsetData[v] = positionData[i];
+        }
+    });
+    int lastSource = nbInputArcs > 0 ? int(sortedKeys[nbInputArcs-1] >> vertexBits) : -1;
+    for (int v=lastSource+1; v<=nbVertices; v++)
+        offsetData[v] = nbArcs;
+
+    // merge runs of equal arcs :
+    if (!csr->allocate(nbVertices, offsetData, placement, &workers))
+        return false;
+    int * targets = csr->targets();
+    double * weights = csr->weights();
+    const double * inputWeights = edgeWeights.constData();
+    RunParallel(workers, [&](int worker)
+    {
+        int begin, end;
+        workers.workerRange(worker, nbInputArcs, &begin, &end);
+        for (int i=begin; i<end; i++)
+        {
+            if (i > 0 && sortedKeys[i] == sortedKeys[i-1])
+                continue;
+            // stable sort : the first arc of the run comes from the first edge
+            double weight = inputWeights[sortedEdges[i]];
+            for (int j=i+1; j<nbInputArcs && sortedKeys[j] == sortedKeys[i]; j++)
+            {
+                double w = inputWeights[sortedEdges[j]];
+                if (merge == MERGE_MIN_WEIGHT)
+                    weight = qMin(weight, w);
+                else if (merge == MERGE_SUM_WEIGHTS)
+                    weight += w;
+            }
+            targets[positionData[i]] = int(sortedKeys[i] & targetMask);
+            weights[positionData[i]] = weight;
+        }
+    });
+
+    if (statistics)
+    {
+        statistics->nbInputEdges = nbEdges;
+        statistics->nbSelfLoops = nbEdges - nbInputArcs / arcsPerEdge;
+        statistics->nbDuplicateArcs = nbInputArcs - nbArcs;
+        statistics->nbArcs = nbArcs;
+    }
+    return true;
+}
+
+//******************************************************************************
+
+}
@@ -0,0 +1,62 @@
+#ifndef GRAPHBUILDER_H
+#define GRAPHBUILDER_H
+
+// Qt
+#include <QVector>
+
+// Project
+#include "GraphMemory.h"
+
+//******************************************************************************
+
+namespace GT {
+
+class CsrGraph;
+class ThreadPool;
+
+//******************************************************************************
+/*!
+ * Weight of an edge given several times :
+ * MERGE_MIN_WEIGHT : the smallest weight, keeps shortest paths unchanged
+ * MERGE_SUM_WEIGHTS : the sum of the weights, e.g. for edge counts
+ * MERGE_KEEP_FIRST : the weight of the first occurrence in the edge list
+ */
+enum DuplicateEdgeMerge
+{
+    MERGE_MIN_WEIGHT=0,
+    MERGE_SUM_WEIGHTS,
+    MERGE_KEEP_FIRST
+};
+
+//******************************************************************************
+
+struct CsrBuildStatistics
+{
+    CsrBuildStatistics() :
+        nbInputEdges(0),
+        nbSelfLoops(0),
+        nbDuplicateArcs(0),
+        nbArcs(0)
+    {
+    }
+    int nbInputEdges;
+    int nbSelfLoops; //!< dropped input edges
+    int nbDuplicateArcs; //!< arcs merged into another one
+    int nbArcs; //!< arcs of the built graph
+};
+
+//******************************************************************************
+
+void ParallelRadixSort(ThreadPool & pool, QVector<quint64> & keys, QVector<int> & values, int nbKeyBits);
+
+bool BuildCsrGraph(int nbVertices, const QVector<int> & edgeVertices, const QVector<double> & edgeWeights,
+                   bool directed, DuplicateEdgeMerge merge, CsrGraph * csr,
+                   ThreadPool * pool=0, NumaPlacement placement=NUMA_DEFAULT, CsrBuildStatistics * statistics=0);
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHBUILDER_H
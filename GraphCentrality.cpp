@@ -0,0 +1,355 @@
+
+// STD
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+// Qt
+#include <QtAlgorithms>
+
+// Project
+#include "GraphCentrality.h"
+#include "GraphWeighted.h"
+#include "GraphThreadPool.h"
+#include "GraphScheduler.h"
+#include "GraphProfiler.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+static const quint32 CENTRALITY_SAMPLE_SEED = 1; //!< sampled sources are reproducible
+
+//******************************************************************************
+/*!
+ * \brief CentralitySums struct accumulates the contributions of the sources run by one worker
+ */
+struct CentralitySums
+{
+    QVector<double> dependencies; //!< sum over the sources of the Brandes dependency of each vertex
+    QVector<double> farness; //!< sum of the distances from the sources reaching each vertex
+    QVector<int> reached; //!< number of sources reaching each vertex
+};
+
+//******************************************************************************
+/*!
+ * \brief BrandesSearch class runs the single source part of Brandes' algorithm on one adjacency
+ *
+ * The forward search settles the vertices in distance order and counts the shortest paths
+ * (sigma), breadth-first for unit weights, Dijkstra otherwise. The dependencies are then
+ * accumulated in the reverse order : w is a predecessor of its out-neighbor v on a shortest
+ * path if dist(v) == dist(w) + weight(w, v) and v is settled after w, so no predecessor lists
+ * are stored. The settled order breaks the ties of zero weight edges : between two vertices at
+ * the same distance, only the first settled is a predecessor of the other.
+ * Only the settled vertices are reset after a source, a search costs the size of its reach.
+ */
+template<class Adjacency>
+class BrandesSearch
+{
+public:
+    typedef typename Adjacency::Weight Weight;
+    typedef typename WeightTraits<Weight>::Distance Distance;
+
+    BrandesSearch(const Adjacency & adjacency, bool unit) :
+        _adjacency(adjacency),
+        _unit(unit),
+        _distances(adjacency.nbVertices(), WeightTraits<Weight>::infinity()),
+        _sigma(adjacency.nbVertices(), 0.0),
+        _delta(adjacency.nbVertices(), 0.0),
+        _positions(adjacency.nbVertices(), -1)
+    {
+        _order.reserve(adjacency.nbVertices());
+    }
+
+    void run(int source, CentralitySums * sums)
+    {
+        if (_unit)
+            breadthFirst(source);
+        else
+            dijkstra(source);
+
+        Distance * distances = _distances.data();
+        double * sigma = _sigma.data();
+        double * delta = _delta.data();
+        double * dependencies = sums->dependencies.data();
+        const int * positions = _positions.constData();
+        for (int i=_order.size()-1; i>0; i--)
+        {
+            int w = _order[i];
+            Distance distance = distances[w];
+            for (typename Adjacency::NeighborIterator it=_adjacency.neighbors(w); !it.atEnd(); it.next())
+            {
+                int v = it.target();
+                if (distances[v] == distance + Distance(it.weight()) && positions[v] > i)
+                    delta[w] += sigma[w] / sigma[v] * (1.0 + delta[v]);
+            }
+            dependencies[w] += delta[w];
+            sums->farness[w] += double(distance);
+            sums->reached[w]++;
+        }
+
+        foreach (int w, _order)
+        {
+            distances[w] = WeightTraits<Weight>::infinity();
+            sigma[w] = 0.0;
+            delta[w] = 0.0;
+            _positions[w] = -1;
+        }
+        _order.clear();
+    }
+
+private:
+    //! the settled order doubles as the queue
+    void breadthFirst(int source)
+    {
+        Distance * distances = _distances.data();
+        double * sigma = _sigma.data();
+        distances[source] = 0;
+        sigma[source] = 1.0;
+        settle(source);
+        for (int head=0; head<_order.size(); head++)
+        {
+            int v = _order[head];
+            Distance next = distances[v] + 1;
+            for (typename Adjacency::NeighborIterator it=_adjacency.neighbors(v); !it.atEnd(); it.next())
+            {
+                int t = it.target();
+                if (distances[t] == WeightTraits<Weight>::infinity())
+                {
+                    distances[t] = next;
+                    settle(t);
+                }
+                if (distances[t] == next)
+                    sigma[t] += sigma[v];
+            }
+        }
+    }
+
+    void dijkstra(int source)
+    {
+        typedef std::pair<Distance, int> Entry;
+        Distance * distances = _distances.data();
+        double * sigma = _sigma.data();
+        distances[source] = 0;
+        sigma[source] = 1.0;
+        _heap.push_back(Entry(0, source));
+        while (!_heap.empty())
+        {
+            std::pop_heap(_heap.begin(), _heap.end(), std::greater<Entry>());
+            Entry top = _heap.back();
+            _heap.pop_back();
+            int v = top.second;
+            if (top.first != distances[v] || _positions[v] >= 0)
+                continue;
+            settle(v);
+            for (typename Adjacency::NeighborIterator it=_adjacency.neighbors(v); !it.atEnd(); it.next())
+            {
+                int t = it.target();
+                Distance distance = top.first + Distance(it.weight());
+                if (distance < distances[t])
+                {
+                    distances[t] = distance;
+                    sigma[t] = sigma[v];
+                    _heap.push_back(Entry(distance, t));
+                    std::push_heap(_heap.begin(), _heap.end(), std::greater<Entry>());
+                }
+                else if (distance == distances[t] && _positions[t] < 0)
+                {
+                    sigma[t] += sigma[v];
+                }
+            }
+        }
+    }
+
+    void settle(int v)
+    {
+        _positions[v] = _order.size();
+        _order << v;
+    }
+
+    const Adjacency & _adjacency;
+    bool _unit;
+    QVector<Distance> _distances;
+    QVector<double> _sigma; //!< shortest path counts, in double as they grow exponentially
+    QVector<double> _delta;
+    QVector<int> _order; //!< settled vertices, non decreasing distances
+    QVector<int> _positions; //!< index in _order, -1 if not settled
+    std::vector< std::pair<Distance, int> > _heap;
+
+    Q_DISABLE_COPY(BrandesSearch)
+};
+
+//******************************************************************************
+/*!
+ * \brief RunBrandes method runs the searches from the sources in parallel, one BrandesSearch and one CentralitySums per worker
+ */
+template<class Adjacency>
+bool RunBrandes(const Adjacency & adjacency, bool unit, const QVector<int> & sources, ThreadPool & workers,
+                const CancellationToken * cancellation, CentralitySums * total)
+{
+    int n = adjacency.nbVertices();
+    int nbWorkers = workers.nbThreads();
+    CentralitySums empty;
+    empty.dependencies.fill(0.0, n);
+    empty.farness.fill(0.0, n);
+    empty.reached.fill(0, n);
+    WorkerLocal<CentralitySums> sums(workers, empty);
+    QVector<BrandesSearch<Adjacency>*> searches;
+    for (int worker=0; worker<nbWorkers; worker++)
+        searches << new BrandesSearch<Adjacency>(adjacency, unit);
+
+    // a source costs a whole search, chunks of one source balance best
+    bool done = ParallelFor(workers, sources.size(), [&](int begin, int end, int worker)
+    {
+        for (int i=begin; i<end; i++)
+            searches[worker]->run(sources[i], &sums[worker]);
+    }, 1, cancellation);
+    qDeleteAll(searches);
+    if (!done)
+        return false;
+
+    *total = empty;
+    for (int worker=0; worker<nbWorkers; worker++)
+    {
+        const CentralitySums & local = sums[worker];
+        for (int v=0; v<n; v++)
+        {
+            total->dependencies[v] += local.dependencies[v];
+            total->farness[v] += local.farness[v];
+            total->reached[v] += local.reached[v];
+        }
+    }
+    return true;
+}
+
+//******************************************************************************
+
+template<class W>
+bool RunWeightedBrandes(const Graph & graph, bool unit, const QVector<int> & sources, ThreadPool & workers,
+                        const CancellationToken * cancellation, CentralitySums * total)
+{
+    WeightedCsrGraph<W> adjacency;
+    if (!adjacency.build(graph))
+        return false;
+    return RunBrandes(adjacency, unit, sources, workers, cancellation, total);
+}
+
+//******************************************************************************
+/*!
+ * \brief SampleSources method picks nbSamples distinct vertices uniformly, by a partial Fisher-Yates shuffle
+ */
+QVector<int> SampleSources(int n, int nbSamples)
+{
+    QVector<int> vertices(n);
+    for (int v=0; v<n; v++)
+        vertices[v] = v;
+    quint32 seed = CENTRALITY_SAMPLE_SEED;
+    for (int i=0; i<nbSamples; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        int j = i + int((quint64(seed) * quint64(n - i)) >> 32);
+        std::swap(vertices[i], vertices[j]);
+    }
+    vertices.resize(nbSamples);
+    return vertices;
+}
+
+//******************************************************************************
+/*!
+ * \brief SampleErrorBound method is the Hoeffding bound for nbSamples sources, with a union bound over the n vertices
+ *
+ * A source s contributes delta_s(v) / (n-2) in [0, 1] to the scaled betweenness of v, the
+ * normalized betweenness is n / (n-1) times the mean contribution.
+ */
+double SampleErrorBound(int n, int nbSamples)
+{
+    double mean = std::sqrt(std::log(2.0 * n / CENTRALITY_FAILURE_PROBABILITY) / (2.0 * nbSamples));
+    return n * mean / (n - 1);
+}
+
+//******************************************************************************
+
+int CentralitySampleCount(int nbVertices, double epsilon)
+{
+    if (nbVertices < 3 || epsilon <= 0.0)
+        return nbVertices;
+    double mean = epsilon * (nbVertices - 1) / nbVertices;
+    double count = std::ceil(std::log(2.0 * nbVertices / CENTRALITY_FAILURE_PROBABILITY) / (2.0 * mean * mean));
+    return count >= nbVertices ? nbVertices : int(count);
+}
+
+//******************************************************************************
+
+bool ComputeCentrality(const Graph & graph, CentralityScores * scores, int nbSamples, ThreadPool * pool,
+                       const CancellationToken * cancellation)
+{
+    GT_PROFILE_SCOPE("ComputeCentrality");
+    if (!scores)
+        return false;
+    *scores = CentralityScores();
+    int n = graph.vertices.size();
+    scores->betweenness.fill(0.0, n);
+    scores->closeness.fill(0.0, n);
+    if (n == 0)
+        return true;
+
+    WeightType type = SelectWeightType(graph);
+    if (type == WEIGHT_NEGATIVE)
+    {
+        std::cerr << "ComputeCentrality : negative weights are not supported" << std::endl;
+        return false;
+    }
+
+    bool exact = nbSamples <= 0 || nbSamples >= n;
+    QVector<int> sources = SampleSources(n, exact ? n : nbSamples);
+    scores->isExact = exact;
+    scores->nbSources = sources.size();
+    scores->isUnweighted = type == WEIGHT_UNIT;
+
+    ThreadPool & workers = pool ? *pool : ThreadPool::instance();
+    CentralitySums sums;
+    bool done = false;
+    switch (type)
+    {
+    case WEIGHT_UNIT:
+    case WEIGHT_UINT8:
+        done = RunWeightedBrandes<quint8>(graph, type == WEIGHT_UNIT, sources, workers, cancellation, &sums);
+        break;
+    case WEIGHT_UINT32:
+        done = RunWeightedBrandes<quint32>(graph, false, sources, workers, cancellation, &sums);
+        break;
+    case WEIGHT_FLOAT:
+        done = RunWeightedBrandes<float>(graph, false, sources, workers, cancellation, &sums);
+        break;
+    default:
+        done = RunWeightedBrandes<double>(graph, false, sources, workers, cancellation, &sums);
+        break;
+    }
+    if (!done)
+        return false;
+
+    // an undirected path is counted from both ends, as are the ordered pairs of the directed normalization
+    double scale = double(n) / scores->nbSources;
+    double pairs = double(n - 1) * (n - 2);
+    for (int v=0; v<n && pairs > 0.0; v++)
+        scores->betweenness[v] = scale * sums.dependencies[v] / pairs;
+    for (int v=0; v<n && n > 1; v++)
+    {
+        if (sums.reached[v] == 0 || sums.farness[v] <= 0.0)
+            continue;
+        double reached = sums.reached[v];
+        scores->closeness[v] = qMin(1.0, scale * reached / (n - 1)) * reached / sums.farness[v];
+    }
+    if (!scores->isExact && n > 2)
+        scores->errorBound = SampleErrorBound(n, scores->nbSources);
+    return true;
+}
+
+//******************************************************************************
+
+}
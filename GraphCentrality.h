@@ -0,0 +1,70 @@
+#ifndef GRAPHCENTRALITY_H
+#define GRAPHCENTRALITY_H
+
+// Qt
+#include <QVector>
+
+//******************************************************************************
+
+namespace GT {
+
+struct Graph;
+class ThreadPool;
+class CancellationToken;
+
+//******************************************************************************
+
+static const double CENTRALITY_FAILURE_PROBABILITY = 0.05; //!< the sampled error bound holds with probability 1 - this value
+
+//******************************************************************************
+/*!
+ * \brief CentralityScores struct holds the betweenness and closeness of each vertex
+ *
+ * Betweenness is normalized to [0, 1] : the fraction of the shortest paths between the other
+ * vertex pairs going through the vertex, divided by (n-1)(n-2). Closeness follows Wasserman and
+ * Faust for disconnected graphs : (r / (n-1)) / (mean distance from the r vertices reaching it),
+ * it is 1 for a vertex adjacent to all others with unit weights.
+ */
+struct CentralityScores
+{
+    CentralityScores() :
+        nbSources(0),
+        isExact(true),
+        errorBound(0.0),
+        isUnweighted(false)
+    {
+    }
+
+    QVector<double> betweenness;
+    QVector<double> closeness;
+    int nbSources; //!< single source searches done
+    bool isExact;
+    //! sampled mode : with probability 1 - CENTRALITY_FAILURE_PROBABILITY, every betweenness is within errorBound of the exact one
+    double errorBound;
+    bool isUnweighted; //!< breadth-first searches were used
+};
+
+//******************************************************************************
+/*!
+ * \brief ComputeCentrality method computes Brandes' betweenness and the closeness of all vertices
+ * \param nbSamples 0 or nbVertices or more for the exact scores, else the number of random sources
+ * \param pool ThreadPool::instance() if 0
+ * \param cancellation optional, returns false once cancelled
+ * \return false on negative weights or when cancelled
+ *
+ * Two vertices joined by a zero weight edge are not each other's predecessor : the one settled
+ * first by the search is.
+ */
+bool ComputeCentrality(const Graph & graph, CentralityScores * scores, int nbSamples=0, ThreadPool * pool=0,
+                       const CancellationToken * cancellation=0);
+
+//! number of sampled sources giving the error bound epsilon on every betweenness
+int CentralitySampleCount(int nbVertices, double epsilon);
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHCENTRALITY_H
@@ -0,0 +1,475 @@
+
+// STD
+#include <iostream>
+#include <limits>
+
+// Qt
+#include <QFile>
+#include <QElapsedTimer>
+
+// Project
+#include "GraphCommandLine.h"
+#include "GraphTools.h"
+#include "GraphIO.h"
+#include "GraphDistributed.h"
+#include "GraphBenchmark.h"
+#include "GraphExternal.h"
+#include "GraphServer.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+void PrintCommandLineUsage()
+{
+    std::cout << "Usage : ggc [command]" << std::endl
+              << "Without command the graph tools application is started." << std::endl
+              << "Commands :" << std::endl
+              << "  --check-distributed <nbWorkers> [file.ggc]  compare multi-process components and shortest paths with the sequential ones" << std::endl
+              << "  --bench-numa [nbThreads] [file.ggc]         memory bandwidth between NUMA nodes, pinned versus unpinned graph sweeps" << std::endl
+              << "  --bench-order [file.ggc]                    traversal times for each vertex ordering (RCM, hub sort, Rabbit)" << std::endl
+              << "  --bench-compressed [file.ggc]               compressed adjacency size and traversal throughput versus CSR" << std::endl
+              << "  --bench-build [nbEdges] [nbThreads]         parallel radix sort CSR builder versus the current graph setup" << std::endl
+              << "  --bench-dynamic [nbEdges] [batchSize]       batched edge updates of the dynamic graph versus a rebuild" << std::endl
+              << "  --bench-versioned [nbReaders] [nbEdges]     readers on pinned graph versions while a writer publishes edits" << std::endl
+              << "  --bench-ch [nbQueries] [file.ggc]           contraction hierarchy queries versus ComputeMinDistance" << std::endl
+              << "  --bench-exact [nbVertices] [timeBudgetMs]   exact coloring versus greedy, one thread versus all" << std::endl
+              << "  --bench-steal [nbVertices] [nbThreads]      work stealing ParallelFor versus static ranges on skewed degrees" << std::endl
+              << "  --bench-external [nbVertices] [nbEdges]     out-of-core components and Bellman-Ford streaming a generated edge file" << std::endl
+              << "  --export-edges <file.ggc> <file.edges>      write the edges of a graph file as an edge file for the out-of-core mode" << std::endl
+              << "  --external <file.edges> [sourceId]          out-of-core components and distances from the source, edges streamed from disk" << std::endl
+              << "  --serve <serverName> [file.ggc]             answer shortest path, component and color queries on a local socket" << std::endl
+              << "  --query <serverName> <query> [a] [b]        send one query : path a b, component a, color a, stats or shutdown" << std::endl
+              << "  --bench-server [nbClients] [nbQueries]      query server throughput and latency, with and without batching" << std::endl
+              << "  --bench-weights [nbVertices] [nbEdges]      shortest path kernels for each weight type and graph backend" << std::endl
+              << "  --bench-mst [nbVertices] [nbEdges]          minimum spanning forest : Boruvka and filter-Kruskal versus Kruskal" << std::endl
+              << "  --bench-centrality [nbVertices] [nbEdges]   betweenness and closeness : exact versus sampled, 1 versus all threads" << std::endl
+              << "  --bench-kpaths [nbVertices] [nbEdges] [k]   k shortest paths : Yen on 1 versus all threads, and walks" << std::endl
+              << "  --bench-perf [file.ggc]                     hardware counters (IPC, cache, TLB and branch misses per edge) for each ordering" << std::endl
+              << "  --bench-triangles [nbVertices] [nbEdges]    triangle counting : merge, AVX2, hash and hybrid intersections on 1 versus all threads" << std::endl
+              << "  --worker <serverName>                       run as a worker process (started by the application)" << std::endl
+              << "  --help" << std::endl;
+}
+
+//******************************************************************************
+
+bool IsCommandLineMode(int argc, char * argv[])
+{
+    return argc > 1 && QString(argv[1]).startsWith("--");
+}
+
+//******************************************************************************
+/*!
+ * \brief GenerateRandomDocument method generates a random undirected graph with integer weights in [1, 9]
+ */
+void GenerateRandomDocument(int nbVertices, int nbEdges, quint32 seed, GraphDocument * doc)
+{
+    *doc = GraphDocument();
+    doc->positions.resize(nbVertices);
+    doc->colors.fill(QColor(Qt::white).rgb(), nbVertices);
+    for (int i=0; i<nbVertices; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        double x = (seed >> 8) / double(1 << 24);
+        seed = seed * 1664525u + 1013904223u;
+        double y = (seed >> 8) / double(1 << 24);
+        doc->positions[i] = QPointF(x, y);
+    }
+    if (nbVertices < 2)
+        return;
+
+    doc->edgeVertices.reserve(2*nbEdges);
+    doc->edgeWeights.reserve(nbEdges);
+    while (doc->nbEdges() < nbEdges)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        int a = (seed >> 8) % nbVertices;
+        seed = seed * 1664525u + 1013904223u;
+        int b = (seed >> 8) % nbVertices;
+        if (a == b)
+            continue;
+        seed = seed * 1664525u + 1013904223u;
+        doc->edgeVertices << a << b;
+        doc->edgeWeights << 1 + int((seed >> 8) % 9);
+    }
+}
+
+//******************************************************************************
+/*!
+ * \brief GenerateShuffledGridDocument method generates a width x height grid graph with vertex ids in random order
+ *
+ * Neighbors in the grid are far apart in memory, as in a graph drawn in random click order.
+ */
+void GenerateShuffledGridDocument(int width, int height, quint32 seed, GraphDocument * doc)
+{
+    *doc = GraphDocument();
+    int nbVertices = width * height;
+    QVector<int> ids(nbVertices);
+    for (int i=0; i<nbVertices; i++)
+        ids[i] = i;
+    for (int i=nbVertices-1; i>0; i--)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        qSwap(ids[i], ids[(seed >> 8) % (i + 1)]);
+    }
+
+    doc->positions.resize(nbVertices);
+    doc->colors.fill(QColor(Qt::white).rgb(), nbVertices);
+    for (int y=0; y<height; y++)
+    {
+        for (int x=0; x<width; x++)
+        {
+            int id = ids[y * width + x];
+            doc->positions[id] = QPointF(x, y);
+            int neighbors[2] = { x+1 < width ? ids[y * width + x + 1] : -1,
+                                 y+1 < height ? ids[(y + 1) * width + x] : -1 };
+            for (int k=0; k<2; k++)
+            {
+                if (neighbors[k] < 0)
+                    continue;
+                seed = seed * 1664525u + 1013904223u;
+                doc->edgeVertices << id << neighbors[k];
+                doc->edgeWeights << 1 + int((seed >> 8) % 9);
+            }
+        }
+    }
+}
+
+//******************************************************************************
+/*!
+ * \brief LoadCommandLineGraph method reads the graph file given by arguments[index], or generates a random graph
+ */
+bool LoadCommandLineGraph(const QStringList & arguments, int index, GraphDocument * doc,
+                          int nbRandomVertices, int nbRandomEdges)
+{
+    if (arguments.size() <= index)
+    {
+        GenerateRandomDocument(nbRandomVertices, nbRandomEdges, 1, doc);
+        return true;
+    }
+
+    QFile file(arguments[index]);
+    if (!file.open(QIODevice::ReadOnly) || !ReadGraphDocument(&file, doc))
+    {
+        std::cerr << "Failed to read the graph file " << arguments[index].toLocal8Bit().constData() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+//******************************************************************************
+/*!
+ * \brief CheckDistributed method compares the multi-process algorithms with the sequential ones
+ * \return 0 if results are equal
+ */
+int CheckDistributed(const QStringList & arguments)
+{
+    int nbWorkers = arguments.value(2, "4").toInt();
+    GraphDocument doc;
+    if (nbWorkers < 1 || !LoadCommandLineGraph(arguments, 3, &doc))
+        return 1;
+
+    std::cout << "Graph : " << doc.nbVertices() << " vertices, " << doc.nbEdges() << " edges, "
+              << nbWorkers << " workers" << std::endl;
+
+    bool ok = true;
+    QElapsedTimer timer;
+
+    // connected components :
+    Graph sequentialGraph, distributedGraph;
+    if (!SetupGraph(doc, &sequentialGraph) || !SetupGraph(doc, &distributedGraph))
+        return 1;
+
+    ConnectedComponents sequentialComponents, distributedComponents;
+    timer.start();
+    ColorConnectedVertices(sequentialGraph, &sequentialComponents);
+    qint64 sequentialTime = timer.elapsed();
+    timer.start();
+    if (!ColorConnectedVerticesDistributed(distributedGraph, nbWorkers, &distributedComponents))
+    {
+        std::cerr << "Distributed connected components failed" << std::endl;
+        return 1;
+    }
+    qint64 distributedTime = timer.elapsed();
+
+    for (int i=0; i<doc.nbVertices(); i++)
+    {
+        ok &= sequentialGraph.vertices[i].color == distributedGraph.vertices[i].color;
+    }
+    std::cout << "Connected components : " << sequentialComponents.nbComponents() << " / " << distributedComponents.nbComponents()
+              << ", sequential " << sequentialTime << " ms, distributed " << distributedTime << " ms"
+              << (ok ? "" : " : MISMATCH") << std::endl;
+
+    // shortest paths :
+    DistributedGraphRunner runner;
+    if (!runner.start(sequentialGraph, nbWorkers))
+    {
+        std::cerr << "Failed to start workers" << std::endl;
+        return 1;
+    }
+    quint32 seed = 7;
+    for (int q=0; q<5; q++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        int start = (seed >> 8) % doc.nbVertices();
+        seed = seed * 1664525u + 1013904223u;
+        int end = (seed >> 8) % doc.nbVertices();
+
+        QList<int> sequentialPath, distributedPath;
+        timer.start();
+        double sequentialDistance = ComputeMinDistance(sequentialGraph, start, end, &sequentialPath);
+        sequentialTime = timer.elapsed();
+        timer.start();
+        double distributedDistance = runner.computeMinDistance(start, end, &distributedPath);
+        distributedTime = timer.elapsed();
+
+        bool same = sequentialDistance == distributedDistance
+                && (sequentialPath.isEmpty() || (distributedPath.first() == start && distributedPath.last() == end));
+        ok &= same;
+        std::cout << "Shortest path " << start << " -> " << end << " : " << sequentialDistance << " / " << distributedDistance
+                  << ", sequential " << sequentialTime << " ms, distributed " << distributedTime
+                  << " ms in " << runner.lastNbRounds() << " rounds" << (same ? "" : " : MISMATCH") << std::endl;
+    }
+
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
+
+//******************************************************************************
+/*!
+ * \brief ExportEdges method converts a graph file to an edge file
+ */
+int ExportEdges(const QStringList & arguments)
+{
+    GraphDocument doc;
+    if (!LoadCommandLineGraph(arguments, 2, &doc) || !WriteEdgeFile(arguments[3], doc))
+        return 1;
+    std::cout << doc.nbVertices() << " vertices, " << doc.nbEdges() << " edges written" << std::endl;
+    return 0;
+}
+
+//******************************************************************************
+/*!
+ * \brief RunExternal method runs the out-of-core algorithms on an edge file, only the vertex state is in memory
+ */
+int RunExternal(const QStringList & arguments)
+{
+    EdgeStream stream;
+    if (!stream.open(arguments[2]))
+        return 1;
+    int source = arguments.value(3, "0").toInt();
+    std::cout << "Edge file : " << stream.nbVertices() << " vertices, " << stream.nbEdges() << " edges" << std::endl;
+
+    ConnectedComponents components;
+    int nbComponents = ExternalConnectedComponents(stream, &components);
+    if (nbComponents < 0)
+        return 1;
+    const EdgeStreamStatistics & statistics = stream.statistics();
+    std::cout << "Connected components : " << nbComponents << ", " << statistics.elapsedNs / 1000000 << " ms, "
+              << statistics.throughput() << " MB/s" << std::endl;
+
+    stream.resetStatistics();
+    QVector<double> distances;
+    if (!ExternalBellmanFord(stream, source, &distances))
+        return 1;
+    int nbReached = 0;
+    double maxDistance = 0.0;
+    foreach (double distance, distances)
+    {
+        if (distance == std::numeric_limits<double>::max())
+            continue;
+        nbReached++;
+        maxDistance = qMax(maxDistance, distance);
+    }
+    std::cout << "Distances from " << source << " : " << nbReached << " vertices reached, farthest at " << maxDistance
+              << ", " << statistics.nbSweeps << " sweeps, " << statistics.elapsedNs / 1000000 << " ms, "
+              << statistics.throughput() << " MB/s" << std::endl;
+    return 0;
+}
+
+//******************************************************************************
+/*!
+ * \brief RunServer method loads the graph once and answers queries until a shutdown query
+ */
+int RunServer(const QStringList & arguments)
+{
+    GraphDocument doc;
+    GraphServer server;
+    if (!LoadCommandLineGraph(arguments, 3, &doc) || !server.load(doc) || !server.start(arguments[2]))
+        return 1;
+    std::cout << "Serving " << server.nbVertices() << " vertices on " << arguments[2].toLocal8Bit().constData() << std::endl;
+    server.waitForShutdown();
+    ServerStatistics statistics = server.statistics();
+    server.stop();
+    std::cout << statistics.nbQueries << " queries in " << statistics.nbBatches << " batches, "
+              << statistics.queriesPerSecond << " queries/s, latency p50 " << statistics.p50Us << " us, p99 "
+              << statistics.p99Us << " us" << std::endl;
+    return 0;
+}
+
+//******************************************************************************
+/*!
+ * \brief RunQuery method sends one query to a server and prints the answer
+ */
+int RunQuery(const QStringList & arguments)
+{
+    QString name = arguments[3];
+    int a = arguments.value(4, "0").toInt();
+    int b = arguments.value(5, "0").toInt();
+    ServerQuery query(1, 0, a, b);
+    if (name == "path")
+        query.type = SQ_SHORTEST_PATH;
+    else if (name == "component")
+        query.type = SQ_COMPONENT;
+    else if (name == "color")
+        query.type = SQ_COLOR;
+    else if (name == "stats")
+        query.type = SQ_STATISTICS;
+    else if (name == "shutdown")
+        query.type = SQ_SHUTDOWN;
+    else
+    {
+        PrintCommandLineUsage();
+        return 1;
+    }
+
+    GraphClient client;
+    ServerAnswer answer;
+    if (!client.connectToServer(arguments[2]) || !client.query(query, &answer))
+        return 1;
+    if (answer.status != SS_OK)
+    {
+        std::cout << (answer.status == SS_NO_PATH ? "No path" : "Invalid query") << std::endl;
+        return 1;
+    }
+    if (query.type == SQ_SHORTEST_PATH)
+    {
+        std::cout << "Distance " << answer.value << ", path";
+        foreach (int v, answer.items)
+            std::cout << " " << v;
+        std::cout << std::endl;
+    }
+    else if (query.type == SQ_STATISTICS && answer.items.size() == 5)
+    {
+        std::cout << answer.items[0] << " queries in " << answer.items[1] << " batches, " << answer.value
+                  << " queries/s, latency p50 " << answer.items[2] << " us, p99 " << answer.items[3] << " us, "
+                  << answer.items[4] << " connections" << std::endl;
+    }
+    else if (query.type != SQ_SHUTDOWN)
+    {
+        std::cout << answer.value << std::endl;
+    }
+    return 0;
+}
+
+//******************************************************************************
+/*!
+ * \brief RunCommandLine method runs the command given as first argument
+ * \param arguments application arguments, arguments[0] is the program
+ * \return process exit code
+ */
+int RunCommandLine(const QStringList & arguments)
+{
+    QString command = arguments.value(1);
+    if (command == "--worker" && arguments.size() > 2)
+    {
+        return RunDistributedWorker(arguments[2]);
+    }
+    else if (command == "--check-distributed")
+    {
+        return CheckDistributed(arguments);
+    }
+    else if (command == "--bench-numa")
+    {
+        return RunNumaBenchmark(arguments);
+    }
+    else if (command == "--bench-order")
+    {
+        return RunOrderingBenchmark(arguments);
+    }
+    else if (command == "--bench-compressed")
+    {
+        return RunCompressionBenchmark(arguments);
+    }
+    else if (command == "--bench-build")
+    {
+        return RunBuildBenchmark(arguments);
+    }
+    else if (command == "--bench-dynamic")
+    {
+        return RunDynamicBenchmark(arguments);
+    }
+    else if (command == "--bench-versioned")
+    {
+        return RunVersionedBenchmark(arguments);
+    }
+    else if (command == "--bench-ch")
+    {
+        return RunContractionBenchmark(arguments);
+    }
+    else if (command == "--bench-exact")
+    {
+        return RunExactColoringBenchmark(arguments);
+    }
+    else if (command == "--bench-steal")
+    {
+        return RunSchedulerBenchmark(arguments);
+    }
+    else if (command == "--bench-external")
+    {
+        return RunExternalBenchmark(arguments);
+    }
+    else if (command == "--export-edges" && arguments.size() > 3)
+    {
+        return ExportEdges(arguments);
+    }
+    else if (command == "--external" && arguments.size() > 2)
+    {
+        return RunExternal(arguments);
+    }
+    else if (command == "--serve" && arguments.size() > 2)
+    {
+        return RunServer(arguments);
+    }
+    else if (command == "--query" && arguments.size() > 3)
+    {
+        return RunQuery(arguments);
+    }
+    else if (command == "--bench-server")
+    {
+        return RunServerBenchmark(arguments);
+    }
+    else if (command == "--bench-weights")
+    {
+        return RunWeightBenchmark(arguments);
+    }
+    else if (command == "--bench-mst")
+    {
+        return RunSpanningTreeBenchmark(arguments);
+    }
+    else if (command == "--bench-centrality")
+    {
+        return RunCentralityBenchmark(arguments);
+    }
+    else if (command == "--bench-kpaths")
+    {
+        return RunKShortestPathsBenchmark(arguments);
+    }
+    else if (command == "--bench-perf")
+    {
+        return RunPerfCounterBenchmark(arguments);
+    }
+    else if (command == "--bench-triangles")
+    {
+        return RunTriangleBenchmark(arguments);
+    }
+
+    PrintCommandLineUsage();
+    return command == "--help" ? 0 : 1;
+}
+
+//******************************************************************************
+
+}
@@ -0,0 +1,32 @@
+#ifndef GRAPHCOMMANDLINE_H
+#define GRAPHCOMMANDLINE_H
+
+// Qt
+#include <QStringList>
+
+//******************************************************************************
+
+namespace GT {
+
+struct GraphDocument;
+
+//******************************************************************************
+
+bool IsCommandLineMode(int argc, char * argv[]);
+
+int RunCommandLine(const QStringList & arguments);
+
+void GenerateRandomDocument(int nbVertices, int nbEdges, quint32 seed, GraphDocument * doc);
+
+void GenerateShuffledGridDocument(int width, int height, quint32 seed, GraphDocument * doc);
+
+bool LoadCommandLineGraph(const QStringList & arguments, int index, GraphDocument * doc,
+                          int nbRandomVertices=20000, int nbRandomEdges=60000);
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHCOMMANDLINE_H
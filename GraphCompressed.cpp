@@ -0,0 +1,164 @@
+
+// STD
+#include <algorithm>
+#include <cmath>
+
+// Qt
+
+// Project
+#include "GraphCompressed.h"
+#include "GraphTools.h"
+#include "GraphProfiler.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+void EncodeVarint(quint32 value, QVector<quint8> * stream)
+{
+    while (value >= 0x80)
+    {
+        *stream << quint8(value | 0x80);
+        value >>= 7;
+    }
+    *stream << quint8(value);
+}
+
+//******************************************************************************
+/*!
+ * \brief EncodeGroupVarint method encodes values by groups of 4, the last group is completed with zeros
+ */
+void EncodeGroupVarint(const QVector<quint32> & values, QVector<quint8> * stream)
+{
+    for (int i=0; i<values.size(); i+=4)
+    {
+        int controlIndex = stream->size();
+        quint8 control = 0;
+        *stream << 0;
+        for (int k=0; k<4; k++)
+        {
+            quint32 value = i + k < values.size() ? values[i + k] : 0;
+            int length = value < (1u << 8) ? 1 : value < (1u << 16) ? 2 : value < (1u << 24) ? 3 : 4;
+            control |= quint8((length - 1) << (2*k));
+            for (int b=0; b<length; b++)
+                *stream << quint8(value >> (8*b));
+        }
+        (*stream)[controlIndex] = control;
+    }
+}
+
+//******************************************************************************
+
+CompressedGraph::CompressedGraph() :
+    _encoding(ENCODING_GROUP_VARINT)
+{
+}
+
+//******************************************************************************
+/*!
+ * \brief CompressedGraph::build method encodes the graph edges, edge a->b is an out-edge of a, and of b if the graph is undirected
+ */
+bool CompressedGraph::build(const Graph & graph, AdjacencyEncoding encoding)
+{
+    GT_PROFILE_SCOPE("CompressedGraph::build");
+    int n = graph.vertices.size();
+    const QVector<Edge> & edges = graph.getEdges();
+    _encoding = encoding;
+
+    // sorted out-edges :
+    bool undirected = !graph.isDirected();
+    _offsets.fill(0, n+1);
+    for (int i=0; i<edges.size(); i++)
+    {
+        _offsets[edges[i].a->id + 1]++;
+        if (undirected)
+            _offsets[edges[i].b->id + 1]++;
+    }
+    for (int v=0; v<n; v++)
+        _offsets[v+1] += _offsets[v];
+
+    typedef QPair<int, double> Neighbor;
+    QVector<Neighbor> neighbors(graph.nbArcs());
+    QVector<int> cursor = _offsets;
+    bool integerWeights = true;
+    for (int i=0; i<edges.size(); i++)
+    {
+        double weight = edges[i].weight;
+        neighbors[cursor[edges[i].a->id]++] = Neighbor(edges[i].b->id, weight);
+        if (undirected)
+            neighbors[cursor[edges[i].b->id]++] = Neighbor(edges[i].a->id, weight);
+        integerWeights &= weight >= 0.0 && weight < 4294967296.0 && weight == std::floor(weight);
+    }
+
+    // gap encoding :
+    _stream.clear();
+    _stream.reserve(2*neighbors.size() + 16);
+    _byteOffsets.resize(n+1);
+    _weights.clear();
+    if (!integerWeights)
+        _weights.resize(neighbors.size());
+    QVector<quint32> values;
+    for (int v=0; v<n; v++)
+    {
+        _byteOffsets[v] = _stream.size();
+        Neighbor * begin = neighbors.data() + _offsets[v];
+        Neighbor * end = neighbors.data() + _offsets[v+1];
+        std::sort(begin, end);
+
+        values.clear();
+        int previous = v;
+        for (Neighbor * neighbor=begin; neighbor<end; neighbor++)
+        {
+            if (neighbor == begin)
+            {
+                int delta = neighbor->first - v;
+                values << ((quint32(delta) << 1) ^ quint32(delta >> 31));
+            }
+            else
+            {
+                values << quint32(neighbor->first - previous);
+            }
+            previous = neighbor->first;
+
+            if (integerWeights)
+                values << quint32(neighbor->second);
+            else
+                _weights[neighbor - neighbors.data()] = neighbor->second;
+        }
+
+        if (encoding == ENCODING_VARINT)
+        {
+            foreach (quint32 value, values)
+                EncodeVarint(value, &_stream);
+        }
+        else
+        {
+            EncodeGroupVarint(values, &_stream);
+        }
+    }
+    _byteOffsets[n] = _stream.size();
+
+    // the group varint decoder reads 4 bytes per value
+    for (int i=0; i<4; i++)
+        _stream << 0;
+    _stream.squeeze();
+    return true;
+}
+
+//******************************************************************************
+/*!
+ * \brief CompressedGraph::compressedBytes method returns the memory used by the stream and the index arrays
+ */
+qint64 CompressedGraph::compressedBytes() const
+{
+    return qint64(_stream.size())
+            + qint64(_byteOffsets.size()) * sizeof(qint64)
+            + qint64(_offsets.size()) * sizeof(int)
+            + qint64(_weights.size()) * sizeof(double);
+}
+
+//******************************************************************************
+
+}
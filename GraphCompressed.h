@@ -0,0 +1,173 @@
+#ifndef GRAPHCOMPRESSED_H
+#define GRAPHCOMPRESSED_H
+
+// STD
+#include <cstring>
+
+// Qt
+#include <QVector>
+
+//******************************************************************************
+
+namespace GT {
+
+struct Graph;
+
+//******************************************************************************
+/*!
+ * ENCODING_VARINT : 7 bits per byte, the high bit marks a following byte (LEB128)
+ * ENCODING_GROUP_VARINT : groups of 4 values, one control byte with the byte length of each value,
+ *  values are decoded with unaligned 4 byte loads and masks, without a branch per byte
+ */
+enum AdjacencyEncoding
+{
+    ENCODING_VARINT=0,
+    ENCODING_GROUP_VARINT
+};
+
+//******************************************************************************
+/*!
+ * \brief CompressedGraph class stores sorted neighbor lists gap-encoded in a byte stream
+ *
+ * The first neighbor of vertex v is stored as the zigzag encoded difference to v, the next
+ * ones as the gap to the previous neighbor. When all edge weights are integers in [0, 2^32),
+ * weights are encoded in the stream after each gap, otherwise they are kept in a double array.
+ * Neighbor lists are decoded on the fly by NeighborIterator :
+ *
+ *  for (CompressedGraph::NeighborIterator it = graph.neighbors(v); !it.atEnd(); it.next())
+ *      visit(it.target(), it.weight());
+ */
+class CompressedGraph
+{
+public:
+    typedef double Weight;
+
+    class NeighborIterator
+    {
+    public:
+        NeighborIterator(const quint8 * data, int degree, int source, AdjacencyEncoding encoding, const double * weights) :
+            _data(data),
+            _weights(weights),
+            _encoding(encoding),
+            _remaining(degree),
+            _target(source),
+            _weight(0.0),
+            _groupIndex(4),
+            _first(true),
+            _atEnd(false)
+        {
+            next();
+        }
+        bool atEnd() const
+        { return _atEnd; }
+        int target() const
+        { return _target; }
+        double weight() const
+        { return _weight; }
+
+        void next()
+        {
+            if (_remaining == 0)
+            {
+                _atEnd = true;
+                return;
+            }
+            _remaining--;
+            quint32 gap = decode();
+            if (_first)
+            {
+                _target += int((gap >> 1) ^ (0u - (gap & 1u)));
+                _first = false;
+            }
+            else
+            {
+                _target += int(gap);
+            }
+            _weight = _weights ? *_weights++ : double(decode());
+        }
+
+    private:
+        quint32 decode()
+        {
+            if (_encoding == ENCODING_VARINT)
+            {
+                quint32 value = 0;
+                int shift = 0;
+                quint8 byte;
+                do
+                {
+                    byte = *_data++;
+                    value |= quint32(byte & 0x7F) << shift;
+                    shift += 7;
+                }
+                while (byte & 0x80);
+                return value;
+            }
+
+            if (_groupIndex == 4)
+            {
+                static const quint32 masks[4] = { 0xFFu, 0xFFFFu, 0xFFFFFFu, 0xFFFFFFFFu };
+                quint8 control = *_data++;
+                for (int i=0; i<4; i++)
+                {
+                    int length = (control >> (2*i)) & 3;
+                    quint32 word;
+                    std::memcpy(&word, _data, sizeof(word)); // streams are padded, little-endian
+                    _group[i] = word & masks[length];
+                    _data += length + 1;
+                }
+                _groupIndex = 0;
+            }
+            return _group[_groupIndex++];
+        }
+
+        const quint8 * _data;
+        const double * _weights;
+        AdjacencyEncoding _encoding;
+        int _remaining;
+        int _target;
+        double _weight;
+        quint32 _group[4];
+        int _groupIndex;
+        bool _first;
+        bool _atEnd;
+    };
+
+    CompressedGraph();
+
+    bool build(const Graph & graph, AdjacencyEncoding encoding=ENCODING_GROUP_VARINT);
+
+    int nbVertices() const
+    { return _offsets.isEmpty() ? 0 : _offsets.size() - 1; }
+    int nbEdges() const
+    { return _offsets.isEmpty() ? 0 : _offsets.last(); }
+    int degree(int v) const
+    { return _offsets[v+1] - _offsets[v]; }
+    AdjacencyEncoding encoding() const
+    { return _encoding; }
+    bool hasIntegerWeights() const
+    { return _weights.isEmpty(); }
+
+    qint64 compressedBytes() const;
+
+    NeighborIterator neighbors(int v) const
+    {
+        return NeighborIterator(_stream.constData() + _byteOffsets[v], degree(v), v, _encoding,
+                                _weights.isEmpty() ? 0 : _weights.constData() + _offsets[v]);
+    }
+
+private:
+    AdjacencyEncoding _encoding;
+    QVector<int> _offsets; //!< edge offsets, give the degrees and the index in _weights
+    QVector<qint64> _byteOffsets; //!< start of each neighbor list in _stream
+    QVector<quint8> _stream;
+    QVector<double> _weights; //!< empty when weights are encoded in the stream
+};
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHCOMPRESSED_H
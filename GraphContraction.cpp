@@ -0,0 +1,703 @@
+
+// STD
+#include <iostream>
+#include <limits>
+#include <queue>
+#include <vector>
+#include <functional>
+
+// Qt
+#include <QDataStream>
+#include <QIODevice>
+#include <QHash>
+
+// Project
+#include "GraphContraction.h"
+#include "GraphTools.h"
+#include "GraphThreadPool.h"
+#include "GraphScheduler.h"
+#include "GraphProfiler.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+static const int WITNESS_SETTLED_LIMIT = 500; //!< a witness search gives up after this number of settled vertices
+static const int ESTIMATE_SETTLED_LIMIT = 50; //!< smaller limit of the witness searches estimating a priority
+
+typedef QPair<double, int> QueueEntry;
+typedef std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> > MinQueue;
+
+//******************************************************************************
+
+struct ContractionArc
+{
+    ContractionArc() :
+        target(-1), weight(0.0), middle(-1)
+    {}
+    ContractionArc(int target, double weight, int middle) :
+        target(target), weight(weight), middle(middle)
+    {}
+    int target;
+    double weight;
+    int middle;
+};
+
+struct Shortcut
+{
+    int from;
+    int to;
+    double weight;
+    int middle;
+};
+
+//******************************************************************************
+/*!
+ * \brief WitnessSearch class is the bounded Dijkstra search of one worker, its distance array is reset through the touched list
+ *
+ * The search stops once all the targets are settled, beyond maxDistance or after settledLimit vertices.
+ */
+class WitnessSearch
+{
+public:
+    explicit WitnessSearch(int nbVertices) :
+        _distances(nbVertices, std::numeric_limits<double>::max()),
+        _targetMarks(nbVertices, 0),
+        _stamp(0)
+    {
+    }
+
+    void run(const QVector< QVector<ContractionArc> > & out, int source, int excluded,
+             const QVector<ContractionArc> & targets, const char * roundMembers,
+             double maxDistance, int settledLimit)
+    {
+        foreach (int v, _touched)
+            _distances[v] = std::numeric_limits<double>::max();
+        _touched.clear();
+
+        _stamp++;
+        int nbTargets = 0;
+        foreach (const ContractionArc & arc, targets)
+        {
+            if (arc.target != source && _targetMarks[arc.target] != _stamp)
+            {
+                _targetMarks[arc.target] = _stamp;
+                nbTargets++;
+            }
+        }
+
+        MinQueue queue;
+        _distances[source] = 0.0;
+        _touched << source;
+        queue.push(QueueEntry(0.0, source));
+        int nbSettled = 0;
+        while (!queue.empty() && nbSettled < settledLimit)
+        {
+            QueueEntry entry = queue.top();
+            queue.pop();
+            int v = entry.second;
+            if (entry.first > _distances[v])
+                continue;
+            if (entry.first > maxDistance)
+                break;
+            nbSettled++;
+            if (_targetMarks[v] == _stamp && --nbTargets == 0)
+                break;
+            foreach (const ContractionArc & arc, out[v])
+            {
+                int x = arc.target;
+                if (x == excluded || (roundMembers && roundMembers[x]))
+                    continue;
+                double distance = entry.first + arc.weight;
+                if (distance < _distances[x])
+                {
+                    if (_distances[x] == std::numeric_limits<double>::max())
+                        _touched << x;
+                    _distances[x] = distance;
+                    queue.push(QueueEntry(distance, x));
+                }
+            }
+        }
+    }
+
+    double distance(int v) const
+    { return _distances[v]; }
+
+private:
+    QVector<double> _distances;
+    QVector<int> _touched;
+    QVector<int> _targetMarks;
+    int _stamp;
+};
+
+//******************************************************************************
+/*!
+ * \brief ContractionBuilder class holds the remaining graph during the contraction
+ */
+class ContractionBuilder
+{
+public:
+    ContractionBuilder(int nbVertices) :
+        out(nbVertices),
+        in(nbVertices),
+        isContracted(nbVertices, 0),
+        contractedNeighbors(nbVertices, 0),
+        priorities(nbVertices, 0)
+    {
+    }
+
+    void addArc(int from, int to, double weight, int middle)
+    {
+        for (int i=0; i<out[from].size(); i++)
+        {
+            if (out[from][i].target != to)
+                continue;
+            if (weight < out[from][i].weight)
+            {
+                out[from][i] = ContractionArc(to, weight, middle);
+                for (int j=0; j<in[to].size(); j++)
+                {
+                    if (in[to][j].target == from)
+                        in[to][j] = ContractionArc(from, weight, middle);
+                }
+            }
+            return;
+        }
+        out[from] << ContractionArc(to, weight, middle);
+        in[to] << ContractionArc(from, weight, middle);
+    }
+
+    /*!
+     * \brief shortcuts method lists the shortcuts needed to contract v
+     *
+     * For each in-neighbor u, a witness search from u avoiding v (and the vertices of the round)
+     * checks each path u->v->x. A smaller settledLimit may only give more shortcuts.
+     */
+    void shortcuts(int v, const char * roundMembers, WitnessSearch & search, QVector<Shortcut> * output,
+                   int settledLimit=WITNESS_SETTLED_LIMIT) const
+    {
+        output->clear();
+        double maxOut = 0.0;
+        foreach (const ContractionArc & arc, out[v])
+            maxOut = qMax(maxOut, arc.weight);
+
+        foreach (const ContractionArc & inArc, in[v])
+        {
+            int u = inArc.target;
+            search.run(out, u, v, out[v], roundMembers, inArc.weight + maxOut, settledLimit);
+            foreach (const ContractionArc & outArc, out[v])
+            {
+                int x = outArc.target;
+                if (x == u)
+                    continue;
+                double weight = inArc.weight + outArc.weight;
+                if (search.distance(x) > weight)
+                {
+                    Shortcut shortcut = { u, x, weight, v };
+                    *output << shortcut;
+                }
+            }
+        }
+    }
+
+    void updatePriority(int v, WitnessSearch & search, QVector<Shortcut> * scratch)
+    {
+        shortcuts(v, 0, search, scratch, ESTIMATE_SETTLED_LIMIT);
+        priorities[v] = scratch->size() - in[v].size() - out[v].size() + contractedNeighbors[v];
+    }
+
+    bool isLocalMinimum(int v) const
+    {
+        for (int k=0; k<2; k++)
+        {
+            foreach (const ContractionArc & arc, k == 0 ? out[v] : in[v])
+            {
+                int u = arc.target;
+                if (priorities[u] < priorities[v] || (priorities[u] == priorities[v] && u < v))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    QVector< QVector<ContractionArc> > out;
+    QVector< QVector<ContractionArc> > in;
+    QVector<char> isContracted;
+    QVector<int> contractedNeighbors;
+    QVector<int> priorities;
+};
+
+//******************************************************************************
+
+void ContractionHierarchy::SearchGraph::clear()
+{
+    offsets.clear();
+    targets.clear();
+    weights.clear();
+    middles.clear();
+}
+
+//******************************************************************************
+
+int ContractionHierarchy::SearchGraph::findMiddle(int v, int target) const
+{
+    for (int i=offsets[v]; i<offsets[v+1]; i++)
+    {
+        if (targets[i] == target)
+            return middles[i];
+    }
+    return -1;
+}
+
+//******************************************************************************
+
+ContractionHierarchy::ContractionHierarchy() :
+    _nbShortcuts(0)
+{
+}
+
+//******************************************************************************
+
+void ContractionHierarchy::clear()
+{
+    _ranks.clear();
+    _up.clear();
+    _down.clear();
+    _nbShortcuts = 0;
+}
+
+//******************************************************************************
+/*!
+ * \brief ContractionHierarchy::build method contracts the graph, parallel edges keep the smallest weight and self-loops are dropped
+ * \param graph
+ * \param pool ThreadPool::instance() if null
+ * \return false if the graph has a negative weight
+ */
+bool ContractionHierarchy::build(const Graph & graph, ThreadPool * pool)
+{
+    GT_PROFILE_SCOPE("ContractionHierarchy::build");
+    clear();
+    int n = graph.vertices.size();
+    const QVector<Edge> & edges = graph.getEdges();
+    ContractionBuilder builder(n);
+    for (int i=0; i<edges.size(); i++)
+    {
+        if (edges[i].weight < 0.0)
+        {
+            std::cerr << "ContractionHierarchy : negative weights are not supported" << std::endl;
+            return false;
+        }
+        int a = edges[i].a->id;
+        int b = edges[i].b->id;
+        if (a == b)
+            continue;
+        builder.addArc(a, b, edges[i].weight, -1);
+        if (!graph.isDirected())
+            builder.addArc(b, a, edges[i].weight, -1);
+    }
+
+    ThreadPool & workers = pool ? *pool : ThreadPool::instance();
+    int nbWorkers = workers.nbThreads();
+    QVector<WitnessSearch*> searches;
+    WorkerLocal< QVector<Shortcut> > scratches(workers);
+    for (int worker=0; worker<nbWorkers; worker++)
+        searches << new WitnessSearch(n);
+
+    // initial priorities :
+    QVector<int> updated(n);
+    for (int v=0; v<n; v++)
+        updated[v] = v;
+    ParallelFor(workers, n, [&](int begin, int end, int worker)
+    {
+        for (int i=begin; i<end; i++)
+            builder.updatePriority(updated[i], *searches[worker], &scratches[worker]);
+    });
+
+    // search graphs are filled in rank order
+    _ranks.fill(-1, n);
+    QVector< QVector<ContractionArc> > upArcs(n), downArcs(n);
+    QVector<int> remaining = updated;
+    QVector<char> roundMembers(n, 0);
+    QVector<int> neighborMarks(n, -1);
+    QVector<int> updatedMarks(n, -1);
+    QVector< QVector<Shortcut> > roundShortcuts;
+    int rank = 0;
+    int nbRounds = 0;
+    while (!remaining.isEmpty())
+    {
+        // independent set of local minima :
+        QVector<int> round;
+        foreach (int v, remaining)
+        {
+            if (builder.isLocalMinimum(v))
+                round << v;
+        }
+        foreach (int v, round)
+            roundMembers[v] = 1;
+
+        int roundSize = round.size();
+        roundShortcuts.resize(roundSize);
+        ParallelFor(workers, roundSize, [&](int begin, int end, int worker)
+        {
+            for (int i=begin; i<end; i++)
+                builder.shortcuts(round[i], roundMembers.constData(), *searches[worker], &roundShortcuts[i]);
+        });
+
+        // contraction :
+        updated.clear();
+        for (int i=0; i<roundSize; i++)
+        {
+            int v = round[i];
+            _ranks[v] = rank++;
+            upArcs[v] = builder.out[v];
+            downArcs[v] = builder.in[v];
+            for (int k=0; k<2; k++)
+            {
+                // arcs v->u are removed from in[u], arcs u->v from out[u]
+                foreach (const ContractionArc & arc, k == 0 ? builder.out[v] : builder.in[v])
+                {
+                    int u = arc.target;
+                    QVector<ContractionArc> & list = k == 0 ? builder.in[u] : builder.out[u];
+                    for (int j=0; j<list.size(); j++)
+                    {
+                        if (list[j].target == v)
+                        {
+                            list.remove(j);
+                            break;
+                        }
+                    }
+                    if (neighborMarks[u] != v)
+                    {
+                        neighborMarks[u] = v;
+                        builder.contractedNeighbors[u]++;
+                    }
+                    if (updatedMarks[u] != nbRounds)
+                    {
+                        updatedMarks[u] = nbRounds;
+                        updated << u;
+                    }
+                }
+            }
+            builder.out[v].clear();
+            builder.in[v].clear();
+            builder.isContracted[v] = 1;
+            roundMembers[v] = 0;
+        }
+        for (int i=0; i<roundSize; i++)
+        {
+            foreach (const Shortcut & shortcut, roundShortcuts[i])
+                builder.addArc(shortcut.from, shortcut.to, shortcut.weight, shortcut.middle);
+            _nbShortcuts += roundShortcuts[i].size();
+        }
+
+        // priorities of the neighbors :
+        int nbUpdated = updated.size();
+        ParallelFor(workers, nbUpdated, [&](int begin, int end, int worker)
+        {
+            for (int i=begin; i<end; i++)
+                builder.updatePriority(updated[i], *searches[worker], &scratches[worker]);
+        });
+
+        QVector<int> next;
+        foreach (int v, remaining)
+        {
+            if (!builder.isContracted[v])
+                next << v;
+        }
+        remaining.swap(next);
+        nbRounds++;
+    }
+    qDeleteAll(searches);
+
+    // search graphs :
+    for (int k=0; k<2; k++)
+    {
+        const QVector< QVector<ContractionArc> > & arcs = k == 0 ? upArcs : downArcs;
+        SearchGraph & search = k == 0 ? _up : _down;
+        search.offsets.resize(n + 1);
+        search.offsets[0] = 0;
+        for (int v=0; v<n; v++)
+        {
+            foreach (const ContractionArc & arc, arcs[v])
+            {
+                search.targets << arc.target;
+                search.weights << arc.weight;
+                search.middles << arc.middle;
+            }
+            search.offsets[v+1] = search.targets.size();
+        }
+    }
+    return true;
+}
+
+//******************************************************************************
+/*!
+ * \brief ContractionHierarchy::unpack method appends to path the vertices of the arc a->b after a
+ */
+void ContractionHierarchy::unpack(int a, int b, int middle, QList<int> * path) const
+{
+    struct PackedArc { int a, b, middle; };
+    QVector<PackedArc> stack;
+    PackedArc first = { a, b, middle };
+    stack << first;
+    while (!stack.isEmpty())
+    {
+        PackedArc arc = stack.last();
+        stack.pop_back();
+        if (arc.middle < 0)
+        {
+            path->append(arc.b);
+            continue;
+        }
+        // a->middle is a downward arc of middle, middle->b an upward arc
+        int m = arc.middle;
+        PackedArc second = { m, arc.b, _up.findMiddle(m, arc.b) };
+        PackedArc first = { arc.a, m, _down.findMiddle(m, arc.a) };
+        stack << second << first;
+    }
+}
+
+//******************************************************************************
+/*!
+ * \brief ContractionHierarchy::computeMinDistance method returns the same distance as ComputeMinDistance
+ * \param startIndex
+ * \param endIndex
+ * \param path is the vertex list from start to end, one of the shortest paths if several exist
+ * \param nbSettled optional output, number of vertices settled by both searches
+ * \return -12345.0 for invalid input, std::numeric_limits<double>::max() if there is no path
+ */
+double ContractionHierarchy::computeMinDistance(int startIndex, int endIndex, QList<int> * path, int * nbSettled) const
+{
+    GT_PROFILE_SCOPE("ContractionHierarchy::computeMinDistance");
+    if (!path || startIndex < 0 || startIndex >= nbVertices() || endIndex < 0 || endIndex >= nbVertices())
+        return -12345.0;
+    path->clear();
+
+    struct Label
+    {
+        double distance;
+        int parent;
+        int middle;
+    };
+    QHash<int, Label> labels[2];
+    MinQueue queues[2];
+    const SearchGraph * graphs[2] = { &_up, &_down };
+    Label root = { 0.0, -1, -1 };
+    labels[0].insert(startIndex, root);
+    labels[1].insert(endIndex, root);
+    queues[0].push(QueueEntry(0.0, startIndex));
+    queues[1].push(QueueEntry(0.0, endIndex));
+
+    double best = std::numeric_limits<double>::max();
+    int meeting = -1;
+    int settled = 0;
+    while (true)
+    {
+        // stop a search once its smallest distance can not improve the best one
+        for (int k=0; k<2; k++)
+        {
+            if (!queues[k].empty() && queues[k].top().first >= best)
+                queues[k] = MinQueue();
+        }
+        if (queues[0].empty() && queues[1].empty())
+            break;
+        int k = queues[1].empty() || (!queues[0].empty() && queues[0].top().first <= queues[1].top().first) ? 0 : 1;
+
+        QueueEntry entry = queues[k].top();
+        queues[k].pop();
+        int v = entry.second;
+        if (entry.first > labels[k].value(v).distance)
+            continue;
+        settled++;
+
+        QHash<int, Label>::const_iterator other = labels[1-k].constFind(v);
+        if (other != labels[1-k].constEnd() && entry.first + other.value().distance < best)
+        {
+            best = entry.first + other.value().distance;
+            meeting = v;
+        }
+
+        const SearchGraph & graph = *graphs[k];
+        for (int i=graph.offsets[v]; i<graph.offsets[v+1]; i++)
+        {
+            int x = graph.targets[i];
+            double distance = entry.first + graph.weights[i];
+            QHash<int, Label>::iterator it = labels[k].find(x);
+            if (it == labels[k].end() || distance < it.value().distance)
+            {
+                Label label = { distance, v, graph.middles[i] };
+                labels[k].insert(x, label);
+                queues[k].push(QueueEntry(distance, x));
+            }
+        }
+    }
+    if (nbSettled)
+        *nbSettled = settled;
+    if (meeting < 0)
+        return std::numeric_limits<double>::max();
+
+    // start -> meeting :
+    QVector<int> forward;
+    for (int v=meeting; v!=startIndex; v=labels[0].value(v).parent)
+        forward << v;
+    path->append(startIndex);
+    int previous = startIndex;
+    for (int i=forward.size()-1; i>=0; i--)
+    {
+        unpack(previous, forward[i], labels[0].value(forward[i]).middle, path);
+        previous = forward[i];
+    }
+    // meeting -> end :
+    for (int v=meeting; v!=endIndex; v=labels[1].value(v).parent)
+    {
+        const Label & label = labels[1][v];
+        unpack(v, label.parent, label.middle, path);
+    }
+    return best;
+}
+
+//******************************************************************************
+/*!
+ * \brief ContractionHierarchy::write method writes the hierarchy in a binary file
+ * \param device opened for writing
+ *
+ * Format (little endian) :
+ *  header : magic (quint32), version (quint16), flags (quint16), nbVertices (quint32), nbShortcuts (quint32)
+ *  ranks  : nbVertices x rank (quint32)
+ *  upward then downward graph : nbArcs (quint32), nbVertices x offset (quint32),
+ *                               nbArcs x [target (quint32), weight (double), middle (qint32)]
+ */
+bool ContractionHierarchy::write(QIODevice * device) const
+{
+    if (!device || !device->isWritable())
+        return false;
+
+    QDataStream stream(device);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    int n = nbVertices();
+    stream << HIERARCHY_FILE_MAGIC << HIERARCHY_FILE_VERSION << quint16(0)
+           << quint32(n) << quint32(_nbShortcuts);
+    for (int v=0; v<n; v++)
+        stream << quint32(_ranks[v]);
+    for (int k=0; k<2; k++)
+    {
+        const SearchGraph & graph = k == 0 ? _up : _down;
+        stream << quint32(graph.targets.size());
+        for (int v=0; v<n; v++)
+            stream << quint32(graph.offsets[v+1]);
+        for (int i=0; i<graph.targets.size(); i++)
+            stream << quint32(graph.targets[i]) << graph.weights[i] << qint32(graph.middles[i]);
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
+//******************************************************************************
+/*!
+ * \brief ContractionHierarchy::read method reads a hierarchy written by write
+ * \return false if the data is not a valid hierarchy file, the hierarchy is then empty
+ *
+ * Besides the bounds, the ranks must be a permutation, every arc must lead to a higher rank and
+ * the middle of every shortcut must be lower than both ends, so that no file makes unpack loop.
+ */
+bool ContractionHierarchy::read(QIODevice * device)
+{
+    clear();
+    if (!device || !device->isReadable())
+        return false;
+
+    QDataStream stream(device);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    quint32 magic=0, nbVertices=0, nbShortcuts=0;
+    quint16 version=0, flags=0;
+    stream >> magic >> version >> flags >> nbVertices >> nbShortcuts;
+    if (stream.status() != QDataStream::Ok || magic != HIERARCHY_FILE_MAGIC || version > HIERARCHY_FILE_VERSION)
+    {
+        std::cerr << "Input is not a contraction hierarchy file" << std::endl;
+        return false;
+    }
+    if (nbVertices > 0x7FFFFFFF || (!device->isSequential() && device->size() - device->pos() < qint64(nbVertices) * 12))
+    {
+        std::cerr << "Contraction hierarchy file is truncated" << std::endl;
+        return false;
+    }
+
+    int n = nbVertices;
+    bool isValid = true;
+    _ranks.resize(n);
+    for (int v=0; v<n; v++)
+    {
+        quint32 rank;
+        stream >> rank;
+        isValid &= rank < nbVertices;
+        _ranks[v] = rank;
+    }
+    // the ranks are a permutation
+    QVector<bool> isRankUsed(isValid ? n : 0, false);
+    for (int v=0; v<isRankUsed.size() && isValid; v++)
+    {
+        isValid = !isRankUsed[_ranks[v]];
+        isRankUsed[_ranks[v]] = true;
+    }
+    for (int k=0; k<2 && isValid; k++)
+    {
+        SearchGraph & graph = k == 0 ? _up : _down;
+        quint32 nbArcs = 0;
+        stream >> nbArcs;
+        if (stream.status() != QDataStream::Ok || nbArcs > 0x7FFFFFFF
+                || (!device->isSequential() && device->size() - device->pos() < qint64(n) * 4 + qint64(nbArcs) * 16))
+        {
+            isValid = false;
+            break;
+        }
+        graph.offsets.resize(n + 1);
+        graph.offsets[0] = 0;
+        for (int v=0; v<n; v++)
+        {
+            quint32 offset;
+            stream >> offset;
+            isValid &= offset >= quint32(graph.offsets[v]) && offset <= nbArcs;
+            graph.offsets[v+1] = offset;
+        }
+        isValid &= quint32(graph.offsets[n]) == nbArcs;
+        graph.targets.resize(nbArcs);
+        graph.weights.resize(nbArcs);
+        graph.middles.resize(nbArcs);
+        for (quint32 i=0; i<nbArcs; i++)
+        {
+            quint32 target;
+            qint32 middle;
+            stream >> target >> graph.weights[i] >> middle;
+            isValid &= target < nbVertices && middle >= -1 && middle < qint32(nbVertices);
+            graph.targets[i] = target;
+            graph.middles[i] = middle;
+        }
+
+        // arcs lead to a higher rank, the middle of a shortcut is lower than both ends : unpack terminates
+        for (int v=0; v<n && isValid; v++)
+        {
+            for (int i=graph.offsets[v]; i<graph.offsets[v+1] && isValid; i++)
+            {
+                int middle = graph.middles[i];
+                isValid = _ranks[graph.targets[i]] > _ranks[v] && (middle < 0 || _ranks[middle] < _ranks[v]);
+            }
+        }
+    }
+    if (!isValid || stream.status() != QDataStream::Ok)
+    {
+        std::cerr << "Contraction hierarchy file is corrupted" << std::endl;
+        clear();
+        return false;
+    }
+    _nbShortcuts = nbShortcuts;
+    return true;
+}
+
+//******************************************************************************
+
+}
@@ -0,0 +1,89 @@
+#ifndef GRAPHCONTRACTION_H
+#define GRAPHCONTRACTION_H
+
+// Qt
+#include <QVector>
+#include <QList>
+
+class QIODevice;
+
+//******************************************************************************
+
+namespace GT {
+
+struct Graph;
+class ThreadPool;
+
+//******************************************************************************
+
+static const quint32 HIERARCHY_FILE_MAGIC = 0x48434747; // "GGCH"
+static const quint16 HIERARCHY_FILE_VERSION = 1;
+
+//******************************************************************************
+/*!
+ * \brief ContractionHierarchy class answers point-to-point shortest path queries on a static graph
+ *
+ * Preprocessing contracts the vertices by increasing edge difference priority (shortcuts
+ * added - arcs removed + contracted neighbors). Each round contracts in parallel the vertices
+ * of smaller priority than all their neighbors, witness searches avoid the vertices of the
+ * round. A shortcut u->x of middle v replaces the path u->v->x when no witness path is shorter.
+ *
+ * The rank of a vertex is its contraction order. The upward graph holds the arcs v->x and the
+ * downward graph the arcs u->v with rank(v) lower than rank(x) and rank(u). A query is a
+ * bidirectional Dijkstra search, forward in the upward graph from the start and backward in
+ * the downward graph from the end, shortcuts of the best path are unpacked with their middle.
+ *
+ * Weights must not be negative.
+ */
+class ContractionHierarchy
+{
+public:
+    ContractionHierarchy();
+
+    void clear();
+    bool build(const Graph & graph, ThreadPool * pool=0);
+
+    bool isEmpty() const
+    { return _ranks.isEmpty(); }
+    int nbVertices() const
+    { return _ranks.size(); }
+    int nbShortcuts() const
+    { return _nbShortcuts; }
+    int rank(int v) const
+    { return _ranks[v]; }
+
+    double computeMinDistance(int startIndex, int endIndex, QList<int> * path, int * nbSettled=0) const;
+
+    bool write(QIODevice * device) const;
+    bool read(QIODevice * device);
+
+private:
+    /*!
+     * \brief SearchGraph struct holds the arcs of each vertex to vertices of higher rank
+     */
+    struct SearchGraph
+    {
+        void clear();
+        int findMiddle(int v, int target) const;
+
+        QVector<int> offsets;
+        QVector<int> targets;
+        QVector<double> weights;
+        QVector<int> middles; //!< contracted vertex of a shortcut, -1 for an edge of the graph
+    };
+
+    void unpack(int a, int b, int middle, QList<int> * path) const;
+
+    QVector<int> _ranks;
+    SearchGraph _up; //!< arcs v->x, stored at v
+    SearchGraph _down; //!< arcs u->v, stored at v
+    int _nbShortcuts;
+};
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHCONTRACTION_H
@@ -0,0 +1,114 @@
+
+// STD
+#include <cstring>
+
+// Qt
+#include <QVector>
+
+// Project
+#include "GraphCsr.h"
+#include "GraphTools.h"
+#include "GraphThreadPool.h"
+#include "GraphProfiler.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+CsrGraph::CsrGraph() :
+    _nbVertices(0),
+    _placement(NUMA_DEFAULT)
+{
+}
+
+//******************************************************************************
+/*!
+ * \brief CsrGraph::allocate method allocates and places the arrays for the given row offsets
+ * \param nbVertices
+ * \param offsets nbVertices+1 row offsets, copied
+ * \param placement
+ * \param pool required for NUMA_FIRST_TOUCH, the pool workers zero the arrays range by range
+ *
+ * Targets and weights are zeroed, builders fill them afterwards.
+ */
+bool CsrGraph::allocate(int nbVertices, const int * offsets, NumaPlacement placement, ThreadPool * pool)
+{
+    int nbEdges = offsets[nbVertices];
+    _nbVertices = 0;
+    _placement = placement;
+    if (!_offsets.allocate(nbVertices+1, placement)
+            || !_targets.allocate(nbEdges, placement)
+            || !_weights.allocate(nbEdges, placement))
+        return false;
+    _nbVertices = nbVertices;
+
+    if (placement == NUMA_FIRST_TOUCH && pool)
+    {
+        RunParallel(*pool, [&](int worker)
+        {
+            int begin, end;
+            pool->workerRange(worker, nbVertices, &begin, &end);
+            std::memcpy(_offsets.data() + begin, offsets + begin, (end - begin) * sizeof(int));
+            int edgeBegin = offsets[begin];
+            int edgeEnd = offsets[end];
+            std::memset(_targets.data() + edgeBegin, 0, (edgeEnd - edgeBegin) * sizeof(int));
+            std::memset(_weights.data() + edgeBegin, 0, (edgeEnd - edgeBegin) * sizeof(double));
+        });
+        _offsets[nbVertices] = nbEdges;
+    }
+    else
+    {
+        std::memcpy(_offsets.data(), offsets, (nbVertices+1) * sizeof(int));
+        std::memset(_targets.data(), 0, nbEdges * sizeof(int));
+        std::memset(_weights.data(), 0, nbEdges * sizeof(double));
+    }
+    return true;
+}
+
+//******************************************************************************
+/*!
+ * \brief CsrGraph::build method copies the graph edges, edge a->b is an out-edge of a, and of b if the graph is undirected
+ */
+bool CsrGraph::build(const Graph & graph, NumaPlacement placement, ThreadPool * pool)
+{
+    GT_PROFILE_SCOPE("CsrGraph::build");
+    int n = graph.vertices.size();
+    const QVector<Edge> & edges = graph.getEdges();
+
+    // an undirected edge is an out-edge of both ends
+    bool undirected = !graph.isDirected();
+    QVector<int> offsets(n+1, 0);
+    for (int i=0; i<edges.size(); i++)
+    {
+        offsets[edges[i].a->id + 1]++;
+        if (undirected)
+            offsets[edges[i].b->id + 1]++;
+    }
+    for (int v=0; v<n; v++)
+        offsets[v+1] += offsets[v];
+
+    if (!allocate(n, offsets.constData(), placement, pool))
+        return false;
+
+    // scatter, pages are already placed
+    QVector<int> cursor = offsets;
+    for (int i=0; i<edges.size(); i++)
+    {
+        int position = cursor[edges[i].a->id]++;
+        _targets[position] = edges[i].b->id;
+        _weights[position] = edges[i].weight;
+        if (undirected)
+        {
+            position = cursor[edges[i].b->id]++;
+            _targets[position] = edges[i].a->id;
+            _weights[position] = edges[i].weight;
+        }
+    }
+    return true;
+}
+
+//******************************************************************************
+
+}
@@ -0,0 +1,100 @@
+#ifndef GRAPHCSR_H
+#define GRAPHCSR_H
+
+// Project
+#include "GraphMemory.h"
+
+//******************************************************************************
+
+namespace GT {
+
+struct Graph;
+class ThreadPool;
+
+//******************************************************************************
+/*!
+ * \brief CsrGraph class is a compressed sparse row copy of the graph edges
+ *
+ * Out-edges of vertex v are [offsets()[v], offsets()[v+1]) in targets() and weights().
+ * Arrays are allocated with the requested NUMA placement : with NUMA_FIRST_TOUCH the pool
+ * workers initialize the vertex range (and its edges) they get from ThreadPool::workerRange,
+ * so kernels partitioned the same way read socket-local memory.
+ */
+class CsrGraph
+{
+public:
+    typedef double Weight;
+
+    /*!
+     * \brief NeighborIterator class walks the out-edges of a vertex, same interface as CompressedGraph::NeighborIterator
+     */
+    class NeighborIterator
+    {
+    public:
+        NeighborIterator(const int * targets, const double * weights, int begin, int end) :
+            _targets(targets),
+            _weights(weights),
+            _edge(begin),
+            _end(end)
+        {
+        }
+        bool atEnd() const
+        { return _edge >= _end; }
+        void next()
+        { _edge++; }
+        int target() const
+        { return _targets[_edge]; }
+        double weight() const
+        { return _weights[_edge]; }
+
+    private:
+        const int * _targets;
+        const double * _weights;
+        int _edge;
+        int _end;
+    };
+
+    CsrGraph();
+
+    bool build(const Graph & graph, NumaPlacement placement=NUMA_DEFAULT, ThreadPool * pool=0);
+    bool allocate(int nbVertices, const int * offsets, NumaPlacement placement=NUMA_DEFAULT, ThreadPool * pool=0);
+
+    int nbVertices() const
+    { return _nbVertices; }
+    int nbEdges() const
+    { return _nbVertices > 0 ? _offsets[_nbVertices] : 0; }
+    int degree(int v) const
+    { return _offsets[v+1] - _offsets[v]; }
+    NumaPlacement placement() const
+    { return _placement; }
+    NeighborIterator neighbors(int v) const
+    { return NeighborIterator(_targets.data(), _weights.data(), _offsets[v], _offsets[v+1]); }
+
+    const int * offsets() const
+    { return _offsets.data(); }
+    const int * targets() const
+    { return _targets.data(); }
+    const double * weights() const
+    { return _weights.data(); }
+    int * targets()
+    { return _targets.data(); }
+    double * weights()
+    { return _weights.data(); }
+
+private:
+    int _nbVertices;
+    NumaPlacement _placement;
+    NumaArray<int> _offsets;
+    NumaArray<int> _targets;
+    NumaArray<double> _weights;
+
+    Q_DISABLE_COPY(CsrGraph)
+};
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHCSR_H
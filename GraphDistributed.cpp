@@ -0,0 +1,765 @@
+
+// STD
+#include <limits>
+#include <iostream>
+
+// Qt
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QProcess>
+#include <QMap>
+
+// Project
+#include "GraphDistributed.h"
+#include "GraphTools.h"
+#include "GraphProfiler.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+enum DistributedMessage
+{
+    DM_PART=1,       //!< coordinator -> worker : rank and graph part
+    DM_START,        //!< coordinator -> worker : algorithm, source vertex, delta
+    DM_ROUND,        //!< coordinator -> worker : ghost updates, worker computes and answers DM_ROUND_DONE
+    DM_ROUND_DONE,   //!< worker -> coordinator : boundary updates
+    DM_COLLECT,      //!< coordinator -> worker : worker answers DM_VALUES
+    DM_VALUES,       //!< worker -> coordinator : values and predecessors of owned vertices
+    DM_QUIT
+};
+
+enum DistributedAlgorithm
+{
+    DA_COMPONENTS=0,
+    DA_SHORTEST_PATH
+};
+
+static const int DISTRIBUTED_TIMEOUT_MS = 600000;
+static const int WORKER_START_TIMEOUT_MS = 30000;
+static const int WORKER_POLL_MS = 100; //!< period at which the workers are checked to be running while they connect
+
+//******************************************************************************
+
+struct DistributedUpdate
+{
+    qint32 vertex; //!< global vertex id
+    double value;
+    qint32 predecessor; //!< global vertex id
+};
+
+//******************************************************************************
+
+void SetupDistributedStream(QDataStream & stream)
+{
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+}
+
+//******************************************************************************
+/*!
+ * \brief WriteDistributedMessage method writes one frame : payload size (quint32), type (quint8), payload
+ */
+bool WriteDistributedMessage(QLocalSocket * socket, quint8 type, const QByteArray & payload)
+{
+    QByteArray header;
+    QDataStream stream(&header, QIODevice::WriteOnly);
+    SetupDistributedStream(stream);
+    stream << quint32(payload.size()) << type;
+
+    if (socket->write(header) != header.size() || socket->write(payload) != payload.size())
+        return false;
+    while (socket->bytesToWrite() > 0)
+    {
+        if (!socket->waitForBytesWritten(DISTRIBUTED_TIMEOUT_MS))
+            return false;
+    }
+    return true;
+}
+
+//******************************************************************************
+
+bool ReadDistributedBytes(QLocalSocket * socket, qint64 size, QByteArray * data)
+{
+    while (socket->bytesAvailable() < size)
+    {
+        if (!socket->waitForReadyRead(DISTRIBUTED_TIMEOUT_MS))
+            return false;
+    }
+    *data = socket->read(size);
+    return true;
+}
+
+//******************************************************************************
+
+bool ReadDistributedMessage(QLocalSocket * socket, quint8 * type, QByteArray * payload)
+{
+    QByteArray header;
+    if (!ReadDistributedBytes(socket, 5, &header))
+        return false;
+
+    QDataStream stream(header);
+    SetupDistributedStream(stream);
+    quint32 size;
+    stream >> size >> *type;
+    return ReadDistributedBytes(socket, size, payload);
+}
+
+//******************************************************************************
+
+QByteArray EncodeDistributedUpdates(const QVector<DistributedUpdate> & updates)
+{
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    SetupDistributedStream(stream);
+    stream << quint32(updates.size());
+    for (int i=0; i<updates.size(); i++)
+    {
+        stream << updates[i].vertex << updates[i].value << updates[i].predecessor;
+    }
+    return payload;
+}
+
+//******************************************************************************
+
+void DecodeDistributedUpdates(const QByteArray & payload, QVector<DistributedUpdate> * updates)
+{
+    QDataStream stream(payload);
+    SetupDistributedStream(stream);
+    quint32 count=0;
+    stream >> count;
+    updates->resize(count);
+    for (quint32 i=0; i<count; i++)
+    {
+        DistributedUpdate & update = (*updates)[i];
+        stream >> update.vertex >> update.value >> update.predecessor;
+    }
+}
+
+//******************************************************************************
+//******************************************************************************
+/*!
+ * \brief DistributedWorker struct is the state of a worker process
+ *
+ * Local vertex values are component labels (smallest global vertex id of the component)
+ * or distances from the source vertex.
+ */
+struct DistributedWorker
+{
+    GraphPart part;
+
+    // directed local edges sorted by source
+    QVector<int> outOffsets;
+    QVector<int> outTargets;
+    QVector<double> outWeights;
+    // undirected local adjacency
+    QVector<int> offsets;
+    QVector<int> adjacency;
+
+    int algorithm;
+    double delta;
+    QVector<double> values;
+    QVector<int> predecessors;
+    QVector<double> sentValues;
+    QList<int> active; //!< vertices improved since the last computation
+};
+
+//******************************************************************************
+
+void SetupDistributedWorker(DistributedWorker * worker)
+{
+    GraphPart & part = worker->part;
+    int n = part.nbVertices();
+
+    part.globalToLocal.clear();
+    part.globalToLocal.reserve(n);
+    for (int i=0; i<n; i++)
+        part.globalToLocal.insert(part.localToGlobal[i], i);
+
+    QVector<int> outDegrees(n+1, 0);
+    QVector<int> degrees(n+1, 0);
+    for (int i=0; i<part.nbEdges(); i++)
+    {
+        outDegrees[part.edgeVertices[2*i]+1]++;
+        degrees[part.edgeVertices[2*i]+1]++;
+        degrees[part.edgeVertices[2*i+1]+1]++;
+    }
+    for (int i=0; i<n; i++)
+    {
+        outDegrees[i+1] += outDegrees[i];
+        degrees[i+1] += degrees[i];
+    }
+    worker->outOffsets = outDegrees;
+    worker->offsets = degrees;
+    worker->outTargets.resize(part.nbEdges());
+    worker->outWeights.resize(part.nbEdges());
+    worker->adjacency.resize(2*part.nbEdges());
+    for (int i=0; i<part.nbEdges(); i++)
+    {
+        int a = part.edgeVertices[2*i];
+        int b = part.edgeVertices[2*i+1];
+        worker->outTargets[outDegrees[a]] = b;
+        worker->outWeights[outDegrees[a]++] = part.edgeWeights[i];
+        worker->adjacency[degrees[a]++] = b;
+        worker->adjacency[degrees[b]++] = a;
+    }
+}
+
+//******************************************************************************
+
+void StartDistributedWorker(DistributedWorker * worker, int algorithm, int source, double delta)
+{
+    const GraphPart & part = worker->part;
+    int n = part.nbVertices();
+    worker->algorithm = algorithm;
+    worker->delta = delta;
+    worker->predecessors.fill(-1, n);
+    worker->sentValues.fill(std::numeric_limits<double>::max(), n);
+    worker->active.clear();
+    if (algorithm == DA_COMPONENTS)
+    {
+        worker->values.resize(n);
+        for (int i=0; i<n; i++)
+            worker->values[i] = part.localToGlobal[i];
+        worker->sentValues = worker->values;
+    }
+    else
+    {
+        worker->values.fill(std::numeric_limits<double>::max(), n);
+        int local = part.globalToLocal.value(source, -1);
+        if (local >= 0 && local < part.nbOwned)
+        {
+            worker->values[local] = 0.0;
+            worker->active << local;
+        }
+    }
+}
+
+//******************************************************************************
+/*!
+ * \brief ComputeDistributedLabels method propagates the smallest label in each local component
+ */
+void ComputeDistributedLabels(DistributedWorker * worker)
+{
+    int n = worker->part.nbVertices();
+    QVector<bool> visited(n, false);
+    QVector<int> component;
+    QVector<int> stack;
+    for (int s=0; s<n; s++)
+    {
+        if (visited[s])
+            continue;
+        component.clear();
+        stack << s;
+        visited[s] = true;
+        double label = worker->values[s];
+        while (!stack.isEmpty())
+        {
+            int u = stack.takeLast();
+            component << u;
+            label = qMin(label, worker->values[u]);
+            for (int e=worker->offsets[u]; e<worker->offsets[u+1]; e++)
+            {
+                int v = worker->adjacency[e];
+                if (!visited[v])
+                {
+                    visited[v] = true;
+                    stack << v;
+                }
+            }
+        }
+        foreach (int u, component)
+            worker->values[u] = label;
+    }
+}
+
+//******************************************************************************
+/*!
+ * \brief ComputeDistributedDistances method runs delta-stepping from the improved vertices
+ *
+ * Bucket i holds vertices with tentative distance in [i*delta, (i+1)*delta). The lowest bucket
+ * is emptied by relaxing light edges (weight <= delta) until it stays empty, then heavy edges
+ * of the vertices removed from it are relaxed once.
+ */
+void ComputeDistributedDistances(DistributedWorker * worker)
+{
+    QVector<double> & dist = worker->values;
+    const GraphPart & part = worker->part;
+    QMap<qint64, QList<int> > buckets;
+    foreach (int u, worker->active)
+        buckets[qint64(dist[u] / worker->delta)] << u;
+    worker->active.clear();
+
+    QVector<double> relaxedAt(part.nbVertices(), -1.0);
+    qint64 relaxations = 0;
+    while (!buckets.isEmpty())
+    {
+        qint64 index = buckets.firstKey();
+        QList<int> settled;
+        while (buckets.contains(index))
+        {
+            QList<int> current = buckets.take(index);
+            foreach (int u, current)
+            {
+                if (relaxedAt[u] == dist[u])
+                    continue;
+                relaxedAt[u] = dist[u];
+                settled << u;
+                for (int e=worker->outOffsets[u]; e<worker->outOffsets[u+1]; e++)
+                {
+                    double w = worker->outWeights[e];
+                    int v = worker->outTargets[e];
+                    relaxations++;
+                    if (w <= worker->delta && dist[u] + w < dist[v])
+                    {
+                        dist[v] = dist[u] + w;
+                        worker->predecessors[v] = part.localToGlobal[u];
+                        buckets[qint64(dist[v] / worker->delta)] << v;
+                    }
+                }
+            }
+        }
+        foreach (int u, settled)
+        {
+            for (int e=worker->outOffsets[u]; e<worker->outOffsets[u+1]; e++)
+            {
+                double w = worker->outWeights[e];
+                int v = worker->outTargets[e];
+                if (w > worker->delta && dist[u] + w < dist[v])
+                {
+                    dist[v] = dist[u] + w;
+                    worker->predecessors[v] = part.localToGlobal[u];
+                    buckets[qint64(dist[v] / worker->delta)] << v;
+                }
+            }
+        }
+    }
+    GT_PROFILE_COUNT(PC_EDGES_RELAXED, relaxations);
+}
+
+//******************************************************************************
+
+void RunDistributedRound(DistributedWorker * worker, const QVector<DistributedUpdate> & updates,
+                         QVector<DistributedUpdate> * boundaryUpdates)
+{
+    const GraphPart & part = worker->part;
+    foreach (DistributedUpdate update, updates)
+    {
+        int local = part.globalToLocal.value(update.vertex, -1);
+        if (local >= 0 && update.value < worker->values[local])
+        {
+            worker->values[local] = update.value;
+            worker->predecessors[local] = update.predecessor;
+            worker->active << local;
+        }
+    }
+
+    if (worker->algorithm == DA_COMPONENTS)
+        ComputeDistributedLabels(worker);
+    else
+        ComputeDistributedDistances(worker);
+
+    boundaryUpdates->clear();
+    foreach (int local, part.boundary)
+    {
+        if (worker->values[local] < worker->sentValues[local])
+        {
+            worker->sentValues[local] = worker->values[local];
+            DistributedUpdate update;
+            update.vertex = part.localToGlobal[local];
+            update.value = worker->values[local];
+            update.predecessor = worker->predecessors[local];
+            *boundaryUpdates << update;
+        }
+    }
+}
+
+//******************************************************************************
+/*!
+ * \brief RunDistributedWorker method is the main loop of a worker process
+ * \param serverName local server of the coordinator
+ * \return process exit code
+ */
+int RunDistributedWorker(const QString & serverName)
+{
+    QLocalSocket socket;
+    socket.connectToServer(serverName);
+    if (!socket.waitForConnected(DISTRIBUTED_TIMEOUT_MS))
+    {
+        std::cerr << "Worker failed to connect to " << serverName.toLocal8Bit().constData() << std::endl;
+        return 1;
+    }
+
+    DistributedWorker worker;
+    quint8 type;
+    QByteArray payload;
+    while (ReadDistributedMessage(&socket, &type, &payload))
+    {
+        QDataStream stream(payload);
+        SetupDistributedStream(stream);
+        if (type == DM_PART)
+        {
+            qint32 nbOwned;
+            stream >> worker.part.localToGlobal >> nbOwned >> worker.part.ghostOwners
+                   >> worker.part.boundary >> worker.part.edgeVertices >> worker.part.edgeWeights;
+            worker.part.nbOwned = nbOwned;
+            SetupDistributedWorker(&worker);
+        }
+        else if (type == DM_START)
+        {
+            qint32 algorithm, source;
+            double delta;
+            stream >> algorithm >> source >> delta;
+            StartDistributedWorker(&worker, algorithm, source, delta);
+        }
+        else if (type == DM_ROUND)
+        {
+            QVector<DistributedUpdate> updates, boundaryUpdates;
+            DecodeDistributedUpdates(payload, &updates);
+            RunDistributedRound(&worker, updates, &boundaryUpdates);
+            if (!WriteDistributedMessage(&socket, DM_ROUND_DONE, EncodeDistributedUpdates(boundaryUpdates)))
+                return 1;
+        }
+        else if (type == DM_COLLECT)
+        {
+            QByteArray values;
+            QDataStream out(&values, QIODevice::WriteOnly);
+            SetupDistributedStream(out);
+            out << worker.values.mid(0, worker.part.nbOwned) << worker.predecessors.mid(0, worker.part.nbOwned);
+            if (!WriteDistributedMessage(&socket, DM_VALUES, values))
+                return 1;
+        }
+        else if (type == DM_QUIT)
+        {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+//******************************************************************************
+//******************************************************************************
+
+DistributedGraphRunner::DistributedGraphRunner() :
+    _meanWeight(1.0),
+    _lastNbRounds(0),
+    _server(0)
+{
+}
+
+//******************************************************************************
+
+DistributedGraphRunner::~DistributedGraphRunner()
+{
+    stop();
+}
+
+//******************************************************************************
+/*!
+ * \brief DistributedGraphRunner::start method partitions the graph and starts one worker process per part
+ * \param graph
+ * \param nbWorkers
+ * \return false if workers could not be started or connected
+ */
+bool DistributedGraphRunner::start(const Graph & graph, int nbWorkers)
+{
+    GT_PROFILE_SCOPE("DistributedGraphRunner::start");
+    stop();
+    if (nbWorkers < 1 || !PartitionGraph(graph, nbWorkers, &_partition))
+        return false;
+
+    int n = graph.vertices.size();
+    _ghostHolders.fill(QVector<int>(), n);
+    for (int p=0; p<_partition.parts.size(); p++)
+    {
+        const GraphPart & part = _partition.parts[p];
+        for (int local=part.nbOwned; local<part.nbVertices(); local++)
+            _ghostHolders[part.localToGlobal[local]] << p;
+    }
+
+    _meanWeight = 0.0;
+    const QVector<Edge> & edges = graph.getEdges();
+    for (int i=0; i<edges.size(); i++)
+        _meanWeight += edges[i].weight;
+    _meanWeight = edges.isEmpty() || _meanWeight <= 0.0 ? 1.0 : _meanWeight / edges.size();
+
+    static int serverCounter = 0;
+    QString serverName = QString("ggc-%1-%2").arg(QCoreApplication::applicationPid()).arg(serverCounter++);
+    QLocalServer::removeServer(serverName);
+    _server = new QLocalServer();
+    if (!_server->listen(serverName))
+    {
+        std::cerr << "Failed to listen on " << serverName.toLocal8Bit().constData() << std::endl;
+        stop();
+        return false;
+    }
+
+    for (int i=0; i<nbWorkers; i++)
+    {
+        QProcess * process = new QProcess();
+        process->setProcessChannelMode(QProcess::ForwardedChannels);
+        process->start(QCoreApplication::applicationFilePath(), QStringList() << "--worker" << serverName);
+        _processes << process;
+        if (!process->waitForStarted(WORKER_START_TIMEOUT_MS))
+        {
+            std::cerr << "Worker process failed to start : " << process->errorString().toLocal8Bit().constData() << std::endl;
+            stop();
+            return false;
+        }
+    }
+
+    // a worker exiting before it connects fails at once, not after the timeout
+    QElapsedTimer timer;
+    timer.start();
+    while (_sockets.size() < nbWorkers)
+    {
+        if (_server->hasPendingConnections() || _server->waitForNewConnection(WORKER_POLL_MS))
+        {
+            _sockets << _server->nextPendingConnection();
+            continue;
+        }
+        bool isRunning = true;
+        foreach (QProcess * process, _processes)
+            isRunning &= process->state() != QProcess::NotRunning;
+        if (!isRunning || timer.elapsed() > DISTRIBUTED_TIMEOUT_MS)
+        {
+            std::cerr << "Worker processes failed to connect" << std::endl;
+            stop();
+            return false;
+        }
+    }
+
+    for (int i=0; i<nbWorkers; i++)
+    {
+        const GraphPart & part = _partition.parts[i];
+        QByteArray payload;
+        QDataStream stream(&payload, QIODevice::WriteOnly);
+        SetupDistributedStream(stream);
+        stream << part.localToGlobal << qint32(part.nbOwned) << part.ghostOwners
+               << part.boundary << part.edgeVertices << part.edgeWeights;
+        if (!WriteDistributedMessage(_sockets[i], DM_PART, payload))
+        {
+            stop();
+            return false;
+        }
+    }
+    return true;
+}
+
+//******************************************************************************
+
+void DistributedGraphRunner::stop()
+{
+    foreach (QLocalSocket * socket, _sockets)
+    {
+        WriteDistributedMessage(socket, DM_QUIT, QByteArray());
+        socket->disconnectFromServer();
+        delete socket;
+    }
+    _sockets.clear();
+
+    foreach (QProcess * process, _processes)
+    {
+        if (!process->waitForFinished(5000))
+            process->kill();
+        delete process;
+    }
+    _processes.clear();
+
+    delete _server;
+    _server = 0;
+}
+
+//******************************************************************************
+/*!
+ * \brief DistributedGraphRunner::run method runs bulk-synchronous rounds until no boundary value changes
+ * \param startPayload DM_START message payload
+ * \param values per graph vertex
+ * \param predecessors per graph vertex (global ids)
+ */
+bool DistributedGraphRunner::run(const QByteArray & startPayload, QVector<double> * values, QVector<int> * predecessors)
+{
+    int nbParts = _sockets.size();
+    for (int i=0; i<nbParts; i++)
+    {
+        if (!WriteDistributedMessage(_sockets[i], DM_START, startPayload))
+            return false;
+    }
+
+    QVector<QVector<DistributedUpdate> > outgoing(nbParts);
+    _lastNbRounds = 0;
+    bool hasUpdates = true;
+    while (hasUpdates)
+    {
+        for (int i=0; i<nbParts; i++)
+        {
+            if (!WriteDistributedMessage(_sockets[i], DM_ROUND, EncodeDistributedUpdates(outgoing[i])))
+                return false;
+            outgoing[i].clear();
+        }
+
+        hasUpdates = false;
+        for (int i=0; i<nbParts; i++)
+        {
+            quint8 type;
+            QByteArray payload;
+            if (!ReadDistributedMessage(_sockets[i], &type, &payload) || type != DM_ROUND_DONE)
+                return false;
+            QVector<DistributedUpdate> updates;
+            DecodeDistributedUpdates(payload, &updates);
+            foreach (DistributedUpdate update, updates)
+            {
+                foreach (int p, _ghostHolders[update.vertex])
+                {
+                    outgoing[p] << update;
+                    hasUpdates = true;
+                }
+            }
+        }
+        _lastNbRounds++;
+    }
+
+    int n = _ghostHolders.size();
+    values->resize(n);
+    predecessors->resize(n);
+    for (int i=0; i<nbParts; i++)
+    {
+        quint8 type;
+        QByteArray payload;
+        if (!WriteDistributedMessage(_sockets[i], DM_COLLECT, QByteArray())
+                || !ReadDistributedMessage(_sockets[i], &type, &payload) || type != DM_VALUES)
+            return false;
+
+        QVector<double> ownedValues;
+        QVector<int> ownedPredecessors;
+        QDataStream stream(payload);
+        SetupDistributedStream(stream);
+        stream >> ownedValues >> ownedPredecessors;
+
+        const GraphPart & part = _partition.parts[i];
+        if (ownedValues.size() != part.nbOwned || ownedPredecessors.size() != part.nbOwned)
+            return false;
+        for (int local=0; local<part.nbOwned; local++)
+        {
+            (*values)[part.localToGlobal[local]] = ownedValues[local];
+            (*predecessors)[part.localToGlobal[local]] = ownedPredecessors[local];
+        }
+    }
+    return true;
+}
+
+//******************************************************************************
+/*!
+ * \brief DistributedGraphRunner::computeComponentLabels method computes connected components by label propagation
+ * \param labels smallest vertex id of the component of each vertex
+ */
+bool DistributedGraphRunner::computeComponentLabels(QVector<int> * labels)
+{
+    GT_PROFILE_SCOPE("DistributedGraphRunner::computeComponentLabels");
+    if (!labels || !isRunning())
+        return false;
+
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    SetupDistributedStream(stream);
+    stream << qint32(DA_COMPONENTS) << qint32(-1) << 1.0;
+
+    QVector<double> values;
+    QVector<int> predecessors;
+    if (!run(payload, &values, &predecessors))
+        return false;
+
+    labels->resize(values.size());
+    for (int i=0; i<values.size(); i++)
+        (*labels)[i] = int(values[i]);
+    return true;
+}
+
+//******************************************************************************
+/*!
+ * \brief DistributedGraphRunner::computeMinDistance method computes shortest path by distributed delta-stepping
+ * \param delta bucket width, mean edge weight if negative
+ * \return same values as ComputeMinDistance
+ */
+double DistributedGraphRunner::computeMinDistance(int startIndex, int endIndex, QList<int> * path, double delta)
+{
+    GT_PROFILE_SCOPE("DistributedGraphRunner::computeMinDistance");
+    int n = _ghostHolders.size();
+    if (!path || !isRunning())
+        return -12345.0;
+    if (startIndex < 0 || startIndex > n-1 || endIndex < 0 || endIndex > n-1)
+        return -12345.0;
+
+    path->clear();
+
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    SetupDistributedStream(stream);
+    stream << qint32(DA_SHORTEST_PATH) << qint32(startIndex) << (delta > 0.0 ? delta : _meanWeight);
+
+    QVector<double> distances;
+    QVector<int> predecessors;
+    if (!run(payload, &distances, &predecessors))
+        return -12345.0;
+
+    double minDistance = distances[endIndex];
+    if (minDistance == std::numeric_limits<double>::max())
+        return minDistance;
+
+    for (int c = endIndex; c != -1 && path->size() <= n; c=predecessors[c])
+    {
+        path->prepend(c);
+    }
+    return minDistance;
+}
+
+//******************************************************************************
+/*!
+ * \brief ColorConnectedVerticesDistributed method is the multi-process version of ColorConnectedVertices
+ *
+ * Components are colored in the order of their smallest vertex id. Unlike ColorConnectedVertices, the
+ * input colors are ignored : every vertex is labeled and recolored, pre-colored vertices do not split
+ * components. On a graph without colors both give the same colors.
+ */
+bool ColorConnectedVerticesDistributed(Graph & graph, int nbWorkers, ConnectedComponents * components)
+{
+    if (!components)
+        return false;
+
+    DistributedGraphRunner runner;
+    QVector<int> labels;
+    if (!runner.start(graph, nbWorkers) || !runner.computeComponentLabels(&labels))
+        return false;
+
+    QVector<int> labelColors(labels.size(), -1);
+    int nbColors = 0;
+    for (int i=0; i<graph.vertices.size(); i++)
+    {
+        int & color = labelColors[labels[i]];
+        if (color < 0)
+            color = nbColors++;
+        graph.vertices[i].color = color;
+        labels[i] = color;
+    }
+    components->setLabels(labels, nbColors);
+    return true;
+}
+
+//******************************************************************************
+
+double ComputeMinDistanceDistributed(const Graph & graph, int nbWorkers, int startIndex, int endIndex, QList<int> * path)
+{
+    DistributedGraphRunner runner;
+    if (!runner.start(graph, nbWorkers))
+        return -12345.0;
+    return runner.computeMinDistance(startIndex, endIndex, path);
+}
+
+//******************************************************************************
+
+}
@@ -0,0 +1,82 @@
+#ifndef GRAPHDISTRIBUTED_H
+#define GRAPHDISTRIBUTED_H
+
+// Qt
+#include <QVector>
+#include <QList>
+#include <QString>
+
+// Project
+#include "GraphPartition.h"
+
+class QLocalServer;
+class QLocalSocket;
+class QProcess;
+class QByteArray;
+
+//******************************************************************************
+
+namespace GT {
+
+struct Graph;
+class ConnectedComponents;
+
+//******************************************************************************
+/*!
+ * \brief DistributedGraphRunner class runs graph algorithms on local worker processes
+ *
+ * The graph is partitioned with PartitionGraph, each worker process (the application
+ * started with --worker) receives one part over a local socket. Algorithms run in
+ * bulk-synchronous rounds : every worker computes on its part, sends the new values of its
+ * boundary vertices, the coordinator routes them to the workers holding these vertices as
+ * ghosts. The run stops when a round produces no update.
+ */
+class DistributedGraphRunner
+{
+public:
+    DistributedGraphRunner();
+    ~DistributedGraphRunner();
+
+    bool start(const Graph & graph, int nbWorkers);
+    void stop();
+
+    bool isRunning() const
+    { return !_sockets.isEmpty(); }
+    int nbWorkers() const
+    { return _sockets.size(); }
+    int lastNbRounds() const
+    { return _lastNbRounds; }
+
+    bool computeComponentLabels(QVector<int> * labels);
+    double computeMinDistance(int startIndex, int endIndex, QList<int> * path, double delta=-1.0);
+
+private:
+    bool run(const QByteArray & startPayload, QVector<double> * values, QVector<int> * predecessors);
+
+    GraphPartition _partition;
+    QVector<QVector<int> > _ghostHolders; //!< parts holding each vertex as a ghost
+    double _meanWeight;
+    int _lastNbRounds;
+
+    QLocalServer * _server;
+    QList<QProcess*> _processes;
+    QList<QLocalSocket*> _sockets;
+
+    Q_DISABLE_COPY(DistributedGraphRunner)
+};
+
+//******************************************************************************
+
+bool ColorConnectedVerticesDistributed(Graph & graph, int nbWorkers, ConnectedComponents * components);
+
+double ComputeMinDistanceDistributed(const Graph & graph, int nbWorkers, int startIndex, int endIndex, QList<int> * path);
+
+int RunDistributedWorker(const QString & serverName);
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHDISTRIBUTED_H
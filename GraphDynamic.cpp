@@ -0,0 +1,334 @@
+
+// STD
+#include <iostream>
+
+// Qt
+
+// Project
+#include "GraphDynamic.h"
+#include "GraphTools.h"
+#include "GraphProfiler.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+static const int DYNAMIC_MIN_CAPACITY = 4;
+
+int DynamicBlockCapacity(int degree)
+{
+    return qMax(DYNAMIC_MIN_CAPACITY, degree + degree / 4);
+}
+
+//******************************************************************************
+
+DynamicGraph::DynamicGraph(bool directed) :
+    _directed(directed),
+    _nbArcs(0),
+    _freeSlots(0)
+{
+}
+
+//******************************************************************************
+
+void DynamicGraph::clear()
+{
+    _offsets.clear();
+    _degrees.clear();
+    _capacities.clear();
+    _targets.clear();
+    _weights.clear();
+    _nbArcs = 0;
+    _freeSlots = 0;
+}
+
+//******************************************************************************
+/*!
+ * \brief DynamicGraph::build method copies the graph and its directed mode, self-loops are dropped and parallel edges keep the last weight
+ */
+bool DynamicGraph::build(const Graph & graph)
+{
+    GT_PROFILE_SCOPE("DynamicGraph::build");
+    clear();
+    _directed = graph.isDirected();
+    int n = graph.vertices.size();
+    const QVector<Edge> & edges = graph.getEdges();
+
+    // blocks sized by degree with slack :
+    _degrees.fill(0, n);
+    for (int i=0; i<edges.size(); i++)
+    {
+        _degrees[edges[i].a->id]++;
+        if (!_directed)
+            _degrees[edges[i].b->id]++;
+    }
+    _offsets.resize(n);
+    _capacities.resize(n);
+    int size = 0;
+    for (int v=0; v<n; v++)
+    {
+        _offsets[v] = size;
+        _capacities[v] = DynamicBlockCapacity(_degrees[v]);
+        size += _capacities[v];
+        _degrees[v] = 0;
+    }
+    _targets.fill(-1, size);
+    _weights.fill(0.0, size);
+
+    QVector<EdgeUpdate> batch;
+    batch.reserve(edges.size());
+    for (int i=0; i<edges.size(); i++)
+        batch << EdgeUpdate(EDGE_INSERT, edges[i].a->id, edges[i].b->id, edges[i].weight);
+    applyBatch(batch);
+    return true;
+}
+
+//******************************************************************************
+/*!
+ * \brief DynamicGraph::addVertices method adds isolated vertices
+ * \return id of the first added vertex
+ */
+int DynamicGraph::addVertices(int count)
+{
+    int first = nbVertices();
+    for (int i=0; i<count; i++)
+    {
+        _offsets << _targets.size();
+        _degrees << 0;
+        _capacities << DYNAMIC_MIN_CAPACITY;
+        _targets.resize(_targets.size() + DYNAMIC_MIN_CAPACITY);
+        _weights.resize(_weights.size() + DYNAMIC_MIN_CAPACITY);
+    }
+    return first;
+}
+
+//******************************************************************************
+
+int DynamicGraph::findArc(int a, int b) const
+{
+    if (a < 0 || a >= nbVertices())
+        return -1;
+    const int * targets = _targets.constData() + _offsets[a];
+    for (int i=0; i<_degrees[a]; i++)
+    {
+        if (targets[i] == b)
+            return _offsets[a] + i;
+    }
+    return -1;
+}
+
+//******************************************************************************
+
+double DynamicGraph::weight(int a, int b) const
+{
+    int arc = findArc(a, b);
+    return arc >= 0 ? _weights[arc] : -1.0;
+}
+
+//******************************************************************************
+/*!
+ * \brief DynamicGraph::growBlock method moves the block of v to the end of the arrays with twice its capacity
+ */
+void DynamicGraph::growBlock(int v)
+{
+    int capacity = 2 * qMax(_capacities[v], DYNAMIC_MIN_CAPACITY / 2);
+    int offset = _targets.size();
+    _targets.resize(offset + capacity);
+    _weights.resize(offset + capacity);
+    for (int i=0; i<_degrees[v]; i++)
+    {
+        _targets[offset + i] = _targets[_offsets[v] + i];
+        _weights[offset + i] = _weights[_offsets[v] + i];
+    }
+    _freeSlots += _capacities[v];
+    _offsets[v] = offset;
+    _capacities[v] = capacity;
+}
+
+//******************************************************************************
+/*!
+ * \brief DynamicGraph::compact method packs the blocks again, each one keeps its degree plus slack
+ */
+void DynamicGraph::compact()
+{
+    GT_PROFILE_SCOPE("DynamicGraph::compact");
+    int n = nbVertices();
+    int size = 0;
+    for (int v=0; v<n; v++)
+        size += DynamicBlockCapacity(_degrees[v]);
+
+    QVector<int> targets(size, -1);
+    QVector<double> weights(size, 0.0);
+    int offset = 0;
+    for (int v=0; v<n; v++)
+    {
+        for (int i=0; i<_degrees[v]; i++)
+        {
+            targets[offset + i] = _targets[_offsets[v] + i];
+            weights[offset + i] = _weights[_offsets[v] + i];
+        }
+        _offsets[v] = offset;
+        _capacities[v] = DynamicBlockCapacity(_degrees[v]);
+        offset += _capacities[v];
+    }
+    _targets.swap(targets);
+    _weights.swap(weights);
+    _freeSlots = 0;
+}
+
+//******************************************************************************
+
+bool DynamicGraph::insertArc(int a, int b, double weight)
+{
+    int arc = findArc(a, b);
+    if (arc >= 0)
+    {
+        _weights[arc] = weight;
+        return false;
+    }
+    if (_degrees[a] == _capacities[a])
+        growBlock(a);
+    arc = _offsets[a] + _degrees[a]++;
+    _targets[arc] = b;
+    _weights[arc] = weight;
+    _nbArcs++;
+    return true;
+}
+
+//******************************************************************************
+
+bool DynamicGraph::removeArc(int a, int b)
+{
+    int arc = findArc(a, b);
+    if (arc < 0)
+        return false;
+    int last = _offsets[a] + --_degrees[a];
+    _targets[arc] = _targets[last];
+    _weights[arc] = _weights[last];
+    _nbArcs--;
+    return true;
+}
+
+//******************************************************************************
+
+bool DynamicGraph::setArcWeight(int a, int b, double weight)
+{
+    int arc = findArc(a, b);
+    if (arc < 0)
+        return false;
+    _weights[arc] = weight;
+    return true;
+}
+
+//******************************************************************************
+/*!
+ * \brief DynamicGraph::applyBatch method applies the edge updates in order
+ * \param batch
+ * \param statistics optional output
+ * \return false if some updates were ignored
+ *
+ * An undirected edge a-b is updated in the blocks of a and b.
+ */
+bool DynamicGraph::applyBatch(const QVector<EdgeUpdate> & batch, DynamicBatchStatistics * statistics)
+{
+    GT_PROFILE_SCOPE("DynamicGraph::applyBatch");
+    DynamicBatchStatistics counts;
+    int n = nbVertices();
+    foreach (EdgeUpdate update, batch)
+    {
+        int a = update.a;
+        int b = update.b;
+        if (a < 0 || a >= n || b < 0 || b >= n || a == b)
+        {
+            counts.nbIgnored++;
+            continue;
+        }
+
+        bool applied = false;
+        if (update.type == EDGE_INSERT)
+        {
+            applied = insertArc(a, b, update.weight);
+            if (!_directed)
+                insertArc(b, a, update.weight);
+            if (applied)
+                counts.nbInserted++;
+            else
+                counts.nbUpdated++;
+            applied = true;
+        }
+        else if (update.type == EDGE_DELETE)
+        {
+            applied = removeArc(a, b);
+            if (!_directed)
+                removeArc(b, a);
+            counts.nbDeleted += applied ? 1 : 0;
+        }
+        else if (update.type == EDGE_SET_WEIGHT)
+        {
+            applied = setArcWeight(a, b, update.weight);
+            if (!_directed)
+                setArcWeight(b, a, update.weight);
+            counts.nbUpdated += applied ? 1 : 0;
+        }
+        if (!applied)
+            counts.nbIgnored++;
+    }
+
+    if (_freeSlots > _targets.size() - _freeSlots)
+        compact();
+
+    if (statistics)
+        *statistics = counts;
+    return counts.nbIgnored == 0;
+}
+
+//******************************************************************************
+
+DynamicGraph::Snapshot DynamicGraph::snapshot() const
+{
+    Snapshot view;
+    view._targets = _targets.constData();
+    view._weights = _weights.constData();
+    view._offsets = _offsets.constData();
+    view._degrees = _degrees.constData();
+    view._nbVertices = nbVertices();
+    view._nbArcs = _nbArcs;
+    return view;
+}
+
+//******************************************************************************
+/*!
+ * \brief DynamicGraph::toGraph method copies the current edges into a GT::Graph, for the GraphTools algorithms
+ */
+void DynamicGraph::toGraph(Graph * graph) const
+{
+    *graph = Graph(_directed);
+    int n = nbVertices();
+    graph->vertices.resize(n);
+    for (int v=0; v<n; v++)
+        graph->vertices[v].id = v;
+
+    QVector<Edge> edges;
+    edges.reserve(_directed ? _nbArcs : _nbArcs / 2);
+    for (int a=0; a<n; a++)
+    {
+        for (int arc=_offsets[a]; arc<_offsets[a] + _degrees[a]; arc++)
+        {
+            int b = _targets[arc];
+            if (!_directed && b < a)
+                continue;
+            Edge edge;
+            edge.a = &graph->vertices[a];
+            edge.b = &graph->vertices[b];
+            edge.weight = _weights[arc];
+            edges << edge;
+        }
+    }
+    graph->setEdges(edges);
+}
+
+//******************************************************************************
+
+}
@@ -0,0 +1,142 @@
+#ifndef GRAPHDYNAMIC_H
+#define GRAPHDYNAMIC_H
+
+// Qt
+#include <QVector>
+
+// Project
+#include "GraphCsr.h"
+
+//******************************************************************************
+
+namespace GT {
+
+struct Graph;
+
+//******************************************************************************
+/*!
+ * EDGE_INSERT : adds the edge, or sets its weight if it exists
+ * EDGE_DELETE : removes the edge
+ * EDGE_SET_WEIGHT : changes the weight of an existing edge
+ */
+enum EdgeUpdateType
+{
+    EDGE_INSERT=0,
+    EDGE_DELETE,
+    EDGE_SET_WEIGHT
+};
+
+struct EdgeUpdate
+{
+    EdgeUpdate() :
+        type(EDGE_INSERT), a(-1), b(-1), weight(1.0)
+    {}
+    EdgeUpdate(EdgeUpdateType type, int a, int b, double weight=1.0) :
+        type(type), a(a), b(b), weight(weight)
+    {}
+    EdgeUpdateType type;
+    int a, b;
+    double weight;
+};
+
+struct DynamicBatchStatistics
+{
+    DynamicBatchStatistics() :
+        nbInserted(0), nbDeleted(0), nbUpdated(0), nbIgnored(0)
+    {}
+    int nbInserted;
+    int nbDeleted;
+    int nbUpdated;
+    int nbIgnored; //!< self-loops, invalid ids, deletions or weight changes of missing edges
+};
+
+//******************************************************************************
+/*!
+ * \brief DynamicGraph class is a mutable adjacency applying batches of edge updates in place
+ *
+ * Each vertex owns a contiguous block of the target and weight arrays with some slack.
+ * Inserting into a full block moves it to the end of the arrays with a doubled capacity,
+ * the free space is reclaimed by a compaction once it exceeds the used space, so an update
+ * costs O(degree) amortized, independently of the graph size. Deleting swaps the last arc
+ * of the block into the hole. Parallel edges and self-loops are not stored.
+ *
+ * snapshot() returns a read-only view with the CsrGraph neighbor iterator, it can be used
+ * by the GraphKernels.h algorithms and stays valid until the next modification.
+ */
+class DynamicGraph
+{
+public:
+    class Snapshot
+    {
+    public:
+        typedef CsrGraph::NeighborIterator NeighborIterator;
+
+        Snapshot() :
+            _targets(0), _weights(0), _offsets(0), _degrees(0), _nbVertices(0), _nbArcs(0)
+        {}
+        int nbVertices() const
+        { return _nbVertices; }
+        int nbArcs() const
+        { return _nbArcs; }
+        int degree(int v) const
+        { return _degrees[v]; }
+        NeighborIterator neighbors(int v) const
+        { return NeighborIterator(_targets, _weights, _offsets[v], _offsets[v] + _degrees[v]); }
+
+    private:
+        friend class DynamicGraph;
+        const int * _targets;
+        const double * _weights;
+        const int * _offsets;
+        const int * _degrees;
+        int _nbVertices;
+        int _nbArcs;
+    };
+
+    explicit DynamicGraph(bool directed=false);
+
+    void clear();
+    bool build(const Graph & graph);
+    int addVertices(int count);
+    bool applyBatch(const QVector<EdgeUpdate> & batch, DynamicBatchStatistics * statistics=0);
+
+    bool isDirected() const
+    { return _directed; }
+    int nbVertices() const
+    { return _degrees.size(); }
+    int nbArcs() const
+    { return _nbArcs; }
+    int degree(int v) const
+    { return _degrees[v]; }
+    bool hasEdge(int a, int b) const
+    { return findArc(a, b) >= 0; }
+    double weight(int a, int b) const;
+
+    Snapshot snapshot() const;
+    void toGraph(Graph * graph) const;
+
+private:
+    int findArc(int a, int b) const;
+    bool insertArc(int a, int b, double weight);
+    bool removeArc(int a, int b);
+    bool setArcWeight(int a, int b, double weight);
+    void growBlock(int v);
+    void compact();
+
+    bool _directed;
+    QVector<int> _offsets; //!< start of the block of each vertex
+    QVector<int> _degrees;
+    QVector<int> _capacities;
+    QVector<int> _targets;
+    QVector<double> _weights;
+    int _nbArcs;
+    int _freeSlots; //!< slots of moved blocks, reclaimed by compact()
+};
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHDYNAMIC_H
@@ -0,0 +1,674 @@
+
+// STD
+#include <algorithm>
+#include <iostream>
+
+// Qt
+#include <QVector>
+#include <QPair>
+#include <QVarLengthArray>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QtAlgorithms>
+
+// Project
+#include "GraphExactColoring.h"
+#include "GraphTools.h"
+#include "GraphThreadPool.h"
+#include "GraphScheduler.h"
+#include "GraphProfiler.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+static const int EXACT_COLORING_CHECK_PERIOD = 1024; //!< nodes between two checks of the time budget
+static const int EXACT_COLORING_CLIQUE_STARTS = 64; //!< vertices of largest degree starting a greedy clique
+
+typedef QVector< QPair<int, int> > ColoringDecisions; //!< (vertex, color) pairs from the root
+
+/*!
+ * \brief ExploreFrame struct holds the colors left to try at a node of the depth-first search
+ */
+struct ExploreFrame
+{
+    int vertex;
+    int nbDecisions; //!< decisions leading to the node
+    QVarLengthArray<int, 64> colors;
+    int next;
+};
+
+//******************************************************************************
+/*!
+ * \brief ColoringProblem struct holds the adjacency rows as bitsets and the clique giving the lower bound
+ */
+struct ColoringProblem
+{
+    explicit ColoringProblem(const Graph & graph);
+
+    const quint64 * row(int v) const
+    { return adjacency.constData() + v * nbWords; }
+    int degree(int v) const;
+
+    int nbVertices;
+    int nbWords;
+    QVector<quint64> adjacency;
+    QVector<int> clique;
+};
+
+//******************************************************************************
+
+ColoringProblem::ColoringProblem(const Graph & graph) :
+    nbVertices(graph.vertices.size()),
+    nbWords((graph.vertices.size() + 63) / 64)
+{
+    adjacency.fill(0, int(qint64(nbVertices) * nbWords));
+    const QVector<Edge> & edges = graph.getEdges();
+    for (int i=0; i<edges.size(); i++)
+    {
+        int a = edges[i].a->id;
+        int b = edges[i].b->id;
+        if (a == b)
+            continue;
+        adjacency[a * nbWords + (b >> 6)] |= quint64(1) << (b & 63);
+        adjacency[b * nbWords + (a >> 6)] |= quint64(1) << (a & 63);
+    }
+}
+
+//******************************************************************************
+
+int ColoringProblem::degree(int v) const
+{
+    const quint64 * bits = row(v);
+    int count = 0;
+    for (int w=0; w<nbWords; w++)
+        count += qPopulationCount(bits[w]);
+    return count;
+}
+
+//******************************************************************************
+/*!
+ * \brief FindGreedyClique method grows a clique from each of the vertices of largest degree, adding the candidate with the most candidate neighbors
+ */
+void FindGreedyClique(ColoringProblem * problem)
+{
+    int n = problem->nbVertices;
+    int nbWords = problem->nbWords;
+    QVector< QPair<int, int> > starts;
+    for (int v=0; v<n; v++)
+        starts << qMakePair(-problem->degree(v), v);
+    std::sort(starts.begin(), starts.end());
+
+    QVector<quint64> candidates(nbWords);
+    problem->clique.clear();
+    for (int i=0; i<qMin(n, EXACT_COLORING_CLIQUE_STARTS); i++)
+    {
+        int start = starts[i].second;
+        if (-starts[i].first < problem->clique.size())
+            break;
+        QVector<int> clique;
+        clique << start;
+        for (int w=0; w<nbWords; w++)
+            candidates[w] = problem->row(start)[w];
+        while (true)
+        {
+            int chosen = -1;
+            int chosenDegree = -1;
+            for (int w=0; w<nbWords; w++)
+            {
+                quint64 bits = candidates[w];
+                while (bits)
+                {
+                    int u = (w << 6) + qCountTrailingZeroBits(bits);
+                    bits &= bits - 1;
+                    const quint64 * row = problem->row(u);
+                    int degree = 0;
+                    for (int k=0; k<nbWords; k++)
+                        degree += qPopulationCount(row[k] & candidates[k]);
+                    if (degree > chosenDegree)
+                    {
+                        chosen = u;
+                        chosenDegree = degree;
+                    }
+                }
+            }
+            if (chosen < 0)
+                break;
+            clique << chosen;
+            for (int w=0; w<nbWords; w++)
+                candidates[w] &= problem->row(chosen)[w];
+        }
+        if (clique.size() > problem->clique.size())
+            problem->clique = clique;
+    }
+}
+
+//******************************************************************************
+/*!
+ * \brief ColoringState class is a partial coloring, colored and uncolored in LIFO order
+ *
+ * The clique of the problem is precolored 0..k-1. Color classes and the uncolored vertices are
+ * bitsets, the number of neighbors of each color gives the saturation of the vertices.
+ */
+class ColoringState
+{
+public:
+    ColoringState(const ColoringProblem & problem, int maxColors);
+
+    bool canColor(int v, int c) const
+    {
+        const quint64 * row = _problem.row(v);
+        const quint64 * members = _classes.constData() + c * _problem.nbWords;
+        for (int w=0; w<_problem.nbWords; w++)
+        {
+            if (row[w] & members[w])
+                return false;
+        }
+        return true;
+    }
+    void color(int v, int c)
+    {
+        assign(v, c);
+        _decisions << qMakePair(v, c);
+    }
+    void uncolor()
+    {
+        unassign(_decisions.last().first);
+        _decisions.removeLast();
+    }
+    int select() const;
+
+    int nbColors() const
+    { return _nbColors; }
+    const QVector<int> & colors() const
+    { return _colors; }
+    //! decisions since the precolored clique
+    const ColoringDecisions & decisions() const
+    { return _decisions; }
+
+private:
+    void assign(int v, int c);
+    void unassign(int v);
+
+    const ColoringProblem & _problem;
+    int _maxColors;
+    int _nbColors;
+    QVector<int> _colors;
+    QVector<quint64> _classes; //!< _maxColors bitsets
+    QVector<quint64> _uncolored;
+    QVector<int> _neighborColors; //!< neighbors of vertex v with color c at v * _maxColors + c
+    QVector<int> _saturation; //!< distinct colors of the neighbors
+    ColoringDecisions _decisions;
+};
+
+//******************************************************************************
+
+ColoringState::ColoringState(const ColoringProblem & problem, int maxColors) :
+    _problem(problem),
+    _maxColors(maxColors),
+    _nbColors(0),
+    _colors(problem.nbVertices, -1),
+    _classes(maxColors * problem.nbWords, 0),
+    _uncolored(problem.nbWords, 0),
+    _neighborColors(problem.nbVertices * maxColors, 0),
+    _saturation(problem.nbVertices, 0)
+{
+    for (int v=0; v<problem.nbVertices; v++)
+        _uncolored[v >> 6] |= quint64(1) << (v & 63);
+    for (int i=0; i<problem.clique.size(); i++)
+        assign(problem.clique[i], i);
+}
+
+//******************************************************************************
+
+void ColoringState::assign(int v, int c)
+{
+    int nbWords = _problem.nbWords;
+    quint64 bit = quint64(1) << (v & 63);
+    _colors[v] = c;
+    _classes[c * nbWords + (v >> 6)] |= bit;
+    _uncolored[v >> 6] &= ~bit;
+    if (c == _nbColors)
+        _nbColors++;
+
+    const quint64 * row = _problem.row(v);
+    for (int w=0; w<nbWords; w++)
+    {
+        quint64 bits = row[w];
+        while (bits)
+        {
+            int u = (w << 6) + qCountTrailingZeroBits(bits);
+            bits &= bits - 1;
+            if (_neighborColors[u * _maxColors + c]++ == 0)
+                _saturation[u]++;
+        }
+    }
+}
+
+//******************************************************************************
+
+void ColoringState::unassign(int v)
+{
+    int nbWords = _problem.nbWords;
+    quint64 bit = quint64(1) << (v & 63);
+    int c = _colors[v];
+    _colors[v] = -1;
+    _classes[c * nbWords + (v >> 6)] &= ~bit;
+    _uncolored[v >> 6] |= bit;
+
+    const quint64 * row = _problem.row(v);
+    for (int w=0; w<nbWords; w++)
+    {
+        quint64 bits = row[w];
+        while (bits)
+        {
+            int u = (w << 6) + qCountTrailingZeroBits(bits);
+            bits &= bits - 1;
+            if (--_neighborColors[u * _maxColors + c] == 0)
+                _saturation[u]--;
+        }
+    }
+
+    // in LIFO order only the last color can become empty
+    while (_nbColors > 0)
+    {
+        const quint64 * members = _classes.constData() + (_nbColors - 1) * nbWords;
+        int w = 0;
+        while (w < nbWords && !members[w])
+            w++;
+        if (w < nbWords)
+            break;
+        _nbColors--;
+    }
+}
+
+//******************************************************************************
+/*!
+ * \brief ColoringState::select method returns the uncolored vertex of largest saturation, then of most uncolored neighbors, -1 if all are colored
+ */
+int ColoringState::select() const
+{
+    int nbWords = _problem.nbWords;
+    int best = -1;
+    int bestSaturation = -1;
+    int bestDegree = -1;
+    for (int w=0; w<nbWords; w++)
+    {
+        quint64 bits = _uncolored[w];
+        while (bits)
+        {
+            int v = (w << 6) + qCountTrailingZeroBits(bits);
+            bits &= bits - 1;
+            if (_saturation[v] < bestSaturation)
+                continue;
+            const quint64 * row = _problem.row(v);
+            int degree = 0;
+            for (int k=0; k<nbWords; k++)
+                degree += qPopulationCount(row[k] & _uncolored[k]);
+            if (_saturation[v] > bestSaturation || degree > bestDegree)
+            {
+                best = v;
+                bestSaturation = _saturation[v];
+                bestDegree = degree;
+            }
+        }
+    }
+    return best;
+}
+
+//******************************************************************************
+/*!
+ * \brief ExactColoringSearch class is the branch and bound shared by the workers
+ *
+ * Each worker has a Chase-Lev deque of subtrees given by their decisions from the root. A worker
+ * pops the newest subtree of its own deque, or steals the oldest one of another deque. Pending
+ * counts the queued and running subtrees, the search ends when it reaches 0.
+ */
+class ExactColoringSearch
+{
+public:
+    ExactColoringSearch(const ColoringProblem & problem, int nbWorkers,
+                        const QVector<int> & colors, int nbColors,
+                        const CancellationToken * deadline, const CancellationToken * cancellation);
+    ~ExactColoringSearch();
+
+    void run(int worker);
+
+    const QVector<int> & bestColors() const
+    { return _bestColors; }
+    int nbColors() const
+    { return _upperBound.load(); }
+    bool isInterrupted() const
+    { return _isInterrupted.load() != 0; }
+    int nbSteals() const
+    { return _nbSteals.load(); }
+    qint64 nbNodes() const;
+
+private:
+    Q_DISABLE_COPY(ExactColoringSearch)
+
+    ColoringDecisions * takeTask(int worker);
+    void share(int worker, const ColoringDecisions & task);
+    void explore(ColoringState & state, int worker, QVector<ExploreFrame> & frames, int depth);
+    void shareOldestBranches(int worker, const ColoringState & state, QVector<ExploreFrame> & frames, int depth);
+    void record(const ColoringState & state);
+
+    const ColoringProblem & _problem;
+    int _maxColors;
+    QVector<WorkStealingDeque<ColoringDecisions>*> _deques;
+    QAtomicInt _pending;
+    QAtomicInt _nbIdle;
+    QAtomicInt _nbSteals;
+    QAtomicInt _stop;
+    QAtomicInt _isInterrupted; //!< stopped by the deadline or the cancellation
+    QAtomicInt _upperBound; //!< colors of the best coloring found
+    QMutex _bestMutex;
+    QVector<int> _bestColors;
+    QVector<qint64> _nbNodes; //!< per worker
+    const CancellationToken * _deadline;
+    const CancellationToken * _cancellation;
+};
+
+//******************************************************************************
+
+ExactColoringSearch::ExactColoringSearch(const ColoringProblem & problem, int nbWorkers,
+                                         const QVector<int> & colors, int nbColors,
+                                         const CancellationToken * deadline, const CancellationToken * cancellation) :
+    _problem(problem),
+    _maxColors(nbColors),
+    _pending(1),
+    _nbIdle(0),
+    _nbSteals(0),
+    _stop(0),
+    _isInterrupted(0),
+    _upperBound(nbColors),
+    _bestColors(colors),
+    _nbNodes(nbWorkers, 0),
+    _deadline(deadline),
+    _cancellation(cancellation)
+{
+    for (int worker=0; worker<nbWorkers; worker++)
+        _deques << new WorkStealingDeque<ColoringDecisions>();
+    // the root subtree
+    _deques[0]->push(new ColoringDecisions());
+}
+
+//******************************************************************************
+
+ExactColoringSearch::~ExactColoringSearch()
+{
+    // subtrees left by an interruption
+    foreach (WorkStealingDeque<ColoringDecisions> * deque, _deques)
+    {
+        while (deque->size() > 0)
+            delete deque->pop();
+    }
+    qDeleteAll(_deques);
+}
+
+//******************************************************************************
+
+qint64 ExactColoringSearch::nbNodes() const
+{
+    qint64 count = 0;
+    foreach (qint64 nodes, _nbNodes)
+        count += nodes;
+    return count;
+}
+
+//******************************************************************************
+
+ColoringDecisions * ExactColoringSearch::takeTask(int worker)
+{
+    ColoringDecisions * task = _deques[worker]->pop();
+    if (task)
+        return task;
+    int nbWorkers = _deques.size();
+    for (int i=1; i<nbWorkers; i++)
+    {
+        task = _deques[(worker + i) % nbWorkers]->steal();
+        if (task)
+        {
+            _nbSteals.ref();
+            return task;
+        }
+    }
+    return 0;
+}
+
+//******************************************************************************
+
+void ExactColoringSearch::share(int worker, const ColoringDecisions & task)
+{
+    _pending.ref();
+    _deques[worker]->push(new ColoringDecisions(task));
+}
+
+//******************************************************************************
+
+void ExactColoringSearch::run(int worker)
+{
+    ColoringState state(_problem, _maxColors);
+    QVector<ExploreFrame> frames(_problem.nbVertices + 1);
+    bool isIdle = false;
+    while (!_stop.loadAcquire())
+    {
+        ColoringDecisions * task = takeTask(worker);
+        if (!task)
+        {
+            if (!isIdle)
+            {
+                isIdle = true;
+                _nbIdle.ref();
+            }
+            if (_pending.loadAcquire() == 0)
+                break;
+            QThread::yieldCurrentThread();
+            continue;
+        }
+        if (isIdle)
+        {
+            isIdle = false;
+            _nbIdle.deref();
+        }
+
+        // replay the decisions of the subtree, it may be pruned by a better coloring found meanwhile
+        for (int i=0; i<task->size(); i++)
+            state.color(task->at(i).first, task->at(i).second);
+        delete task;
+        if (state.nbColors() < _upperBound.loadAcquire())
+            explore(state, worker, frames, 0);
+        while (!state.decisions().isEmpty())
+            state.uncolor();
+        _pending.deref();
+    }
+    if (isIdle)
+        _nbIdle.deref();
+}
+
+//******************************************************************************
+
+void ExactColoringSearch::explore(ColoringState & state, int worker, QVector<ExploreFrame> & frames, int depth)
+{
+    if (_stop.loadAcquire())
+        return;
+    if (++_nbNodes[worker] % EXACT_COLORING_CHECK_PERIOD == 0 &&
+            (_deadline->isCancelled() || (_cancellation && _cancellation->isCancelled())))
+    {
+        _isInterrupted.storeRelease(1);
+        _stop.storeRelease(1);
+        return;
+    }
+
+    int v = state.select();
+    if (v < 0)
+    {
+        record(state);
+        return;
+    }
+
+    // colors keeping the count below the best coloring, the new color is the next index
+    ExploreFrame & frame = frames[depth];
+    frame.vertex = v;
+    frame.nbDecisions = state.decisions().size();
+    frame.colors.clear();
+    frame.next = 0;
+    int last = qMin(state.nbColors(), _upperBound.loadAcquire() - 2);
+    for (int c=0; c<=last; c++)
+    {
+        if (state.canColor(v, c))
+            frame.colors.append(c);
+    }
+
+    while (frame.next < frame.colors.size())
+    {
+        int c = frame.colors[frame.next++];
+        if (c > _upperBound.loadAcquire() - 2)
+            break;
+        if (_nbIdle.loadAcquire() > 0)
+            shareOldestBranches(worker, state, frames, depth);
+        state.color(v, c);
+        explore(state, worker, frames, depth + 1);
+        state.uncolor();
+    }
+}
+
+//******************************************************************************
+/*!
+ * \brief ExactColoringSearch::shareOldestBranches method queues the untried colors of the shallowest node that has some, they are the largest subtrees
+ */
+void ExactColoringSearch::shareOldestBranches(int worker, const ColoringState & state, QVector<ExploreFrame> & frames, int depth)
+{
+    for (int d=0; d<=depth; d++)
+    {
+        ExploreFrame & frame = frames[d];
+        if (frame.next >= frame.colors.size())
+            continue;
+        ColoringDecisions prefix = state.decisions().mid(0, frame.nbDecisions);
+        for (int i=frame.next; i<frame.colors.size(); i++)
+        {
+            ColoringDecisions task = prefix;
+            task << qMakePair(frame.vertex, frame.colors[i]);
+            share(worker, task);
+        }
+        frame.next = frame.colors.size();
+        return;
+    }
+}
+
+//******************************************************************************
+
+void ExactColoringSearch::record(const ColoringState & state)
+{
+    QMutexLocker locker(&_bestMutex);
+    if (state.nbColors() >= _upperBound.loadAcquire())
+        return;
+    _bestColors = state.colors();
+    _upperBound.storeRelease(state.nbColors());
+    if (state.nbColors() <= _problem.clique.size())
+        _stop.storeRelease(1);
+}
+
+//******************************************************************************
+
+bool ExactGraphColoring(Graph * graph, int timeBudgetMs, ThreadPool * pool, ExactColoringStatistics * statistics,
+                        const CancellationToken * cancellation)
+{
+    GT_PROFILE_SCOPE("ExactGraphColoring");
+    QElapsedTimer timer;
+    timer.start();
+    int n = graph->vertices.size();
+    if (!ExactColoringFits(*graph, pool))
+    {
+        std::cerr << "ExactGraphColoring : more than " << (EXACT_COLORING_MAX_MEMORY >> 20) << " MB needed" << std::endl;
+        if (statistics)
+            *statistics = ExactColoringStatistics();
+        return false;
+    }
+    ColoringProblem problem(*graph);
+    FindGreedyClique(&problem);
+
+    // DSatur heuristic, the first upper bound
+    int maxDegree = 0;
+    for (int v=0; v<n; v++)
+        maxDegree = qMax(maxDegree, problem.degree(v));
+    QVector<int> colors;
+    int nbColors = 0;
+    {
+        ColoringState state(problem, maxDegree + 1);
+        int v;
+        while ((v = state.select()) >= 0)
+        {
+            int c = 0;
+            while (!state.canColor(v, c))
+                c++;
+            state.color(v, c);
+        }
+        colors = state.colors();
+        nbColors = state.nbColors();
+    }
+
+    ExactColoringStatistics result;
+    result.lowerBound = problem.clique.size();
+    result.initialNbColors = nbColors;
+    result.isOptimal = true;
+    if (nbColors > problem.clique.size())
+    {
+        ThreadPool & workers = pool ? *pool : ThreadPool::instance();
+        CancellationToken deadline;
+        deadline.setDeadline(timeBudgetMs);
+        ExactColoringSearch search(problem, workers.nbThreads(), colors, nbColors, &deadline, cancellation);
+        RunParallel(workers, [&](int worker)
+        {
+            search.run(worker);
+        });
+        colors = search.bestColors();
+        nbColors = search.nbColors();
+        result.isOptimal = !search.isInterrupted();
+        result.nbNodes = search.nbNodes();
+        result.nbSteals = search.nbSteals();
+    }
+
+    for (int v=0; v<n; v++)
+        graph->vertices[v].color = colors[v];
+    result.nbColors = nbColors;
+    result.elapsedMs = timer.elapsed();
+    if (statistics)
+        *statistics = result;
+    return result.isOptimal;
+}
+
+//******************************************************************************
+
+bool ExactColoringFits(const Graph & graph, ThreadPool * pool)
+{
+    ThreadPool & workers = pool ? *pool : ThreadPool::instance();
+    int n = graph.vertices.size();
+    QVector<int> degrees(n, 0);
+    const QVector<Edge> & edges = graph.getEdges();
+    for (int i=0; i<edges.size(); i++)
+    {
+        if (edges[i].a == edges[i].b)
+            continue;
+        degrees[edges[i].a->id]++;
+        degrees[edges[i].b->id]++;
+    }
+    int maxDegree = 0;
+    for (int v=0; v<n; v++)
+        maxDegree = qMax(maxDegree, qMin(degrees[v], n - 1));
+
+    qint64 nbWords = (n + 63) / 64;
+    qint64 adjacencyBytes = n * nbWords * qint64(sizeof(quint64));
+    qint64 stateBytes = qint64(n) * (maxDegree + 1) * qint64(sizeof(int)) + (maxDegree + 1) * nbWords * qint64(sizeof(quint64))
+            + qint64(n + 1) * qint64(sizeof(ExploreFrame));
+    return adjacencyBytes + (workers.nbThreads() + 1) * stateBytes <= EXACT_COLORING_MAX_MEMORY;
+}
+
+//******************************************************************************
+
+}
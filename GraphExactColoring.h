@@ -0,0 +1,86 @@
+#ifndef GRAPHEXACTCOLORING_H
+#define GRAPHEXACTCOLORING_H
+
+// Qt
+#include <QtGlobal>
+
+//******************************************************************************
+
+namespace GT {
+
+struct Graph;
+class ThreadPool;
+class CancellationToken;
+
+//******************************************************************************
+
+static const qint64 EXACT_COLORING_MAX_MEMORY = qint64(256) << 20; //!< bytes, see ExactColoringFits
+
+//******************************************************************************
+/*!
+ * \brief ExactColoringStatistics struct describes the search of ExactGraphColoring
+ */
+struct ExactColoringStatistics
+{
+    ExactColoringStatistics() :
+        lowerBound(0),
+        nbColors(0),
+        initialNbColors(0),
+        isOptimal(false),
+        nbNodes(0),
+        nbSteals(0),
+        elapsedMs(0)
+    {
+    }
+    int lowerBound; //!< size of the greedy clique
+    int nbColors; //!< colors of the best coloring found
+    int initialNbColors; //!< colors of the DSatur heuristic, the first upper bound
+    bool isOptimal; //!< false if the time budget expired or the search was cancelled
+    qint64 nbNodes; //!< branch-and-bound nodes
+    int nbSteals; //!< subtrees taken from the queue of another worker
+    qint64 elapsedMs;
+};
+
+//******************************************************************************
+/*!
+ * \brief ExactGraphColoring method colors the graph with the minimal number of colors
+ * \param graph vertex colors are replaced by the best coloring found
+ * \param timeBudgetMs the search stops after this time and keeps the best coloring found, 0 for no limit
+ * \param pool ThreadPool::instance() if null
+ * \param statistics optional
+ * \param cancellation optional, stops the search as the time budget does
+ * \return true if the coloring is proven optimal, false with the colors unchanged if !ExactColoringFits
+ *
+ * DSatur branch and bound : the uncolored vertex with the most distinct neighbor colors (then
+ * the most uncolored neighbors) takes in turn each color of no neighbor, or a new color while the
+ * count stays below the best coloring found. Color classes and adjacency rows are bitsets.
+ * A greedy clique gives the lower bound, its vertices are precolored 0..k-1 and a new color is
+ * always the next index, which removes the color permutations from the tree.
+ *
+ * Workers explore subtrees in parallel : while some workers are idle, a busy worker pushes the
+ * untried colors of its shallowest open node on its WorkStealingDeque, idle workers steal the
+ * oldest (largest) subtrees.
+ *
+ * Edges are conflicts in both directions, self-loops are ignored.
+ */
+bool ExactGraphColoring(Graph * graph, int timeBudgetMs=0, ThreadPool * pool=0, ExactColoringStatistics * statistics=0,
+                        const CancellationToken * cancellation=0);
+
+//******************************************************************************
+/*!
+ * \brief ExactColoringFits method tells if ExactGraphColoring stays within EXACT_COLORING_MAX_MEMORY
+ * \param pool ThreadPool::instance() if null
+ *
+ * The adjacency bitsets take n^2 / 8 bytes. Each coloring state, the DSatur one and one per
+ * worker, counts the neighbors of each color : n * (maxDegree + 1) ints, 4 GB for a clique of
+ * 16384 vertices. maxDegree is bounded by the edge count, parallel edges included.
+ */
+bool ExactColoringFits(const Graph & graph, ThreadPool * pool=0);
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHEXACTCOLORING_H
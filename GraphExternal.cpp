@@ -0,0 +1,579 @@
+
+// STD
+#include <iostream>
+#include <limits>
+#include <cstring>
+
+// Qt
+#include <QFile>
+#include <QThread>
+#include <QMutexLocker>
+
+// System
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+// Project
+#include "GraphExternal.h"
+#include "GraphIO.h"
+#include "GraphTools.h"
+#include "GraphUnionFind.h"
+#include "GraphMemory.h"
+#include "GraphProfiler.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+static const int EDGE_FILE_DIRECTED = 1;
+static const int EDGE_FILE_PAGE_BYTES = 4096;
+
+//******************************************************************************
+
+EdgeFileWriter::EdgeFileWriter() :
+    _file(0),
+    _nbVertices(0),
+    _directed(false),
+    _nbEdges(0),
+    _ok(false)
+{
+}
+
+//******************************************************************************
+
+EdgeFileWriter::~EdgeFileWriter()
+{
+    if (_file)
+        close();
+}
+
+//******************************************************************************
+
+bool EdgeFileWriter::open(const QString & fileName, int nbVertices, bool directed)
+{
+    if (_file)
+        close();
+    _file = new QFile(fileName);
+    if (!_file->open(QIODevice::WriteOnly))
+    {
+        std::cerr << "Failed to open the edge file for writing" << std::endl;
+        delete _file;
+        _file = 0;
+        return false;
+    }
+    _nbVertices = nbVertices;
+    _directed = directed;
+    _nbEdges = 0;
+    _block.clear();
+    _block.reserve(EDGE_STREAM_BLOCK_BYTES / int(sizeof(ExternalEdge)));
+    _ok = writeHeader();
+    return _ok;
+}
+
+//******************************************************************************
+
+bool EdgeFileWriter::append(int a, int b, double weight)
+{
+    if (!_file || !_ok)
+        return false;
+    if (a < 0 || a >= _nbVertices || b < 0 || b >= _nbVertices)
+    {
+        std::cerr << "Edge vertex out of range : " << a << ", " << b << std::endl;
+        return false;
+    }
+    ExternalEdge edge;
+    edge.a = a;
+    edge.b = b;
+    edge.weight = weight;
+    _block << edge;
+    _nbEdges++;
+    if (_block.size() == _block.capacity())
+        _ok = flush();
+    return _ok;
+}
+
+//******************************************************************************
+
+bool EdgeFileWriter::close()
+{
+    if (!_file)
+        return false;
+    bool ok = _ok && flush() && _file->seek(0) && writeHeader();
+    _file->close();
+    delete _file;
+    _file = 0;
+    _block.clear();
+    if (!ok)
+        std::cerr << "Failed to write the edge file" << std::endl;
+    return ok;
+}
+
+//******************************************************************************
+
+bool EdgeFileWriter::flush()
+{
+    qint64 bytes = _block.size() * qint64(sizeof(ExternalEdge));
+    bool ok = _file->write(reinterpret_cast<const char*>(_block.constData()), bytes) == bytes;
+    _block.resize(0);
+    return ok;
+}
+
+//******************************************************************************
+
+bool EdgeFileWriter::writeHeader()
+{
+    char header[EDGE_FILE_HEADER_BYTES];
+    std::memset(header, 0, sizeof(header));
+    quint32 magic = EDGE_FILE_MAGIC;
+    quint16 version = EDGE_FILE_VERSION;
+    quint16 flags = _directed ? EDGE_FILE_DIRECTED : 0;
+    quint32 nbVertices = _nbVertices;
+    quint64 nbEdges = _nbEdges;
+    std::memcpy(header, &magic, 4);
+    std::memcpy(header + 4, &version, 2);
+    std::memcpy(header + 6, &flags, 2);
+    std::memcpy(header + 8, &nbVertices, 4);
+    std::memcpy(header + 16, &nbEdges, 8);
+    return _file->write(header, sizeof(header)) == qint64(sizeof(header));
+}
+
+//******************************************************************************
+/*!
+ * \brief WriteEdgeFile method writes the undirected edges of a document to an edge file
+ */
+bool WriteEdgeFile(const QString & fileName, const GraphDocument & doc)
+{
+    EdgeFileWriter writer;
+    if (!writer.open(fileName, doc.nbVertices(), false))
+        return false;
+    for (int i=0; i<doc.nbEdges(); i++)
+    {
+        if (!writer.append(doc.edgeVertices[2*i], doc.edgeVertices[2*i+1], doc.edgeWeights[i]))
+            return false;
+    }
+    return writer.close();
+}
+
+//******************************************************************************
+/*!
+ * \brief EdgeReadAheadThread class reads the blocks of one sweep
+ */
+class EdgeReadAheadThread : public QThread
+{
+public:
+    explicit EdgeReadAheadThread(EdgeStream * stream) :
+        _stream(stream)
+    {
+    }
+
+protected:
+    void run()
+    { _stream->readAhead(); }
+
+private:
+    EdgeStream * _stream;
+};
+
+//******************************************************************************
+
+EdgeStream::EdgeStream() :
+    _fd(-1),
+    _file(0),
+    _nbVertices(0),
+    _nbEdges(0),
+    _directed(false),
+    _blockBytes(0),
+    _nbBlocks(0),
+    _thread(0),
+    _nbFilled(0),
+    _stop(false),
+    _error(false),
+    _nextBlock(0),
+    _isHolding(false),
+    _isSweeping(false)
+{
+}
+
+//******************************************************************************
+
+EdgeStream::~EdgeStream()
+{
+    close();
+}
+
+//******************************************************************************
+/*!
+ * \brief EdgeStream::open method reads the header of an edge file
+ * \param blockBytes rounded down to a multiple of the page size
+ * \param nbReadAhead number of blocks in memory, at least 2
+ */
+bool EdgeStream::open(const QString & fileName, int blockBytes, int nbReadAhead)
+{
+    close();
+
+#ifdef Q_OS_UNIX
+    _fd = ::open(fileName.toLocal8Bit().constData(), O_RDONLY);
+#ifdef Q_OS_LINUX
+    if (_fd >= 0)
+        posix_fadvise(_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+#else
+    _file = new QFile(fileName);
+    if (!_file->open(QIODevice::ReadOnly))
+    {
+        delete _file;
+        _file = 0;
+    }
+#endif
+    if (!isOpen())
+    {
+        std::cerr << "Failed to open the edge file" << std::endl;
+        return false;
+    }
+
+    char header[24];
+    quint32 magic=0, nbVertices=0;
+    quint16 version=0, flags=0;
+    quint64 nbEdges=0;
+    if (readBlock(0, header, sizeof(header)) == qint64(sizeof(header)))
+    {
+        std::memcpy(&magic, header, 4);
+        std::memcpy(&version, header + 4, 2);
+        std::memcpy(&flags, header + 6, 2);
+        std::memcpy(&nbVertices, header + 8, 4);
+        std::memcpy(&nbEdges, header + 16, 8);
+    }
+    if (magic != EDGE_FILE_MAGIC || version != EDGE_FILE_VERSION || nbVertices > quint32(std::numeric_limits<int>::max()))
+    {
+        std::cerr << "Not an edge file or unsupported version" << std::endl;
+        close();
+        return false;
+    }
+    _nbVertices = nbVertices;
+    _nbEdges = nbEdges;
+    _directed = flags & EDGE_FILE_DIRECTED;
+
+    _blockBytes = qMax(EDGE_FILE_PAGE_BYTES, blockBytes - blockBytes % EDGE_FILE_PAGE_BYTES);
+    int edgesPerBlock = _blockBytes / int(sizeof(ExternalEdge));
+    _nbBlocks = (_nbEdges + edgesPerBlock - 1) / edgesPerBlock;
+    _buffers.fill(0, qMax(2, nbReadAhead));
+    _bufferEdges.fill(0, _buffers.size());
+    for (int i=0; i<_buffers.size(); i++)
+    {
+        _buffers[i] = static_cast<char*>(AllocateNumaMemory(_blockBytes, NUMA_DEFAULT));
+        if (!_buffers[i])
+        {
+            std::cerr << "Failed to allocate the edge stream blocks" << std::endl;
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+//******************************************************************************
+
+void EdgeStream::close()
+{
+    stopReadAhead();
+#ifdef Q_OS_UNIX
+    if (_fd >= 0)
+        ::close(_fd);
+#endif
+    _fd = -1;
+    delete _file;
+    _file = 0;
+    for (int i=0; i<_buffers.size(); i++)
+    {
+        if (_buffers[i])
+            FreeNumaMemory(_buffers[i], _blockBytes);
+    }
+    _buffers.clear();
+    _bufferEdges.clear();
+    _nbVertices = 0;
+    _nbEdges = 0;
+    _nbBlocks = 0;
+    _isSweeping = false;
+}
+
+//******************************************************************************
+/*!
+ * \brief EdgeStream::rewind method starts a sweep, the read-ahead thread reads the first blocks
+ */
+bool EdgeStream::rewind()
+{
+    if (!isOpen())
+        return false;
+    stopReadAhead();
+    _nbFilled = 0;
+    _stop = false;
+    _error = false;
+    _nextBlock = 0;
+    _isHolding = false;
+    _statistics.nbSweeps++;
+    _isSweeping = true;
+    _sweepTimer.start();
+    if (_nbBlocks > 0)
+    {
+        _thread = new EdgeReadAheadThread(this);
+        _thread->start();
+    }
+    return true;
+}
+
+//******************************************************************************
+/*!
+ * \brief EdgeStream::nextBlock method releases the previous block and waits for the next one
+ */
+const ExternalEdge * EdgeStream::nextBlock(int * nbEdges)
+{
+    QMutexLocker locker(&_mutex);
+    if (_isHolding)
+    {
+        _isHolding = false;
+        _nbFilled--;
+        _blockFree.wakeAll();
+    }
+    if (_nextBlock < _nbBlocks && _nbFilled == 0 && !_error)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        while (_nbFilled == 0 && !_error)
+            _blockRead.wait(&_mutex);
+        _statistics.waitNs += timer.nsecsElapsed();
+    }
+    if (_nextBlock >= _nbBlocks || _error)
+    {
+        if (_isSweeping)
+        {
+            _statistics.elapsedNs += _sweepTimer.nsecsElapsed();
+            _isSweeping = false;
+        }
+        return 0;
+    }
+    int slot = _nextBlock % _buffers.size();
+    _nextBlock++;
+    _isHolding = true;
+    *nbEdges = _bufferEdges[slot];
+    return reinterpret_cast<const ExternalEdge*>(_buffers[slot]);
+}
+
+//******************************************************************************
+
+void EdgeStream::dropCache()
+{
+#ifdef Q_OS_LINUX
+    if (_fd >= 0)
+        posix_fadvise(_fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+}
+
+//******************************************************************************
+
+void EdgeStream::stopReadAhead()
+{
+    if (!_thread)
+        return;
+    {
+        QMutexLocker locker(&_mutex);
+        _stop = true;
+        _blockFree.wakeAll();
+    }
+    _thread->wait();
+    delete _thread;
+    _thread = 0;
+}
+
+//******************************************************************************
+/*!
+ * \brief EdgeStream::readAhead method, on the read-ahead thread, reads the blocks into the free buffers
+ *
+ * Block i goes to buffer i modulo the ring size, it is free once the consumer released block i - ring size.
+ */
+void EdgeStream::readAhead()
+{
+    int edgesPerBlock = _blockBytes / int(sizeof(ExternalEdge));
+    int nbBuffers = _buffers.size();
+    QElapsedTimer timer;
+    for (qint64 block=0; block<_nbBlocks; block++)
+    {
+        {
+            QMutexLocker locker(&_mutex);
+            while (_nbFilled == nbBuffers && !_stop)
+                _blockFree.wait(&_mutex);
+            if (_stop)
+                return;
+        }
+
+        int slot = block % nbBuffers;
+        qint64 first = block * edgesPerBlock;
+        int count = int(qMin(qint64(edgesPerBlock), _nbEdges - first));
+        qint64 bytes = count * qint64(sizeof(ExternalEdge));
+        timer.start();
+        bool ok = readBlock(EDGE_FILE_HEADER_BYTES + first * qint64(sizeof(ExternalEdge)), _buffers[slot], bytes) == bytes;
+
+        QMutexLocker locker(&_mutex);
+        _statistics.readNs += timer.nsecsElapsed();
+        if (!ok)
+        {
+            std::cerr << "Failed to read the edge file, block " << block << std::endl;
+            _error = true;
+            _blockRead.wakeAll();
+            return;
+        }
+        _bufferEdges[slot] = count;
+        _statistics.nbBlocks++;
+        _statistics.bytesRead += bytes;
+        _nbFilled++;
+        _blockRead.wakeAll();
+    }
+}
+
+//******************************************************************************
+
+qint64 EdgeStream::readBlock(qint64 offset, char * buffer, qint64 bytes)
+{
+#ifdef Q_OS_UNIX
+    if (_fd >= 0)
+    {
+        qint64 done = 0;
+        while (done < bytes)
+        {
+            ssize_t n = pread(_fd, buffer + done, bytes - done, offset + done);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                break;
+            done += n;
+        }
+        return done;
+    }
+#endif
+    if (!_file || !_file->seek(offset))
+        return -1;
+    return _file->read(buffer, bytes);
+}
+
+//******************************************************************************
+/*!
+ * \brief ExternalConnectedComponents method computes the components of an edge file in one sweep
+ * \return number of components, -1 on error
+ *
+ * Semi-external : the union-find of the vertices is in memory, the edges are streamed.
+ * Labels are in the order of the smallest vertex id, as with ColorConnectedVertices.
+ */
+int ExternalConnectedComponents(EdgeStream & stream, ConnectedComponents * components)
+{
+    GT_PROFILE_SCOPE("ExternalConnectedComponents");
+    if (!components || !stream.rewind())
+        return -1;
+
+    int n = stream.nbVertices();
+    UnionFind sets(n);
+    int nbEdges = 0;
+    const ExternalEdge * edges = 0;
+    while ((edges = stream.nextBlock(&nbEdges)))
+    {
+        for (int i=0; i<nbEdges; i++)
+        {
+            const ExternalEdge & edge = edges[i];
+            if (quint32(edge.a) < quint32(n) && quint32(edge.b) < quint32(n))
+                sets.unite(edge.a, edge.b);
+        }
+    }
+    if (stream.hasError())
+        return -1;
+
+    QVector<int> rootLabels(n, -1);
+    QVector<int> labels(n);
+    int nbLabels = 0;
+    for (int v=0; v<n; v++)
+    {
+        int & label = rootLabels[sets.find(v)];
+        if (label < 0)
+            label = nbLabels++;
+        labels[v] = label;
+    }
+    components->setLabels(labels, nbLabels);
+    return nbLabels;
+}
+
+//******************************************************************************
+/*!
+ * \brief ExternalBellmanFord method computes the distances from the source by sweeps over an edge file
+ * \param distances std::numeric_limits<double>::max() for unreachable vertices
+ * \param predecessors optional, -1 for the source and the unreachable vertices
+ * \param maxSweeps 0 for nbVertices, which detects negative cycles
+ * \return false on a read error, a negative cycle or if the distances did not converge within maxSweeps
+ *
+ * Each sweep relaxes every edge once (both directions for an undirected file), the distances are
+ * in memory. It stops after the first sweep changing nothing, i.e. after (number of edges of the
+ * longest shortest path + 1) sweeps, which is few on small-world graphs.
+ */
+bool ExternalBellmanFord(EdgeStream & stream, int source, QVector<double> * distances, QVector<int> * predecessors,
+                         int maxSweeps)
+{
+    GT_PROFILE_SCOPE("ExternalBellmanFord");
+    int n = stream.nbVertices();
+    if (!distances || !stream.isOpen() || source < 0 || source >= n)
+        return false;
+
+    const double infinity = std::numeric_limits<double>::max();
+    distances->fill(infinity, n);
+    (*distances)[source] = 0.0;
+    if (predecessors)
+        predecessors->fill(-1, n);
+    if (maxSweeps <= 0)
+        maxSweeps = n;
+
+    double * d = distances->data();
+    int * p = predecessors ? predecessors->data() : 0;
+    bool directed = stream.isDirected();
+    for (int sweep=0; sweep<maxSweeps; sweep++)
+    {
+        if (!stream.rewind())
+            return false;
+        bool changed = false;
+        int nbEdges = 0;
+        const ExternalEdge * edges = 0;
+        while ((edges = stream.nextBlock(&nbEdges)))
+        {
+            for (int i=0; i<nbEdges; i++)
+            {
+                const ExternalEdge & edge = edges[i];
+                if (quint32(edge.a) >= quint32(n) || quint32(edge.b) >= quint32(n))
+                    continue;
+                if (d[edge.a] != infinity && d[edge.a] + edge.weight < d[edge.b])
+                {
+                    d[edge.b] = d[edge.a] + edge.weight;
+                    if (p)
+                        p[edge.b] = edge.a;
+                    changed = true;
+                }
+                if (!directed && d[edge.b] != infinity && d[edge.b] + edge.weight < d[edge.a])
+                {
+                    d[edge.a] = d[edge.b] + edge.weight;
+                    if (p)
+                        p[edge.a] = edge.b;
+                    changed = true;
+                }
+            }
+        }
+        if (stream.hasError())
+            return false;
+        if (!changed)
+            return true;
+    }
+    if (maxSweeps >= n)
+        std::cerr << "Negative cycle reachable from vertex " << source << std::endl;
+    return false;
+}
+
+//******************************************************************************
+
+}
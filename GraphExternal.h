@@ -0,0 +1,195 @@
+#ifndef GRAPHEXTERNAL_H
+#define GRAPHEXTERNAL_H
+
+// Qt
+#include <QVector>
+#include <QString>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+
+class QFile;
+
+//******************************************************************************
+
+namespace GT {
+
+struct GraphDocument;
+class ConnectedComponents;
+class EdgeReadAheadThread;
+
+//******************************************************************************
+
+static const quint32 EDGE_FILE_MAGIC = 0x45434747; // "GGCE"
+static const quint16 EDGE_FILE_VERSION = 1;
+static const int EDGE_FILE_HEADER_BYTES = 4096; //!< edge records start on a page boundary
+static const int EDGE_STREAM_BLOCK_BYTES = 1 << 20;
+static const int EDGE_STREAM_READ_AHEAD = 4; //!< blocks in flight, one is read while the others are processed
+
+//******************************************************************************
+/*!
+ * \brief ExternalEdge struct is the record of an edge file, in host byte order
+ */
+struct ExternalEdge
+{
+    qint32 a;
+    qint32 b;
+    double weight;
+};
+
+//******************************************************************************
+/*!
+ * \brief EdgeFileWriter class writes an edge file one edge at a time, the edges are never all in memory
+ *
+ *  header : magic (quint32), version (quint16), flags (quint16, 1 for directed), nbVertices (quint32),
+ *           reserved (quint32), nbEdges (quint64), zero padding up to EDGE_FILE_HEADER_BYTES
+ *  edges : ExternalEdge records
+ */
+class EdgeFileWriter
+{
+public:
+    EdgeFileWriter();
+    ~EdgeFileWriter();
+
+    bool open(const QString & fileName, int nbVertices, bool directed);
+    bool append(int a, int b, double weight);
+    //! writes the edge count in the header
+    bool close();
+
+    qint64 nbEdges() const
+    { return _nbEdges; }
+
+private:
+    Q_DISABLE_COPY(EdgeFileWriter)
+
+    bool flush();
+    bool writeHeader();
+
+    QFile * _file;
+    QVector<ExternalEdge> _block;
+    int _nbVertices;
+    bool _directed;
+    qint64 _nbEdges;
+    bool _ok;
+};
+
+bool WriteEdgeFile(const QString & fileName, const GraphDocument & doc);
+
+//******************************************************************************
+/*!
+ * \brief EdgeStreamStatistics struct accumulates the sweeps of an EdgeStream
+ */
+struct EdgeStreamStatistics
+{
+    EdgeStreamStatistics() :
+        nbSweeps(0),
+        nbBlocks(0),
+        bytesRead(0),
+        readNs(0),
+        waitNs(0),
+        elapsedNs(0)
+    {
+    }
+    //! MB/s over the whole sweeps, processing included
+    double throughput() const
+    { return elapsedNs > 0 ? bytesRead * 1e3 / elapsedNs : 0.0; }
+
+    int nbSweeps;
+    qint64 nbBlocks;
+    qint64 bytesRead;
+    qint64 readNs; //!< spent in the reads, on the read-ahead thread
+    qint64 waitNs; //!< spent by the consumer waiting for a block
+    qint64 elapsedNs; //!< from each rewind to the end of its sweep
+};
+
+//******************************************************************************
+/*!
+ * \brief EdgeStream class reads the edges of an edge file sequentially, in blocks, for out-of-core algorithms
+ *
+ * A sweep starts with rewind() and nextBlock() hands the blocks in file order until it returns 0.
+ * A read-ahead thread fills a ring of nbReadAhead page-aligned blocks with pread, the consumer
+ * processes one block while the next ones are read. Only the ring is in memory, whatever the
+ * file size. The kernel read-ahead is asked for sequential access.
+ */
+class EdgeStream
+{
+public:
+    EdgeStream();
+    ~EdgeStream();
+
+    bool open(const QString & fileName, int blockBytes=EDGE_STREAM_BLOCK_BYTES, int nbReadAhead=EDGE_STREAM_READ_AHEAD);
+    void close();
+
+    bool isOpen() const
+    { return _fd >= 0 || _file; }
+    int nbVertices() const
+    { return _nbVertices; }
+    qint64 nbEdges() const
+    { return _nbEdges; }
+    bool isDirected() const
+    { return _directed; }
+    qint64 fileBytes() const
+    { return EDGE_FILE_HEADER_BYTES + _nbEdges * qint64(sizeof(ExternalEdge)); }
+
+    bool rewind();
+    //! 0 at the end of the sweep or on a read error
+    const ExternalEdge * nextBlock(int * nbEdges);
+    bool hasError() const
+    { return _error; }
+
+    //! evicts the file from the page cache, the next sweep reads the disk (Linux only)
+    void dropCache();
+
+    const EdgeStreamStatistics & statistics() const
+    { return _statistics; }
+    void resetStatistics()
+    { _statistics = EdgeStreamStatistics(); }
+
+private:
+    Q_DISABLE_COPY(EdgeStream)
+    friend class EdgeReadAheadThread;
+
+    void stopReadAhead();
+    void readAhead();
+    qint64 readBlock(qint64 offset, char * buffer, qint64 bytes);
+
+    int _fd; //!< POSIX descriptor, -1 where pread is not available
+    QFile * _file; //!< fallback
+    int _nbVertices;
+    qint64 _nbEdges;
+    bool _directed;
+
+    int _blockBytes;
+    QVector<char*> _buffers;
+    QVector<int> _bufferEdges;
+    qint64 _nbBlocks;
+
+    EdgeReadAheadThread * _thread;
+    QMutex _mutex;
+    QWaitCondition _blockRead;
+    QWaitCondition _blockFree;
+    int _nbFilled; //!< blocks read and not released, the consumer holds one of them
+    bool _stop;
+    bool _error;
+    qint64 _nextBlock; //!< next block given to the consumer
+    bool _isHolding; //!< the consumer holds the previous block
+
+    EdgeStreamStatistics _statistics;
+    QElapsedTimer _sweepTimer;
+    bool _isSweeping;
+};
+
+//******************************************************************************
+
+int ExternalConnectedComponents(EdgeStream & stream, ConnectedComponents * components);
+
+bool ExternalBellmanFord(EdgeStream & stream, int source, QVector<double> * distances, QVector<int> * predecessors=0,
+                         int maxSweeps=0);
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHEXTERNAL_H
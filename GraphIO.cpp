@@ -0,0 +1,339 @@
+
+// STD
+#include <iostream>
+
+// Qt
+#include <QIODevice>
+#include <QDataStream>
+#include <QTextStream>
+#include <QXmlStreamWriter>
+
+// Project
+#include "GraphIO.h"
+#include "GraphTools.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+// Byte size of one serialized vertex : x, y (double) and color (quint32)
+static const qint64 VERTEX_RECORD_SIZE = 2*8 + 4;
+// Byte size of one serialized edge : vertex1, vertex2 (quint32) and weight (double)
+static const qint64 EDGE_RECORD_SIZE = 2*4 + 8;
+
+void setupStream(QDataStream & stream)
+{
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+}
+
+//******************************************************************************
+/*!
+ * \brief WriteGraphDocument method writes the document in the binary graph file format
+ * \param device opened for writing
+ * \param doc
+ * \return false if document is inconsistent or device write failed
+ *
+ * Format (little endian) :
+ *  header   : magic (quint32), version (quint16), flags (quint16), nbVertices (quint32), nbEdges (quint32)
+ *  vertices : nbVertices x [x (double), y (double), color (quint32)]
+ *  edges    : nbEdges x [vertex1 (quint32), vertex2 (quint32), weight (double)]
+ *  results  : start (qint32), end (qint32), distance (double), pathSize (quint32), pathSize x vertex (qint32)
+ *
+ * Everything is written in one pass, records have fixed size.
+ */
+bool WriteGraphDocument(QIODevice * device, const GraphDocument & doc)
+{
+    if (!device || !device->isWritable())
+        return false;
+
+    int nbVertices = doc.nbVertices();
+    int nbEdges = doc.nbEdges();
+    if (doc.colors.size() != nbVertices || doc.edgeVertices.size() != 2*nbEdges)
+    {
+        std::cerr << "Graph document is inconsistent" << std::endl;
+        return false;
+    }
+
+    QDataStream stream(device);
+    setupStream(stream);
+
+    stream << GRAPH_FILE_MAGIC << GRAPH_FILE_VERSION << quint16(0)
+           << quint32(nbVertices) << quint32(nbEdges);
+
+    const QPointF * positions = doc.positions.constData();
+    const QRgb * colors = doc.colors.constData();
+    for (int i=0; i<nbVertices; i++)
+    {
+        stream << positions[i].x() << positions[i].y() << quint32(colors[i]);
+    }
+
+    const int * edgeVertices = doc.edgeVertices.constData();
+    const double * edgeWeights = doc.edgeWeights.constData();
+    for (int i=0; i<nbEdges; i++)
+    {
+        stream << quint32(edgeVertices[2*i]) << quint32(edgeVertices[2*i+1]) << edgeWeights[i];
+    }
+
+    stream << qint32(doc.startVertexId) << qint32(doc.endVertexId) << doc.distance
+           << quint32(doc.path.size());
+    foreach (int index, doc.path)
+    {
+        stream << qint32(index);
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
+
+//******************************************************************************
+/*!
+ * \brief ReadGraphDocument method reads the binary graph file format written by WriteGraphDocument
+ * \param device opened for reading
+ * \param doc is overwritten
+ * \return false if the data is not a valid graph file
+ *
+ * Records counts are checked against the remaining device size before any allocation,
+ * so a corrupted header can not trigger a huge allocation.
+ */
+bool ReadGraphDocument(QIODevice * device, GraphDocument * doc)
+{
+    if (!device || !doc || !device->isReadable())
+        return false;
+
+    QDataStream stream(device);
+    setupStream(stream);
+
+    quint32 magic=0, nbVertices=0, nbEdges=0;
+    quint16 version=0, flags=0;
+    stream >> magic >> version >> flags >> nbVertices >> nbEdges;
+    if (stream.status() != QDataStream::Ok || magic != GRAPH_FILE_MAGIC)
+    {
+        std::cerr << "Input is not a graph file" << std::endl;
+        return false;
+    }
+    if (version > GRAPH_FILE_VERSION)
+    {
+        std::cerr << "Graph file version " << version << " is not supported" << std::endl;
+        return false;
+    }
+
+    qint64 recordsSize = nbVertices * VERTEX_RECORD_SIZE + nbEdges * EDGE_RECORD_SIZE;
+    if (nbVertices > 0x7FFFFFFF || nbEdges > 0x3FFFFFFF
+            || (!device->isSequential() && device->size() - device->pos() < recordsSize))
+    {
+        std::cerr << "Graph file is truncated" << std::endl;
+        return false;
+    }
+
+    *doc = GraphDocument();
+    doc->positions.resize(nbVertices);
+    doc->colors.resize(nbVertices);
+    QPointF * positions = doc->positions.data();
+    QRgb * colors = doc->colors.data();
+    for (quint32 i=0; i<nbVertices; i++)
+    {
+        double x, y;
+        quint32 color;
+        stream >> x >> y >> color;
+        positions[i] = QPointF(x, y);
+        colors[i] = color;
+    }
+
+    doc->edgeVertices.resize(2*nbEdges);
+    doc->edgeWeights.resize(nbEdges);
+    int * edgeVertices = doc->edgeVertices.data();
+    double * edgeWeights = doc->edgeWeights.data();
+    for (quint32 i=0; i<nbEdges; i++)
+    {
+        quint32 v1, v2;
+        stream >> v1 >> v2 >> edgeWeights[i];
+        if (v1 >= nbVertices || v2 >= nbVertices)
+        {
+            std::cerr << "Graph file contains an edge with unknown vertex" << std::endl;
+            return false;
+        }
+        edgeVertices[2*i] = v1;
+        edgeVertices[2*i+1] = v2;
+    }
+
+    qint32 start, end;
+    quint32 pathSize;
+    stream >> start >> end >> doc->distance >> pathSize;
+    if (stream.status() != QDataStream::Ok || pathSize > nbVertices)
+    {
+        std::cerr << "Graph file results section is corrupted" << std::endl;
+        return false;
+    }
+    doc->startVertexId = start;
+    doc->endVertexId = end;
+    for (quint32 i=0; i<pathSize; i++)
+    {
+        qint32 index;
+        stream >> index;
+        doc->path << index;
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
+
+//******************************************************************************
+/*!
+ * \brief ExportGraphJson method writes the document as JSON for interchange with other tools
+ *
+ * Layout : { "vertices": [{"id", "x", "y", "color"}], "edges": [{"source", "target", "weight"}],
+ * "shortestPath": {"start", "end", "distance", "path"} }. Vertex ids are 0-based.
+ */
+bool ExportGraphJson(QIODevice * device, const GraphDocument & doc)
+{
+    if (!device || !device->isWritable())
+        return false;
+
+    QTextStream out(device);
+    out.setRealNumberPrecision(17);
+
+    out << "{\n  \"vertices\": [";
+    for (int i=0; i<doc.nbVertices(); i++)
+    {
+        out << (i > 0 ? ",\n    " : "\n    ")
+            << "{\"id\": " << i
+            << ", \"x\": " << doc.positions[i].x()
+            << ", \"y\": " << doc.positions[i].y()
+            << ", \"color\": \"" << QColor(doc.colors.value(i)).name() << "\"}";
+    }
+    out << "\n  ],\n  \"edges\": [";
+    for (int i=0; i<doc.nbEdges(); i++)
+    {
+        out << (i > 0 ? ",\n    " : "\n    ")
+            << "{\"source\": " << doc.edgeVertices[2*i]
+            << ", \"target\": " << doc.edgeVertices[2*i+1]
+            << ", \"weight\": " << doc.edgeWeights[i] << "}";
+    }
+    out << "\n  ],\n  \"shortestPath\": {\"start\": " << doc.startVertexId
+        << ", \"end\": " << doc.endVertexId
+        << ", \"distance\": " << doc.distance
+        << ", \"path\": [";
+    for (int i=0; i<doc.path.size(); i++)
+    {
+        out << (i > 0 ? ", " : "") << doc.path[i];
+    }
+    out << "]}\n}\n";
+
+    out.flush();
+    return out.status() == QTextStream::Ok;
+}
+
+//******************************************************************************
+/*!
+ * \brief ExportGraphML method writes the document as an undirected GraphML graph
+ *
+ * Vertex positions and colors, edge weights are exported as GraphML data keys.
+ */
+bool ExportGraphML(QIODevice * device, const GraphDocument & doc)
+{
+    if (!device || !device->isWritable())
+        return false;
+
+    QXmlStreamWriter xml(device);
+    xml.setAutoFormatting(true);
+    xml.writeStartDocument();
+    xml.writeStartElement("graphml");
+    xml.writeDefaultNamespace("http://graphml.graphdrawing.org/xmlns");
+
+    const char * keys[][4] = {
+        { "x", "node", "x", "double" },
+        { "y", "node", "y", "double" },
+        { "color", "node", "color", "string" },
+        { "weight", "edge", "weight", "double" }
+    };
+    for (int i=0; i<4; i++)
+    {
+        xml.writeStartElement("key");
+        xml.writeAttribute("id", keys[i][0]);
+        xml.writeAttribute("for", keys[i][1]);
+        xml.writeAttribute("attr.name", keys[i][2]);
+        xml.writeAttribute("attr.type", keys[i][3]);
+        xml.writeEndElement();
+    }
+
+    xml.writeStartElement("graph");
+    xml.writeAttribute("id", "G");
+    xml.writeAttribute("edgedefault", "undirected");
+
+    for (int i=0; i<doc.nbVertices(); i++)
+    {
+        xml.writeStartElement("node");
+        xml.writeAttribute("id", QString("n%1").arg(i));
+        xml.writeTextElement("data", QString::number(doc.positions[i].x(), 'g', 17));
+        xml.writeTextElement("data", QString::number(doc.positions[i].y(), 'g', 17));
+        xml.writeTextElement("data", QColor(doc.colors.value(i)).name());
+        xml.writeEndElement();
+    }
+    for (int i=0; i<doc.nbEdges(); i++)
+    {
+        xml.writeStartElement("edge");
+        xml.writeAttribute("source", QString("n%1").arg(doc.edgeVertices[2*i]));
+        xml.writeAttribute("target", QString("n%1").arg(doc.edgeVertices[2*i+1]));
+        xml.writeTextElement("data", QString::number(doc.edgeWeights[i], 'g', 17));
+        xml.writeEndElement();
+    }
+
+    xml.writeEndElement(); // graph
+    xml.writeEndElement(); // graphml
+    xml.writeEndDocument();
+
+    return !xml.hasError();
+}
+
+//******************************************************************************
+/*!
+ * \brief SetupGraph method fills algorithm graph from the document
+ * \param doc
+ * \param graph
+ * \return false if graph is empty or has negative weights
+ *
+ * Document edges are undirected, the graph is undirected and stores each of them once.
+ */
+bool SetupGraph(const GraphDocument & doc, Graph * graph)
+{
+    if (!graph)
+        return false;
+
+    // the visual graph is undirected, each drawn edge is stored once
+    *graph = Graph(false);
+    graph->vertices.resize(doc.nbVertices());
+    for (int i=0;i<graph->vertices.size();i++)
+    {
+        graph->vertices[i].id = i;
+    }
+
+    QVector<GT::Edge> edges(doc.nbEdges());
+    for (int i=0; i<doc.nbEdges(); i++)
+    {
+        int vertexIndex1 = doc.edgeVertices[2*i];
+        int vertexIndex2 = doc.edgeVertices[2*i+1];
+        double weight = doc.edgeWeights[i];
+
+        if (weight < 0)
+        {
+            std::cerr << "Weights should not negative for undirected graphs" << std::endl;
+            return false;
+        }
+
+        edges[i].a = &graph->vertices[vertexIndex1];
+        edges[i].b = &graph->vertices[vertexIndex2];
+        edges[i].weight = weight;
+    }
+
+    graph->setEdges(edges);
+
+    if (graph->vertices.isEmpty())
+        return false;
+
+    return true;
+}
+
+//******************************************************************************
+
+}
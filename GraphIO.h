@@ -0,0 +1,72 @@
+#ifndef GRAPHIO_H
+#define GRAPHIO_H
+
+// Qt
+#include <QVector>
+#include <QList>
+#include <QPointF>
+#include <QColor>
+
+class QIODevice;
+
+//******************************************************************************
+
+namespace GT {
+
+struct Graph;
+
+//******************************************************************************
+/*!
+ * \brief GraphDocument struct is a plain snapshot of the drawn graph and of the last algorithm results.
+ *
+ * Vertex i is positioned at positions[i] and drawn with colors[i].
+ * Edge j connects edgeVertices[2*j] and edgeVertices[2*j+1] with weight edgeWeights[j].
+ */
+struct GraphDocument
+{
+    GraphDocument() :
+        startVertexId(-1),
+        endVertexId(-1),
+        distance(-1.0)
+    {
+    }
+
+    int nbVertices() const
+    { return positions.size(); }
+    int nbEdges() const
+    { return edgeWeights.size(); }
+
+    QVector<QPointF> positions;
+    QVector<QRgb> colors;
+    QVector<int> edgeVertices;
+    QVector<double> edgeWeights;
+
+    // Last shortest path result
+    int startVertexId;
+    int endVertexId;
+    double distance;
+    QList<int> path;
+};
+
+//******************************************************************************
+
+static const quint32 GRAPH_FILE_MAGIC = 0x46434747; // "GGCF"
+static const quint16 GRAPH_FILE_VERSION = 1;
+
+bool WriteGraphDocument(QIODevice * device, const GraphDocument & doc);
+
+bool ReadGraphDocument(QIODevice * device, GraphDocument * doc);
+
+bool ExportGraphJson(QIODevice * device, const GraphDocument & doc);
+
+bool ExportGraphML(QIODevice * device, const GraphDocument & doc);
+
+bool SetupGraph(const GraphDocument & doc, Graph * graph);
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHIO_H
@@ -0,0 +1,547 @@
+
+// STD
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+// Qt
+#include <QtAlgorithms>
+
+// Project
+#include "GraphKShortestPaths.h"
+#include "GraphTools.h"
+#include "GraphThreadPool.h"
+#include "GraphScheduler.h"
+#include "GraphProfiler.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+typedef std::pair<double, int> HeapEntry;
+typedef std::vector<HeapEntry> MinHeap;
+
+inline void PushHeap(MinHeap & heap, double key, int value)
+{
+    heap.push_back(HeapEntry(key, value));
+    std::push_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+}
+
+inline HeapEntry PopHeap(MinHeap & heap)
+{
+    std::pop_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+    HeapEntry top = heap.back();
+    heap.pop_back();
+    return top;
+}
+
+//******************************************************************************
+/*!
+ * \brief ArcList struct is a CSR adjacency with one arc per ordered vertex pair, of the smallest weight
+ */
+struct ArcList
+{
+    struct Arc
+    {
+        int tail;
+        int head;
+        double weight;
+        bool operator<(const Arc & other) const
+        {
+            return tail < other.tail || (tail == other.tail &&
+                   (head < other.head || (head == other.head && weight < other.weight)));
+        }
+    };
+
+    void build(int n, std::vector<Arc> & arcs)
+    {
+        std::sort(arcs.begin(), arcs.end());
+        offsets.fill(0, n+1);
+        targets.clear();
+        weights.clear();
+        for (size_t i=0; i<arcs.size(); i++)
+        {
+            if (i > 0 && arcs[i].tail == arcs[i-1].tail && arcs[i].head == arcs[i-1].head)
+                continue;
+            offsets[arcs[i].tail + 1]++;
+            targets << arcs[i].head;
+            weights << arcs[i].weight;
+        }
+        for (int v=0; v<n; v++)
+            offsets[v+1] += offsets[v];
+    }
+
+    QVector<int> offsets;
+    QVector<int> targets;
+    QVector<double> weights;
+};
+
+//******************************************************************************
+/*!
+ * \brief CandidatePath struct is a path of Yen's algorithm, accepted or candidate
+ */
+struct CandidatePath
+{
+    CandidatePath() :
+        distance(0.0),
+        deviation(0)
+    {
+    }
+    bool operator<(const CandidatePath & other) const
+    { return distance < other.distance || (distance == other.distance && vertices < other.vertices); }
+
+    double distance;
+    std::vector<int> vertices;
+    std::vector<double> prefix; //!< distance from the start to each vertex
+    int deviation; //!< index of the spur vertex the path was found from, earlier spurs were searched by its parent (Lawler)
+};
+
+//******************************************************************************
+/*!
+ * \brief SpurSearch class finds the shortest spur path of Yen's algorithm, one instance per worker
+ *
+ * The root vertices before the spur vertex are blocked, as are the first hops taken by the
+ * accepted paths sharing the root. The distances to the end vertex in the whole graph
+ * (reverse shortest path tree) are lower bounds once vertices and arcs are removed, an A*
+ * search uses them as its consistent heuristic and skips the vertices that can not reach the
+ * end at all. The search stops at the first settled vertex whose tree path avoids the removed
+ * vertices and arcs : that path is available and reaches the bound, the spur path follows it.
+ * When the spur vertex itself is clean no arc is scanned.
+ * Marks are stamped with a round number, nothing is cleared between spurs.
+ */
+class SpurSearch
+{
+public:
+    SpurSearch(const ArcList & arcs, const QVector<double> & toEnd, const QVector<int> & successors, int end) :
+        _arcs(arcs),
+        _toEnd(toEnd),
+        _successors(successors),
+        _end(end),
+        _round(0),
+        _blocked(toEnd.size(), 0),
+        _reached(toEnd.size(), 0),
+        _settled(toEnd.size(), 0),
+        _distances(toEnd.size(), 0.0),
+        _parents(toEnd.size(), -1),
+        _checked(toEnd.size(), 0),
+        _clean(toEnd.size(), false)
+    {
+    }
+
+    bool run(const CandidatePath & path, int spurIndex, const std::vector<int> & excluded,
+             CandidatePath * candidate, KShortestPathStatistics * statistics)
+    {
+        _round++;
+        for (int i=0; i<spurIndex; i++)
+            _blocked[path.vertices[i]] = _round;
+        int spur = path.vertices[spurIndex];
+        double rootDistance = path.prefix[spurIndex];
+        statistics->nbSpurPaths++;
+
+        candidate->vertices.assign(path.vertices.begin(), path.vertices.begin() + spurIndex);
+        candidate->prefix.assign(path.prefix.begin(), path.prefix.begin() + spurIndex);
+        candidate->deviation = spurIndex;
+
+        // the tree path of the spur vertex is cut if its first hop is removed
+        if (std::find(excluded.begin(), excluded.end(), _successors[spur]) != excluded.end())
+        {
+            _checked[spur] = _round;
+            _clean[spur] = false;
+        }
+
+        // A* search, stopped at the first settled vertex whose tree path is clean
+        _heap.clear();
+        _reached[spur] = _round;
+        _distances[spur] = 0.0;
+        _parents[spur] = -1;
+        PushHeap(_heap, _toEnd[spur], spur);
+        int meet = -1;
+        while (!_heap.empty())
+        {
+            int v = PopHeap(_heap).second;
+            if (_settled[v] == _round)
+                continue;
+            _settled[v] = _round;
+            statistics->nbSettled++;
+            if (isClean(v))
+            {
+                meet = v;
+                break;
+            }
+            for (int a=_arcs.offsets[v]; a<_arcs.offsets[v+1]; a++)
+            {
+                int t = _arcs.targets[a];
+                if (_blocked[t] == _round || _settled[t] == _round || _toEnd[t] == std::numeric_limits<double>::max())
+                    continue;
+                if (v == spur && std::find(excluded.begin(), excluded.end(), t) != excluded.end())
+                    continue;
+                double distance = _distances[v] + _arcs.weights[a];
+                if (_reached[t] != _round || distance < _distances[t])
+                {
+                    _reached[t] = _round;
+                    _distances[t] = distance;
+                    _parents[t] = v;
+                    PushHeap(_heap, distance + _toEnd[t], t);
+                }
+            }
+        }
+        if (meet < 0)
+            return false;
+        if (meet == spur)
+            statistics->nbTreeSpurPaths++;
+
+        size_t rootSize = candidate->vertices.size();
+        for (int v=meet; v >= 0; v=_parents[v])
+        {
+            candidate->vertices.push_back(v);
+            candidate->prefix.push_back(rootDistance + _distances[v]);
+        }
+        std::reverse(candidate->vertices.begin() + rootSize, candidate->vertices.end());
+        std::reverse(candidate->prefix.begin() + rootSize, candidate->prefix.end());
+        double meetDistance = rootDistance + _distances[meet] + _toEnd[meet];
+        for (int v=meet; v != _end; )
+        {
+            v = _successors[v];
+            candidate->vertices.push_back(v);
+            candidate->prefix.push_back(meetDistance - _toEnd[v]);
+        }
+        candidate->distance = candidate->prefix.back();
+        return true;
+    }
+
+private:
+    //! true if the tree path from v reaches the end without a blocked vertex, memoized along the path
+    bool isClean(int v)
+    {
+        _path.clear();
+        bool clean = true;
+        for (; ; v=_successors[v])
+        {
+            if (_checked[v] == _round)
+            {
+                clean = _clean[v];
+                break;
+            }
+            if (_blocked[v] == _round)
+            {
+                clean = false;
+                break;
+            }
+            if (v == _end)
+                break;
+            _path.push_back(v);
+        }
+        for (size_t i=0; i<_path.size(); i++)
+        {
+            _checked[_path[i]] = _round;
+            _clean[_path[i]] = clean;
+        }
+        return clean;
+    }
+
+    const ArcList & _arcs;
+    const QVector<double> & _toEnd;
+    const QVector<int> & _successors;
+    int _end;
+    int _round;
+    QVector<int> _blocked;
+    QVector<int> _reached;
+    QVector<int> _settled;
+    QVector<double> _distances;
+    QVector<int> _parents;
+    QVector<int> _checked;
+    QVector<bool> _clean; //!< tree path state of the vertices checked this round
+    std::vector<int> _path;
+    MinHeap _heap;
+
+    Q_DISABLE_COPY(SpurSearch)
+};
+
+//******************************************************************************
+/*!
+ * \brief YenPaths method is Yen's algorithm with Lawler's rule : only the spur vertices from the deviation of the last path are searched
+ */
+void YenPaths(const ArcList & arcs, const QVector<double> & toEnd, const QVector<int> & successors,
+              int start, int end, int k, ThreadPool & workers, std::vector<CandidatePath> * accepted,
+              KShortestPathStatistics * statistics)
+{
+    CandidatePath first;
+    for (int v=start; ; v=successors[v])
+    {
+        first.vertices.push_back(v);
+        first.prefix.push_back(toEnd[start] - toEnd[v]);
+        if (v == end)
+            break;
+    }
+    first.distance = toEnd[start];
+    accepted->push_back(first);
+
+    int nbWorkers = workers.nbThreads();
+    QVector<SpurSearch*> searches;
+    for (int worker=0; worker<nbWorkers; worker++)
+        searches << new SpurSearch(arcs, toEnd, successors, end);
+    WorkerLocal<KShortestPathStatistics> counts(workers);
+
+    std::set<CandidatePath> candidates;
+    std::set< std::vector<int> > known;
+    known.insert(first.vertices);
+    while (int(accepted->size()) < k)
+    {
+        const CandidatePath & last = accepted->back();
+        int nbSpurs = int(last.vertices.size()) - 1 - last.deviation;
+        WorkerLocal< std::vector<CandidatePath> > found(workers);
+        ParallelFor(workers, nbSpurs, [&](int begin, int finish, int worker)
+        {
+            std::vector<int> excluded;
+            for (int i=begin; i<finish; i++)
+            {
+                int spurIndex = last.deviation + i;
+                excluded.clear();
+                for (size_t p=0; p<accepted->size(); p++)
+                {
+                    const std::vector<int> & vertices = (*accepted)[p].vertices;
+                    if (int(vertices.size()) > spurIndex + 1
+                            && std::equal(vertices.begin(), vertices.begin() + spurIndex + 1, last.vertices.begin()))
+                        excluded.push_back(vertices[spurIndex + 1]);
+                }
+                CandidatePath candidate;
+                if (searches[worker]->run(last, spurIndex, excluded, &candidate, &counts[worker]))
+                    found[worker].push_back(candidate);
+            }
+        }, 1);
+
+        for (int worker=0; worker<nbWorkers; worker++)
+        {
+            for (size_t i=0; i<found[worker].size(); i++)
+            {
+                if (known.insert(found[worker][i].vertices).second)
+                    candidates.insert(found[worker][i]);
+            }
+        }
+        if (candidates.empty())
+            break;
+        accepted->push_back(*candidates.begin());
+        candidates.erase(candidates.begin());
+    }
+    qDeleteAll(searches);
+
+    for (int worker=0; worker<nbWorkers; worker++)
+    {
+        statistics->nbSpurPaths += counts[worker].nbSpurPaths;
+        statistics->nbTreeSpurPaths += counts[worker].nbTreeSpurPaths;
+        statistics->nbSettled += counts[worker].nbSettled;
+    }
+}
+
+//******************************************************************************
+/*!
+ * \brief Sidetrack struct is an arc out of the shortest path tree, delta is its extra distance
+ */
+struct Sidetrack
+{
+    double delta; //!< weight + toEnd[head] - toEnd[tail]
+    int tail;
+    int head;
+    bool operator<(const Sidetrack & other) const
+    { return delta < other.delta || (delta == other.delta && (tail < other.tail || (tail == other.tail && head < other.head))); }
+};
+
+//******************************************************************************
+/*!
+ * \brief WalkNode struct is a path of the walk enumeration : its parent path followed by one more sidetrack
+ */
+struct WalkNode
+{
+    double distance;
+    int parent; //!< -1 for the shortest path
+    int position; //!< of the sidetrack in the list of the parent head
+    int head; //!< vertex reached by the last sidetrack, the start for the shortest path
+};
+
+//******************************************************************************
+/*!
+ * \brief EppsteinWalks method enumerates the walks by their sidetrack sequences, best first
+ *
+ * A walk is the tree path from the start with sidetracks taken on the way, its distance is
+ * toEnd[start] plus the sidetrack deltas. The sidetracks available after reaching x are the
+ * ones out of the tree path from x, sorted by delta. A popped walk pushes its first child
+ * (one more sidetrack, the smallest) and its next sibling (its last sidetrack replaced by the
+ * next one in the parent list) : each walk is generated once, after its parent. Eppstein
+ * shares the sorted lists in persistent heaps, here they are built when a head is first
+ * reached, enough for the k of the user interface.
+ */
+void EppsteinWalks(const ArcList & arcs, const QVector<double> & toEnd, const QVector<int> & successors,
+                   int start, int end, int k, QList<WeightedPath> * paths)
+{
+    std::map<int, std::vector<Sidetrack> > lists;
+    std::vector<WalkNode> nodes;
+    MinHeap heap;
+    WalkNode root = { toEnd[start], -1, -1, start };
+    nodes.push_back(root);
+    PushHeap(heap, root.distance, 0);
+
+    while (!heap.empty() && paths->size() < k)
+    {
+        int index = PopHeap(heap).second;
+        WalkNode node = nodes[index];
+
+        // sidetracks of the walk, from the start
+        std::vector<Sidetrack> sequence;
+        for (int n=index; nodes[n].parent >= 0; n=nodes[n].parent)
+            sequence.push_back(lists[nodes[nodes[n].parent].head][nodes[n].position]);
+        WeightedPath path;
+        path.distance = node.distance;
+        int v = start;
+        for (int i=int(sequence.size())-1; i>=0; i--)
+        {
+            for (; v != sequence[i].tail; v=successors[v])
+                path.vertices << v;
+            path.vertices << v;
+            v = sequence[i].head;
+        }
+        for (; v != end; v=successors[v])
+            path.vertices << v;
+        path.vertices << end;
+        *paths << path;
+
+        std::map<int, std::vector<Sidetrack> >::iterator it = lists.find(node.head);
+        if (it == lists.end())
+        {
+            std::vector<Sidetrack> & list = lists[node.head];
+            for (int u=node.head; ; u=successors[u])
+            {
+                for (int a=arcs.offsets[u]; a<arcs.offsets[u+1]; a++)
+                {
+                    int t = arcs.targets[a];
+                    if (t == successors[u] || toEnd[t] == std::numeric_limits<double>::max())
+                        continue;
+                    Sidetrack sidetrack = { qMax(0.0, arcs.weights[a] + toEnd[t] - toEnd[u]), u, t };
+                    list.push_back(sidetrack);
+                }
+                if (u == end)
+                    break;
+            }
+            std::sort(list.begin(), list.end());
+            it = lists.find(node.head);
+        }
+        if (!it->second.empty())
+        {
+            WalkNode child = { node.distance + it->second[0].delta, index, 0, it->second[0].head };
+            nodes.push_back(child);
+            PushHeap(heap, child.distance, int(nodes.size()) - 1);
+        }
+        if (node.parent >= 0)
+        {
+            const WalkNode & parent = nodes[node.parent];
+            const std::vector<Sidetrack> & siblings = lists[parent.head];
+            int position = node.position + 1;
+            if (position < int(siblings.size()))
+            {
+                WalkNode sibling = { parent.distance + siblings[position].delta, node.parent, position, siblings[position].head };
+                nodes.push_back(sibling);
+                PushHeap(heap, sibling.distance, int(nodes.size()) - 1);
+            }
+        }
+    }
+}
+
+//******************************************************************************
+
+bool ComputeKShortestPaths(const Graph & graph, int startIndex, int endIndex, int k, QList<WeightedPath> * paths,
+                           KShortestPathMode mode, ThreadPool * pool, KShortestPathStatistics * statistics)
+{
+    GT_PROFILE_SCOPE("ComputeKShortestPaths");
+    if (!paths)
+        return false;
+    paths->clear();
+    int n = graph.vertices.size();
+    if (startIndex < 0 || startIndex >= n || endIndex < 0 || endIndex >= n)
+        return false;
+
+    std::vector<ArcList::Arc> forward, reverse;
+    const QVector<Edge> & edges = graph.getEdges();
+    for (int i=0; i<edges.size(); i++)
+    {
+        double weight = edges[i].weight;
+        if (!(weight >= 0.0))
+        {
+            std::cerr << "ComputeKShortestPaths : negative weights are not supported" << std::endl;
+            return false;
+        }
+        ArcList::Arc arc = { edges[i].a->id, edges[i].b->id, weight };
+        ArcList::Arc back = { arc.head, arc.tail, weight };
+        forward.push_back(arc);
+        reverse.push_back(back);
+        if (!graph.isDirected())
+        {
+            forward.push_back(back);
+            reverse.push_back(arc);
+        }
+    }
+    ArcList arcs, reverseArcs;
+    arcs.build(n, forward);
+    reverseArcs.build(n, reverse);
+
+    // reverse shortest path tree : distance to the end vertex and next vertex towards it
+    QVector<double> toEnd(n, std::numeric_limits<double>::max());
+    QVector<int> successors(n, -1);
+    {
+        QVector<char> settled(n, 0);
+        MinHeap heap;
+        toEnd[endIndex] = 0.0;
+        PushHeap(heap, 0.0, endIndex);
+        while (!heap.empty())
+        {
+            int v = PopHeap(heap).second;
+            if (settled[v])
+                continue;
+            settled[v] = 1;
+            for (int a=reverseArcs.offsets[v]; a<reverseArcs.offsets[v+1]; a++)
+            {
+                int u = reverseArcs.targets[a];
+                double distance = toEnd[v] + reverseArcs.weights[a];
+                if (!settled[u] && distance < toEnd[u])
+                {
+                    toEnd[u] = distance;
+                    successors[u] = v;
+                    PushHeap(heap, distance, u);
+                }
+            }
+        }
+    }
+    if (k <= 0 || toEnd[startIndex] == std::numeric_limits<double>::max())
+        return true;
+
+    if (mode == K_SHORTEST_WALKS)
+    {
+        EppsteinWalks(arcs, toEnd, successors, startIndex, endIndex, k, paths);
+        return true;
+    }
+
+    ThreadPool & workers = pool ? *pool : ThreadPool::instance();
+    std::vector<CandidatePath> accepted;
+    KShortestPathStatistics counts;
+    YenPaths(arcs, toEnd, successors, startIndex, endIndex, k, workers, &accepted, &counts);
+    if (statistics)
+        *statistics = counts;
+    for (size_t i=0; i<accepted.size(); i++)
+    {
+        WeightedPath path;
+        path.distance = accepted[i].distance;
+        for (size_t j=0; j<accepted[i].vertices.size(); j++)
+            path.vertices << accepted[i].vertices[j];
+        *paths << path;
+    }
+    return true;
+}
+
+//******************************************************************************
+
+}
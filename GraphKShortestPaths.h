@@ -0,0 +1,75 @@
+#ifndef GRAPHKSHORTESTPATHS_H
+#define GRAPHKSHORTESTPATHS_H
+
+// Qt
+#include <QList>
+
+//******************************************************************************
+
+namespace GT {
+
+struct Graph;
+class ThreadPool;
+
+//******************************************************************************
+/*!
+ * K_SHORTEST_SIMPLE : loopless paths, Yen's algorithm, the spur searches of a path run in parallel
+ * K_SHORTEST_WALKS : paths may repeat vertices, enumerated from the sidetracks of the shortest path tree (Eppstein)
+ */
+enum KShortestPathMode
+{
+    K_SHORTEST_SIMPLE=0,
+    K_SHORTEST_WALKS
+};
+
+//******************************************************************************
+
+struct WeightedPath
+{
+    WeightedPath() :
+        distance(0.0)
+    {
+    }
+
+    double distance;
+    QList<int> vertices; //!< from the start vertex to the end vertex
+};
+
+//******************************************************************************
+/*!
+ * \brief KShortestPathStatistics struct counts the spur paths of Yen's algorithm
+ */
+struct KShortestPathStatistics
+{
+    KShortestPathStatistics() :
+        nbSpurPaths(0),
+        nbTreeSpurPaths(0),
+        nbSettled(0)
+    {
+    }
+
+    int nbSpurPaths; //!< spur vertices examined
+    int nbTreeSpurPaths; //!< spur paths read from the reverse shortest path tree, without search
+    qint64 nbSettled; //!< vertices settled by the spur searches
+};
+
+//******************************************************************************
+/*!
+ * \brief ComputeKShortestPaths method computes up to k shortest paths from startIndex to endIndex, by non decreasing distance
+ *
+ * Parallel edges count as one edge of their smallest weight, paths are vertex lists. Fewer
+ * than k paths are returned when fewer exist.
+ * \param pool spur searches run on its workers, ThreadPool::instance() if 0
+ * \return false on negative weights or invalid vertex indices
+ */
+bool ComputeKShortestPaths(const Graph & graph, int startIndex, int endIndex, int k, QList<WeightedPath> * paths,
+                           KShortestPathMode mode=K_SHORTEST_SIMPLE, ThreadPool * pool=0,
+                           KShortestPathStatistics * statistics=0);
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHKSHORTESTPATHS_H
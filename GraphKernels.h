@@ -0,0 +1,307 @@
+#ifndef GRAPHKERNELS_H
+#define GRAPHKERNELS_H
+
+// STD
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// Qt
+#include <QVector>
+
+// Project
+#include "GraphWeighted.h"
+#include "GraphProfiler.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+/*
+ * Traversal kernels over any adjacency storage providing nbVertices() and
+ * neighbors(v) returning an iterator with atEnd(), next(), target(), weight() :
+ * CsrGraph, CompressedGraph, WeightedCsrGraph and BitMatrixGraph.
+ * Shortest path kernels also need the Weight typedef, and maxWeight() for integer weights.
+ */
+
+//******************************************************************************
+/*!
+ * \brief GreedyColoringKernel method is GreedyGraphColoring on an adjacency storage
+ * \return number of colors, colors are the ones GreedyGraphColoring gives
+ */
+template<class Adjacency>
+int GreedyColoringKernel(const Adjacency & adjacency, QVector<int> * colors)
+{
+    int n = adjacency.nbVertices();
+    colors->fill(-1, n);
+    int color = 0;
+    bool colored = true;
+    while (colored)
+    {
+        colored = false;
+        for (int v=0; v<n; v++)
+        {
+            if ((*colors)[v] >= 0)
+                continue;
+            bool sameColorVertexFound = false;
+            for (typename Adjacency::NeighborIterator it = adjacency.neighbors(v); !it.atEnd(); it.next())
+            {
+                if ((*colors)[it.target()] == color)
+                {
+                    sameColorVertexFound = true;
+                    break;
+                }
+            }
+            if (!sameColorVertexFound)
+            {
+                (*colors)[v] = color;
+                colored = true;
+            }
+        }
+        if (colored)
+            color++;
+    }
+    return color;
+}
+
+//******************************************************************************
+/*!
+ * \brief BreadthFirstKernel method computes the hop count of each vertex from root, -1 if not reached
+ * \return number of reached vertices
+ */
+template<class Adjacency>
+int BreadthFirstKernel(const Adjacency & adjacency, int root, QVector<int> * levels)
+{
+    levels->fill(-1, adjacency.nbVertices());
+    QVector<int> queue;
+    queue.reserve(adjacency.nbVertices());
+    queue << root;
+    (*levels)[root] = 0;
+    for (int head=0; head<queue.size(); head++)
+    {
+        int v = queue[head];
+        for (typename Adjacency::NeighborIterator it = adjacency.neighbors(v); !it.atEnd(); it.next())
+        {
+            int t = it.target();
+            if ((*levels)[t] < 0)
+            {
+                (*levels)[t] = (*levels)[v] + 1;
+                queue << t;
+            }
+        }
+    }
+    return queue.size();
+}
+
+//******************************************************************************
+/*!
+ * \brief ConnectedComponentsKernel method labels the components by depth-first search, in vertex order
+ * \return number of components, labels are the colors ColorConnectedVertices gives
+ */
+template<class Adjacency>
+int ConnectedComponentsKernel(const Adjacency & adjacency, QVector<int> * labels)
+{
+    int n = adjacency.nbVertices();
+    labels->fill(-1, n);
+    QVector<int> stack;
+    int label = 0;
+    for (int root=0; root<n; root++)
+    {
+        if ((*labels)[root] >= 0)
+            continue;
+        stack << root;
+        while (!stack.isEmpty())
+        {
+            int v = stack.last();
+            stack.pop_back();
+            if ((*labels)[v] >= 0)
+                continue;
+            (*labels)[v] = label;
+            for (typename Adjacency::NeighborIterator it = adjacency.neighbors(v); !it.atEnd(); it.next())
+            {
+                if ((*labels)[it.target()] < 0)
+                    stack << it.target();
+            }
+        }
+        label++;
+    }
+    return label;
+}
+
+//******************************************************************************
+
+static const int BUCKET_QUEUE_MAX_WEIGHT = 1 << 16; //!< larger integer weights are searched with the binary heap
+
+/*!
+ * \brief HeapShortestPathKernel method is Dijkstra with a binary heap, weights must not be negative
+ * \param target the search stops once target is settled, -1 to settle all reachable vertices
+ * \param predecessors may be 0
+ * \return number of settled vertices
+ *
+ * Distances of the vertices not settled are upper bounds, or infinity() if not reached.
+ * With GT_PROFILING the relaxations are added to PC_EDGES_RELAXED once per search.
+ */
+template<class Adjacency>
+int HeapShortestPathKernel(const Adjacency & adjacency, int source, int target,
+                           QVector<typename WeightTraits<typename Adjacency::Weight>::Distance> * distances,
+                           QVector<int> * predecessors)
+{
+    typedef WeightTraits<typename Adjacency::Weight> Traits;
+    typedef typename Traits::Distance Distance;
+    typedef std::pair<Distance, int> HeapEntry;
+
+    distances->fill(Traits::infinity(), adjacency.nbVertices());
+    if (predecessors)
+        predecessors->fill(-1, adjacency.nbVertices());
+    Distance * dist = distances->data();
+
+    std::vector<HeapEntry> heap;
+    heap.push_back(HeapEntry(Distance(0), source));
+    dist[source] = 0;
+    int nbSettled = 0;
+    qint64 nbRelaxed = 0;
+    while (!heap.empty())
+    {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+        HeapEntry top = heap.back();
+        heap.pop_back();
+        int v = top.second;
+        if (top.first != dist[v])
+            continue; // a shorter distance was found after this entry was pushed
+        nbSettled++;
+        if (v == target)
+            break;
+        for (typename Adjacency::NeighborIterator it = adjacency.neighbors(v); !it.atEnd(); it.next())
+        {
+            Distance d = top.first + Distance(it.weight());
+            int t = it.target();
+            if (d < dist[t])
+            {
+                dist[t] = d;
+                nbRelaxed++;
+                if (predecessors)
+                    (*predecessors)[t] = v;
+                heap.push_back(HeapEntry(d, t));
+                std::push_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+            }
+        }
+    }
+    GT_PROFILE_COUNT(PC_EDGES_RELAXED, nbRelaxed);
+    Q_UNUSED(nbRelaxed);
+    return nbSettled;
+}
+
+//******************************************************************************
+/*!
+ * \brief BucketShortestPathKernel method is Dijkstra with a bucket queue (Dial), for integer weights
+ *
+ * Queued distances are in [d, d + maxWeight] when distance d is settled, so maxWeight + 1
+ * buckets used circularly hold them all : a push and a pop are O(1), the vertices of a bucket
+ * are settled in push order. Same parameters and results as HeapShortestPathKernel.
+ */
+template<class Adjacency>
+int BucketShortestPathKernel(const Adjacency & adjacency, int source, int target,
+                             QVector<typename WeightTraits<typename Adjacency::Weight>::Distance> * distances,
+                             QVector<int> * predecessors)
+{
+    typedef WeightTraits<typename Adjacency::Weight> Traits;
+    typedef typename Traits::Distance Distance;
+
+    distances->fill(Traits::infinity(), adjacency.nbVertices());
+    if (predecessors)
+        predecessors->fill(-1, adjacency.nbVertices());
+    Distance * dist = distances->data();
+
+    int nbBuckets = int(adjacency.maxWeight()) + 1;
+    std::vector<std::vector<int> > buckets(nbBuckets);
+    buckets[0].push_back(source);
+    dist[source] = 0;
+    qint64 nbQueued = 1;
+    int nbSettled = 0;
+    qint64 nbRelaxed = 0;
+    for (Distance d = 0; nbQueued > 0; d++)
+    {
+        // zero weight edges push to the bucket being read, its size is read at each step
+        std::vector<int> & bucket = buckets[d % nbBuckets];
+        for (size_t i=0; i<bucket.size(); i++)
+        {
+            int v = bucket[i];
+            nbQueued--;
+            if (dist[v] != d)
+                continue;
+            nbSettled++;
+            if (v == target)
+            {
+                GT_PROFILE_COUNT(PC_EDGES_RELAXED, nbRelaxed);
+                return nbSettled;
+            }
+            for (typename Adjacency::NeighborIterator it = adjacency.neighbors(v); !it.atEnd(); it.next())
+            {
+                Distance dt = d + Distance(it.weight());
+                int t = it.target();
+                if (dt < dist[t])
+                {
+                    dist[t] = dt;
+                    nbRelaxed++;
+                    if (predecessors)
+                        (*predecessors)[t] = v;
+                    buckets[dt % nbBuckets].push_back(t);
+                    nbQueued++;
+                }
+            }
+        }
+        bucket.clear();
+    }
+    GT_PROFILE_COUNT(PC_EDGES_RELAXED, nbRelaxed);
+    Q_UNUSED(nbRelaxed);
+    return nbSettled;
+}
+
+//******************************************************************************
+/*!
+ * \brief ShortestPathSearch struct selects the shortest path kernel from the weight type at compile time
+ */
+template<class Adjacency, bool isInteger=WeightTraits<typename Adjacency::Weight>::isInteger>
+struct ShortestPathSearch
+{
+    static int run(const Adjacency & adjacency, int source, int target,
+                   QVector<typename WeightTraits<typename Adjacency::Weight>::Distance> * distances,
+                   QVector<int> * predecessors)
+    { return HeapShortestPathKernel(adjacency, source, target, distances, predecessors); }
+};
+
+template<class Adjacency>
+struct ShortestPathSearch<Adjacency, true>
+{
+    static int run(const Adjacency & adjacency, int source, int target,
+                   QVector<typename WeightTraits<typename Adjacency::Weight>::Distance> * distances,
+                   QVector<int> * predecessors)
+    {
+        if (qint64(adjacency.maxWeight()) <= BUCKET_QUEUE_MAX_WEIGHT)
+            return BucketShortestPathKernel(adjacency, source, target, distances, predecessors);
+        return HeapShortestPathKernel(adjacency, source, target, distances, predecessors);
+    }
+};
+
+//******************************************************************************
+/*!
+ * \brief ShortestPathKernel method computes the distances from source, integer weights use the bucket queue
+ * \return number of settled vertices
+ */
+template<class Adjacency>
+int ShortestPathKernel(const Adjacency & adjacency, int source, int target,
+                       QVector<typename WeightTraits<typename Adjacency::Weight>::Distance> * distances,
+                       QVector<int> * predecessors=0)
+{
+    return ShortestPathSearch<Adjacency>::run(adjacency, source, target, distances, predecessors);
+}
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHKERNELS_H
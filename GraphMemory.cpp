@@ -0,0 +1,75 @@
+
+// STD
+#include <cstdlib>
+
+// Qt
+#include <QtGlobal>
+
+// System
+#ifdef Q_OS_LINUX
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Project
+#include "GraphMemory.h"
+#include "GraphThreadPool.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+#ifdef Q_OS_LINUX
+// from linux/mempolicy.h, libnuma is not required
+static const int GT_MPOL_INTERLEAVE = 3;
+#endif
+
+//******************************************************************************
+/*!
+ * \brief AllocateNumaMemory method allocates page-aligned memory without touching it
+ * \return 0 on failure
+ *
+ * Interleaving uses the mbind system call and is silently skipped if it fails
+ * (single node machine, kernel without NUMA support).
+ */
+void * AllocateNumaMemory(size_t bytes, NumaPlacement placement)
+{
+#ifdef Q_OS_LINUX
+    void * data = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED)
+        return 0;
+
+    if (placement == NUMA_INTERLEAVED)
+    {
+        static const int nbNodes = NumaTopology::detect().nbNodes();
+        if (nbNodes > 1)
+        {
+            unsigned long nodeMask = nbNodes >= 64 ? ~0UL : (1UL << nbNodes) - 1;
+            syscall(SYS_mbind, data, bytes, GT_MPOL_INTERLEAVE, &nodeMask, 8 * sizeof(nodeMask) + 1, 0);
+        }
+    }
+    return data;
+#else
+    Q_UNUSED(placement)
+    return std::malloc(bytes);
+#endif
+}
+
+//******************************************************************************
+
+void FreeNumaMemory(void * data, size_t bytes)
+{
+#ifdef Q_OS_LINUX
+    munmap(data, bytes);
+#else
+    Q_UNUSED(bytes)
+    std::free(data);
+#endif
+}
+
+//******************************************************************************
+
+}
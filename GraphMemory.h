@@ -0,0 +1,98 @@
+#ifndef GRAPHMEMORY_H
+#define GRAPHMEMORY_H
+
+// STD
+#include <cstddef>
+
+// Qt
+#include <QtGlobal>
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+/*!
+ * NUMA_DEFAULT : pages go to the node of the first thread writing them, arrays are initialized by the calling thread
+ * NUMA_FIRST_TOUCH : arrays are initialized in parallel by pinned workers, each page lands on the node of the worker using it
+ * NUMA_INTERLEAVED : pages are interleaved round-robin over all nodes
+ */
+enum NumaPlacement
+{
+    NUMA_DEFAULT=0,
+    NUMA_FIRST_TOUCH,
+    NUMA_INTERLEAVED
+};
+
+//******************************************************************************
+
+void * AllocateNumaMemory(size_t bytes, NumaPlacement placement);
+
+void FreeNumaMemory(void * data, size_t bytes);
+
+//******************************************************************************
+/*!
+ * \brief NumaArray class is a fixed size array of plain values in page-aligned memory
+ *
+ * Memory is not initialized : pages are placed by the first write (or interleaved),
+ * so the array should be initialized by the threads that will use it.
+ */
+template<class T>
+class NumaArray
+{
+public:
+    NumaArray() :
+        _data(0),
+        _size(0)
+    {
+    }
+    ~NumaArray()
+    { release(); }
+
+    bool allocate(int size, NumaPlacement placement=NUMA_DEFAULT)
+    {
+        release();
+        if (size <= 0)
+            return true;
+        _data = static_cast<T*>(AllocateNumaMemory(size * sizeof(T), placement));
+        _size = _data ? size : 0;
+        return _data != 0;
+    }
+    void release()
+    {
+        if (_data)
+            FreeNumaMemory(_data, _size * sizeof(T));
+        _data = 0;
+        _size = 0;
+    }
+    void swap(NumaArray & other)
+    {
+        qSwap(_data, other._data);
+        qSwap(_size, other._size);
+    }
+
+    int size() const
+    { return _size; }
+    T * data()
+    { return _data; }
+    const T * data() const
+    { return _data; }
+    T & operator[](int i)
+    { return _data[i]; }
+    const T & operator[](int i) const
+    { return _data[i]; }
+
+private:
+    T * _data;
+    int _size;
+
+    Q_DISABLE_COPY(NumaArray)
+};
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHMEMORY_H
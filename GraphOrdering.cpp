@@ -0,0 +1,545 @@
+
+// STD
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+// Qt
+
+// Project
+#include "GraphOrdering.h"
+#include "GraphProfiler.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+const char * VertexOrderingName(VertexOrdering ordering)
+{
+    switch (ordering)
+    {
+    case ORDER_ORIGINAL: return "original";
+    case ORDER_RCM: return "RCM";
+    case ORDER_HUB_SORT: return "hub sort";
+    case ORDER_RABBIT: return "Rabbit";
+    default: return "unknown";
+    }
+}
+
+//******************************************************************************
+/*!
+ * \brief VertexPermutation::setOrder method sets the permutation from the list of original ids in new order
+ */
+void VertexPermutation::setOrder(const QVector<int> & order)
+{
+    newToOld = order;
+    oldToNew.fill(-1, order.size());
+    for (int i=0; i<order.size(); i++)
+        oldToNew[order[i]] = i;
+}
+
+//******************************************************************************
+
+bool VertexPermutation::isValid() const
+{
+    if (newToOld.size() != oldToNew.size())
+        return false;
+    for (int i=0; i<newToOld.size(); i++)
+    {
+        int oldId = newToOld[i];
+        if (oldId < 0 || oldId >= oldToNew.size() || oldToNew[oldId] != i)
+            return false;
+    }
+    return true;
+}
+
+//******************************************************************************
+/*!
+ * \brief OrderingAdjacency struct is the undirected, duplicate free adjacency used by the orderings
+ */
+struct OrderingAdjacency
+{
+    int nbVertices() const
+    { return offsets.size() - 1; }
+    int degree(int v) const
+    { return offsets[v+1] - offsets[v]; }
+
+    QVector<int> offsets;
+    QVector<int> targets;
+};
+
+//******************************************************************************
+
+void BuildOrderingAdjacency(const Graph & graph, OrderingAdjacency * adjacency)
+{
+    int n = graph.vertices.size();
+    const QVector<Edge> & edges = graph.getEdges();
+
+    QVector<int> offsets(n+1, 0);
+    for (int i=0; i<edges.size(); i++)
+    {
+        if (edges[i].a->id == edges[i].b->id)
+            continue;
+        offsets[edges[i].a->id + 1]++;
+        offsets[edges[i].b->id + 1]++;
+    }
+    for (int v=0; v<n; v++)
+        offsets[v+1] += offsets[v];
+
+    QVector<int> targets(offsets[n]);
+    QVector<int> cursor = offsets;
+    for (int i=0; i<edges.size(); i++)
+    {
+        int a = edges[i].a->id;
+        int b = edges[i].b->id;
+        if (a == b)
+            continue;
+        targets[cursor[a]++] = b;
+        targets[cursor[b]++] = a;
+    }
+
+    // sort and remove duplicates, in place
+    adjacency->offsets.fill(0, n+1);
+    int count = 0;
+    for (int v=0; v<n; v++)
+    {
+        int * begin = targets.data() + offsets[v];
+        int * end = targets.data() + offsets[v+1];
+        std::sort(begin, end);
+        end = std::unique(begin, end);
+        for (int * t=begin; t<end; t++)
+            targets[count++] = *t;
+        adjacency->offsets[v+1] = count;
+    }
+    targets.resize(count);
+    adjacency->targets = targets;
+}
+
+//******************************************************************************
+/*!
+ * \brief RcmLevels method runs a breadth-first search, returns the last level
+ */
+int RcmLevels(const OrderingAdjacency & adjacency, int root, QVector<int> * distances, QVector<int> * lastLevel)
+{
+    distances->fill(-1, adjacency.nbVertices());
+    lastLevel->clear();
+    QVector<int> queue;
+    queue << root;
+    (*distances)[root] = 0;
+    int depth = 0;
+    for (int head=0; head<queue.size(); head++)
+    {
+        int v = queue[head];
+        for (int e=adjacency.offsets[v]; e<adjacency.offsets[v+1]; e++)
+        {
+            int t = adjacency.targets[e];
+            if ((*distances)[t] < 0)
+            {
+                (*distances)[t] = (*distances)[v] + 1;
+                queue << t;
+            }
+        }
+    }
+    depth = (*distances)[queue.last()];
+    foreach (int v, queue)
+    {
+        if ((*distances)[v] == depth)
+            *lastLevel << v;
+    }
+    return depth;
+}
+
+//******************************************************************************
+/*!
+ * \brief PseudoPeripheralVertex method finds a vertex of large eccentricity (George-Liu)
+ */
+int PseudoPeripheralVertex(const OrderingAdjacency & adjacency, int root)
+{
+    QVector<int> distances, lastLevel;
+    int eccentricity = RcmLevels(adjacency, root, &distances, &lastLevel);
+    for (int iteration=0; iteration<8; iteration++)
+    {
+        int candidate = lastLevel.first();
+        foreach (int v, lastLevel)
+        {
+            if (adjacency.degree(v) < adjacency.degree(candidate))
+                candidate = v;
+        }
+        int candidateEccentricity = RcmLevels(adjacency, candidate, &distances, &lastLevel);
+        if (candidateEccentricity <= eccentricity)
+            break;
+        root = candidate;
+        eccentricity = candidateEccentricity;
+    }
+    return root;
+}
+
+//******************************************************************************
+/*!
+ * \brief ReverseCuthillMcKee method orders each component breadth-first, neighbors by increasing degree
+ */
+QVector<int> ReverseCuthillMcKee(const OrderingAdjacency & adjacency)
+{
+    int n = adjacency.nbVertices();
+    QVector<int> order;
+    order.reserve(n);
+    QVector<bool> visited(n, false);
+
+    // components are started from their lowest degree vertex
+    QVector<int> byDegree(n);
+    for (int v=0; v<n; v++)
+        byDegree[v] = v;
+    std::stable_sort(byDegree.begin(), byDegree.end(), [&](int a, int b)
+    { return adjacency.degree(a) < adjacency.degree(b); });
+
+    QVector<int> neighbors;
+    foreach (int seed, byDegree)
+    {
+        if (visited[seed])
+            continue;
+        int root = PseudoPeripheralVertex(adjacency, seed);
+        int head = order.size();
+        order << root;
+        visited[root] = true;
+        for (; head<order.size(); head++)
+        {
+            int v = order[head];
+            neighbors.clear();
+            for (int e=adjacency.offsets[v]; e<adjacency.offsets[v+1]; e++)
+            {
+                int t = adjacency.targets[e];
+                if (!visited[t])
+                {
+                    visited[t] = true;
+                    neighbors << t;
+                }
+            }
+            std::stable_sort(neighbors.begin(), neighbors.end(), [&](int a, int b)
+            { return adjacency.degree(a) < adjacency.degree(b); });
+            order << neighbors;
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+//******************************************************************************
+/*!
+ * \brief HubSort method moves the vertices of degree above the average first, by decreasing degree
+ *
+ * Hub sorting keeps the original relative order of the other vertices, which often
+ * carries some locality already (e.g. drawing order).
+ */
+QVector<int> HubSort(const OrderingAdjacency & adjacency)
+{
+    int n = adjacency.nbVertices();
+    double meanDegree = n > 0 ? double(adjacency.targets.size()) / n : 0.0;
+
+    QVector<int> hubs, others;
+    for (int v=0; v<n; v++)
+    {
+        if (adjacency.degree(v) > meanDegree)
+            hubs << v;
+        else
+            others << v;
+    }
+    std::stable_sort(hubs.begin(), hubs.end(), [&](int a, int b)
+    { return adjacency.degree(a) > adjacency.degree(b); });
+    return hubs << others;
+}
+
+//******************************************************************************
+
+int FindRabbitCommunity(QVector<int> & parents, int v)
+{
+    while (parents[v] != v)
+    {
+        parents[v] = parents[parents[v]];
+        v = parents[v];
+    }
+    return v;
+}
+
+//******************************************************************************
+/*!
+ * \brief RabbitOrder method implements the sequential Rabbit Order (Arai et al., 2016)
+ *
+ * Vertices are visited by increasing degree. A visited vertex gathers the edges of the
+ * vertices already merged into it, then merges into the neighbor community of maximal
+ * modularity gain w(u,v)/m - d(u)d(v)/(2m^2), if positive. The merges form a dendrogram,
+ * its depth-first traversal gives contiguous ids to each community and sub-community.
+ */
+QVector<int> RabbitOrder(const OrderingAdjacency & adjacency)
+{
+    int n = adjacency.nbVertices();
+    double totalStrength = adjacency.targets.size(); // 2m
+    QVector<int> parents(n), order;
+    QVector<double> strengths(n);
+    QVector<QVector<QPair<int, double> > > communityEdges(n);
+    QVector<QVector<int> > children(n);
+    order.reserve(n);
+    if (totalStrength == 0.0)
+    {
+        for (int v=0; v<n; v++)
+            order << v;
+        return order;
+    }
+
+    QVector<int> byDegree(n);
+    for (int v=0; v<n; v++)
+    {
+        parents[v] = v;
+        byDegree[v] = v;
+        strengths[v] = adjacency.degree(v);
+        for (int e=adjacency.offsets[v]; e<adjacency.offsets[v+1]; e++)
+            communityEdges[v] << QPair<int, double>(adjacency.targets[e], 1.0);
+    }
+    std::stable_sort(byDegree.begin(), byDegree.end(), [&](int a, int b)
+    { return adjacency.degree(a) < adjacency.degree(b); });
+
+    QHash<int, double> gathered;
+    QVector<bool> isTopLevel(n, false);
+    foreach (int u, byDegree)
+    {
+        // aggregate the edges of u and of its merged vertices per neighbor community
+        gathered.clear();
+        typedef QPair<int, double> WeightedEdge;
+        foreach (WeightedEdge edge, communityEdges[u])
+        {
+            int community = FindRabbitCommunity(parents, edge.first);
+            if (community != u)
+                gathered[community] += edge.second;
+        }
+        communityEdges[u].clear();
+        for (QHash<int, double>::const_iterator it=gathered.constBegin(); it!=gathered.constEnd(); ++it)
+            communityEdges[u] << WeightedEdge(it.key(), it.value());
+
+        int best = -1;
+        double bestGain = 0.0;
+        foreach (WeightedEdge edge, communityEdges[u])
+        {
+            double gain = edge.second - strengths[u] * strengths[edge.first] / totalStrength;
+            if (gain > bestGain || (gain == bestGain && best >= 0 && edge.first < best))
+            {
+                best = edge.first;
+                bestGain = gain;
+            }
+        }
+
+        if (best < 0)
+        {
+            isTopLevel[u] = true;
+            continue;
+        }
+        parents[u] = best;
+        strengths[best] += strengths[u];
+        communityEdges[best] << communityEdges[u];
+        communityEdges[u].clear();
+        children[best] << u;
+    }
+
+    // depth-first traversal of the dendrogram, children merged last are visited first
+    QVector<int> stack;
+    for (int root=0; root<n; root++)
+    {
+        if (!isTopLevel[root] || parents[root] != root)
+            continue;
+        stack << root;
+        while (!stack.isEmpty())
+        {
+            int v = stack.last();
+            stack.pop_back();
+            order << v;
+            stack << children[v];
+        }
+    }
+    return order;
+}
+
+//******************************************************************************
+/*!
+ * \brief ComputeVertexOrdering method computes a cache friendly relabeling of the graph vertices
+ * \param graph
+ * \param ordering
+ * \param permutation output, new id of each vertex and inverse map
+ * \return false if the graph vertex ids are not their indices
+ */
+bool ComputeVertexOrdering(const Graph & graph, VertexOrdering ordering, VertexPermutation * permutation)
+{
+    GT_PROFILE_SCOPE("ComputeVertexOrdering");
+    if (!permutation)
+        return false;
+    for (int i=0; i<graph.vertices.size(); i++)
+    {
+        if (graph.vertices[i].id != i)
+        {
+            std::cerr << "ComputeVertexOrdering : vertex ids should be equal to their indices" << std::endl;
+            return false;
+        }
+    }
+
+    QVector<int> order;
+    if (ordering == ORDER_ORIGINAL)
+    {
+        for (int v=0; v<graph.vertices.size(); v++)
+            order << v;
+    }
+    else
+    {
+        OrderingAdjacency adjacency;
+        BuildOrderingAdjacency(graph, &adjacency);
+        if (ordering == ORDER_RCM)
+            order = ReverseCuthillMcKee(adjacency);
+        else if (ordering == ORDER_HUB_SORT)
+            order = HubSort(adjacency);
+        else if (ordering == ORDER_RABBIT)
+            order = RabbitOrder(adjacency);
+        else
+            return false;
+    }
+    permutation->setOrder(order);
+    return true;
+}
+
+//******************************************************************************
+/*!
+ * \brief PermuteGraph method relabels the graph vertices, vertex newId is the original vertex toOld(newId)
+ *
+ * Edges are sorted by new source id, so edge loops also follow the new order.
+ */
+bool PermuteGraph(const Graph & graph, const VertexPermutation & permutation, Graph * permuted)
+{
+    GT_PROFILE_SCOPE("PermuteGraph");
+    int n = graph.vertices.size();
+    if (!permuted || permutation.size() != n)
+        return false;
+
+    *permuted = Graph(graph.isDirected());
+    permuted->vertices.resize(n);
+    for (int newId=0; newId<n; newId++)
+    {
+        permuted->vertices[newId] = graph.vertices[permutation.toOld(newId)];
+        permuted->vertices[newId].id = newId;
+    }
+
+    const QVector<Edge> & edges = graph.getEdges();
+    QVector<int> offsets(n+1, 0);
+    for (int i=0; i<edges.size(); i++)
+        offsets[permutation.toNew(edges[i].a->id) + 1]++;
+    for (int v=0; v<n; v++)
+        offsets[v+1] += offsets[v];
+
+    QVector<Edge> permutedEdges(edges.size());
+    for (int i=0; i<edges.size(); i++)
+    {
+        int a = permutation.toNew(edges[i].a->id);
+        Edge & edge = permutedEdges[offsets[a]++];
+        edge.a = &permuted->vertices[a];
+        edge.b = &permuted->vertices[permutation.toNew(edges[i].b->id)];
+        edge.weight = edges[i].weight;
+    }
+    permuted->setEdges(permutedEdges);
+    return true;
+}
+
+//******************************************************************************
+/*!
+ * \brief MeanEdgeSpan method returns the mean id distance |a - b| of the graph edges, a locality measure
+ */
+double MeanEdgeSpan(const Graph & graph)
+{
+    const QVector<Edge> & edges = graph.getEdges();
+    if (edges.isEmpty())
+        return 0.0;
+    double span = 0.0;
+    for (int i=0; i<edges.size(); i++)
+        span += std::abs(edges[i].a->id - edges[i].b->id);
+    return span / edges.size();
+}
+
+//******************************************************************************
+
+ReorderedGraph::ReorderedGraph()
+{
+}
+
+//******************************************************************************
+
+bool ReorderedGraph::setup(const Graph & graph, VertexOrdering ordering)
+{
+    return ComputeVertexOrdering(graph, ordering, &_permutation)
+            && PermuteGraph(graph, _permutation, &_graph);
+}
+
+//******************************************************************************
+
+void ReorderedGraph::copyColorsFrom(const Graph & original)
+{
+    for (int i=0; i<_graph.vertices.size(); i++)
+        _graph.vertices[i].color = original.vertices[_permutation.toOld(i)].color;
+}
+
+//******************************************************************************
+
+void ReorderedGraph::copyColorsTo(Graph * original) const
+{
+    for (int i=0; i<_graph.vertices.size(); i++)
+        original->vertices[_permutation.toOld(i)].color = _graph.vertices[i].color;
+}
+
+//******************************************************************************
+/*!
+ * \brief ReorderedGraph::greedyGraphColoring method colors the reordered graph, colors are written to the original vertices
+ */
+void ReorderedGraph::greedyGraphColoring(Graph * original)
+{
+    copyColorsFrom(*original);
+    GreedyGraphColoring(&_graph);
+    copyColorsTo(original);
+}
+
+//******************************************************************************
+/*!
+ * \brief ReorderedGraph::computeMinDistance method, start/end indices and path use the original ids
+ */
+double ReorderedGraph::computeMinDistance(int startIndex, int endIndex, QList<int> * path) const
+{
+    if (startIndex < 0 || startIndex >= _permutation.size() ||
+            endIndex < 0 || endIndex >= _permutation.size())
+        return -12345.0;
+
+    double distance = ComputeMinDistance(_graph, _permutation.toNew(startIndex), _permutation.toNew(endIndex), path);
+    if (path)
+    {
+        for (int i=0; i<path->size(); i++)
+            (*path)[i] = _permutation.toOld(path->at(i));
+    }
+    return distance;
+}
+
+//******************************************************************************
+/*!
+ * \brief ReorderedGraph::colorConnectedVertices method, components hold original vertex ids
+ */
+bool ReorderedGraph::colorConnectedVertices(Graph & original, ConnectedComponents * components)
+{
+    if (!components)
+        return false;
+    copyColorsFrom(original);
+    ConnectedComponents reordered;
+    if (!ColorConnectedVertices(_graph, &reordered))
+        return false;
+    copyColorsTo(&original);
+
+    QVector<int> labels(_graph.vertices.size());
+    for (int i=0; i<labels.size(); i++)
+        labels[_permutation.toOld(i)] = reordered.label(i);
+    components->setLabels(labels, reordered.nbComponents());
+    return true;
+}
+
+//******************************************************************************
+
+}
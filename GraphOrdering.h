@@ -0,0 +1,102 @@
+#ifndef GRAPHORDERING_H
+#define GRAPHORDERING_H
+
+// Qt
+#include <QVector>
+#include <QList>
+
+// Project
+#include "GraphTools.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+/*!
+ * ORDER_ORIGINAL : click or file order
+ * ORDER_RCM : Reverse Cuthill-McKee, breadth-first levels from a pseudo-peripheral vertex, reduces the bandwidth
+ * ORDER_HUB_SORT : vertices of degree above the average first, by decreasing degree, the others keep their order
+ * ORDER_RABBIT : Rabbit Order, communities merged by modularity gain, each community gets contiguous ids
+ */
+enum VertexOrdering
+{
+    ORDER_ORIGINAL=0,
+    ORDER_RCM,
+    ORDER_HUB_SORT,
+    ORDER_RABBIT,
+    ORDER_NB_ORDERINGS
+};
+
+const char * VertexOrderingName(VertexOrdering ordering);
+
+//******************************************************************************
+/*!
+ * \brief VertexPermutation struct maps the original vertex ids to the new ones and back
+ */
+struct VertexPermutation
+{
+    int size() const
+    { return newToOld.size(); }
+    int toNew(int oldId) const
+    { return oldToNew[oldId]; }
+    int toOld(int newId) const
+    { return newToOld[newId]; }
+
+    void setOrder(const QVector<int> & order);
+    bool isValid() const;
+
+    QVector<int> newToOld; //!< original id of each new id
+    QVector<int> oldToNew; //!< new id of each original id
+};
+
+//******************************************************************************
+
+bool ComputeVertexOrdering(const Graph & graph, VertexOrdering ordering, VertexPermutation * permutation);
+
+bool PermuteGraph(const Graph & graph, const VertexPermutation & permutation, Graph * permuted);
+
+double MeanEdgeSpan(const Graph & graph);
+
+//******************************************************************************
+/*!
+ * \brief ReorderedGraph class runs the graph algorithms on a relabeled copy of a graph
+ *
+ * Results are translated back to the original ids : colors are written to the original
+ * vertices, paths and component members refer to the original ids. Coloring results
+ * are valid colorings but, as the algorithms visit vertices by id, may differ from the
+ * ones computed on the original order.
+ */
+class ReorderedGraph
+{
+public:
+    ReorderedGraph();
+
+    bool setup(const Graph & graph, VertexOrdering ordering);
+
+    const Graph & graph() const
+    { return _graph; }
+    const VertexPermutation & permutation() const
+    { return _permutation; }
+
+    void greedyGraphColoring(Graph * original);
+    double computeMinDistance(int startIndex, int endIndex, QList<int> * path) const;
+    bool colorConnectedVertices(Graph & original, ConnectedComponents * components);
+
+private:
+    void copyColorsFrom(const Graph & original);
+    void copyColorsTo(Graph * original) const;
+
+    Graph _graph;
+    VertexPermutation _permutation;
+
+    Q_DISABLE_COPY(ReorderedGraph)
+};
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHORDERING_H
@@ -0,0 +1,620 @@
+
+// STD
+#include <algorithm>
+#include <queue>
+#include <iostream>
+
+// Qt
+
+// Project
+#include "GraphPartition.h"
+#include "GraphTools.h"
+#include "GraphProfiler.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+/*!
+ * \brief PartitionLevel struct is the undirected weighted graph of one coarsening level in CSR form
+ *
+ * Edge weights count the merged input edges, vertex weights count the merged input vertices.
+ */
+struct PartitionLevel
+{
+    int nbVertices() const
+    { return vertexWeights.size(); }
+
+    QVector<int> offsets;
+    QVector<int> adjacency;
+    QVector<int> adjacencyWeights;
+    QVector<int> vertexWeights;
+    QVector<int> coarseMap; //!< vertex index in the next (coarser) level
+};
+
+//******************************************************************************
+
+quint32 NextPartitionRandom(quint32 & seed)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+//******************************************************************************
+
+void BuildPartitionLevel(const Graph & graph, PartitionLevel * level)
+{
+    int n = graph.vertices.size();
+    const QVector<Edge> & edges = graph.getEdges();
+
+    // undirected pairs (lo, hi), duplicates are merged into the edge weight
+    QVector<quint64> pairs;
+    pairs.reserve(edges.size());
+    for (int i=0; i<edges.size(); i++)
+    {
+        quint32 a = edges[i].a->id;
+        quint32 b = edges[i].b->id;
+        if (a == b)
+            continue;
+        pairs << ((quint64(qMin(a, b)) << 32) | qMax(a, b));
+    }
+    std::sort(pairs.begin(), pairs.end());
+
+    QVector<int> degrees(n, 0);
+    for (int i=0; i<pairs.size(); i++)
+    {
+        if (i > 0 && pairs[i] == pairs[i-1])
+            continue;
+        degrees[int(pairs[i] >> 32)]++;
+        degrees[int(pairs[i] & 0xFFFFFFFF)]++;
+    }
+
+    level->offsets.resize(n+1);
+    level->offsets[0] = 0;
+    for (int i=0; i<n; i++)
+    {
+        level->offsets[i+1] = level->offsets[i] + degrees[i];
+    }
+    level->adjacency.resize(level->offsets[n]);
+    level->adjacencyWeights.resize(level->offsets[n]);
+    level->vertexWeights.fill(1, n);
+
+    QVector<int> cursor = level->offsets;
+    for (int i=0; i<pairs.size(); )
+    {
+        int j = i;
+        while (j < pairs.size() && pairs[j] == pairs[i])
+            j++;
+        int a = int(pairs[i] >> 32);
+        int b = int(pairs[i] & 0xFFFFFFFF);
+        level->adjacency[cursor[a]] = b;
+        level->adjacencyWeights[cursor[a]++] = j - i;
+        level->adjacency[cursor[b]] = a;
+        level->adjacencyWeights[cursor[b]++] = j - i;
+        i = j;
+    }
+}
+
+//******************************************************************************
+/*!
+ * \brief CoarsenPartitionLevel method contracts a heavy-edge matching of the fine level
+ * \return false if the matching does not reduce the graph enough
+ *
+ * Vertices are visited in random order, each unmatched vertex is matched with the
+ * unmatched neighbor connected by the heaviest edge.
+ */
+bool CoarsenPartitionLevel(PartitionLevel & fine, PartitionLevel * coarse, int maxVertexWeight, quint32 & seed)
+{
+    int n = fine.nbVertices();
+
+    QVector<int> order(n);
+    for (int i=0; i<n; i++)
+        order[i] = i;
+    for (int i=n-1; i>0; i--)
+        qSwap(order[i], order[NextPartitionRandom(seed) % (i+1)]);
+
+    QVector<int> match(n, -1);
+    foreach (int u, order)
+    {
+        if (match[u] >= 0)
+            continue;
+        int best = -1;
+        int bestWeight = -1;
+        for (int e=fine.offsets[u]; e<fine.offsets[u+1]; e++)
+        {
+            int v = fine.adjacency[e];
+            if (match[v] < 0 && fine.adjacencyWeights[e] > bestWeight
+                    && fine.vertexWeights[u] + fine.vertexWeights[v] <= maxVertexWeight)
+            {
+                best = v;
+                bestWeight = fine.adjacencyWeights[e];
+            }
+        }
+        match[u] = (best < 0) ? u : best;
+        if (best >= 0)
+            match[best] = u;
+    }
+
+    // coarse vertex ids
+    fine.coarseMap.fill(-1, n);
+    int nc = 0;
+    for (int u=0; u<n; u++)
+    {
+        if (fine.coarseMap[u] >= 0)
+            continue;
+        fine.coarseMap[u] = nc;
+        fine.coarseMap[match[u]] = nc;
+        nc++;
+    }
+    if (nc > 0.95 * n)
+        return false;
+
+    QVector<int> members(2*nc, -1);
+    for (int u=0; u<n; u++)
+    {
+        int cu = fine.coarseMap[u];
+        members[2*cu + (members[2*cu] < 0 ? 0 : 1)] = u;
+    }
+
+    // merge adjacencies, marker gives the position of a coarse neighbor in the current row
+    coarse->vertexWeights.fill(0, nc);
+    coarse->offsets.resize(nc+1);
+    coarse->offsets[0] = 0;
+    coarse->adjacency.clear();
+    coarse->adjacencyWeights.clear();
+    coarse->adjacency.reserve(fine.adjacency.size());
+    coarse->adjacencyWeights.reserve(fine.adjacency.size());
+    QVector<int> marker(nc, -1);
+    for (int cu=0; cu<nc; cu++)
+    {
+        int rowStart = coarse->adjacency.size();
+        for (int m=0; m<2; m++)
+        {
+            int u = members[2*cu+m];
+            if (u < 0)
+                continue;
+            coarse->vertexWeights[cu] += fine.vertexWeights[u];
+            for (int e=fine.offsets[u]; e<fine.offsets[u+1]; e++)
+            {
+                int cv = fine.coarseMap[fine.adjacency[e]];
+                if (cv == cu)
+                    continue;
+                if (marker[cv] < rowStart)
+                {
+                    marker[cv] = coarse->adjacency.size();
+                    coarse->adjacency << cv;
+                    coarse->adjacencyWeights << fine.adjacencyWeights[e];
+                }
+                else
+                {
+                    coarse->adjacencyWeights[marker[cv]] += fine.adjacencyWeights[e];
+                }
+            }
+        }
+        coarse->offsets[cu+1] = coarse->adjacency.size();
+    }
+    return true;
+}
+
+//******************************************************************************
+/*!
+ * \brief InitialPartition method grows parts one after another by breadth first search from unassigned seeds
+ */
+void InitialPartition(const PartitionLevel & level, int nbParts, QVector<int> * parts)
+{
+    int n = level.nbVertices();
+    int totalWeight = 0;
+    foreach (int w, level.vertexWeights)
+        totalWeight += w;
+
+    parts->fill(-1, n);
+    int nextSeed = 0;
+    int assignedWeight = 0;
+    for (int p=0; p<nbParts-1; p++)
+    {
+        int target = (totalWeight - assignedWeight) / (nbParts - p);
+        int partWeight = 0;
+        QList<int> frontier;
+        while (partWeight < target)
+        {
+            if (frontier.isEmpty())
+            {
+                while (nextSeed < n && (*parts)[nextSeed] >= 0)
+                    nextSeed++;
+                if (nextSeed >= n)
+                    break;
+                (*parts)[nextSeed] = p;
+                partWeight += level.vertexWeights[nextSeed];
+                frontier << nextSeed;
+                continue;
+            }
+            int u = frontier.takeFirst();
+            for (int e=level.offsets[u]; e<level.offsets[u+1] && partWeight < target; e++)
+            {
+                int v = level.adjacency[e];
+                if ((*parts)[v] >= 0)
+                    continue;
+                (*parts)[v] = p;
+                partWeight += level.vertexWeights[v];
+                frontier << v;
+            }
+        }
+        assignedWeight += partWeight;
+    }
+    for (int u=0; u<n; u++)
+    {
+        if ((*parts)[u] < 0)
+            (*parts)[u] = nbParts-1;
+    }
+}
+
+//******************************************************************************
+/*!
+ * \brief BestPartitionMove method finds the best partition to move vertex u to
+ * \param connections is a scratch buffer of nbParts elements, left filled with zeros
+ * \return gain of the move (cut reduction), target partition in *target (-1 if u is not on the boundary)
+ */
+int BestPartitionMove(const PartitionLevel & level, const QVector<int> & parts, int u,
+                      QVector<int> & connections, int * target)
+{
+    int from = parts[u];
+    for (int e=level.offsets[u]; e<level.offsets[u+1]; e++)
+    {
+        connections[parts[level.adjacency[e]]] += level.adjacencyWeights[e];
+    }
+    int internal = connections[from];
+    int best = -1;
+    int bestConnection = 0;
+    for (int e=level.offsets[u]; e<level.offsets[u+1]; e++)
+    {
+        int p = parts[level.adjacency[e]];
+        if (p != from && connections[p] > bestConnection)
+        {
+            best = p;
+            bestConnection = connections[p];
+        }
+    }
+    for (int e=level.offsets[u]; e<level.offsets[u+1]; e++)
+    {
+        connections[parts[level.adjacency[e]]] = 0;
+    }
+    *target = best;
+    return bestConnection - internal;
+}
+
+//******************************************************************************
+/*!
+ * \brief RefinePartition method implements a k-way Fiduccia-Mattheyses refinement
+ *
+ * Each pass moves boundary vertices by decreasing gain (negative gains are allowed to
+ * climb out of local minima), locks moved vertices and rolls back to the best cut seen.
+ * Moves never make a partition heavier than maxPartWeight.
+ */
+void RefinePartition(const PartitionLevel & level, int nbParts, int maxPartWeight, QVector<int> * parts)
+{
+    typedef QPair<int, int> GainEntry; // (gain, vertex)
+    static const int MAX_PASSES = 8;
+    static const int MAX_NON_IMPROVING_MOVES = 64;
+
+    int n = level.nbVertices();
+    QVector<int> & p = *parts;
+    QVector<int> partWeights(nbParts, 0);
+    for (int u=0; u<n; u++)
+        partWeights[p[u]] += level.vertexWeights[u];
+
+    QVector<int> connections(nbParts, 0);
+
+    for (int pass=0; pass<MAX_PASSES; pass++)
+    {
+        std::priority_queue<GainEntry> heap;
+        for (int u=0; u<n; u++)
+        {
+            int target;
+            int gain = BestPartitionMove(level, p, u, connections, &target);
+            if (target >= 0)
+                heap.push(GainEntry(gain, u));
+        }
+
+        QVector<bool> locked(n, false);
+        QVector<QPair<int, int> > moves; // (vertex, previous partition)
+        int cutDelta = 0;
+        int bestCutDelta = 0;
+        int bestMoves = 0;
+        int nonImproving = 0;
+        while (!heap.empty() && nonImproving < MAX_NON_IMPROVING_MOVES)
+        {
+            GainEntry entry = heap.top();
+            heap.pop();
+            int u = entry.second;
+            if (locked[u])
+                continue;
+            int target;
+            int gain = BestPartitionMove(level, p, u, connections, &target);
+            if (target < 0)
+                continue;
+            if (gain != entry.first)
+            {
+                heap.push(GainEntry(gain, u));
+                continue;
+            }
+            int from = p[u];
+            // balance constraint, a move from an overweight partition is always welcome
+            if (partWeights[target] + level.vertexWeights[u] > maxPartWeight
+                    && partWeights[from] <= maxPartWeight)
+                continue;
+
+            p[u] = target;
+            partWeights[from] -= level.vertexWeights[u];
+            partWeights[target] += level.vertexWeights[u];
+            locked[u] = true;
+            moves << qMakePair(u, from);
+            cutDelta -= gain;
+            if (cutDelta < bestCutDelta)
+            {
+                bestCutDelta = cutDelta;
+                bestMoves = moves.size();
+                nonImproving = 0;
+            }
+            else
+            {
+                nonImproving++;
+            }
+
+            for (int e=level.offsets[u]; e<level.offsets[u+1]; e++)
+            {
+                int v = level.adjacency[e];
+                if (locked[v])
+                    continue;
+                int vTarget;
+                int vGain = BestPartitionMove(level, p, v, connections, &vTarget);
+                if (vTarget >= 0)
+                    heap.push(GainEntry(vGain, v));
+            }
+        }
+
+        // roll back moves after the best cut
+        for (int i=moves.size()-1; i>=bestMoves; i--)
+        {
+            int u = moves[i].first;
+            partWeights[p[u]] -= level.vertexWeights[u];
+            p[u] = moves[i].second;
+            partWeights[p[u]] += level.vertexWeights[u];
+        }
+
+        if (bestCutDelta >= 0)
+            break;
+    }
+}
+
+//******************************************************************************
+/*!
+ * \brief BalancePartition method moves vertices out of overweight partitions
+ *
+ * Initial growing and projection can leave partitions above maxPartWeight. A first sweep
+ * moves boundary vertices to an adjacent partition that can take them, a second sweep
+ * moves any vertex to the lightest partition.
+ */
+void BalancePartition(const PartitionLevel & level, int nbParts, int maxPartWeight, QVector<int> * parts)
+{
+    int n = level.nbVertices();
+    QVector<int> & p = *parts;
+    QVector<int> partWeights(nbParts, 0);
+    for (int u=0; u<n; u++)
+        partWeights[p[u]] += level.vertexWeights[u];
+
+    for (int sweep=0; sweep<2; sweep++)
+    {
+        for (int u=0; u<n; u++)
+        {
+            int from = p[u];
+            int w = level.vertexWeights[u];
+            if (partWeights[from] <= maxPartWeight)
+                continue;
+
+            int target = -1;
+            if (sweep == 0)
+            {
+                for (int e=level.offsets[u]; e<level.offsets[u+1]; e++)
+                {
+                    int q = p[level.adjacency[e]];
+                    if (q != from && partWeights[q] + w <= maxPartWeight)
+                    {
+                        target = q;
+                        break;
+                    }
+                }
+            }
+            else
+            {
+                target = 0;
+                for (int q=1; q<nbParts; q++)
+                {
+                    if (partWeights[q] < partWeights[target])
+                        target = q;
+                }
+                if (target == from || partWeights[target] + w > maxPartWeight)
+                    target = -1;
+            }
+            if (target < 0)
+                continue;
+
+            p[u] = target;
+            partWeights[from] -= w;
+            partWeights[target] += w;
+        }
+    }
+}
+
+//******************************************************************************
+
+void BuildGraphParts(const Graph & graph, GraphPartition * partition)
+{
+    int n = graph.vertices.size();
+    const QVector<int> & vertexParts = partition->vertexParts;
+    QVector<GraphPart> & parts = partition->parts;
+    parts.fill(GraphPart(), partition->nbParts);
+
+    for (int u=0; u<n; u++)
+    {
+        GraphPart & part = parts[vertexParts[u]];
+        part.globalToLocal.insert(u, part.localToGlobal.size());
+        part.localToGlobal << u;
+    }
+    for (int i=0; i<parts.size(); i++)
+    {
+        parts[i].nbOwned = parts[i].localToGlobal.size();
+    }
+
+    // edges of an undirected graph give two arcs
+    QVector<bool> isBoundary(n, false);
+    const QVector<Edge> & edges = graph.getEdges();
+    int nbArcs = graph.nbArcs();
+    for (int arc=0; arc<nbArcs; arc++)
+    {
+        int i = graph.isDirected() ? arc : arc / 2;
+        bool reversed = !graph.isDirected() && (arc & 1);
+        int a = reversed ? edges[i].b->id : edges[i].a->id;
+        int b = reversed ? edges[i].a->id : edges[i].b->id;
+        int pa = vertexParts[a];
+        int pb = vertexParts[b];
+        if (pa != pb)
+        {
+            isBoundary[a] = true;
+            isBoundary[b] = true;
+        }
+        for (int k=0; k<2; k++)
+        {
+            if (k == 1 && pa == pb)
+                break;
+            GraphPart & part = parts[k == 0 ? pa : pb];
+            int ends[2] = { a, b };
+            for (int j=0; j<2; j++)
+            {
+                if (!part.globalToLocal.contains(ends[j]))
+                {
+                    part.globalToLocal.insert(ends[j], part.localToGlobal.size());
+                    part.localToGlobal << ends[j];
+                    part.ghostOwners << vertexParts[ends[j]];
+                }
+                part.edgeVertices << part.globalToLocal.value(ends[j]);
+            }
+            part.edgeWeights << edges[i].weight;
+        }
+    }
+
+    for (int i=0; i<parts.size(); i++)
+    {
+        GraphPart & part = parts[i];
+        for (int local=0; local<part.nbOwned; local++)
+        {
+            if (isBoundary[part.localToGlobal[local]])
+                part.boundary << local;
+        }
+    }
+}
+
+//******************************************************************************
+/*!
+ * \brief PartitionGraph method splits graph vertices into nbParts balanced parts with a small edge cut
+ * \param graph
+ * \param nbParts
+ * \param partition output vertex partitions, edge cut and per-partition subgraphs with ghost vertices
+ * \param imbalance tolerated partition weight above the average, e.g. 0.03 for 3%
+ * \return false if nbParts < 1
+ *
+ * Multilevel scheme : the graph is coarsened by heavy-edge matching down to a few vertices
+ * per partition, the coarsest graph is partitioned by graph growing, then the partition is
+ * projected back level by level and refined with Fiduccia-Mattheyses moves.
+ */
+bool PartitionGraph(const Graph & graph, int nbParts, GraphPartition * partition, double imbalance)
+{
+    GT_PROFILE_SCOPE("PartitionGraph");
+    if (!partition || nbParts < 1)
+        return false;
+
+    int n = graph.vertices.size();
+    partition->nbParts = nbParts;
+
+    QList<PartitionLevel> levels;
+    levels << PartitionLevel();
+    BuildPartitionLevel(graph, &levels.last());
+
+    // coarsening :
+    int coarsenTo = qMax(20 * nbParts, 40);
+    int maxVertexWeight = qMax(1, int(1.5 * n / coarsenTo));
+    quint32 seed = 12345;
+    while (levels.last().nbVertices() > coarsenTo)
+    {
+        PartitionLevel coarse;
+        if (!CoarsenPartitionLevel(levels.last(), &coarse, maxVertexWeight, seed))
+            break;
+        levels << coarse;
+    }
+
+    // initial partition and uncoarsening :
+    int maxPartWeight = int((1.0 + imbalance) * n / nbParts + 0.999999);
+    QVector<int> parts;
+    InitialPartition(levels.last(), nbParts, &parts);
+    for (int l=levels.size()-1; l>=0; l--)
+    {
+        const PartitionLevel & level = levels[l];
+        if (l < levels.size()-1)
+        {
+            QVector<int> fineParts(level.nbVertices());
+            for (int u=0; u<level.nbVertices(); u++)
+                fineParts[u] = parts[level.coarseMap[u]];
+            parts = fineParts;
+        }
+        BalancePartition(level, nbParts, maxPartWeight, &parts);
+        RefinePartition(level, nbParts, maxPartWeight, &parts);
+    }
+    partition->vertexParts = parts;
+
+    // edge cut on the input graph :
+    const PartitionLevel & finest = levels.first();
+    partition->edgeCut = 0;
+    for (int u=0; u<n; u++)
+    {
+        for (int e=finest.offsets[u]; e<finest.offsets[u+1]; e++)
+        {
+            if (u < finest.adjacency[e] && parts[u] != parts[finest.adjacency[e]])
+                partition->edgeCut++;
+        }
+    }
+
+    BuildGraphParts(graph, partition);
+    return true;
+}
+
+//******************************************************************************
+/*!
+ * \brief SetupPartGraph method fills algorithm graph from a partition subgraph, vertex ids are local ids
+ */
+bool SetupPartGraph(const GraphPart & part, Graph * graph)
+{
+    if (!graph)
+        return false;
+
+    // part edges are directed arcs
+    *graph = Graph(true);
+    graph->vertices.resize(part.nbVertices());
+    for (int i=0;i<graph->vertices.size();i++)
+    {
+        graph->vertices[i].id = i;
+    }
+
+    QVector<GT::Edge> edges(part.nbEdges());
+    for (int i=0; i<part.nbEdges(); i++)
+    {
+        edges[i].a = &graph->vertices[part.edgeVertices[2*i]];
+        edges[i].b = &graph->vertices[part.edgeVertices[2*i+1]];
+        edges[i].weight = part.edgeWeights[i];
+    }
+    graph->setEdges(edges);
+    return true;
+}
+
+//******************************************************************************
+
+}
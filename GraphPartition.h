@@ -0,0 +1,77 @@
+#ifndef GRAPHPARTITION_H
+#define GRAPHPARTITION_H
+
+// Qt
+#include <QVector>
+#include <QHash>
+
+//******************************************************************************
+
+namespace GT {
+
+struct Graph;
+
+//******************************************************************************
+/*!
+ * \brief GraphPart struct is the subgraph owned by one partition
+ *
+ * Local vertex ids : owned vertices come first [0, nbOwned), ghost vertices
+ * (neighbors owned by other partitions) follow. Local edge j connects
+ * edgeVertices[2*j] -> edgeVertices[2*j+1], every input arc touching an owned vertex is kept
+ * (an undirected input edge gives two arcs).
+ */
+struct GraphPart
+{
+    GraphPart() :
+        nbOwned(0)
+    {
+    }
+
+    int nbVertices() const
+    { return localToGlobal.size(); }
+    int nbEdges() const
+    { return edgeWeights.size(); }
+    bool isGhost(int localId) const
+    { return localId >= nbOwned; }
+    int ghostOwner(int localId) const
+    { return ghostOwners[localId - nbOwned]; }
+
+    QVector<int> localToGlobal;
+    QHash<int, int> globalToLocal;
+    int nbOwned;
+    QVector<int> ghostOwners; //!< owner partition of each ghost, index is localId - nbOwned
+    QVector<int> boundary; //!< local ids of owned vertices connected to a ghost
+
+    QVector<int> edgeVertices;
+    QVector<double> edgeWeights;
+};
+
+//******************************************************************************
+
+struct GraphPartition
+{
+    GraphPartition() :
+        nbParts(0),
+        edgeCut(0)
+    {
+    }
+
+    int nbParts;
+    QVector<int> vertexParts; //!< partition of each graph vertex
+    int edgeCut; //!< number of undirected vertex pairs connected across partitions
+    QVector<GraphPart> parts;
+};
+
+//******************************************************************************
+
+bool PartitionGraph(const Graph & graph, int nbParts, GraphPartition * partition, double imbalance=0.03);
+
+bool SetupPartGraph(const GraphPart & part, Graph * graph);
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHPARTITION_H
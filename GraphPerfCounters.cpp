@@ -0,0 +1,159 @@
+
+// STD
+#include <cerrno>
+#include <cstring>
+
+// Qt
+#include <QtGlobal>
+
+// System
+#ifdef Q_OS_LINUX
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Project
+#include "GraphPerfCounters.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+#ifdef Q_OS_LINUX
+
+struct CounterEvent
+{
+    quint32 type;
+    quint64 config;
+};
+
+static const CounterEvent COUNTER_EVENTS[HC_NB_COUNTERS] =
+{
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }
+};
+
+#endif
+
+//******************************************************************************
+
+HardwareCounters::HardwareCounters()
+{
+    for (int i=0; i<HC_NB_COUNTERS; i++)
+        _descriptors[i] = -1;
+
+#ifdef Q_OS_LINUX
+    for (int i=0; i<HC_NB_COUNTERS; i++)
+    {
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = COUNTER_EVENTS[i].type;
+        attributes.config = COUNTER_EVENTS[i].config;
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        _descriptors[i] = int(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+        if (_descriptors[i] < 0 && _error.isEmpty())
+        {
+            _error = QString("%1 : %2").arg(counterName(HardwareCounter(i))).arg(std::strerror(errno));
+            if (errno == EACCES || errno == EPERM)
+                _error += " (see /proc/sys/kernel/perf_event_paranoid)";
+        }
+    }
+#else
+    _error = "hardware counters are only read on Linux";
+#endif
+}
+
+//******************************************************************************
+
+HardwareCounters::~HardwareCounters()
+{
+#ifdef Q_OS_LINUX
+    for (int i=0; i<HC_NB_COUNTERS; i++)
+    {
+        if (_descriptors[i] >= 0)
+            close(_descriptors[i]);
+    }
+#endif
+}
+
+//******************************************************************************
+
+bool HardwareCounters::isAvailable() const
+{
+    for (int i=0; i<HC_NB_COUNTERS; i++)
+    {
+        if (_descriptors[i] >= 0)
+            return true;
+    }
+    return false;
+}
+
+//******************************************************************************
+
+void HardwareCounters::start()
+{
+#ifdef Q_OS_LINUX
+    for (int i=0; i<HC_NB_COUNTERS; i++)
+    {
+        if (_descriptors[i] < 0)
+            continue;
+        ioctl(_descriptors[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(_descriptors[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+//******************************************************************************
+
+void HardwareCounters::stop(HardwareCounts * counts)
+{
+    *counts = HardwareCounts();
+#ifdef Q_OS_LINUX
+    for (int i=0; i<HC_NB_COUNTERS; i++)
+    {
+        if (_descriptors[i] >= 0)
+            ioctl(_descriptors[i], PERF_EVENT_IOC_DISABLE, 0);
+    }
+    for (int i=0; i<HC_NB_COUNTERS; i++)
+    {
+        // value, time enabled, time running
+        quint64 values[3];
+        if (_descriptors[i] < 0 || read(_descriptors[i], values, sizeof(values)) != ssize_t(sizeof(values)))
+            continue;
+        if (values[2] == 0)
+            continue;
+        double scale = values[2] < values[1] ? double(values[1]) / values[2] : 1.0;
+        counts->values[i] = qint64(values[0] * scale);
+    }
+#endif
+}
+
+//******************************************************************************
+
+const char * HardwareCounters::counterName(HardwareCounter counter)
+{
+    switch (counter)
+    {
+    case HC_CYCLES: return "cycles";
+    case HC_INSTRUCTIONS: return "instructions";
+    case HC_LLC_MISSES: return "LLC misses";
+    case HC_DTLB_MISSES: return "dTLB misses";
+    case HC_BRANCH_MISSES: return "branch misses";
+    default: return "unknown";
+    }
+}
+
+//******************************************************************************
+
+}
@@ -0,0 +1,87 @@
+#ifndef GRAPHPERFCOUNTERS_H
+#define GRAPHPERFCOUNTERS_H
+
+// Qt
+#include <QString>
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+enum HardwareCounter
+{
+    HC_CYCLES=0,
+    HC_INSTRUCTIONS,
+    HC_LLC_MISSES, //!< last level cache misses
+    HC_DTLB_MISSES, //!< data TLB read misses
+    HC_BRANCH_MISSES,
+    HC_NB_COUNTERS
+};
+
+//******************************************************************************
+/*!
+ * \brief HardwareCounts struct holds the counts of one measured phase, -1 for the counters not available
+ */
+struct HardwareCounts
+{
+    HardwareCounts()
+    {
+        for (int i=0; i<HC_NB_COUNTERS; i++)
+            values[i] = -1;
+    }
+    bool has(HardwareCounter counter) const
+    { return values[counter] >= 0; }
+    //! instructions per cycle, -1 if not counted
+    double ipc() const
+    { return has(HC_CYCLES) && has(HC_INSTRUCTIONS) && values[HC_CYCLES] > 0 ? double(values[HC_INSTRUCTIONS]) / values[HC_CYCLES] : -1.0; }
+
+    qint64 values[HC_NB_COUNTERS];
+};
+
+//******************************************************************************
+/*!
+ * \brief HardwareCounters class counts CPU events of the calling thread with Linux perf_event_open
+ *
+ * Each counter is opened on its own, user space only : a counter the CPU or the kernel does
+ * not provide (virtual machines, perf_event_paranoid above 2, other systems) is left out and
+ * error() tells why, the others still count. When the kernel multiplexes the counters the
+ * counts are scaled by the time they were enabled over the time they ran.
+ * Work done by other threads, e.g. the thread pool workers, is not counted.
+ */
+class HardwareCounters
+{
+public:
+    HardwareCounters();
+    ~HardwareCounters();
+
+    //! true if at least one counter is open
+    bool isAvailable() const;
+    bool hasCounter(HardwareCounter counter) const
+    { return _descriptors[counter] >= 0; }
+    //! reason of the first counter that could not be opened, empty if all are open
+    const QString & error() const
+    { return _error; }
+
+    //! resets and enables the counters
+    void start();
+    //! disables the counters and reads them
+    void stop(HardwareCounts * counts);
+
+    static const char * counterName(HardwareCounter counter);
+
+private:
+    int _descriptors[HC_NB_COUNTERS];
+    QString _error;
+
+    Q_DISABLE_COPY(HardwareCounters)
+};
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHPERFCOUNTERS_H
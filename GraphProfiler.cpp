@@ -0,0 +1,163 @@
+
+// Qt
+#include <QIODevice>
+#include <QTextStream>
+#include <QThread>
+#include <QMutexLocker>
+#include <QHash>
+#include <QStringList>
+
+// Project
+#include "GraphProfiler.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+Profiler::Profiler()
+{
+    reset();
+}
+
+//******************************************************************************
+
+Profiler & Profiler::instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+//******************************************************************************
+
+void Profiler::reset()
+{
+    QMutexLocker locker(&_mutex);
+    _events.clear();
+    for (int i=0; i<PC_NB_COUNTERS; i++)
+    {
+        _counters[i] = 0;
+    }
+    _timer.start();
+}
+
+//******************************************************************************
+
+void Profiler::addEvent(const char * name, qint64 start, qint64 duration)
+{
+    ProfileEvent event;
+    event.name = name;
+    event.start = start;
+    event.duration = duration;
+    event.threadId = quintptr(QThread::currentThreadId());
+
+    QMutexLocker locker(&_mutex);
+    _events.append(event);
+}
+
+//******************************************************************************
+
+QVector<ProfileEvent> Profiler::events() const
+{
+    QMutexLocker locker(&_mutex);
+    return _events;
+}
+
+//******************************************************************************
+
+const char * Profiler::counterName(ProfileCounter counter)
+{
+    switch (counter)
+    {
+    case PC_EDGES_RELAXED: return "Edges relaxed";
+    case PC_BELLMAN_FORD_ROUNDS: return "Bellman-Ford rounds";
+    case PC_COLORS_TRIED: return "Colors tried";
+    case PC_DFS_STACK_PUSHES: return "DFS stack pushes";
+    case PC_ALLOCATIONS: return "Allocations";
+    default: return "Unknown";
+    }
+}
+
+//******************************************************************************
+/*!
+ * \brief Profiler::summary method returns a text report : total time and calls per scope, then counters
+ */
+QString Profiler::summary() const
+{
+    QVector<ProfileEvent> evts = events();
+
+    // aggregate scopes by name, keep first occurrence order
+    QStringList names;
+    QHash<QString, QPair<qint64, int> > totals;
+    foreach (ProfileEvent event, evts)
+    {
+        QString name(event.name);
+        if (!totals.contains(name))
+            names << name;
+        QPair<qint64, int> & total = totals[name];
+        total.first += event.duration;
+        total.second++;
+    }
+
+    QString out;
+    QTextStream stream(&out);
+    foreach (QString name, names)
+    {
+        QPair<qint64, int> total = totals.value(name);
+        stream << name << " : " << total.first * 1e-6 << " ms (" << total.second << " calls)\n";
+    }
+    for (int i=0; i<PC_NB_COUNTERS; i++)
+    {
+        stream << counterName(ProfileCounter(i)) << " : " << _counters[i] << "\n";
+    }
+    stream.flush();
+    return out;
+}
+
+//******************************************************************************
+/*!
+ * \brief Profiler::writeChromeTrace method writes events in the Chrome trace event format
+ * \param device
+ * \return
+ *
+ * Open the file in chrome://tracing or https://ui.perfetto.dev
+ * Scopes are complete events ("ph":"X"), counters are written as counter events at the end of the trace.
+ */
+bool Profiler::writeChromeTrace(QIODevice * device) const
+{
+    if (!device || !device->isWritable())
+        return false;
+
+    QVector<ProfileEvent> evts = events();
+
+    QTextStream out(device);
+    out.setRealNumberPrecision(15);
+    out << "{\"traceEvents\":[";
+    qint64 end = 0;
+    for (int i=0; i<evts.size(); i++)
+    {
+        const ProfileEvent & event = evts[i];
+        out << (i > 0 ? ",\n" : "\n")
+            << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1"
+            << ",\"tid\":" << quint64(event.threadId)
+            << ",\"ts\":" << event.start * 1e-3
+            << ",\"dur\":" << event.duration * 1e-3 << "}";
+        end = qMax(end, event.start + event.duration);
+    }
+    for (int i=0; i<PC_NB_COUNTERS; i++)
+    {
+        out << (evts.isEmpty() && i == 0 ? "\n" : ",\n")
+            << "{\"name\":\"" << counterName(ProfileCounter(i)) << "\",\"ph\":\"C\",\"pid\":1"
+            << ",\"ts\":" << end * 1e-3
+            << ",\"args\":{\"value\":" << _counters[i] << "}}";
+    }
+    out << "\n]}\n";
+
+    out.flush();
+    return out.status() == QTextStream::Ok;
+}
+
+//******************************************************************************
+
+}
@@ -0,0 +1,129 @@
+#ifndef GRAPHPROFILER_H
+#define GRAPHPROFILER_H
+
+// Qt
+#include <QVector>
+#include <QString>
+#include <QElapsedTimer>
+#include <QMutex>
+
+class QIODevice;
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+enum ProfileCounter
+{
+    PC_EDGES_RELAXED=0, //!< relaxations that lowered a distance
+    PC_BELLMAN_FORD_ROUNDS,
+    PC_COLORS_TRIED,
+    PC_DFS_STACK_PUSHES,
+    PC_ALLOCATIONS,
+    PC_NB_COUNTERS
+};
+
+//******************************************************************************
+
+struct ProfileEvent
+{
+    const char * name;
+    qint64 start; //!< in nanoseconds since profiler reset
+    qint64 duration; //!< in nanoseconds
+    quintptr threadId;
+};
+
+//******************************************************************************
+/*!
+ * \brief Profiler class collects scoped timings and algorithm counters
+ *
+ * Use GT_PROFILE_SCOPE and GT_PROFILE_COUNT macros, they compile to nothing
+ * when GT_PROFILING is not defined (qmake CONFIG+=profiling to enable).
+ * Scopes are thread-safe, counters are not : parallel code should accumulate
+ * locally and add once.
+ */
+class Profiler
+{
+public:
+    static Profiler & instance();
+
+    void reset();
+
+    qint64 now() const
+    { return _timer.nsecsElapsed(); }
+
+    void addEvent(const char * name, qint64 start, qint64 duration);
+    void addCount(ProfileCounter counter, qint64 n)
+    { _counters[counter] += n; }
+
+    qint64 count(ProfileCounter counter) const
+    { return _counters[counter]; }
+    QVector<ProfileEvent> events() const;
+
+    QString summary() const;
+    bool writeChromeTrace(QIODevice * device) const;
+
+    static const char * counterName(ProfileCounter counter);
+
+private:
+    Profiler();
+
+    QElapsedTimer _timer;
+    mutable QMutex _mutex;
+    QVector<ProfileEvent> _events;
+    qint64 _counters[PC_NB_COUNTERS];
+};
+
+//******************************************************************************
+
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char * name) :
+        _name(name),
+        _start(Profiler::instance().now())
+    {
+    }
+    ~ProfileScope()
+    {
+        Profiler & profiler = Profiler::instance();
+        profiler.addEvent(_name, _start, profiler.now() - _start);
+    }
+
+private:
+    const char * _name;
+    qint64 _start;
+};
+
+//******************************************************************************
+
+inline bool ProfilingEnabled()
+{
+#ifdef GT_PROFILING
+    return true;
+#else
+    return false;
+#endif
+}
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#ifdef GT_PROFILING
+#define GT_PROFILE_CONCAT_(a, b) a##b
+#define GT_PROFILE_CONCAT(a, b) GT_PROFILE_CONCAT_(a, b)
+#define GT_PROFILE_SCOPE(name) GT::ProfileScope GT_PROFILE_CONCAT(gtProfileScope, __LINE__)(name)
+#define GT_PROFILE_COUNT(counter, n) GT::Profiler::instance().addCount(GT::counter, n)
+#else
+#define GT_PROFILE_SCOPE(name)
+#define GT_PROFILE_COUNT(counter, n)
+#endif
+
+//******************************************************************************
+
+#endif // GRAPHPROFILER_H
@@ -0,0 +1,428 @@
+
+// STD
+#include <iostream>
+
+// Qt
+#include <QThread>
+
+// Project
+#include "GraphRecoloring.h"
+#include "GraphTools.h"
+#include "GraphProfiler.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+/*!
+ * \brief FirstFitColoring method gives each vertex, in id order, the smallest color unused by its smaller neighbors
+ * \param neighbors
+ * \param colors input : -1 for removed vertices, which are skipped; output : the colors
+ *
+ * This is the coloring of GreedyGraphColoring : at the color sweep c, the vertex v gets c
+ * if no smaller neighbor got c before, i.e. v gets the smallest color of no smaller neighbor.
+ */
+void FirstFitColoring(const QVector< QVector<int> > & neighbors, QVector<int> * colors)
+{
+    int n = neighbors.size();
+    QVector<int> marks(1, 0);
+    for (int v=0; v<n; v++)
+    {
+        if ((*colors)[v] < 0)
+            continue;
+        const QVector<int> & list = neighbors[v];
+        if (marks.size() < list.size() + 1)
+            marks.resize(list.size() + 1);
+        foreach (int u, list)
+        {
+            int c = (*colors)[u];
+            if (u < v && c >= 0 && c <= list.size())
+                marks[c] = v + 1;
+        }
+        int color = 0;
+        while (marks[color] == v + 1)
+            color++;
+        (*colors)[v] = color;
+    }
+}
+
+//******************************************************************************
+/*!
+ * \brief RecompactionJob class computes the first-fit coloring of an adjacency copy in a thread
+ */
+class RecompactionJob : public QThread
+{
+public:
+    RecompactionJob(const QVector< QVector<int> > & neighbors, const QVector<int> & colors) :
+        _neighbors(neighbors),
+        _colors(colors)
+    {
+    }
+
+    const QVector<int> & colors() const
+    { return _colors; }
+
+protected:
+    void run()
+    {
+        GT_PROFILE_SCOPE("RecompactionJob");
+        FirstFitColoring(_neighbors, &_colors);
+    }
+
+private:
+    QVector< QVector<int> > _neighbors;
+    QVector<int> _colors;
+};
+
+//******************************************************************************
+
+IncrementalColoring::IncrementalColoring() :
+    _stamp(0),
+    _compactNbColors(0),
+    _job(0)
+{
+}
+
+//******************************************************************************
+
+IncrementalColoring::~IncrementalColoring()
+{
+    if (_job)
+    {
+        _job->wait();
+        delete _job;
+    }
+}
+
+//******************************************************************************
+
+void IncrementalColoring::clear()
+{
+    if (_job)
+    {
+        _job->wait();
+        delete _job;
+        _job = 0;
+    }
+    _neighbors.clear();
+    _colors.clear();
+    _colorCounts.clear();
+    _recolored.clear();
+    _addedEdges.clear();
+    _compactNbColors = 0;
+}
+
+//******************************************************************************
+/*!
+ * \brief IncrementalColoring::build method copies the graph edges and colors it as GreedyGraphColoring
+ * \param graph
+ * \param useGraphColors keep the vertex colors of the graph instead, e.g. an exact coloring
+ */
+void IncrementalColoring::build(const Graph & graph, bool useGraphColors)
+{
+    GT_PROFILE_SCOPE("IncrementalColoring::build");
+    clear();
+    int n = graph.vertices.size();
+    _neighbors.resize(n);
+    const QVector<Edge> & edges = graph.getEdges();
+    for (int i=0; i<edges.size(); i++)
+    {
+        int a = edges[i].a->id;
+        int b = edges[i].b->id;
+        if (a == b)
+            continue;
+        _neighbors[a] << b;
+        _neighbors[b] << a;
+    }
+
+    // parallel edges :
+    QVector<int> marks(n, -1);
+    for (int v=0; v<n; v++)
+    {
+        QVector<int> & list = _neighbors[v];
+        int size = 0;
+        for (int i=0; i<list.size(); i++)
+        {
+            if (marks[list[i]] == v)
+                continue;
+            marks[list[i]] = v;
+            list[size++] = list[i];
+        }
+        list.resize(size);
+    }
+
+    QVector<int> colors(n, 0);
+    if (useGraphColors)
+    {
+        for (int v=0; v<n; v++)
+            colors[v] = graph.vertices[v].color;
+    }
+    else
+    {
+        FirstFitColoring(_neighbors, &colors);
+    }
+    adopt(colors);
+    _recolored.clear();
+}
+
+//******************************************************************************
+
+void IncrementalColoring::setColor(int v, int color)
+{
+    int previous = _colors[v];
+    if (previous == color)
+        return;
+    if (previous >= 0)
+        _colorCounts[previous]--;
+    if (color >= 0)
+    {
+        if (color >= _colorCounts.size())
+            _colorCounts.resize(color + 1);
+        _colorCounts[color]++;
+    }
+    while (!_colorCounts.isEmpty() && _colorCounts.last() == 0)
+        _colorCounts.removeLast();
+    _colors[v] = color;
+    _recolored << v;
+}
+
+//******************************************************************************
+/*!
+ * \brief IncrementalColoring::smallestFreeColor method returns the smallest color unused by the neighbors of v, at most its degree
+ */
+int IncrementalColoring::smallestFreeColor(int v)
+{
+    const QVector<int> & list = _neighbors[v];
+    if (_marks.size() < list.size() + 1)
+        _marks.resize(list.size() + 1);
+    _stamp++;
+    foreach (int u, list)
+    {
+        int c = _colors[u];
+        if (c >= 0 && c <= list.size())
+            _marks[c] = _stamp;
+    }
+    int color = 0;
+    while (_marks[color] == _stamp)
+        color++;
+    return color;
+}
+
+//******************************************************************************
+
+void IncrementalColoring::lowerColor(int v)
+{
+    if (_colors[v] < 0)
+        return;
+    int color = smallestFreeColor(v);
+    if (color < _colors[v])
+        setColor(v, color);
+}
+
+//******************************************************************************
+/*!
+ * \brief IncrementalColoring::adopt method replaces all colors, e.g. by a full coloring
+ */
+void IncrementalColoring::adopt(const QVector<int> & colors)
+{
+    _recolored.clear();
+    _colorCounts.clear();
+    for (int v=0; v<colors.size(); v++)
+    {
+        if (v >= _colors.size() || _colors[v] != colors[v])
+            _recolored << v;
+        if (colors[v] < 0)
+            continue;
+        if (colors[v] >= _colorCounts.size())
+            _colorCounts.resize(colors[v] + 1);
+        _colorCounts[colors[v]]++;
+    }
+    _colors = colors;
+    _compactNbColors = nbColors();
+}
+
+//******************************************************************************
+/*!
+ * \brief IncrementalColoring::addVertices method adds isolated vertices with color 0
+ * \return id of the first added vertex
+ */
+int IncrementalColoring::addVertices(int count)
+{
+    _recolored.clear();
+    int first = nbVertices();
+    for (int i=0; i<count; i++)
+    {
+        _neighbors << QVector<int>();
+        _colors << -1;
+        setColor(first + i, 0);
+    }
+    return first;
+}
+
+//******************************************************************************
+/*!
+ * \brief IncrementalColoring::addEdge method adds the edge a-b and repairs a color conflict, O(degree)
+ * \return false if the edge exists, is a self-loop or an endpoint is invalid or removed
+ */
+bool IncrementalColoring::addEdge(int a, int b)
+{
+    _recolored.clear();
+    int n = nbVertices();
+    if (a < 0 || a >= n || b < 0 || b >= n || a == b || _colors[a] < 0 || _colors[b] < 0)
+        return false;
+    bool exists = _neighbors[a].size() <= _neighbors[b].size() ?
+                _neighbors[a].contains(b) : _neighbors[b].contains(a);
+    if (exists)
+        return false;
+
+    _neighbors[a] << b;
+    _neighbors[b] << a;
+    if (_job)
+        _addedEdges << qMakePair(a, b);
+    if (_colors[a] == _colors[b])
+    {
+        int v = _neighbors[a].size() <= _neighbors[b].size() ? a : b;
+        setColor(v, smallestFreeColor(v));
+    }
+    return true;
+}
+
+//******************************************************************************
+/*!
+ * \brief IncrementalColoring::removeEdge method removes the edge a-b, the endpoints take a smaller free color if any
+ */
+bool IncrementalColoring::removeEdge(int a, int b)
+{
+    _recolored.clear();
+    int n = nbVertices();
+    if (a < 0 || a >= n || b < 0 || b >= n)
+        return false;
+    int index = _neighbors[a].indexOf(b);
+    if (index < 0)
+        return false;
+    _neighbors[a].remove(index);
+    _neighbors[b].remove(_neighbors[b].indexOf(a));
+    lowerColor(a);
+    lowerColor(b);
+    return true;
+}
+
+//******************************************************************************
+/*!
+ * \brief IncrementalColoring::removeVertex method removes the edges of v and marks it removed (color -1), ids do not change
+ */
+void IncrementalColoring::removeVertex(int v)
+{
+    _recolored.clear();
+    if (v < 0 || v >= nbVertices() || _colors[v] < 0)
+        return;
+    QVector<int> neighbors = _neighbors[v];
+    _neighbors[v].clear();
+    foreach (int u, neighbors)
+        _neighbors[u].remove(_neighbors[u].indexOf(v));
+    setColor(v, -1);
+    foreach (int u, neighbors)
+        lowerColor(u);
+}
+
+//******************************************************************************
+
+bool IncrementalColoring::isValid() const
+{
+    for (int v=0; v<nbVertices(); v++)
+    {
+        if (_colors[v] < 0 && !_neighbors[v].isEmpty())
+            return false;
+        foreach (int u, _neighbors[v])
+        {
+            if (_colors[u] == _colors[v])
+                return false;
+        }
+    }
+    return true;
+}
+
+//******************************************************************************
+/*!
+ * \brief IncrementalColoring::recompact method recomputes the GreedyGraphColoring colors
+ */
+void IncrementalColoring::recompact()
+{
+    GT_PROFILE_SCOPE("IncrementalColoring::recompact");
+    if (_job)
+        finishRecompaction(true);
+    QVector<int> colors = _colors;
+    FirstFitColoring(_neighbors, &colors);
+    adopt(colors);
+}
+
+//******************************************************************************
+/*!
+ * \brief IncrementalColoring::needsRecompaction method returns true if local repairs added a quarter more colors (at least 2) than the last full coloring
+ */
+bool IncrementalColoring::needsRecompaction() const
+{
+    return !_job && nbColors() > _compactNbColors + qMax(2, _compactNbColors / 4);
+}
+
+//******************************************************************************
+/*!
+ * \brief IncrementalColoring::startRecompaction method starts the full coloring of the current edges in a thread
+ * \return false if a recompaction is running
+ */
+bool IncrementalColoring::startRecompaction()
+{
+    if (_job)
+        return false;
+    _addedEdges.clear();
+    _job = new RecompactionJob(_neighbors, _colors);
+    _job->start();
+    return true;
+}
+
+//******************************************************************************
+/*!
+ * \brief IncrementalColoring::finishRecompaction method adopts the colors of a finished recompaction
+ * \param wait wait for the recompaction to finish
+ * \return false if no recompaction is running, or if it is not finished and wait is false
+ *
+ * Vertices added or removed meanwhile keep their state, then the conflicts of the edges added
+ * meanwhile are repaired as in addEdge. recolored() gives the vertices whose color changed.
+ */
+bool IncrementalColoring::finishRecompaction(bool wait)
+{
+    if (!_job || (!wait && !_job->isFinished()))
+        return false;
+    _job->wait();
+    QVector<int> colors = _job->colors();
+    delete _job;
+    _job = 0;
+
+    for (int v=0; v<nbVertices(); v++)
+    {
+        if (v >= colors.size())
+            colors << _colors[v];
+        else if (_colors[v] < 0)
+            colors[v] = -1;
+    }
+    adopt(colors);
+
+    for (int i=0; i<_addedEdges.size(); i++)
+    {
+        int a = _addedEdges[i].first;
+        int b = _addedEdges[i].second;
+        if (_colors[a] >= 0 && _colors[a] == _colors[b] && _neighbors[a].contains(b))
+        {
+            int v = _neighbors[a].size() <= _neighbors[b].size() ? a : b;
+            setColor(v, smallestFreeColor(v));
+        }
+    }
+    _addedEdges.clear();
+    _compactNbColors = nbColors();
+    return true;
+}
+
+//******************************************************************************
+
+}
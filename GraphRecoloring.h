@@ -0,0 +1,89 @@
+#ifndef GRAPHRECOLORING_H
+#define GRAPHRECOLORING_H
+
+// Qt
+#include <QVector>
+#include <QPair>
+
+//******************************************************************************
+
+namespace GT {
+
+struct Graph;
+class RecompactionJob;
+
+//******************************************************************************
+/*!
+ * \brief IncrementalColoring class keeps a valid vertex coloring while vertices and edges are added or removed
+ *
+ * Edges are conflicts in both directions, as in ColorGraph. An added edge between two vertices
+ * of the same color recolors the endpoint of smaller degree with the smallest color unused by
+ * its neighbors : no other vertex changes, the cost is O(degree). A removed edge or vertex lets
+ * the endpoints or the neighbors take a smaller free color.
+ *
+ * Local repairs may use more colors than a full greedy coloring. recompact() recomputes the
+ * GreedyGraphColoring colors, startRecompaction() does it in a thread on a copy of the
+ * adjacency while edits go on, and finishRecompaction() adopts the result and repairs the
+ * edges added meanwhile.
+ */
+class IncrementalColoring
+{
+public:
+    IncrementalColoring();
+    ~IncrementalColoring();
+
+    void clear();
+    void build(const Graph & graph, bool useGraphColors=false);
+
+    int addVertices(int count);
+    bool addEdge(int a, int b);
+    bool removeEdge(int a, int b);
+    void removeVertex(int v);
+
+    int nbVertices() const
+    { return _colors.size(); }
+    int color(int v) const
+    { return _colors[v]; }
+    const QVector<int> & colors() const
+    { return _colors; }
+    int nbColors() const
+    { return _colorCounts.size(); }
+    //! vertices whose color changed during the last edit
+    const QVector<int> & recolored() const
+    { return _recolored; }
+    bool isValid() const;
+
+    void recompact();
+    bool needsRecompaction() const;
+    bool startRecompaction();
+    bool finishRecompaction(bool wait=false);
+    bool isRecompacting() const
+    { return _job != 0; }
+
+private:
+    Q_DISABLE_COPY(IncrementalColoring)
+
+    void setColor(int v, int color);
+    int smallestFreeColor(int v);
+    void lowerColor(int v);
+    void adopt(const QVector<int> & colors);
+
+    QVector< QVector<int> > _neighbors;
+    QVector<int> _colors; //!< -1 for removed vertices
+    QVector<int> _colorCounts; //!< vertices of each color, the last one is not 0
+    QVector<int> _marks; //!< scratch of smallestFreeColor
+    int _stamp;
+    QVector<int> _recolored;
+    int _compactNbColors; //!< number of colors after the last full coloring
+
+    RecompactionJob * _job;
+    QVector< QPair<int, int> > _addedEdges; //!< edges added since the recompaction started
+};
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHRECOLORING_H
@@ -0,0 +1,286 @@
+
+// Qt
+#include <QThread>
+
+// Project
+#include "GraphScheduler.h"
+#include "GraphProfiler.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+CancellationToken::CancellationToken() :
+    _cancelled(0),
+    _deadline(-1)
+{
+    _timer.start();
+}
+
+//******************************************************************************
+
+void CancellationToken::reset()
+{
+    _deadline = -1;
+    _cancelled.storeRelease(0);
+}
+
+//******************************************************************************
+
+void CancellationToken::setDeadline(int milliseconds)
+{
+    _timer.start();
+    _deadline = milliseconds > 0 ? milliseconds : -1;
+}
+
+//******************************************************************************
+
+bool CancellationToken::isCancelled() const
+{
+    if (_cancelled.loadAcquire())
+        return true;
+    if (_deadline >= 0 && _timer.elapsed() >= _deadline)
+    {
+        _cancelled.storeRelease(1);
+        return true;
+    }
+    return false;
+}
+
+//******************************************************************************
+/*!
+ * \brief ParallelForStatistics::imbalance method returns the busy time of the slowest worker over the mean busy time, 1 for a perfect balance
+ */
+double ParallelForStatistics::imbalance() const
+{
+    qint64 total = 0;
+    qint64 maximum = 0;
+    foreach (qint64 busy, workerBusyNs)
+    {
+        total += busy;
+        maximum = qMax(maximum, busy);
+    }
+    if (total == 0)
+        return 1.0;
+    return double(maximum) * workerBusyNs.size() / total;
+}
+
+//******************************************************************************
+
+struct ParallelRange
+{
+    ParallelRange(int begin, int end) :
+        begin(begin), end(end)
+    {}
+    int begin;
+    int end;
+};
+
+//******************************************************************************
+/*!
+ * \brief ParallelLoop class is the state of a RunParallelFor shared by the workers
+ *
+ * remaining counts the items not processed yet, the workers stop when it reaches 0 or when
+ * the loop is cancelled.
+ */
+class ParallelLoop
+{
+public:
+    ParallelLoop(const ThreadPool & pool, int size, RangeTask * task, int grain, const CancellationToken * cancellation);
+    ~ParallelLoop();
+
+    void run(int worker);
+    bool isCancelled() const
+    { return _isCancelled.loadAcquire() != 0; }
+    void collect(ParallelForStatistics * statistics) const;
+
+private:
+    Q_DISABLE_COPY(ParallelLoop)
+
+    struct WorkerCounters
+    {
+        WorkerCounters() :
+            items(0), busyNs(0), chunks(0), splits(0), steals(0)
+        {}
+        qint64 items;
+        qint64 busyNs;
+        int chunks;
+        int splits;
+        int steals;
+        char padding[64]; //!< counters of two workers are not on the same cache line
+    };
+
+    ParallelRange * steal(int worker);
+    void process(ParallelRange * range, int worker, int * grain);
+
+    int _size;
+    RangeTask * _task;
+    int _fixedGrain;
+    const CancellationToken * _cancellation;
+    QVector<WorkStealingDeque<ParallelRange>*> _deques;
+    QVector<WorkerCounters> _counters;
+    QAtomicInt _remaining;
+    QAtomicInt _isCancelled;
+};
+
+//******************************************************************************
+/*!
+ * \brief ParallelLoop::ParallelLoop method gives each worker its ThreadPool::workerRange part of the range
+ */
+ParallelLoop::ParallelLoop(const ThreadPool & pool, int size, RangeTask * task, int grain, const CancellationToken * cancellation) :
+    _size(size),
+    _task(task),
+    _fixedGrain(grain),
+    _cancellation(cancellation),
+    _counters(pool.nbThreads()),
+    _remaining(size),
+    _isCancelled(0)
+{
+    for (int worker=0; worker<pool.nbThreads(); worker++)
+    {
+        _deques << new WorkStealingDeque<ParallelRange>();
+        int begin, end;
+        pool.workerRange(worker, size, &begin, &end);
+        if (begin < end)
+            _deques[worker]->push(new ParallelRange(begin, end));
+    }
+}
+
+//******************************************************************************
+
+ParallelLoop::~ParallelLoop()
+{
+    // ranges left by a cancellation
+    foreach (WorkStealingDeque<ParallelRange> * deque, _deques)
+    {
+        while (deque->size() > 0)
+            delete deque->pop();
+    }
+    qDeleteAll(_deques);
+}
+
+//******************************************************************************
+
+void ParallelLoop::run(int worker)
+{
+    WorkStealingDeque<ParallelRange> & deque = *_deques[worker];
+    int grain = _fixedGrain > 0 ? _fixedGrain : 1;
+    while (true)
+    {
+        ParallelRange * range = deque.pop();
+        if (!range)
+            range = steal(worker);
+        if (range)
+        {
+            process(range, worker, &grain);
+            delete range;
+            continue;
+        }
+        if (_remaining.loadAcquire() == 0 || isCancelled())
+            break;
+        QThread::yieldCurrentThread();
+    }
+}
+
+//******************************************************************************
+
+ParallelRange * ParallelLoop::steal(int worker)
+{
+    int nbWorkers = _deques.size();
+    for (int i=1; i<nbWorkers; i++)
+    {
+        ParallelRange * range = _deques[(worker + i) % nbWorkers]->steal();
+        if (range)
+        {
+            _counters[worker].steals++;
+            return range;
+        }
+    }
+    return 0;
+}
+
+//******************************************************************************
+/*!
+ * \brief ParallelLoop::process method runs the chunks of a range, the upper half is pushed for the thieves whenever the deque is empty
+ */
+void ParallelLoop::process(ParallelRange * range, int worker, int * grain)
+{
+    WorkStealingDeque<ParallelRange> & deque = *_deques[worker];
+    WorkerCounters & counters = _counters[worker];
+    QElapsedTimer timer;
+    while (range->begin < range->end)
+    {
+        if (isCancelled() || (_cancellation && _cancellation->isCancelled()))
+        {
+            _isCancelled.storeRelease(1);
+            return;
+        }
+
+        // lazy binary splitting
+        while (range->end - range->begin > 2 * (*grain) && deque.size() == 0)
+        {
+            int middle = range->begin + (range->end - range->begin) / 2;
+            deque.push(new ParallelRange(middle, range->end));
+            range->end = middle;
+            counters.splits++;
+        }
+
+        int end = qMin(range->end, range->begin + *grain);
+        timer.start();
+        _task->run(range->begin, end, worker);
+        qint64 ns = timer.nsecsElapsed();
+        counters.busyNs += ns;
+        counters.items += end - range->begin;
+        counters.chunks++;
+        _remaining.fetchAndAddOrdered(range->begin - end);
+        range->begin = end;
+
+        if (_fixedGrain <= 0)
+        {
+            if (ns < PARALLEL_FOR_CHUNK_NS / 2 && *grain < _size)
+                *grain *= 2;
+            else if (ns > 2 * PARALLEL_FOR_CHUNK_NS && *grain > 1)
+                *grain /= 2;
+        }
+    }
+}
+
+//******************************************************************************
+
+void ParallelLoop::collect(ParallelForStatistics * statistics) const
+{
+    *statistics = ParallelForStatistics();
+    foreach (const WorkerCounters & counters, _counters)
+    {
+        statistics->nbChunks += counters.chunks;
+        statistics->nbSplits += counters.splits;
+        statistics->nbSteals += counters.steals;
+        statistics->workerItems << counters.items;
+        statistics->workerBusyNs << counters.busyNs;
+    }
+}
+
+//******************************************************************************
+
+bool RunParallelFor(ThreadPool & pool, int size, RangeTask * task, int grain,
+                    const CancellationToken * cancellation, ParallelForStatistics * statistics)
+{
+    GT_PROFILE_SCOPE("ParallelFor");
+    ParallelLoop loop(pool, qMax(0, size), task, grain, cancellation);
+    if (size > 0)
+    {
+        RunParallel(pool, [&](int worker)
+        {
+            loop.run(worker);
+        });
+    }
+    if (statistics)
+        loop.collect(statistics);
+    return !loop.isCancelled() && !(cancellation && cancellation->isCancelled());
+}
+
+//******************************************************************************
+
+}
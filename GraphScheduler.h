@@ -0,0 +1,281 @@
+#ifndef GRAPHSCHEDULER_H
+#define GRAPHSCHEDULER_H
+
+// Qt
+#include <QVector>
+#include <QList>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QElapsedTimer>
+#include <QtAlgorithms>
+
+// Project
+#include "GraphThreadPool.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+static const qint64 PARALLEL_FOR_CHUNK_NS = 50000; //!< target duration of an adaptive ParallelFor chunk
+
+//******************************************************************************
+/*!
+ * \brief CancellationToken class tells long computations to stop, it is cancelled explicitly or once its deadline is passed
+ *
+ * cancel() may be called from any thread, e.g. the GUI thread while a job runs.
+ */
+class CancellationToken
+{
+public:
+    CancellationToken();
+
+    void reset();
+    void cancel()
+    { _cancelled.storeRelease(1); }
+    //! from now, 0 for none, to be set before the computation starts
+    void setDeadline(int milliseconds);
+    bool isCancelled() const;
+
+private:
+    Q_DISABLE_COPY(CancellationToken)
+
+    mutable QAtomicInt _cancelled;
+    QElapsedTimer _timer;
+    qint64 _deadline; //!< milliseconds of _timer, -1 for none
+};
+
+//******************************************************************************
+/*!
+ * \brief WorkStealingDeque class is the Chase-Lev deque of one worker
+ *
+ * The owner pushes and pops at the bottom (newest item), any other thread steals at the top
+ * (oldest item). Only the last item is contended, the owner and a thief race on the top index.
+ * steal() returns 0 when the deque is empty or when it lost a race, the caller tries again.
+ * The ring buffer grows by doubling, the replaced buffers are kept until destruction because
+ * a thief may still read them. Items are not owned.
+ */
+template<class T>
+class WorkStealingDeque
+{
+public:
+    //! capacity is rounded up to a power of 2
+    explicit WorkStealingDeque(int capacity=64) :
+        _top(0),
+        _bottom(0)
+    {
+        int size = 2;
+        while (size < capacity)
+            size *= 2;
+        _buffer.store(new Buffer(size));
+    }
+    ~WorkStealingDeque()
+    {
+        delete _buffer.load();
+        qDeleteAll(_retired);
+    }
+
+    //! owner only
+    void push(T * item)
+    {
+        int bottom = _bottom.load();
+        int top = _top.loadAcquire();
+        Buffer * buffer = _buffer.load();
+        if (bottom - top >= buffer->capacity - 1)
+        {
+            Buffer * larger = new Buffer(2 * buffer->capacity);
+            for (int i=top; i<bottom; i++)
+                larger->store(i, buffer->load(i));
+            _retired << buffer;
+            _buffer.storeRelease(larger);
+            buffer = larger;
+        }
+        buffer->store(bottom, item);
+        _bottom.storeRelease(bottom + 1);
+    }
+
+    //! owner only
+    T * pop()
+    {
+        int bottom = _bottom.load() - 1;
+        // the ordered exchange is the full barrier between the bottom store and the top load
+        _bottom.fetchAndStoreOrdered(bottom);
+        int top = _top.loadAcquire();
+        if (top > bottom)
+        {
+            _bottom.storeRelease(bottom + 1);
+            return 0;
+        }
+        T * item = _buffer.load()->load(bottom);
+        if (top == bottom)
+        {
+            // last item : race with the thieves
+            if (!_top.testAndSetOrdered(top, top + 1))
+                item = 0;
+            _bottom.storeRelease(bottom + 1);
+        }
+        return item;
+    }
+
+    T * steal()
+    {
+        // the ordered read of top is the full barrier before the bottom load
+        int top = _top.fetchAndAddOrdered(0);
+        int bottom = _bottom.loadAcquire();
+        if (top >= bottom)
+            return 0;
+        T * item = _buffer.loadAcquire()->load(top);
+        if (!_top.testAndSetOrdered(top, top + 1))
+            return 0;
+        return item;
+    }
+
+    //! approximate when other threads steal
+    int size() const
+    { return qMax(0, _bottom.loadAcquire() - _top.loadAcquire()); }
+
+private:
+    Q_DISABLE_COPY(WorkStealingDeque)
+
+    struct Buffer
+    {
+        explicit Buffer(int size) :
+            capacity(size),
+            items(new QAtomicPointer<T>[size])
+        {
+        }
+        ~Buffer()
+        { delete [] items; }
+        T * load(int index) const
+        { return items[index & (capacity - 1)].loadAcquire(); }
+        void store(int index, T * item)
+        { items[index & (capacity - 1)].storeRelease(item); }
+
+        int capacity; //!< power of 2
+        QAtomicPointer<T> * items;
+    };
+
+    QAtomicInt _top;
+    QAtomicInt _bottom;
+    QAtomicPointer<Buffer> _buffer;
+    QList<Buffer*> _retired;
+};
+
+//******************************************************************************
+/*!
+ * \brief WorkerLocal class holds one value per pool worker, e.g. a scratch buffer, each value on its own cache lines
+ */
+template<class T>
+class WorkerLocal
+{
+public:
+    explicit WorkerLocal(const ThreadPool & pool, const T & value=T()) :
+        _slots(pool.nbThreads(), Slot(value))
+    {
+    }
+    int size() const
+    { return _slots.size(); }
+    T & operator[](int worker)
+    { return _slots[worker].value; }
+    const T & operator[](int worker) const
+    { return _slots[worker].value; }
+
+private:
+    struct Slot
+    {
+        Slot()
+        {}
+        explicit Slot(const T & value) :
+            value(value)
+        {}
+        char padding[64]; //!< separates the value from the previous slot
+        T value;
+    };
+    QVector<Slot> _slots;
+};
+
+//******************************************************************************
+/*!
+ * \brief ParallelForStatistics struct describes the scheduling of a ParallelFor
+ */
+struct ParallelForStatistics
+{
+    ParallelForStatistics() :
+        nbChunks(0),
+        nbSplits(0),
+        nbSteals(0)
+    {
+    }
+    double imbalance() const;
+
+    int nbChunks; //!< calls of the function
+    int nbSplits; //!< ranges split to feed the deques
+    int nbSteals;
+    QVector<qint64> workerItems;
+    QVector<qint64> workerBusyNs; //!< time spent in the function
+};
+
+//******************************************************************************
+
+class RangeTask
+{
+public:
+    virtual ~RangeTask() {}
+    virtual void run(int begin, int end, int worker) = 0;
+};
+
+//******************************************************************************
+
+template<class Function>
+class FunctionRangeTask : public RangeTask
+{
+public:
+    explicit FunctionRangeTask(const Function & function) :
+        _function(function)
+    {
+    }
+    void run(int begin, int end, int worker)
+    { _function(begin, end, worker); }
+
+private:
+    Function _function;
+};
+
+//******************************************************************************
+
+bool RunParallelFor(ThreadPool & pool, int size, RangeTask * task, int grain,
+                    const CancellationToken * cancellation, ParallelForStatistics * statistics);
+
+/*!
+ * \brief ParallelFor method runs function(begin, end, worker) on chunks covering [0, size), balanced by work stealing
+ * \param pool the pool whose workers run the chunks, it must not be called from one of them
+ * \param size number of items, e.g. vertices or edges
+ * \param function called concurrently on disjoint chunks
+ * \param grain chunk size, 0 to adapt it to the measured chunk time
+ * \param cancellation optional, chunks not started when it is cancelled are skipped
+ * \param statistics optional
+ * \return false if cancelled
+ *
+ * Each worker starts with a contiguous part of the range in its Chase-Lev deque. A worker
+ * splits its current range in halves while its deque is empty (lazy binary splitting), so the
+ * thieves always find the largest pending ranges and a balanced loop creates few tasks.
+ * The adaptive grain doubles or halves on each worker to keep chunks around
+ * PARALLEL_FOR_CHUNK_NS, which amortizes the scheduling cost of cheap items and still splits
+ * the ranges of expensive items, e.g. high degree vertices.
+ */
+template<class Function>
+bool ParallelFor(ThreadPool & pool, int size, const Function & function, int grain=0,
+                 const CancellationToken * cancellation=0, ParallelForStatistics * statistics=0)
+{
+    FunctionRangeTask<Function> task(function);
+    return RunParallelFor(pool, size, &task, grain, cancellation, statistics);
+}
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHSCHEDULER_H
@@ -0,0 +1,799 @@
+
+// STD
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+// Qt
+#include <QDataStream>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QThread>
+#include <QMutexLocker>
+
+// Project
+#include "GraphServer.h"
+#include "GraphIO.h"
+#include "GraphThreadPool.h"
+#include "GraphScheduler.h"
+#include "GraphProfiler.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+static const quint32 SERVER_QUERY_BYTES = 13; //!< query frame without the size
+static const quint32 SERVER_ANSWER_BYTES = 17; //!< answer frame without the size and the items
+
+typedef QPair<double, int> ServerQueueEntry;
+
+enum ServerThreadRole
+{
+    STR_ACCEPT=0,
+    STR_BATCH,
+    STR_CONNECTION
+};
+
+//******************************************************************************
+
+void SetupServerStream(QDataStream & stream)
+{
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+}
+
+//******************************************************************************
+
+struct PendingQuery
+{
+    PendingQuery() :
+        receivedNs(0),
+        isDone(false)
+    {}
+    ServerQuery query;
+    ServerAnswer answer;
+    qint64 receivedNs;
+    bool isDone;
+};
+
+//******************************************************************************
+/*!
+ * \brief GraphServer::Workspace struct holds the arrays of one search, reset in O(1) by a stamp
+ *
+ * A vertex distance is valid when its stamp is the current one, the arrays are allocated
+ * once for the server lifetime.
+ */
+struct GraphServer::Workspace
+{
+    Workspace() :
+        stamp(0)
+    {}
+    void begin(int nbVertices)
+    {
+        if (stamps.size() != nbVertices || stamp == std::numeric_limits<int>::max())
+        {
+            distances.resize(nbVertices);
+            predecessors.resize(nbVertices);
+            stamps.fill(0, nbVertices);
+            targetStamps.fill(0, nbVertices);
+            stamp = 0;
+        }
+        stamp++;
+        heap.clear();
+    }
+    double distance(int v) const
+    { return stamps[v] == stamp ? distances[v] : std::numeric_limits<double>::max(); }
+    void set(int v, double distance, int predecessor)
+    {
+        stamps[v] = stamp;
+        distances[v] = distance;
+        predecessors[v] = predecessor;
+    }
+
+    QVector<double> distances;
+    QVector<int> predecessors;
+    QVector<int> stamps;
+    QVector<int> targetStamps; //!< targets of the current search not settled yet
+    int stamp;
+    std::vector<ServerQueueEntry> heap;
+};
+
+//******************************************************************************
+
+class GraphServerThread : public QThread
+{
+public:
+    GraphServerThread(GraphServer * server, int role, quintptr descriptor=0) :
+        _server(server),
+        _role(role),
+        _descriptor(descriptor)
+    {
+    }
+
+protected:
+    void run()
+    {
+        if (_role == STR_ACCEPT)
+            _server->acceptConnections();
+        else if (_role == STR_BATCH)
+            _server->processBatches();
+        else
+            _server->serveConnection(_descriptor);
+    }
+
+private:
+    GraphServer * _server;
+    int _role;
+    quintptr _descriptor;
+};
+
+//******************************************************************************
+/*!
+ * \brief GraphServerListener class hands the socket descriptors to the server, each connection is served by its own thread
+ */
+class GraphServerListener : public QLocalServer
+{
+public:
+    explicit GraphServerListener(GraphServer * server) :
+        _server(server)
+    {
+    }
+
+protected:
+    void incomingConnection(quintptr descriptor)
+    { _server->addConnection(descriptor); }
+
+private:
+    GraphServer * _server;
+};
+
+//******************************************************************************
+
+GraphServer::GraphServer(ThreadPool * pool) :
+    _pool(pool ? pool : &ThreadPool::instance()),
+    _maxBatchSize(SERVER_MAX_BATCH),
+    _isRunning(false),
+    _acceptThread(0),
+    _batchThread(0),
+    _isListening(false),
+    _isStopping(false),
+    _isShutdownRequested(false),
+    _nbQueries(0),
+    _nbBatches(0),
+    _nbLatencies(0),
+    _nextLatency(0)
+{
+    for (int i=0; i<_pool->nbThreads(); i++)
+        _workspaces << new Workspace();
+}
+
+//******************************************************************************
+
+GraphServer::~GraphServer()
+{
+    stop();
+    qDeleteAll(_workspaces);
+}
+
+//******************************************************************************
+/*!
+ * \brief GraphServer::load method sets up the graph and computes the components and the greedy coloring
+ */
+bool GraphServer::load(const GraphDocument & doc)
+{
+    GT_PROFILE_SCOPE("GraphServer::load");
+    if (_isRunning)
+    {
+        std::cerr << "The graph of a running server can not be replaced" << std::endl;
+        return false;
+    }
+    if (!SetupGraph(doc, &_graph) || !_csr.build(_graph))
+        return false;
+
+    for (int i=0; i<_graph.vertices.size(); i++)
+        _graph.vertices[i].color = -1;
+    ColorConnectedVertices(_graph, &_components);
+
+    for (int i=0; i<_graph.vertices.size(); i++)
+        _graph.vertices[i].color = -1;
+    GreedyGraphColoring(&_graph);
+    _colors.resize(_graph.vertices.size());
+    for (int i=0; i<_colors.size(); i++)
+        _colors[i] = _graph.vertices[i].color;
+    return true;
+}
+
+//******************************************************************************
+/*!
+ * \brief GraphServer::start method listens on the local socket serverName and starts the server threads
+ */
+bool GraphServer::start(const QString & serverName)
+{
+    if (_isRunning)
+        return false;
+    _serverName = serverName;
+    _isListening = false;
+    _isStopping = false;
+    _isShutdownRequested = false;
+    _nbQueries = 0;
+    _nbBatches = 0;
+    _latenciesNs.fill(0, SERVER_LATENCY_WINDOW);
+    _nbLatencies = 0;
+    _nextLatency = 0;
+    _clock.start();
+
+    _acceptThread = new GraphServerThread(this, STR_ACCEPT);
+    _acceptThread->start();
+    bool isListening = false;
+    {
+        QMutexLocker locker(&_mutex);
+        while (!_isListening && !_acceptThread->isFinished())
+            _stateChanged.wait(&_mutex, SERVER_POLL_MS);
+        isListening = _isListening;
+    }
+    if (!isListening)
+    {
+        _acceptThread->wait();
+        delete _acceptThread;
+        _acceptThread = 0;
+        return false;
+    }
+
+    _batchThread = new GraphServerThread(this, STR_BATCH);
+    _batchThread->start();
+    _isRunning = true;
+    return true;
+}
+
+//******************************************************************************
+/*!
+ * \brief GraphServer::stop method answers the queued queries and joins the threads
+ */
+void GraphServer::stop()
+{
+    if (!_isRunning)
+        return;
+    {
+        QMutexLocker locker(&_mutex);
+        _isStopping = true;
+        _queryAdded.wakeAll();
+        _stateChanged.wakeAll();
+    }
+    _acceptThread->wait();
+    delete _acceptThread;
+    _acceptThread = 0;
+    _batchThread->wait();
+    delete _batchThread;
+    _batchThread = 0;
+
+    QList<GraphServerThread*> connections;
+    {
+        QMutexLocker locker(&_mutex);
+        connections.swap(_connections);
+    }
+    foreach (GraphServerThread * connection, connections)
+        connection->wait();
+    qDeleteAll(connections);
+    _isRunning = false;
+}
+
+//******************************************************************************
+
+void GraphServer::waitForShutdown()
+{
+    QMutexLocker locker(&_mutex);
+    while (!_isShutdownRequested && !_isStopping)
+        _stateChanged.wait(&_mutex);
+}
+
+//******************************************************************************
+
+ServerStatistics GraphServer::statistics() const
+{
+    ServerStatistics statistics;
+    QVector<qint64> latencies;
+    {
+        QMutexLocker locker(&_mutex);
+        statistics.nbQueries = _nbQueries;
+        statistics.nbBatches = _nbBatches;
+        foreach (GraphServerThread * connection, _connections)
+            statistics.nbConnections += connection->isFinished() ? 0 : 1;
+        latencies = _latenciesNs.mid(0, _nbLatencies);
+    }
+    statistics.queriesPerSecond = statistics.nbQueries * 1e9 / qMax(qint64(1), _clock.nsecsElapsed());
+    if (!latencies.isEmpty())
+    {
+        qint64 * begin = latencies.data();
+        qint64 * end = begin + latencies.size();
+        qint64 * p50 = begin + latencies.size() / 2;
+        qint64 * p99 = begin + qMin(latencies.size() - 1, latencies.size() * 99 / 100);
+        std::nth_element(begin, p50, end);
+        statistics.p50Us = *p50 * 1e-3;
+        std::nth_element(begin, p99, end);
+        statistics.p99Us = *p99 * 1e-3;
+    }
+    return statistics;
+}
+
+//******************************************************************************
+
+void GraphServer::recordLatency(qint64 ns)
+{
+    _latenciesNs[_nextLatency] = ns;
+    _nextLatency = (_nextLatency + 1) % _latenciesNs.size();
+    _nbLatencies = qMin(_nbLatencies + 1, _latenciesNs.size());
+}
+
+//******************************************************************************
+/*!
+ * \brief GraphServer::acceptConnections method, on the accept thread, listens until stop()
+ */
+void GraphServer::acceptConnections()
+{
+    GraphServerListener listener(this);
+    QLocalServer::removeServer(_serverName);
+    bool isListening = listener.listen(_serverName);
+    {
+        QMutexLocker locker(&_mutex);
+        _isListening = isListening;
+        _stateChanged.wakeAll();
+    }
+    if (!isListening)
+    {
+        std::cerr << "Failed to listen on " << _serverName.toLocal8Bit().constData() << std::endl;
+        return;
+    }
+
+    forever
+    {
+        {
+            QMutexLocker locker(&_mutex);
+            if (_isStopping)
+                break;
+        }
+        listener.waitForNewConnection(SERVER_POLL_MS);
+    }
+    listener.close();
+}
+
+//******************************************************************************
+
+void GraphServer::addConnection(quintptr descriptor)
+{
+    QMutexLocker locker(&_mutex);
+    for (int i=_connections.size()-1; i>=0; i--)
+    {
+        if (_connections[i]->isFinished())
+            delete _connections.takeAt(i);
+    }
+    GraphServerThread * connection = new GraphServerThread(this, STR_CONNECTION, descriptor);
+    _connections << connection;
+    connection->start();
+}
+
+//******************************************************************************
+/*!
+ * \brief GraphServer::serveConnection method, on the thread of a connection, reads the queries and writes the answers
+ *
+ * All the complete query frames available are queued together, the answers are written
+ * once they are all processed.
+ */
+void GraphServer::serveConnection(quintptr descriptor)
+{
+    QLocalSocket socket;
+    if (!socket.setSocketDescriptor(descriptor))
+        return;
+
+    QByteArray input;
+    QList<PendingQuery*> pending;
+    while (socket.state() == QLocalSocket::ConnectedState)
+    {
+        {
+            QMutexLocker locker(&_mutex);
+            if (_isStopping)
+                break;
+        }
+        if (socket.bytesAvailable() == 0 && !socket.waitForReadyRead(SERVER_POLL_MS))
+            continue;
+        input.append(socket.readAll());
+        qint64 receivedNs = _clock.nsecsElapsed();
+
+        QDataStream stream(input);
+        SetupServerStream(stream);
+        int position = 0;
+        bool isValid = true;
+        while (input.size() - position >= int(4 + SERVER_QUERY_BYTES))
+        {
+            quint32 size = 0;
+            stream >> size;
+            if (size != SERVER_QUERY_BYTES)
+            {
+                isValid = false;
+                break;
+            }
+            PendingQuery * query = new PendingQuery();
+            stream >> query->query.id >> query->query.type >> query->query.a >> query->query.b;
+            query->receivedNs = receivedNs;
+            pending << query;
+            position += 4 + SERVER_QUERY_BYTES;
+        }
+        input.remove(0, position);
+        if (!isValid)
+        {
+            std::cerr << "Invalid query frame, connection closed" << std::endl;
+            break;
+        }
+        if (pending.isEmpty())
+            continue;
+
+        bool isShutdown = false;
+        {
+            QMutexLocker locker(&_mutex);
+            if (_isStopping)
+            {
+                foreach (PendingQuery * query, pending)
+                {
+                    query->answer.status = SS_STOPPING;
+                    query->isDone = true;
+                }
+            }
+            else
+            {
+                _queue << pending;
+                _queryAdded.wakeOne();
+            }
+            // batches are taken in queue order and processed one at a time
+            while (!pending.last()->isDone)
+                _queryDone.wait(&_mutex);
+        }
+
+        QByteArray output;
+        QDataStream answers(&output, QIODevice::WriteOnly);
+        SetupServerStream(answers);
+        foreach (PendingQuery * query, pending)
+        {
+            const ServerAnswer & answer = query->answer;
+            answers << quint32(SERVER_ANSWER_BYTES + 4 * answer.items.size()) << query->query.id << answer.status
+                    << answer.value << quint32(answer.items.size());
+            for (int i=0; i<answer.items.size(); i++)
+                answers << qint32(answer.items[i]);
+            isShutdown |= query->query.type == SQ_SHUTDOWN;
+        }
+        bool isWritten = socket.write(output) == output.size();
+        while (isWritten && socket.bytesToWrite() > 0)
+            isWritten = socket.waitForBytesWritten(SERVER_TIMEOUT_MS);
+
+        {
+            QMutexLocker locker(&_mutex);
+            qint64 answeredNs = _clock.nsecsElapsed();
+            foreach (PendingQuery * query, pending)
+                recordLatency(answeredNs - query->receivedNs);
+            if (isShutdown)
+            {
+                _isShutdownRequested = true;
+                _stateChanged.wakeAll();
+            }
+        }
+        qDeleteAll(pending);
+        pending.clear();
+        if (!isWritten)
+            break;
+    }
+    socket.disconnectFromServer();
+}
+
+//******************************************************************************
+/*!
+ * \brief GraphServer::processBatches method, on the batch thread, processes the queued queries until stop()
+ *
+ * The queries queued while a batch is processed form the next batch.
+ */
+void GraphServer::processBatches()
+{
+    QList<PendingQuery*> batch;
+    QVector<const ServerQuery*> queries;
+    QVector<ServerAnswer*> answers;
+    forever
+    {
+        {
+            QMutexLocker locker(&_mutex);
+            while (_queue.isEmpty() && !_isStopping)
+                _queryAdded.wait(&_mutex);
+            if (_queue.isEmpty())
+                return;
+            int size = qMin(_queue.size(), _maxBatchSize);
+            batch = _queue.mid(0, size);
+            _queue.erase(_queue.begin(), _queue.begin() + size);
+        }
+
+        queries.resize(batch.size());
+        answers.resize(batch.size());
+        for (int i=0; i<batch.size(); i++)
+        {
+            queries[i] = &batch[i]->query;
+            answers[i] = &batch[i]->answer;
+        }
+        processBatch(queries, &answers);
+
+        QMutexLocker locker(&_mutex);
+        foreach (PendingQuery * query, batch)
+            query->isDone = true;
+        _nbQueries += batch.size();
+        _nbBatches++;
+        _queryDone.wakeAll();
+    }
+}
+
+//******************************************************************************
+/*!
+ * \brief GraphServer::processBatch method answers a batch, shortest path queries are grouped by source
+ *
+ * Each group is one search, the groups run in parallel on the pool. A batch of one group runs
+ * in the calling thread, which keeps the latency of a lone query low.
+ */
+void GraphServer::processBatch(const QVector<const ServerQuery*> & queries, QVector<ServerAnswer*> * answers)
+{
+    GT_PROFILE_SCOPE("GraphServer::processBatch");
+    int n = nbVertices();
+    QVector<QPair<int, int> > pathQueries; //!< source, query index
+    for (int i=0; i<queries.size(); i++)
+    {
+        const ServerQuery & query = *queries[i];
+        ServerAnswer & answer = *(*answers)[i];
+        answer.id = query.id;
+        answer.status = SS_OK;
+        answer.value = 0.0;
+        answer.items.clear();
+
+        bool isVertexValid = query.a >= 0 && query.a < n;
+        if (query.type == SQ_SHORTEST_PATH && isVertexValid && query.b >= 0 && query.b < n)
+        {
+            pathQueries << qMakePair(int(query.a), i);
+        }
+        else if (query.type == SQ_COMPONENT && isVertexValid)
+        {
+            answer.value = _components.label(query.a);
+        }
+        else if (query.type == SQ_COLOR && isVertexValid)
+        {
+            answer.value = _colors[query.a];
+        }
+        else if (query.type == SQ_STATISTICS)
+        {
+            ServerStatistics statistics = this->statistics();
+            answer.value = statistics.queriesPerSecond;
+            answer.items << int(qMin(statistics.nbQueries, qint64(std::numeric_limits<int>::max())))
+                         << int(qMin(statistics.nbBatches, qint64(std::numeric_limits<int>::max())))
+                         << qRound(statistics.p50Us) << qRound(statistics.p99Us) << statistics.nbConnections;
+        }
+        else if (query.type != SQ_SHUTDOWN)
+        {
+            answer.status = SS_INVALID;
+        }
+    }
+    if (pathQueries.isEmpty())
+        return;
+
+    std::sort(pathQueries.begin(), pathQueries.end());
+    QVector<int> groupStarts;
+    for (int i=0; i<pathQueries.size(); i++)
+    {
+        if (i == 0 || pathQueries[i].first != pathQueries[i-1].first)
+            groupStarts << i;
+    }
+    groupStarts << pathQueries.size();
+
+    auto searchGroups = [&](int begin, int end, int worker)
+    {
+        QVector<int> targets;
+        QVector<double> distances;
+        QVector<QVector<int> > paths;
+        for (int g=begin; g<end; g++)
+        {
+            targets.clear();
+            for (int i=groupStarts[g]; i<groupStarts[g+1]; i++)
+                targets << queries[pathQueries[i].second]->b;
+            shortestPaths(worker, pathQueries[groupStarts[g]].first, targets, &distances, &paths);
+            for (int i=groupStarts[g]; i<groupStarts[g+1]; i++)
+            {
+                ServerAnswer & answer = *(*answers)[pathQueries[i].second];
+                int t = i - groupStarts[g];
+                answer.value = distances[t];
+                answer.items = paths[t];
+                if (distances[t] == std::numeric_limits<double>::max())
+                    answer.status = SS_NO_PATH;
+            }
+        }
+    };
+    int nbGroups = groupStarts.size() - 1;
+    if (nbGroups == 1)
+        searchGroups(0, 1, 0);
+    else
+        ParallelFor(*_pool, nbGroups, searchGroups, 1);
+}
+
+//******************************************************************************
+/*!
+ * \brief GraphServer::shortestPaths method runs one Dijkstra search from source until all the targets are settled
+ */
+void GraphServer::shortestPaths(int worker, int source, const QVector<int> & targets, QVector<double> * distances,
+                                QVector<QVector<int> > * paths)
+{
+    Workspace & workspace = *_workspaces[worker];
+    workspace.begin(nbVertices());
+    int nbTargets = 0;
+    foreach (int target, targets)
+    {
+        if (workspace.targetStamps[target] != workspace.stamp)
+        {
+            workspace.targetStamps[target] = workspace.stamp;
+            nbTargets++;
+        }
+    }
+
+    std::vector<ServerQueueEntry> & heap = workspace.heap;
+    std::greater<ServerQueueEntry> compare;
+    workspace.set(source, 0.0, -1);
+    heap.push_back(ServerQueueEntry(0.0, source));
+    while (!heap.empty() && nbTargets > 0)
+    {
+        std::pop_heap(heap.begin(), heap.end(), compare);
+        ServerQueueEntry entry = heap.back();
+        heap.pop_back();
+        int v = entry.second;
+        if (entry.first > workspace.distance(v))
+            continue;
+        if (workspace.targetStamps[v] == workspace.stamp)
+        {
+            // settled target
+            workspace.targetStamps[v] = workspace.stamp - 1;
+            nbTargets--;
+        }
+        for (CsrGraph::NeighborIterator it = _csr.neighbors(v); !it.atEnd(); it.next())
+        {
+            double distance = entry.first + it.weight();
+            if (distance < workspace.distance(it.target()))
+            {
+                workspace.set(it.target(), distance, v);
+                heap.push_back(ServerQueueEntry(distance, it.target()));
+                std::push_heap(heap.begin(), heap.end(), compare);
+            }
+        }
+    }
+
+    distances->resize(targets.size());
+    paths->resize(targets.size());
+    for (int i=0; i<targets.size(); i++)
+    {
+        QVector<int> & path = (*paths)[i];
+        path.clear();
+        (*distances)[i] = workspace.distance(targets[i]);
+        if ((*distances)[i] == std::numeric_limits<double>::max())
+            continue;
+        for (int v=targets[i]; v != -1; v=workspace.predecessors[v])
+            path << v;
+        std::reverse(path.begin(), path.end());
+    }
+}
+
+//******************************************************************************
+
+GraphClient::GraphClient() :
+    _socket(0)
+{
+}
+
+//******************************************************************************
+
+GraphClient::~GraphClient()
+{
+    disconnectFromServer();
+}
+
+//******************************************************************************
+
+bool GraphClient::connectToServer(const QString & serverName, int timeoutMs)
+{
+    disconnectFromServer();
+    _socket = new QLocalSocket();
+    _socket->connectToServer(serverName);
+    if (!_socket->waitForConnected(timeoutMs))
+    {
+        std::cerr << "Failed to connect to " << serverName.toLocal8Bit().constData() << std::endl;
+        disconnectFromServer();
+        return false;
+    }
+    return true;
+}
+
+//******************************************************************************
+
+void GraphClient::disconnectFromServer()
+{
+    if (!_socket)
+        return;
+    _socket->disconnectFromServer();
+    delete _socket;
+    _socket = 0;
+    _output.clear();
+    _input.clear();
+}
+
+//******************************************************************************
+
+void GraphClient::send(const ServerQuery & query)
+{
+    QDataStream stream(&_output, QIODevice::Append);
+    SetupServerStream(stream);
+    stream << SERVER_QUERY_BYTES << query.id << query.type << query.a << query.b;
+}
+
+//******************************************************************************
+
+bool GraphClient::flush()
+{
+    if (!_socket)
+        return false;
+    if (_output.isEmpty())
+        return true;
+    bool ok = _socket->write(_output) == _output.size();
+    _output.clear();
+    while (ok && _socket->bytesToWrite() > 0)
+        ok = _socket->waitForBytesWritten(SERVER_TIMEOUT_MS);
+    return ok;
+}
+
+//******************************************************************************
+
+bool GraphClient::receive(ServerAnswer * answer, int timeoutMs)
+{
+    if (!flush())
+        return false;
+    forever
+    {
+        if (_input.size() >= int(4 + SERVER_ANSWER_BYTES))
+        {
+            QDataStream stream(_input);
+            SetupServerStream(stream);
+            quint32 size = 0;
+            stream >> size;
+            if (size < SERVER_ANSWER_BYTES)
+                return false;
+            if (quint32(_input.size()) >= 4 + size)
+            {
+                quint32 nbItems = 0;
+                stream >> answer->id >> answer->status >> answer->value >> nbItems;
+                if (size != SERVER_ANSWER_BYTES + 4 * nbItems)
+                    return false;
+                answer->items.resize(nbItems);
+                for (quint32 i=0; i<nbItems; i++)
+                {
+                    qint32 item = 0;
+                    stream >> item;
+                    answer->items[i] = item;
+                }
+                _input.remove(0, 4 + size);
+                return true;
+            }
+        }
+        if (!_socket->waitForReadyRead(timeoutMs))
+            return false;
+        _input.append(_socket->readAll());
+    }
+}
+
+//******************************************************************************
+
+bool GraphClient::query(const ServerQuery & query, ServerAnswer * answer)
+{
+    send(query);
+    return receive(answer);
+}
+
+//******************************************************************************
+
+}
@@ -0,0 +1,236 @@
+#ifndef GRAPHSERVER_H
+#define GRAPHSERVER_H
+
+// Qt
+#include <QVector>
+#include <QList>
+#include <QString>
+#include <QByteArray>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+
+// Project
+#include "GraphTools.h"
+#include "GraphCsr.h"
+
+class QLocalSocket;
+
+//******************************************************************************
+
+namespace GT {
+
+struct GraphDocument;
+class ThreadPool;
+class GraphServerThread;
+struct PendingQuery;
+
+//******************************************************************************
+
+static const int SERVER_MAX_BATCH = 256; //!< queries processed together
+static const int SERVER_POLL_MS = 100; //!< the server threads check for stop() at this period
+static const int SERVER_TIMEOUT_MS = 30000; //!< client side
+static const int SERVER_LATENCY_WINDOW = 65536; //!< latest latencies kept for the percentiles
+
+/*!
+ * Queries, a and b are vertex ids :
+ * SQ_SHORTEST_PATH : distance from a to b in value, the path in items
+ * SQ_COMPONENT : connected component label of a in value
+ * SQ_COLOR : greedy coloring color of a in value
+ * SQ_STATISTICS : queries per second in value, items are nbQueries, nbBatches, p50 and p99 latencies (us), nbConnections
+ * SQ_SHUTDOWN : stops the server after the answer
+ */
+enum ServerQueryType
+{
+    SQ_SHORTEST_PATH=1,
+    SQ_COMPONENT,
+    SQ_COLOR,
+    SQ_STATISTICS,
+    SQ_SHUTDOWN
+};
+
+enum ServerStatus
+{
+    SS_OK=0,
+    SS_INVALID,         //!< unknown query or vertex id out of range
+    SS_NO_PATH,
+    SS_STOPPING         //!< the server is stopping, the query was not processed
+};
+
+//******************************************************************************
+/*!
+ * \brief ServerQuery struct is a request frame : size (quint32), id (quint32), type (quint8), a (qint32), b (qint32)
+ *
+ * The id is chosen by the client and copied to the answer, a client may send several queries before reading the answers.
+ */
+struct ServerQuery
+{
+    ServerQuery() :
+        id(0), type(0), a(-1), b(-1)
+    {}
+    ServerQuery(quint32 id, int type, int a, int b=-1) :
+        id(id), type(type), a(a), b(b)
+    {}
+    quint32 id;
+    quint8 type;
+    qint32 a;
+    qint32 b;
+};
+
+//******************************************************************************
+/*!
+ * \brief ServerAnswer struct is an answer frame : size (quint32), id (quint32), status (quint8), value (double), nbItems (quint32), items (qint32)
+ */
+struct ServerAnswer
+{
+    ServerAnswer() :
+        id(0), status(SS_INVALID), value(0.0)
+    {}
+    quint32 id;
+    quint8 status;
+    double value;
+    QVector<int> items;
+};
+
+//******************************************************************************
+
+struct ServerStatistics
+{
+    ServerStatistics() :
+        nbQueries(0),
+        nbBatches(0),
+        nbConnections(0),
+        p50Us(0.0),
+        p99Us(0.0),
+        queriesPerSecond(0.0)
+    {
+    }
+    double meanBatchSize() const
+    { return nbBatches > 0 ? double(nbQueries) / nbBatches : 0.0; }
+
+    qint64 nbQueries;
+    qint64 nbBatches;
+    int nbConnections; //!< open connections
+    double p50Us; //!< from the query frame received to the answer written
+    double p99Us;
+    double queriesPerSecond; //!< since start()
+};
+
+//******************************************************************************
+/*!
+ * \brief GraphServer class answers graph queries from other processes over a local socket
+ *
+ * The graph is loaded once : components and greedy colors are computed at load time, shortest
+ * paths are searched per query by Dijkstra on a CSR copy (loaded weights are not negative).
+ *
+ * One thread per connection reads the query frames and sends the answers. Queries of all
+ * connections go to one queue, the batch thread takes all queued queries (up to maxBatchSize)
+ * as one batch : shortest path queries from the same source share one search, which stops once
+ * all their targets are settled, and the searches run in parallel on the pool with one reused
+ * workspace per worker. Batches form naturally while the previous one is processed, a lone
+ * query does not wait for others.
+ */
+class GraphServer
+{
+public:
+    explicit GraphServer(ThreadPool * pool=0);
+    ~GraphServer();
+
+    bool load(const GraphDocument & doc);
+    int nbVertices() const
+    { return _graph.vertices.size(); }
+
+    bool start(const QString & serverName);
+    void stop();
+    bool isRunning() const
+    { return _isRunning; }
+    //! returns after a SQ_SHUTDOWN query or stop()
+    void waitForShutdown();
+
+    void setMaxBatchSize(int size)
+    { _maxBatchSize = qMax(1, size); }
+    ServerStatistics statistics() const;
+
+    //! answers the queries in the calling thread, without socket
+    void processBatch(const QVector<const ServerQuery*> & queries, QVector<ServerAnswer*> * answers);
+
+private:
+    Q_DISABLE_COPY(GraphServer)
+    friend class GraphServerThread;
+    friend class GraphServerListener;
+
+    void acceptConnections();
+    void addConnection(quintptr descriptor);
+    void serveConnection(quintptr descriptor);
+    void processBatches();
+    void shortestPaths(int worker, int source, const QVector<int> & targets, QVector<double> * distances,
+                       QVector<QVector<int> > * paths);
+    void recordLatency(qint64 ns);
+
+    Graph _graph;
+    CsrGraph _csr;
+    ConnectedComponents _components;
+    QVector<int> _colors;
+    ThreadPool * _pool;
+    int _maxBatchSize;
+
+    struct Workspace;
+    QVector<Workspace*> _workspaces; //!< one per pool worker
+
+    QString _serverName;
+    bool _isRunning;
+    GraphServerThread * _acceptThread;
+    GraphServerThread * _batchThread;
+    QList<GraphServerThread*> _connections;
+    mutable QMutex _mutex;
+    QWaitCondition _stateChanged; //!< listening, shutdown requested
+    QWaitCondition _queryAdded;
+    QWaitCondition _queryDone;
+    QList<PendingQuery*> _queue;
+    bool _isListening;
+    bool _isStopping;
+    bool _isShutdownRequested;
+
+    QElapsedTimer _clock;
+    qint64 _nbQueries;
+    qint64 _nbBatches;
+    QVector<qint64> _latenciesNs; //!< ring of the latest latencies
+    int _nbLatencies;
+    int _nextLatency;
+};
+
+//******************************************************************************
+/*!
+ * \brief GraphClient class sends queries to a GraphServer
+ */
+class GraphClient
+{
+public:
+    GraphClient();
+    ~GraphClient();
+
+    bool connectToServer(const QString & serverName, int timeoutMs=SERVER_TIMEOUT_MS);
+    void disconnectFromServer();
+
+    //! queries are buffered until flush() or receive()
+    void send(const ServerQuery & query);
+    bool flush();
+    //! answers come in the order of the queries of this client
+    bool receive(ServerAnswer * answer, int timeoutMs=SERVER_TIMEOUT_MS);
+    bool query(const ServerQuery & query, ServerAnswer * answer);
+
+private:
+    Q_DISABLE_COPY(GraphClient)
+
+    QLocalSocket * _socket;
+    QByteArray _output;
+    QByteArray _input;
+};
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHSERVER_H
@@ -0,0 +1,377 @@
+
+// STD
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// Qt
+#include <QAtomicInt>
+
+// Project
+#include "GraphSpanningTree.h"
+#include "GraphTools.h"
+#include "GraphUnionFind.h"
+#include "GraphThreadPool.h"
+#include "GraphScheduler.h"
+#include "GraphProfiler.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+static const int FILTER_KRUSKAL_MIN_EDGES = 1 << 12; //!< smaller edge sets are sorted, as are the ones with fewer edges than trees left
+static const int FILTER_KRUSKAL_SAMPLES = 31; //!< the pivot is the median of this sample
+static const int SPANNING_PARALLEL_EDGES = 1 << 16; //!< smaller edge sets are filtered by the calling thread
+
+//******************************************************************************
+/*!
+ * \brief EdgeOrder class compares edges by weight, then by index : a strict total order, the minimum spanning forest is unique
+ */
+class EdgeOrder
+{
+public:
+    explicit EdgeOrder(const double * weights) :
+        _weights(weights)
+    {
+    }
+    bool operator()(int e, int f) const
+    { return _weights[e] < _weights[f] || (_weights[e] == _weights[f] && e < f); }
+
+private:
+    const double * _weights;
+};
+
+//******************************************************************************
+/*!
+ * \brief UpdateLightest method replaces the lightest edge of a component by e if e is lighter, lock-free
+ */
+inline void UpdateLightest(QAtomicInt & lightest, int e, const EdgeOrder & lighter)
+{
+    int current = lightest.loadAcquire();
+    while (current < 0 || lighter(e, current))
+    {
+        if (lightest.testAndSetOrdered(current, e))
+            return;
+        current = lightest.loadAcquire();
+    }
+}
+
+//******************************************************************************
+/*!
+ * \brief BoruvkaForest method is the parallel Boruvka algorithm
+ *
+ * A component is named by one of its vertices. Each round :
+ *  - the active edges are scanned in parallel, each component keeps its lightest edge with a CAS
+ *  - each component points to the component across its lightest edge, these pointers form
+ *    trees with one 2-cycle, where both components picked the same edge : the smaller id of the
+ *    cycle becomes the root, the other pointers are tree edges
+ *  - the vertex labels are replaced by their root in parallel, edges inside a component are
+ *    dropped, each worker compacting its own range of the edge array
+ * The number of components at least halves each round.
+ */
+void BoruvkaForest(int n, const int * ends, const double * weights, int nbEdges, ThreadPool & pool,
+                   SpanningForest * forest)
+{
+    EdgeOrder lighter(weights);
+    int nbWorkers = pool.nbThreads();
+    QVector<int> labels(n);
+    QVector<int> components(n);
+    for (int v=0; v<n; v++)
+    {
+        labels[v] = v;
+        components[v] = v;
+    }
+    QVector<int> active;
+    active.reserve(nbEdges);
+    for (int e=0; e<nbEdges; e++)
+    {
+        if (ends[2*e] != ends[2*e + 1])
+            active << e;
+    }
+    QVector<QAtomicInt> lightest(n, QAtomicInt(-1));
+    QVector<int> successors = components;
+    QVector<int> kept(nbWorkers);
+
+    while (!active.isEmpty())
+    {
+        forest->nbRounds++;
+        const int * label = labels.constData();
+        const int * edges = active.constData();
+        QAtomicInt * best = lightest.data();
+        ParallelFor(pool, active.size(), [&](int begin, int end, int)
+        {
+            for (int i=begin; i<end; i++)
+            {
+                int e = edges[i];
+                UpdateLightest(best[label[ends[2*e]]], e, lighter);
+                UpdateLightest(best[label[ends[2*e + 1]]], e, lighter);
+            }
+        });
+
+        // components without active edge are complete trees
+        int nbComponents = 0;
+        for (int i=0; i<components.size(); i++)
+        {
+            int c = components[i];
+            int e = lightest[c].loadAcquire();
+            if (e < 0)
+                continue;
+            int a = labels[ends[2*e]];
+            successors[c] = a == c ? labels[ends[2*e + 1]] : a;
+            components[nbComponents++] = c;
+        }
+        components.resize(nbComponents);
+
+        for (int i=0; i<nbComponents; i++)
+        {
+            int c = components[i];
+            int s = successors[c];
+            if (successors[s] == c && c < s)
+                continue;
+            forest->edges << lightest[c].loadAcquire();
+        }
+        for (int i=0; i<nbComponents; i++)
+        {
+            int c = components[i];
+            int s = successors[c];
+            if (successors[s] == c && c < s)
+                successors[c] = c;
+        }
+
+        // roots, with path compression
+        for (int i=0; i<nbComponents; i++)
+        {
+            int c = components[i];
+            int root = c;
+            while (successors[root] != root)
+                root = successors[root];
+            while (successors[c] != root)
+            {
+                int next = successors[c];
+                successors[c] = root;
+                c = next;
+            }
+        }
+        int nbRoots = 0;
+        for (int i=0; i<nbComponents; i++)
+        {
+            int c = components[i];
+            lightest[c].storeRelease(-1);
+            if (successors[c] == c)
+                components[nbRoots++] = c;
+        }
+        components.resize(nbRoots);
+
+        // finished components stay their own root
+        int * relabel = labels.data();
+        const int * roots = successors.constData();
+        ParallelFor(pool, n, [&](int begin, int end, int)
+        {
+            for (int v=begin; v<end; v++)
+                relabel[v] = roots[relabel[v]];
+        });
+
+        // drop the edges inside a component
+        int * compacted = active.data();
+        int * keptEdges = kept.data();
+        int size = active.size();
+        RunParallel(pool, [&](int worker)
+        {
+            int begin, end;
+            pool.workerRange(worker, size, &begin, &end);
+            int out = begin;
+            for (int i=begin; i<end; i++)
+            {
+                int e = compacted[i];
+                if (label[ends[2*e]] != label[ends[2*e + 1]])
+                    compacted[out++] = e;
+            }
+            keptEdges[worker] = out - begin;
+        });
+        int nbKept = 0;
+        for (int worker=0; worker<nbWorkers; worker++)
+        {
+            int begin, end;
+            pool.workerRange(worker, size, &begin, &end);
+            std::memmove(compacted + nbKept, compacted + begin, kept[worker] * sizeof(int));
+            nbKept += kept[worker];
+        }
+        active.resize(nbKept);
+    }
+}
+
+//******************************************************************************
+/*!
+ * \brief FilterKruskal class is the filter-Kruskal algorithm (Osipov, Sanders, Singler)
+ *
+ * Edges are split around a pivot weight : the light part is solved first, recursively, then
+ * the heavy edges whose ends are already in one tree are filtered out before the heavy part
+ * is solved. Most heavy edges of a dense graph never get sorted. Filtering reads the
+ * union-find without modifying it, in parallel on large edge sets.
+ */
+class FilterKruskal
+{
+public:
+    FilterKruskal(int n, const int * ends, const double * weights, ThreadPool & pool, SpanningForest * forest) :
+        _ends(ends),
+        _lighter(weights),
+        _pool(pool),
+        _forest(forest),
+        _sets(n)
+    {
+    }
+
+    void run(int * begin, int * end)
+    {
+        if (end - begin <= qMax(FILTER_KRUSKAL_MIN_EDGES, _sets.nbSets()))
+        {
+            kruskal(begin, end);
+            return;
+        }
+
+        // median of an evenly spaced sample
+        int sample[FILTER_KRUSKAL_SAMPLES];
+        int step = int((end - begin) / FILTER_KRUSKAL_SAMPLES);
+        for (int i=0; i<FILTER_KRUSKAL_SAMPLES; i++)
+            sample[i] = begin[i * step];
+        std::nth_element(sample, sample + FILTER_KRUSKAL_SAMPLES / 2, sample + FILTER_KRUSKAL_SAMPLES, _lighter);
+        int pivot = sample[FILTER_KRUSKAL_SAMPLES / 2];
+
+        const EdgeOrder & lighter = _lighter;
+        int * middle = std::partition(begin, end, [&](int e) { return !lighter(pivot, e); });
+        _forest->nbRounds++;
+        run(begin, middle);
+        if (_sets.nbSets() > 1)
+            run(middle, filter(middle, end));
+    }
+
+private:
+    void kruskal(int * begin, int * end)
+    {
+        std::sort(begin, end, _lighter);
+        for (int * e=begin; e<end && _sets.nbSets() > 1; e++)
+        {
+            if (_sets.unite(_ends[2 * *e], _ends[2 * *e + 1]))
+                _forest->edges << *e;
+        }
+    }
+
+    //! removes the edges whose ends are in one tree, returns the new end
+    int * filter(int * begin, int * end)
+    {
+        int size = int(end - begin);
+        if (size < SPANNING_PARALLEL_EDGES)
+        {
+            int * out = begin;
+            for (int * e=begin; e<end; e++)
+            {
+                if (_sets.find(_ends[2 * *e]) != _sets.find(_ends[2 * *e + 1]))
+                    *out++ = *e;
+            }
+            return out;
+        }
+
+        _keep.resize(size);
+        char * keep = _keep.data();
+        const UnionFind & sets = _sets;
+        const int * ends = _ends;
+        ParallelFor(_pool, size, [&](int first, int last, int)
+        {
+            for (int i=first; i<last; i++)
+                keep[i] = sets.root(ends[2 * begin[i]]) != sets.root(ends[2 * begin[i] + 1]);
+        });
+        int * out = begin;
+        for (int i=0; i<size; i++)
+        {
+            if (keep[i])
+                *out++ = begin[i];
+        }
+        return out;
+    }
+
+    const int * _ends;
+    EdgeOrder _lighter;
+    ThreadPool & _pool;
+    SpanningForest * _forest;
+    UnionFind _sets;
+    QVector<char> _keep;
+};
+
+//******************************************************************************
+
+bool MinimumSpanningForest(int nbVertices, const QVector<int> & edgeVertices, const QVector<double> & edgeWeights,
+                           SpanningForest * forest, SpanningTreeAlgorithm algorithm, ThreadPool * pool)
+{
+    GT_PROFILE_SCOPE("MinimumSpanningForest");
+    if (!forest)
+        return false;
+    forest->clear();
+    int nbEdges = edgeWeights.size();
+    if (edgeVertices.size() != 2 * nbEdges)
+        return false;
+    const int * ends = edgeVertices.constData();
+    const double * weights = edgeWeights.constData();
+    for (int e=0; e<nbEdges; e++)
+    {
+        if (ends[2*e] < 0 || ends[2*e] >= nbVertices || ends[2*e + 1] < 0 || ends[2*e + 1] >= nbVertices
+                || weights[e] != weights[e])
+        {
+            std::cerr << "MinimumSpanningForest : invalid edge " << e << std::endl;
+            return false;
+        }
+    }
+
+    ThreadPool & workers = pool ? *pool : ThreadPool::instance();
+    if (algorithm == SPANNING_TREE_BORUVKA)
+    {
+        BoruvkaForest(nbVertices, ends, weights, nbEdges, workers, forest);
+    }
+    else
+    {
+        QVector<int> edges(nbEdges);
+        for (int e=0; e<nbEdges; e++)
+            edges[e] = e;
+        FilterKruskal kruskal(nbVertices, ends, weights, workers, forest);
+        kruskal.run(edges.data(), edges.data() + nbEdges);
+    }
+
+    std::sort(forest->edges.begin(), forest->edges.end());
+    for (int i=0; i<forest->edges.size(); i++)
+        forest->totalWeight += weights[forest->edges[i]];
+    forest->nbTrees = nbVertices - forest->edges.size();
+    return true;
+}
+
+//******************************************************************************
+
+bool MinimumSpanningForest(const Graph & graph, SpanningForest * forest, SpanningTreeAlgorithm algorithm, ThreadPool * pool)
+{
+    const QVector<Edge> & edges = graph.getEdges();
+    QVector<int> edgeVertices(2 * edges.size());
+    QVector<double> edgeWeights(edges.size());
+    for (int i=0; i<edges.size(); i++)
+    {
+        edgeVertices[2*i] = edges[i].a->id;
+        edgeVertices[2*i + 1] = edges[i].b->id;
+        edgeWeights[i] = edges[i].weight;
+    }
+    return MinimumSpanningForest(graph.vertices.size(), edgeVertices, edgeWeights, forest, algorithm, pool);
+}
+
+//******************************************************************************
+
+const char * SpanningTreeAlgorithmName(SpanningTreeAlgorithm algorithm)
+{
+    switch (algorithm)
+    {
+    case SPANNING_TREE_BORUVKA: return "Boruvka";
+    case SPANNING_TREE_FILTER_KRUSKAL: return "filter-Kruskal";
+    }
+    return "";
+}
+
+//******************************************************************************
+
+}
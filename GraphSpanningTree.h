@@ -0,0 +1,74 @@
+#ifndef GRAPHSPANNINGTREE_H
+#define GRAPHSPANNINGTREE_H
+
+// Qt
+#include <QVector>
+
+//******************************************************************************
+
+namespace GT {
+
+struct Graph;
+class ThreadPool;
+
+//******************************************************************************
+/*!
+ * SPANNING_TREE_BORUVKA : rounds where each component picks its lightest edge in parallel and the components are merged
+ * SPANNING_TREE_FILTER_KRUSKAL : Kruskal on the light edges of a pivot split, heavy edges within a tree are filtered before their turn
+ */
+enum SpanningTreeAlgorithm
+{
+    SPANNING_TREE_BORUVKA=0,
+    SPANNING_TREE_FILTER_KRUSKAL
+};
+
+//******************************************************************************
+/*!
+ * \brief SpanningForest struct is a minimum spanning forest, one tree per connected component
+ *
+ * Edges of equal weight are ordered by their index, the forest is unique and both algorithms
+ * give the same edges.
+ */
+struct SpanningForest
+{
+    SpanningForest() :
+        totalWeight(0.0),
+        nbTrees(0),
+        nbRounds(0)
+    {
+    }
+    void clear()
+    { *this = SpanningForest(); }
+
+    double totalWeight;
+    int nbTrees; //!< connected components, isolated vertices included
+    int nbRounds; //!< Boruvka rounds or filter-Kruskal partitions
+    QVector<int> edges; //!< indices of the tree edges in the input edges, increasing
+};
+
+//******************************************************************************
+
+/*!
+ * \brief MinimumSpanningForest method computes the minimum spanning forest of an undirected edge list
+ * \param edgeVertices 2 x nbEdges vertex ids, as BuildCsrGraph
+ * \param edgeWeights nbEdges weights, negative weights are allowed
+ * \param pool parallel parts run on the pool workers, ThreadPool::instance() if 0
+ * \return false on invalid vertex ids or NaN weights
+ */
+bool MinimumSpanningForest(int nbVertices, const QVector<int> & edgeVertices, const QVector<double> & edgeWeights,
+                           SpanningForest * forest, SpanningTreeAlgorithm algorithm=SPANNING_TREE_BORUVKA,
+                           ThreadPool * pool=0);
+
+//! edge indices are the ones of graph.getEdges(), directed edges are taken as undirected
+bool MinimumSpanningForest(const Graph & graph, SpanningForest * forest,
+                           SpanningTreeAlgorithm algorithm=SPANNING_TREE_BORUVKA, ThreadPool * pool=0);
+
+const char * SpanningTreeAlgorithmName(SpanningTreeAlgorithm algorithm);
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHSPANNINGTREE_H
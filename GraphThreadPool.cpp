@@ -0,0 +1,270 @@
+
+// Qt
+#include <QThread>
+#include <QDir>
+#include <QFile>
+#include <QStringList>
+#include <QMutexLocker>
+
+// System
+#ifdef Q_OS_LINUX
+#include <sched.h>
+#endif
+
+// Project
+#include "GraphThreadPool.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+int NumaTopology::nbCpus() const
+{
+    int count = 0;
+    foreach (QVector<int> cpus, nodeCpus)
+        count += cpus.size();
+    return count;
+}
+
+//******************************************************************************
+/*!
+ * \brief ParseCpuList method parses a kernel cpu list, e.g. "0-3,8-11"
+ */
+QVector<int> ParseCpuList(const QString & text)
+{
+    QVector<int> cpus;
+    foreach (QString range, text.trimmed().split(',', QString::SkipEmptyParts))
+    {
+        QStringList bounds = range.split('-');
+        int first = bounds[0].toInt();
+        int last = bounds.size() > 1 ? bounds[1].toInt() : first;
+        for (int cpu=first; cpu<=last; cpu++)
+            cpus << cpu;
+    }
+    return cpus;
+}
+
+//******************************************************************************
+
+NumaTopology NumaTopology::detect()
+{
+    NumaTopology topology;
+#ifdef Q_OS_LINUX
+    QDir nodes("/sys/devices/system/node");
+    for (int node=0; ; node++)
+    {
+        QFile file(nodes.filePath(QString("node%1/cpulist").arg(node)));
+        if (!file.open(QIODevice::ReadOnly))
+            break;
+        QVector<int> cpus = ParseCpuList(QString::fromLatin1(file.readAll()));
+        if (!cpus.isEmpty())
+            topology.nodeCpus << cpus;
+    }
+#endif
+    if (topology.nodeCpus.isEmpty())
+    {
+        QVector<int> cpus;
+        for (int cpu=0; cpu<qMax(1, QThread::idealThreadCount()); cpu++)
+            cpus << cpu;
+        topology.nodeCpus << cpus;
+    }
+    return topology;
+}
+
+//******************************************************************************
+
+bool PinCurrentThread(int cpu)
+{
+#ifdef Q_OS_LINUX
+    if (cpu < 0)
+        return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    Q_UNUSED(cpu)
+    return false;
+#endif
+}
+
+//******************************************************************************
+
+class ThreadPoolWorker : public QThread
+{
+public:
+    ThreadPoolWorker(ThreadPool * pool, int index) :
+        _pool(pool),
+        _index(index)
+    {
+    }
+
+protected:
+    void run()
+    {
+        if (_pool->_pinned)
+            PinCurrentThread(_pool->_workerCpus[_index]);
+
+        int generation = 0;
+        while (true)
+        {
+            ParallelTask * task;
+            {
+                QMutexLocker locker(&_pool->_mutex);
+                while (!_pool->_quit && _pool->_generation == generation)
+                    _pool->_startCondition.wait(&_pool->_mutex);
+                if (_pool->_quit)
+                    return;
+                generation = _pool->_generation;
+                task = _pool->_task;
+            }
+
+            task->run(_index);
+
+            QMutexLocker locker(&_pool->_mutex);
+            if (--_pool->_pending == 0)
+                _pool->_doneCondition.wakeAll();
+        }
+    }
+
+private:
+    ThreadPool * _pool;
+    int _index;
+};
+
+//******************************************************************************
+/*!
+ * \brief ThreadPool::ThreadPool
+ * \param nbThreads number of workers, one per CPU if 0
+ * \param pinned pin each worker to one CPU, workers are spread over NUMA nodes
+ */
+ThreadPool::ThreadPool(int nbThreads, bool pinned) :
+    _topology(NumaTopology::detect()),
+    _pinned(pinned),
+    _task(0),
+    _generation(0),
+    _pending(0),
+    _quit(false)
+{
+    int nbCpus = _topology.nbCpus();
+    if (nbThreads <= 0)
+        nbThreads = nbCpus;
+
+    // CPUs in node order, threads per node proportional to node size
+    QVector<int> cpus, nodes;
+    for (int node=0; node<_topology.nbNodes(); node++)
+    {
+        foreach (int cpu, _topology.nodeCpus[node])
+        {
+            cpus << cpu;
+            nodes << node;
+        }
+    }
+    for (int i=0; i<nbThreads; i++)
+    {
+        int index = nbThreads <= nbCpus ? int(qint64(i) * nbCpus / nbThreads) : i % nbCpus;
+        _workerCpus << cpus[index];
+        _workerNodes << nodes[index];
+    }
+
+    for (int i=0; i<nbThreads; i++)
+    {
+        ThreadPoolWorker * worker = new ThreadPoolWorker(this, i);
+        _workers << worker;
+        worker->start();
+    }
+}
+
+//******************************************************************************
+
+ThreadPool::~ThreadPool()
+{
+    {
+        QMutexLocker locker(&_mutex);
+        _quit = true;
+        _startCondition.wakeAll();
+    }
+    foreach (ThreadPoolWorker * worker, _workers)
+    {
+        worker->wait();
+        delete worker;
+    }
+}
+
+//******************************************************************************
+
+ThreadPool & ThreadPool::instance()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+//******************************************************************************
+/*!
+ * \brief ThreadPool::run method runs task->run(worker) on every worker and waits for all of them
+ */
+void ThreadPool::run(ParallelTask * task)
+{
+    QMutexLocker runLocker(&_runMutex);
+    QMutexLocker locker(&_mutex);
+    _task = task;
+    _pending = _workers.size();
+    _generation++;
+    _startCondition.wakeAll();
+    while (_pending > 0)
+        _doneCondition.wait(&_mutex);
+    _task = 0;
+}
+
+//******************************************************************************
+
+void ThreadPool::workerRange(int worker, int size, int * begin, int * end) const
+{
+    int n = nbThreads();
+    *begin = int(qint64(size) * worker / n);
+    *end = int(qint64(size) * (worker + 1) / n);
+}
+
+//******************************************************************************
+/*!
+ * \brief ParallelExclusiveScan method replaces values by their exclusive prefix sums
+ * \return sum of all values
+ *
+ * Each worker sums its range, the range sums are scanned, then each worker scans its range
+ * starting from the sum of the previous ranges.
+ */
+int ParallelExclusiveScan(ThreadPool & pool, int * values, int size)
+{
+    QVector<int> rangeSums(pool.nbThreads() + 1, 0);
+    RunParallel(pool, [&](int worker)
+    {
+        int begin, end;
+        pool.workerRange(worker, size, &begin, &end);
+        int sum = 0;
+        for (int i=begin; i<end; i++)
+            sum += values[i];
+        rangeSums[worker + 1] = sum;
+    });
+    for (int worker=0; worker<pool.nbThreads(); worker++)
+        rangeSums[worker + 1] += rangeSums[worker];
+
+    RunParallel(pool, [&](int worker)
+    {
+        int begin, end;
+        pool.workerRange(worker, size, &begin, &end);
+        int sum = rangeSums[worker];
+        for (int i=begin; i<end; i++)
+        {
+            int value = values[i];
+            values[i] = sum;
+            sum += value;
+        }
+    });
+    return rangeSums.last();
+}
+
+//******************************************************************************
+
+}
@@ -0,0 +1,136 @@
+#ifndef GRAPHTHREADPOOL_H
+#define GRAPHTHREADPOOL_H
+
+// Qt
+#include <QVector>
+#include <QList>
+#include <QMutex>
+#include <QWaitCondition>
+
+//******************************************************************************
+
+namespace GT {
+
+class ThreadPoolWorker;
+
+//******************************************************************************
+/*!
+ * \brief NumaTopology struct lists the CPUs of each NUMA node
+ *
+ * Read from /sys/devices/system/node on Linux, a single node with all CPUs otherwise.
+ */
+struct NumaTopology
+{
+    int nbNodes() const
+    { return nodeCpus.size(); }
+    int nbCpus() const;
+
+    QVector<QVector<int> > nodeCpus;
+
+    static NumaTopology detect();
+};
+
+//******************************************************************************
+
+class ParallelTask
+{
+public:
+    virtual ~ParallelTask() {}
+    virtual void run(int worker) = 0;
+};
+
+//******************************************************************************
+
+template<class Function>
+class FunctionTask : public ParallelTask
+{
+public:
+    explicit FunctionTask(const Function & function) :
+        _function(function)
+    {
+    }
+    void run(int worker)
+    { _function(worker); }
+
+private:
+    Function _function;
+};
+
+//******************************************************************************
+/*!
+ * \brief ThreadPool class runs a task once on each of its worker threads
+ *
+ * When pinned, worker i runs on a single CPU and workers are ordered node by node :
+ * workers of NUMA node 0 come first, then workers of node 1, etc. workerRange() splits
+ * an index range into contiguous chunks in worker order, so each socket gets one
+ * contiguous part of the range (socket-local work partition).
+ *
+ * Calls of run() from several threads are serialized, e.g. a background job and the GUI
+ * thread sharing instance(). A worker must not call run() on its own pool.
+ */
+class ThreadPool
+{
+public:
+    explicit ThreadPool(int nbThreads=0, bool pinned=true);
+    ~ThreadPool();
+
+    int nbThreads() const
+    { return _workers.size(); }
+    bool isPinned() const
+    { return _pinned; }
+    int workerCpu(int worker) const
+    { return _workerCpus[worker]; }
+    int workerNode(int worker) const
+    { return _workerNodes[worker]; }
+    const NumaTopology & topology() const
+    { return _topology; }
+
+    void run(ParallelTask * task);
+    void workerRange(int worker, int size, int * begin, int * end) const;
+
+    static ThreadPool & instance();
+
+private:
+    friend class ThreadPoolWorker;
+
+    NumaTopology _topology;
+    bool _pinned;
+    QVector<int> _workerCpus;
+    QVector<int> _workerNodes;
+    QList<ThreadPoolWorker*> _workers;
+
+    QMutex _runMutex; //!< held by the caller of run() until its task is done
+    QMutex _mutex;
+    QWaitCondition _startCondition;
+    QWaitCondition _doneCondition;
+    ParallelTask * _task;
+    int _generation;
+    int _pending;
+    bool _quit;
+
+    Q_DISABLE_COPY(ThreadPool)
+};
+
+//******************************************************************************
+
+bool PinCurrentThread(int cpu);
+
+/*!
+ * \brief RunParallel method runs function(worker) on every worker of the pool, e.g. with a lambda
+ */
+template<class Function>
+void RunParallel(ThreadPool & pool, const Function & function)
+{
+    FunctionTask<Function> task(function);
+    pool.run(&task);
+}
+
+int ParallelExclusiveScan(ThreadPool & pool, int * values, int size);
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHTHREADPOOL_H
@@ -7,6 +7,9 @@
 
 // Project
 #include "GraphTools.h"
+#include "GraphWeighted.h"
+#include "GraphKernels.h"
+#include "GraphProfiler.h"
 
 //******************************************************************************
 
@@ -14,42 +17,55 @@ namespace GT {
 
 //******************************************************************************
 
+void AddEdgeConnection(QHash<int, QList<EdgeConnection> > & connections, int vertexIndex, Vertex * vertex, double weight)
+{
+    if (!connections.contains(vertexIndex))
+    {
+        QList<GT::EdgeConnection> vts = QList<GT::EdgeConnection>()
+                << GT::EdgeConnection(vertex, weight);
+        connections.insert(vertexIndex, vts);
+        GT_PROFILE_COUNT(PC_ALLOCATIONS, 1);
+    }
+    else
+    {
+        QList<GT::EdgeConnection> & vts = connections[vertexIndex];
+        vts << GT::EdgeConnection(vertex, weight);
+    }
+}
+
+//******************************************************************************
+
 void Graph::setEdges(const QVector<Edge> & edges)
 {
+    GT_PROFILE_SCOPE("Graph::setEdges");
     _edges = edges;
     _edgeConnections.clear();
+    _inEdgeConnections.clear();
     foreach (Edge edge, _edges)
     {
         int vertexIndex1 = edge.a->id;
         int vertexIndex2 = edge.b->id;
-        int weight = edge.weight;
-
-        if (!_edgeConnections.contains(vertexIndex1))
-        {
-            QList<GT::EdgeConnection> vts = QList<GT::EdgeConnection>()
-                    << GT::EdgeConnection(&vertices[vertexIndex2], weight);
-            _edgeConnections.insert(vertexIndex1, vts);
-        }
-        else
-        {
-            QList<GT::EdgeConnection> & vts = _edgeConnections[vertexIndex1];
-            vts << GT::EdgeConnection(&vertices[vertexIndex2], weight);
-        }
+        double weight = edge.weight;
 
-        if (!_edgeConnections.contains(vertexIndex2))
-        {
-            QList<GT::EdgeConnection> vts = QList<GT::EdgeConnection>()
-                    << GT::EdgeConnection(&vertices[vertexIndex1], weight);
-            _edgeConnections.insert(vertexIndex2, vts);
-        }
-        else
-        {
-            QList<GT::EdgeConnection> & vts = _edgeConnections[vertexIndex2];
-            vts << GT::EdgeConnection(&vertices[vertexIndex1], weight);
-        }
+        AddEdgeConnection(_edgeConnections, vertexIndex1, &vertices[vertexIndex2], weight);
+        AddEdgeConnection(_directed ? _inEdgeConnections : _edgeConnections,
+                          vertexIndex2, &vertices[vertexIndex1], weight);
     }
 }
 
+//******************************************************************************
+/*!
+ * \brief Graph::setDirected method changes the graph mode, the current edge list is kept and the adjacency rebuilt
+ */
+void Graph::setDirected(bool directed)
+{
+    if (_directed == directed)
+        return;
+    _directed = directed;
+    QVector<Edge> edges = _edges;
+    setEdges(edges);
+}
+
 //******************************************************************************
 
 bool TestStdDoubleMaxLimit()
@@ -97,7 +113,10 @@ bool ColorGraph(Graph * graph, int color)
         if (notColoredVertex.color >= 0)
             continue;
 
+        GT_PROFILE_COUNT(PC_COLORS_TRIED, 1);
         QList<EdgeConnection> connectedVertices = graph->getEdgeConnections().value(notColoredVertex.id);
+        if (graph->isDirected())
+            connectedVertices << graph->getInEdgeConnections().value(notColoredVertex.id);
         bool sameColorVertexFound=false;
         foreach (EdgeConnection vertex, connectedVertices)
         {
@@ -128,6 +147,7 @@ bool ColorGraph(Graph * graph, int color)
  */
 void GreedyGraphColoring(Graph *graph)
 {
+    GT_PROFILE_SCOPE("GreedyGraphColoring");
     int color=0;
     while (ColorGraph(graph, color))
     {
@@ -137,24 +157,13 @@ void GreedyGraphColoring(Graph *graph)
 
 //******************************************************************************
 /*
- * Method to compute shortest path between two vertices.
+ * Method to compute shortest path between two vertices, used when weights are negative.
  *
  * https://en.wikipedia.org/wiki/Bellman%E2%80%93Ford_algorithm
  * http://e-maxx.ru/algo/ford_bellman
  */
-double ComputeMinDistance(const Graph & graph, int startIndex, int endIndex, QList<int> * path)
+double BellmanFordMinDistance(const Graph & graph, int startIndex, int endIndex, QList<int> * path)
 {
-    if (!path)
-        return -12345.0;
-
-    if (startIndex < 0 || startIndex > graph.vertices.size()-1 ||
-            endIndex < 0 || endIndex > graph.vertices.size()-1)
-    {
-        return -12345.0;
-    }
-
-    path->clear();
-
     // initialization :
     int nbVertices = graph.vertices.size();
     QVector<double> distMatrix(nbVertices, std::numeric_limits<double>::max());
@@ -164,18 +173,34 @@ double ComputeMinDistance(const Graph & graph, int startIndex, int endIndex, QLi
     // computation part:
     for (int i=0; i<nbVertices-1; i++)
     {
+        GT_PROFILE_COUNT(PC_BELLMAN_FORD_ROUNDS, 1);
         bool isModified=false;
         // loop on edges
+        // undirected edges are relaxed in both directions
         const QVector<Edge> & edges = graph.getEdges();
+        bool undirected = !graph.isDirected();
         for (int j=0; j<edges.size();j++)
         {
-            if (distMatrix[ edges[j].a->id ] < std::numeric_limits<double>::max())
+            int a = edges[j].a->id;
+            int b = edges[j].b->id;
+            if (distMatrix[ a ] < std::numeric_limits<double>::max())
+            {
+                if ( distMatrix[ b ] > distMatrix[ a ] + edges[j].weight )
+                {
+                    distMatrix[ b ] = distMatrix[ a ] + edges[j].weight;
+                    p[ b ] = a;
+                    isModified=true;
+                    GT_PROFILE_COUNT(PC_EDGES_RELAXED, 1);
+                }
+            }
+            if (undirected && distMatrix[ b ] < std::numeric_limits<double>::max())
             {
-                if ( distMatrix[ edges[j].b->id ] > distMatrix[ edges[j].a->id ] + edges[j].weight )
+                if ( distMatrix[ a ] > distMatrix[ b ] + edges[j].weight )
                 {
-                    distMatrix[ edges[j].b->id ] = distMatrix[ edges[j].a->id ] + edges[j].weight;
-                    p[ edges[j].b->id ] = edges[j].a->id;
+                    distMatrix[ a ] = distMatrix[ b ] + edges[j].weight;
+                    p[ a ] = b;
                     isModified=true;
+                    GT_PROFILE_COUNT(PC_EDGES_RELAXED, 1);
                 }
             }
         }
@@ -205,6 +230,126 @@ double ComputeMinDistance(const Graph & graph, int startIndex, int endIndex, QLi
     return minDistance;
 }
 
+//******************************************************************************
+
+template<class Adjacency>
+double KernelMinDistance(const Adjacency & adjacency, int startIndex, int endIndex, QList<int> * path)
+{
+    typedef WeightTraits<typename Adjacency::Weight> Traits;
+    QVector<typename Traits::Distance> distances;
+    QVector<int> p;
+    ShortestPathKernel(adjacency, startIndex, endIndex, &distances, &p);
+    if (distances[endIndex] == Traits::infinity())
+        return std::numeric_limits<double>::max();
+
+    for (int c = endIndex; c != -1; c=p[c])
+    {
+        path->prepend(c);
+    }
+    return double(distances[endIndex]);
+}
+
+//******************************************************************************
+
+template<class W>
+double WeightedMinDistance(const Graph & graph, int startIndex, int endIndex, QList<int> * path)
+{
+    WeightedCsrGraph<W> csr;
+    if (!csr.build(graph))
+        return BellmanFordMinDistance(graph, startIndex, endIndex, path);
+    return KernelMinDistance(csr, startIndex, endIndex, path);
+}
+
+//******************************************************************************
+/*!
+ * \brief ComputeMinDistance method computes the shortest path between two vertices
+ * \return the path length, std::numeric_limits<double>::max() if endIndex is not reachable
+ *
+ * Weights are copied to a CSR graph of the narrowest weight type that holds them exactly and
+ * searched by Dijkstra : with a bucket queue for integer weights, a binary heap otherwise.
+ * Dense graphs of unit weights are searched on a bit matrix. Negative weights fall back to
+ * Bellman-Ford on the edge list.
+ */
+double ComputeMinDistance(const Graph & graph, int startIndex, int endIndex, QList<int> * path)
+{
+    GT_PROFILE_SCOPE("ComputeMinDistance");
+    if (!path)
+        return -12345.0;
+
+    if (startIndex < 0 || startIndex > graph.vertices.size()-1 ||
+            endIndex < 0 || endIndex > graph.vertices.size()-1)
+    {
+        return -12345.0;
+    }
+
+    path->clear();
+
+    switch (SelectWeightType(graph))
+    {
+    case WEIGHT_UNIT:
+        // a bit row is smaller than a CSR row above nbVertices / 40 neighbors, but the row scan
+        // only pays off on its cost per neighbor above nbVertices / 4 of them
+        if (graph.vertices.size() <= BIT_MATRIX_MAX_VERTICES
+                && qint64(graph.nbArcs()) * 4 > qint64(graph.vertices.size()) * graph.vertices.size())
+        {
+            BitMatrixGraph matrix;
+            matrix.build(graph);
+            return KernelMinDistance(matrix, startIndex, endIndex, path);
+        }
+        return WeightedMinDistance<quint8>(graph, startIndex, endIndex, path);
+    case WEIGHT_UINT8:
+        return WeightedMinDistance<quint8>(graph, startIndex, endIndex, path);
+    case WEIGHT_UINT32:
+        return WeightedMinDistance<quint32>(graph, startIndex, endIndex, path);
+    case WEIGHT_FLOAT:
+        return WeightedMinDistance<float>(graph, startIndex, endIndex, path);
+    case WEIGHT_DOUBLE:
+        return WeightedMinDistance<double>(graph, startIndex, endIndex, path);
+    case WEIGHT_NEGATIVE:
+        break;
+    }
+    return BellmanFordMinDistance(graph, startIndex, endIndex, path);
+}
+
+//******************************************************************************
+
+void ConnectedComponents::clear()
+{
+    _labels.clear();
+    _offsets.clear();
+    _vertexIds.clear();
+}
+
+//******************************************************************************
+/*!
+ * \brief ConnectedComponents::setLabels method groups the vertex ids by label
+ *
+ * A counting pass gives the component sizes, a second pass scatters the ids. The offsets are
+ * used as insertion cursors and shifted back afterwards, no other buffer is needed.
+ */
+void ConnectedComponents::setLabels(const QVector<int> & labels, int nbComponents)
+{
+    _labels = labels;
+    _offsets.fill(0, nbComponents + 1);
+    for (int v=0; v<labels.size(); v++)
+    {
+        if (labels[v] >= 0)
+            _offsets[labels[v] + 1]++;
+    }
+    for (int c=0; c<nbComponents; c++)
+        _offsets[c + 1] += _offsets[c];
+
+    _vertexIds.resize(_offsets[nbComponents]);
+    for (int v=0; v<labels.size(); v++)
+    {
+        if (labels[v] >= 0)
+            _vertexIds[_offsets[labels[v]]++] = v;
+    }
+    for (int c=nbComponents; c>0; c--)
+        _offsets[c] = _offsets[c - 1];
+    _offsets[0] = 0;
+}
+
 //******************************************************************************
 /*!
  * \brief FindConnectedVertices method to compute all connected vertices
@@ -215,6 +360,7 @@ double ComputeMinDistance(const Graph & graph, int startIndex, int endIndex, QLi
  *
  * Algorithm used in the method is Depth-first-search
  * http://en.wikipedia.org/wiki/Depth-first_search
+ * On directed graphs edges are followed in both directions (weakly connected vertices)
  *
  */
 
@@ -231,7 +377,7 @@ QVector<Vertex *> ColorConnectedVertices(Graph & graph, Vertex & inputVertex, in
 
     QList<Vertex*> stack;
     stack.push_back(&inputVertex);
-    out.append(&inputVertex);
+    GT_PROFILE_COUNT(PC_DFS_STACK_PUSHES, 1);
     while (!stack.isEmpty())
     {
         Vertex * v = stack.takeLast();
@@ -240,10 +386,13 @@ QVector<Vertex *> ColorConnectedVertices(Graph & graph, Vertex & inputVertex, in
             v->color = color;
             out.append(v);
             QList<EdgeConnection> connectedVertices = graph.getEdgeConnections().value(v->id);
+            if (graph.isDirected())
+                connectedVertices << graph.getInEdgeConnections().value(v->id);
             foreach (EdgeConnection ec, connectedVertices)
             {
                 stack.push_back(ec.first);
             }
+            GT_PROFILE_COUNT(PC_DFS_STACK_PUSHES, connectedVertices.size());
         }
     }
     return out;
@@ -252,26 +401,60 @@ QVector<Vertex *> ColorConnectedVertices(Graph & graph, Vertex & inputVertex, in
 
 //******************************************************************************
 
-bool ColorConnectedVertices(Graph &graph, QVector< QVector<Vertex*> > * connectedVertices)
+void PushNeighbors(const QHash<int, QList<EdgeConnection> > & connections, int v, QVector<int> * stack)
 {
-    if (!connectedVertices) return false;
+    QHash<int, QList<EdgeConnection> >::const_iterator it = connections.constFind(v);
+    if (it == connections.constEnd())
+        return;
+    const QList<EdgeConnection> & neighbors = it.value();
+    for (int i=0; i<neighbors.size(); i++)
+        *stack << neighbors[i].first->id;
+    GT_PROFILE_COUNT(PC_DFS_STACK_PUSHES, neighbors.size());
+}
 
+//******************************************************************************
+/*!
+ * \brief ColorConnectedVertices method colors each component, in the order of its smallest vertex id
+ * \param graph vertices already colored are skipped, they get the label -1
+ * \param components labels are the colors
+ *
+ * Iterative depth-first search on vertex ids, one label array and one stack for the whole graph.
+ */
+bool ColorConnectedVertices(Graph &graph, ConnectedComponents * components)
+{
+    if (!components) return false;
+
+    GT_PROFILE_SCOPE("ColorConnectedVertices");
+    int n = graph.vertices.size();
+    QVector<int> labels(n, -1);
+    QVector<int> stack;
     int color = 0;
-    for (int i=0; i<graph.vertices.size();i++)
+    for (int i=0; i<n; i++)
     {
-
-        Vertex & notColoredVertex = graph.vertices[i];
-        if (notColoredVertex.color >= 0)
+        if (graph.vertices[i].color >= 0)
             continue;
 
-        QVector<Vertex*> cvertices = ColorConnectedVertices(graph, notColoredVertex, color);
-        connectedVertices->append(cvertices);
+        stack << i;
+        GT_PROFILE_COUNT(PC_DFS_STACK_PUSHES, 1);
+        while (!stack.isEmpty())
+        {
+            int v = stack.last();
+            stack.pop_back();
+            Vertex & vertex = graph.vertices[v];
+            if (vertex.color >= 0)
+                continue;
+            vertex.color = color;
+            labels[v] = color;
+            PushNeighbors(graph.getEdgeConnections(), v, &stack);
+            if (graph.isDirected())
+                PushNeighbors(graph.getInEdgeConnections(), v, &stack);
+        }
         color++;
     }
+    components->setLabels(labels, color);
     return true;
 }
 
-
 //******************************************************************************
 
 }
@@ -39,26 +39,134 @@ struct Edge
 
 typedef QPair<Vertex*, double> EdgeConnection;
 
+/*!
+ * \brief Graph struct holds the vertices, the edge list and the adjacency
+ *
+ * Undirected graph (default) : each edge a-b is stored once in the edge list and
+ * appears in the adjacency of both a and b.
+ * Directed graph : edge a->b is in the out-adjacency of a (getEdgeConnections) and
+ * in the in-adjacency of b (getInEdgeConnections).
+ */
 struct Graph
 {
 
-    Graph()
+    explicit Graph(bool directed=false) :
+        _directed(directed)
     {
     }
     QVector<Vertex> vertices;
     void setEdges(const QVector<Edge> & edges);
 
+    bool isDirected() const
+    { return _directed; }
+    void setDirected(bool directed);
+    //! number of directed arcs, edges of an undirected graph count twice
+    int nbArcs() const
+    { return _directed ? _edges.size() : 2*_edges.size(); }
+
     const QVector<Edge> & getEdges() const
     { return _edges; }
     const QHash<int, QList<EdgeConnection> > & getEdgeConnections() const
     { return _edgeConnections; }
+    const QHash<int, QList<EdgeConnection> > & getInEdgeConnections() const
+    { return _directed ? _inEdgeConnections : _edgeConnections; }
 
 protected:
 
+    bool _directed;
     QVector<Edge> _edges;
     QHash<int, QList<EdgeConnection> > _edgeConnections;
+    QHash<int, QList<EdgeConnection> > _inEdgeConnections; //!< only used by directed graphs
+
 
+};
 
+//******************************************************************************
+/*!
+ * \brief ConnectedComponents class holds the components of a graph as one label per vertex
+ *
+ * The vertex ids are grouped by component in one array (CSR layout) : component c is
+ * vertexIds[offsets[c], offsets[c+1]), in increasing id order. Both arrays are built from the
+ * labels in two linear passes, walking a component allocates nothing.
+ * A vertex of label -1 belongs to no component.
+ */
+class ConnectedComponents
+{
+public:
+    /*!
+     * \brief Component class is a view on the vertex ids of one component
+     */
+    class Component
+    {
+    public:
+        Component(const int * begin, const int * end) :
+            _begin(begin),
+            _end(end)
+        {}
+        const int * begin() const
+        { return _begin; }
+        const int * end() const
+        { return _end; }
+        int size() const
+        { return int(_end - _begin); }
+        int operator[](int i) const
+        { return _begin[i]; }
+    private:
+        const int * _begin;
+        const int * _end;
+    };
+
+    /*!
+     * \brief const_iterator class walks the components in label order
+     */
+    class const_iterator
+    {
+    public:
+        const_iterator(const ConnectedComponents * components, int label) :
+            _components(components),
+            _label(label)
+        {}
+        Component operator*() const
+        { return _components->component(_label); }
+        const_iterator & operator++()
+        { _label++; return *this; }
+        bool operator!=(const const_iterator & other) const
+        { return _label != other._label; }
+        int label() const
+        { return _label; }
+    private:
+        const ConnectedComponents * _components;
+        int _label;
+    };
+
+    ConnectedComponents() {}
+
+    void clear();
+    //! labels are in [-1, nbComponents)
+    void setLabels(const QVector<int> & labels, int nbComponents);
+
+    int nbVertices() const
+    { return _labels.size(); }
+    int nbComponents() const
+    { return qMax(0, _offsets.size() - 1); }
+    int label(int v) const
+    { return _labels[v]; }
+    const QVector<int> & labels() const
+    { return _labels; }
+    int componentSize(int label) const
+    { return _offsets[label + 1] - _offsets[label]; }
+    Component component(int label) const
+    { return Component(_vertexIds.constData() + _offsets[label], _vertexIds.constData() + _offsets[label + 1]); }
+
+    const_iterator begin() const
+    { return const_iterator(this, 0); }
+    const_iterator end() const
+    { return const_iterator(this, nbComponents()); }
+
+private:
+    QVector<int> _labels;
+    QVector<int> _offsets; //!< nbComponents + 1 entries
+    QVector<int> _vertexIds; //!< grouped by component
 };
 
 //******************************************************************************
@@ -69,7 +177,10 @@ void GreedyGraphColoring(Graph * graph);
 
 double ComputeMinDistance(const Graph & graph, int startIndex, int endIndex, QList<int> *path);
 
-bool ColorConnectedVertices(Graph & graph, QVector<QVector<Vertex *> > *connectedVertices);
+//! edge list sweeps, used by ComputeMinDistance for negative weights
+double BellmanFordMinDistance(const Graph & graph, int startIndex, int endIndex, QList<int> * path);
+
+bool ColorConnectedVertices(Graph & graph, ConnectedComponents * components);
 
 QVector<Vertex *> ColorConnectedVertices(Graph &graph, Vertex &inputVertex, int color);
 
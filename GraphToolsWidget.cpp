@@ -7,17 +7,65 @@
 #include <QGraphicsSimpleTextItem>
 #include <QGraphicsSceneMouseEvent>
 #include <QSpinBox>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QThread>
+#include <QCoreApplication>
 
 // Project
 #include "ui_GraphToolsWidget.h"
 #include "GraphToolsWidget.h"
 #include "GraphTools.h"
+#include "GraphIO.h"
+#include "GraphProfiler.h"
+#include "GraphExactColoring.h"
+#include "GraphScheduler.h"
+#include "GraphSpanningTree.h"
+#include "GraphCentrality.h"
+#include "GraphKShortestPaths.h"
 
 namespace GT
 {
 
 //******************************************************************************
 
+static const int EXACT_COLORING_TIME_BUDGET_MS = 5000;
+static const int EVENT_POLL_MS = 50; //!< GUI events are processed at this period while a job runs
+static const int CENTRALITY_EXACT_MAX_VERTICES = 2000; //!< larger graphs get sampled betweenness
+static const double CENTRALITY_SAMPLED_ERROR = 0.02;
+
+//******************************************************************************
+/*!
+ * \brief ExactColoringJob class runs ExactGraphColoring in a thread, the GUI stays responsive and can cancel it
+ */
+class ExactColoringJob : public QThread
+{
+public:
+    ExactColoringJob(Graph * graph, const CancellationToken * cancellation) :
+        _graph(graph),
+        _cancellation(cancellation)
+    {
+    }
+
+    const ExactColoringStatistics & statistics() const
+    { return _statistics; }
+
+protected:
+    void run()
+    {
+        ExactGraphColoring(_graph, EXACT_COLORING_TIME_BUDGET_MS, 0, &_statistics, _cancellation);
+    }
+
+private:
+    Graph * _graph;
+    const CancellationToken * _cancellation;
+    ExactColoringStatistics _statistics;
+};
+
+//******************************************************************************
+
 QList<QColor> getColorPanel()
 {
     QList<QColor> o = QList<QColor>()
@@ -39,6 +87,14 @@ QList<QColor> getColorPanel()
     return o;
 }
 
+QColor getLabelColor(int colorLabel)
+{
+    QList<QColor> colorPanel = getColorPanel();
+    if (colorLabel >= colorPanel.size())
+        return QColor(colorLabel,colorLabel,colorLabel);
+    return colorPanel[colorLabel];
+}
+
 void removeItem(QGraphicsItem * path)
 {
     path->scene()->removeItem(path);
@@ -52,7 +108,12 @@ GraphToolsWidget::GraphToolsWidget(QWidget *parent) :
     ui(new Ui::GraphToolsWidget),
     _isChooseVertexMode(false),
     _chooseSender(0),
-    _path(0)
+    _path(0),
+    _pathDistance(-1.0),
+    _tree(0),
+    _isLiveColoring(false),
+    _hierarchyVersion(-1),
+    _isColoring(false)
 {
     setWindowTitle(tr("Graph Tools App"));
 
@@ -66,8 +127,18 @@ GraphToolsWidget::GraphToolsWidget(QWidget *parent) :
     connect(ui->_runMVD, SIGNAL(clicked()), this, SLOT(runMVD()));
     connect(ui->_cleanMVD, SIGNAL(clicked()), this, SLOT(cleanMVD()));
     connect(ui->_runCCV, SIGNAL(clicked()), this, SLOT(runCCV()));
+    connect(ui->_runMST, SIGNAL(clicked()), this, SLOT(runMST()));
+    connect(ui->_cleanMST, SIGNAL(clicked()), this, SLOT(cleanMST()));
+    connect(ui->_runCentrality, SIGNAL(clicked()), this, SLOT(runCentrality()));
     connect(ui->_chooseSVId, SIGNAL(clicked()), this, SLOT(onChooseVertexId()));
     connect(ui->_chooseEVId, SIGNAL(clicked()), this, SLOT(onChooseVertexId()));
+    connect(ui->_save, SIGNAL(clicked()), this, SLOT(saveGraph()));
+    connect(ui->_load, SIGNAL(clicked()), this, SLOT(loadGraph()));
+    connect(ui->_export, SIGNAL(clicked()), this, SLOT(exportGraph()));
+    connect(ui->_saveTrace, SIGNAL(clicked()), this, SLOT(saveTrace()));
+
+    // statistics are only collected when built with CONFIG+=profiling
+    ui->_statsGroup->setVisible(ProfilingEnabled());
 
     clear();
 
@@ -82,6 +153,14 @@ void GraphToolsWidget::clear()
         removeItem(_path);
         _path=0;
     }
+    _pathVertices.clear();
+    _pathDistance=-1.0;
+    if (_tree) {
+        removeItem(_tree);
+        _tree=0;
+    }
+    ui->_treeWeight->setText("");
+    ui->_centralityInfo->setText("");
 
     _chooseSender=0;
     _isChooseVertexMode=false;
@@ -91,6 +170,14 @@ void GraphToolsWidget::clear()
     ui->_chooseSVId->setDown(_isChooseVertexMode);
     ui->_chooseEVId->setDown(_isChooseVertexMode);
 
+    ui->_nbColors->setText("");
+    _cancellation.cancel();
+    _isLiveColoring=false;
+    _liveColoring.clear();
+    _components.clear();
+    _hierarchy.clear();
+    _hierarchyVersion=-1;
+
     GraphViewer::clear();
 
 }
@@ -99,6 +186,15 @@ void GraphToolsWidget::clear()
 
 void GraphToolsWidget::runGGC()
 {
+    // a click while the exact coloring runs cancels it
+    if (_isColoring)
+    {
+        _cancellation.cancel();
+        return;
+    }
+
+    Profiler::instance().reset();
+
     // setup graph data
     GT::Graph graph;
     if (!setupGraph(&graph))
@@ -106,22 +202,106 @@ void GraphToolsWidget::runGGC()
         return;
     }
 
-    // Apply greedy graph coloring algorithm
-    GT::GreedyGraphColoring(&graph);
+    // Apply greedy graph coloring algorithm, or the exact one within a time budget
+    bool isTooLarge = !GT::ExactColoringFits(graph);
+    bool isExact = ui->_exactGGC->isChecked() && !isTooLarge;
+    if (isExact)
+    {
+        int version = versions().currentNumber();
+        _cancellation.reset();
+        _isColoring=true;
+        ui->_runGGC->setText(tr("Cancel"));
+        // the search holds ThreadPool::instance() until it ends, the algorithms sharing it would block the GUI
+        ui->_runMVD->setEnabled(false);
+        ui->_runMST->setEnabled(false);
+        ui->_runCentrality->setEnabled(false);
+        ExactColoringJob job(&graph, &_cancellation);
+        job.start();
+        while (!job.wait(EVENT_POLL_MS))
+            QCoreApplication::processEvents();
+        ui->_runMVD->setEnabled(true);
+        ui->_runMST->setEnabled(true);
+        ui->_runCentrality->setEnabled(true);
+        ui->_runGGC->setText(tr("Run"));
+        _isColoring=false;
+
+        // the graph may have been edited or cleared meanwhile
+        if (versions().currentNumber() != version)
+        {
+            ui->_nbColors->setText(tr("Graph changed, coloring dropped"));
+            return;
+        }
+        const GT::ExactColoringStatistics & statistics = job.statistics();
+        ui->_nbColors->setText(statistics.isOptimal ?
+                                   tr("%1 colors (optimal)").arg(statistics.nbColors) :
+                                   tr("%1 colors (at least %2, search stopped)").arg(statistics.nbColors).arg(statistics.lowerBound));
+    }
+    else
+    {
+        GT::GreedyGraphColoring(&graph);
+        int nbColors = 0;
+        foreach (const GT::Vertex & vertex, graph.vertices)
+            nbColors = qMax(nbColors, vertex.color + 1);
+        ui->_nbColors->setText(ui->_exactGGC->isChecked() && isTooLarge ?
+                                   tr("%1 colors (greedy, graph too large for exact)").arg(nbColors) :
+                                   tr("%1 colors").arg(nbColors));
+    }
+    showStatistics();
 
     // Show results
-    QList<QColor> colorPanel = getColorPanel();
     for (int i=0; i<qMin(graph.vertices.size(), _vertices.size());i++)
     {
-        int colorLabel = graph.vertices[i].color;
-        QColor color;
-        if (colorLabel >= colorPanel.size())
-            color = QColor(colorLabel,colorLabel,colorLabel);
-        else
-            color = colorPanel[colorLabel];
-        _vertices[i]->setBrush(color);
+        _vertices[i]->setBrush(getLabelColor(graph.vertices[i].color));
     }
 
+    // keep the coloring valid while editing
+    _liveColoring.build(graph, isExact);
+    _isLiveColoring=true;
+
+}
+
+//******************************************************************************
+
+void GraphToolsWidget::onVertexAdded(int)
+{
+    _components.addVertices(1);
+    if (!_isLiveColoring)
+        return;
+    _liveColoring.addVertices(1);
+    updateLiveColoring();
+}
+
+//******************************************************************************
+
+void GraphToolsWidget::onEdgeAdded(int vertexIndex1, int vertexIndex2)
+{
+    _components.addEdge(vertexIndex1, vertexIndex2);
+    if (!_isLiveColoring)
+        return;
+    _liveColoring.addEdge(vertexIndex1, vertexIndex2);
+    updateLiveColoring();
+}
+
+//******************************************************************************
+/*!
+ * \brief GraphToolsWidget::updateLiveColoring method repaints the vertices recolored by the last edit
+ *
+ * A finished background recompaction is adopted here, a new one is started when the local
+ * repairs used too many colors.
+ */
+void GraphToolsWidget::updateLiveColoring()
+{
+    QVector<int> recolored = _liveColoring.recolored();
+    if (_liveColoring.finishRecompaction())
+        recolored << _liveColoring.recolored();
+    else if (_liveColoring.needsRecompaction())
+        _liveColoring.startRecompaction();
+
+    foreach (int index, recolored)
+    {
+        if (index < _vertices.size() && _liveColoring.color(index) >= 0)
+            _vertices[index]->setBrush(getLabelColor(_liveColoring.color(index)));
+    }
 }
 
 //******************************************************************************
@@ -134,6 +314,8 @@ void GraphToolsWidget::runMVD()
     if (startVertexId < 0 || endVertexId < 0)
         return;
 
+    Profiler::instance().reset();
+
     // setup graph data
     GT::Graph graph;
     if (!setupGraph(&graph))
@@ -141,9 +323,48 @@ void GraphToolsWidget::runMVD()
         return;
     }
 
+    // Alternative routes : k shortest loopless paths, drawn from the longest to the shortest
+    int nbPaths = ui->_nbPaths->value();
+    if (nbPaths > 1)
+    {
+        QList<GT::WeightedPath> paths;
+        if (!GT::ComputeKShortestPaths(graph, startVertexId, endVertexId, nbPaths, &paths))
+        {
+            ui->_distance->setText(QString("Path can not be found"));
+            return;
+        }
+        showStatistics();
+        if (paths.isEmpty())
+        {
+            ui->_distance->setText(QString("No path between vertices"));
+            return;
+        }
+        ui->_distance->setText(QString("%1 (%2 paths, up to %3)")
+                               .arg(paths.first().distance).arg(paths.size()).arg(paths.last().distance));
+        QList< QList<int> > routes;
+        foreach (const GT::WeightedPath & path, paths)
+            routes << path.vertices;
+        _pathVertices = paths.first().vertices;
+        _pathDistance = paths.first().distance;
+        drawPaths(routes);
+        return;
+    }
+
+    // Contract the graph once per version, repeated queries reuse the hierarchy
+    int version = versions().currentNumber();
+    if (_hierarchyVersion != version)
+    {
+        _hierarchyVersion = version;
+        if (!_hierarchy.build(graph))
+            _hierarchy.clear();
+    }
+
     // Apply minimal distance computation
     QList<int> path;
-    double distance = GT::ComputeMinDistance(graph, startVertexId, endVertexId, &path);
+    double distance = _hierarchy.isEmpty() ?
+                GT::ComputeMinDistance(graph, startVertexId, endVertexId, &path) :
+                _hierarchy.computeMinDistance(startVertexId, endVertexId, &path);
+    showStatistics();
 
 
     // Display the result:
@@ -171,6 +392,27 @@ void GraphToolsWidget::runMVD()
 
 
     // draw path :
+    _pathVertices = path;
+    _pathDistance = distance;
+    drawPath(path);
+
+}
+
+//******************************************************************************
+
+void GraphToolsWidget::drawPath(const QList<int> & path)
+{
+    drawPaths(QList< QList<int> >() << path);
+}
+
+//******************************************************************************
+/*!
+ * \brief GraphToolsWidget::drawPaths method draws the paths in distinct colors, the first one in red
+ *
+ * Later paths are drawn wider and below, the edges shared with shorter paths stay visible.
+ */
+void GraphToolsWidget::drawPaths(const QList< QList<int> > & paths)
+{
     if (_path) {
         removeItem(_path);
         _path=0;
@@ -178,29 +420,33 @@ void GraphToolsWidget::runMVD()
     _path = new QGraphicsItemGroup();
     _scene.addItem(_path);
 
-    for (int i=0; i<path.size()-1;i++)
+    for (int p=paths.size()-1; p>=0; p--)
     {
-        int pvi1=path[i];
-        int pvi2=path[i+1];
-
-        if (pvi1 < 0 || pvi1 > _vertices.size()-1 ||
-                pvi2 < 0 || pvi2 > _vertices.size()-1)
+        const QList<int> & path = paths[p];
+        QColor color = QColor::fromHsvF(double(p) / paths.size(), 1.0, 0.9);
+        for (int i=0; i<path.size()-1;i++)
         {
-            std::cerr << "Failed to find drawn vertices" << std::endl;
-            break;
-        }
+            int pvi1=path[i];
+            int pvi2=path[i+1];
 
-        QGraphicsLineItem* line = new QGraphicsLineItem(
-                    _vertices[pvi1]->scenePos().x(),
-                    _vertices[pvi1]->scenePos().y(),
-                    _vertices[pvi2]->scenePos().x(),
-                    _vertices[pvi2]->scenePos().y()
-                    );
-        line->setPen(QPen(Qt::red,VERTEX_SIZE*0.05));
-        _path->addToGroup(line);
+            if (pvi1 < 0 || pvi1 > _vertices.size()-1 ||
+                    pvi2 < 0 || pvi2 > _vertices.size()-1)
+            {
+                std::cerr << "Failed to find drawn vertices" << std::endl;
+                break;
+            }
+
+            QGraphicsLineItem* line = new QGraphicsLineItem(
+                        _vertices[pvi1]->scenePos().x(),
+                        _vertices[pvi1]->scenePos().y(),
+                        _vertices[pvi2]->scenePos().x(),
+                        _vertices[pvi2]->scenePos().y()
+                        );
+            line->setPen(QPen(color,VERTEX_SIZE*0.05*(1.0 + 0.5*p)));
+            _path->addToGroup(line);
+        }
     }
     _path->setZValue(PATH_LINE_Z);
-
 }
 
 //******************************************************************************
@@ -224,6 +470,8 @@ void GraphToolsWidget::cleanMVD()
         removeItem(_path);
         _path=0;
     }
+    _pathVertices.clear();
+    _pathDistance=-1.0;
 
     // clean overlays:
     int index;
@@ -243,9 +491,88 @@ void GraphToolsWidget::cleanMVD()
 }
 
 //******************************************************************************
+/*!
+ * \brief GraphToolsWidget::runMST method highlights the minimum spanning forest, one tree per connected component
+ */
+void GraphToolsWidget::runMST()
+{
+    Profiler::instance().reset();
 
-void GraphToolsWidget::runCCV()
+    // setup graph data
+    GT::Graph graph;
+    if (!setupGraph(&graph))
+    {
+        return;
+    }
+
+    GT::SpanningForest forest;
+    if (!GT::MinimumSpanningForest(graph, &forest))
+    {
+        ui->_treeWeight->setText(QString("Tree can not be found"));
+        return;
+    }
+    showStatistics();
+
+    ui->_treeWeight->setText(forest.nbTrees > 1 ?
+                                 QString("%1 (%2 trees)").arg(forest.totalWeight).arg(forest.nbTrees) :
+                                 QString("%1").arg(forest.totalWeight));
+    drawTree(graph, forest);
+}
+
+//******************************************************************************
+
+void GraphToolsWidget::drawTree(const GT::Graph & graph, const GT::SpanningForest & forest)
+{
+    if (_tree) {
+        removeItem(_tree);
+        _tree=0;
+    }
+    _tree = new QGraphicsItemGroup();
+    _scene.addItem(_tree);
+
+    const QVector<GT::Edge> & edges = graph.getEdges();
+    foreach (int e, forest.edges)
+    {
+        int vi1 = edges[e].a->id;
+        int vi2 = edges[e].b->id;
+        if (vi1 > _vertices.size()-1 || vi2 > _vertices.size()-1)
+        {
+            std::cerr << "Failed to find drawn vertices" << std::endl;
+            break;
+        }
+
+        QGraphicsLineItem* line = new QGraphicsLineItem(
+                    _vertices[vi1]->scenePos().x(),
+                    _vertices[vi1]->scenePos().y(),
+                    _vertices[vi2]->scenePos().x(),
+                    _vertices[vi2]->scenePos().y()
+                    );
+        line->setPen(QPen(Qt::darkGreen,VERTEX_SIZE*0.05));
+        _tree->addToGroup(line);
+    }
+    _tree->setZValue(PATH_LINE_Z);
+}
+
+//******************************************************************************
+
+void GraphToolsWidget::cleanMST()
 {
+    if (_tree) {
+        removeItem(_tree);
+        _tree=0;
+    }
+    ui->_treeWeight->setText("");
+}
+
+//******************************************************************************
+/*!
+ * \brief GraphToolsWidget::runCentrality method fills the vertices with a heat color of the chosen centrality
+ *
+ * Betweenness is sampled above CENTRALITY_EXACT_MAX_VERTICES vertices, the bound is shown.
+ */
+void GraphToolsWidget::runCentrality()
+{
+    Profiler::instance().reset();
 
     // setup graph data
     GT::Graph graph;
@@ -254,29 +581,61 @@ void GraphToolsWidget::runCCV()
         return;
     }
 
-    // Apply greedy graph coloring algorithm
-    QVector< QVector<Vertex*> > connectedVertices;
-    if (!GT::ColorConnectedVertices(graph, &connectedVertices))
+    int n = graph.vertices.size();
+    int nbSamples = n > CENTRALITY_EXACT_MAX_VERTICES ? GT::CentralitySampleCount(n, CENTRALITY_SAMPLED_ERROR) : 0;
+    GT::CentralityScores scores;
+    if (!GT::ComputeCentrality(graph, &scores, nbSamples))
     {
-        std::cerr << "Algorithm to color connected vertices is failed" << std::endl;
+        ui->_centralityInfo->setText(tr("Negative weights"));
         return;
     }
+    showStatistics();
+
+    bool isBetweenness = ui->_centralityMeasure->currentIndex() == 0;
+    const QVector<double> & values = isBetweenness ? scores.betweenness : scores.closeness;
+    double maxValue = 0.0;
+    foreach (double value, values)
+        maxValue = qMax(maxValue, value);
+    ui->_centralityInfo->setText(scores.isExact ?
+                                     tr("max %1").arg(maxValue) :
+                                     tr("max %1, %2 sources, +/- %3").arg(maxValue).arg(scores.nbSources).arg(scores.errorBound));
+
+    // heat colors replace the coloring
+    _isLiveColoring=false;
+    setVertexHeat(values);
+}
+
+//******************************************************************************
+
+void GraphToolsWidget::runCCV()
+{
+    Profiler::instance().reset();
 
-    std::cout << "Number of sets of connected vertices : " << connectedVertices.size() << std::endl;
+    // components are maintained on each edit, no graph traversal here
+    GT::ConnectedComponents components;
+    int nbComponents = _components.componentLabels(&components);
+
+    std::cout << "Number of sets of connected vertices : " << nbComponents << std::endl;
+    showStatistics();
 
     // Show results
     QList<QColor> colorPanel = getColorPanel();
-    for (int i=0; i<qMin(graph.vertices.size(), _vertices.size());i++)
+    for (GT::ConnectedComponents::const_iterator it = components.begin(); it != components.end(); ++it)
     {
-        int colorLabel = graph.vertices[i].color;
+        int colorLabel = it.label();
         QColor color;
         if (colorLabel >= colorPanel.size() && colorLabel < 256)
             color = QColor(colorLabel,colorLabel,colorLabel);
-        else if (colorLabel >= 0 && colorLabel < colorPanel.size())
+        else if (colorLabel < colorPanel.size())
             color = colorPanel[colorLabel];
         else
             color = QColor(Qt::white);
-        _vertices[i]->setBrush(color);
+        GT::ConnectedComponents::Component component = *it;
+        for (int i=0; i<component.size(); i++)
+        {
+            if (component[i] < _vertices.size())
+                _vertices[component[i]]->setBrush(color);
+        }
     }
 
 }
@@ -345,37 +704,18 @@ bool GraphToolsWidget::eventFilter(QObject * object, QEvent * event)
 
                 if (vertex && _isChooseVertexMode)
                 {
-                    QRectF r=vertex->rect().adjusted(-VERTEX_SIZE*0.05,
-                                                     -VERTEX_SIZE*0.05,
-                                                     VERTEX_SIZE*0.05,
-                                                     VERTEX_SIZE*0.05);
-                    QGraphicsEllipseItem* overlay = _scene.addEllipse(r,QPen(Qt::black,0));
-                    overlay->setData(0,"overlay");
-                    overlay->setZValue(vertex->zValue()-1);
-                    overlay->setParentItem(vertex);
-                    QGraphicsSimpleTextItem * text = _scene.addSimpleText("");
-                    text->setParentItem(overlay);
-                    text->setPen(QPen(Qt::blue,0));
-                    text->setTransform(
-                                QTransform::fromScale(0.005, 0.005)
-                                * QTransform::fromTranslate(-0.5*r.width(),r.height()*0.51)
-                                );
-
-
                     // set value to UI:
                     if (_chooseSender == ui->_chooseSVId)
                     {
                         ui->_chooseSVId->setDown(false);
                         ui->_startVertexId->setValue(vertex->data(KEY_VERTEX_ID).toInt()+1);
-                        overlay->setPen(QPen(Qt::darkBlue,0));
-                        text->setText("Start");
+                        addVertexOverlay(vertex, true);
                     }
                     else if (_chooseSender == ui->_chooseEVId)
                     {
                         ui->_chooseEVId->setDown(false);
                         ui->_endVertexId->setValue(vertex->data(KEY_VERTEX_ID).toInt()+1);
-                        overlay->setPen(QPen(Qt::darkYellow,0));
-                        text->setText("End");
+                        addVertexOverlay(vertex, false);
                     }
                     _isChooseVertexMode=false;
                     _chooseSender=0;
@@ -390,6 +730,156 @@ bool GraphToolsWidget::eventFilter(QObject * object, QEvent * event)
 
 //******************************************************************************
 
+void GraphToolsWidget::addVertexOverlay(QGraphicsEllipseItem * vertex, bool isStartVertex)
+{
+    QRectF r=vertex->rect().adjusted(-VERTEX_SIZE*0.05,
+                                     -VERTEX_SIZE*0.05,
+                                     VERTEX_SIZE*0.05,
+                                     VERTEX_SIZE*0.05);
+    QGraphicsEllipseItem* overlay = _scene.addEllipse(r,QPen(Qt::black,0));
+    overlay->setData(0,"overlay");
+    overlay->setZValue(vertex->zValue()-1);
+    overlay->setParentItem(vertex);
+    QGraphicsSimpleTextItem * text = _scene.addSimpleText("");
+    text->setParentItem(overlay);
+    text->setPen(QPen(Qt::blue,0));
+    text->setTransform(
+                QTransform::fromScale(0.005, 0.005)
+                * QTransform::fromTranslate(-0.5*r.width(),r.height()*0.51)
+                );
+
+    if (isStartVertex)
+    {
+        overlay->setPen(QPen(Qt::darkBlue,0));
+        text->setText("Start");
+    }
+    else
+    {
+        overlay->setPen(QPen(Qt::darkYellow,0));
+        text->setText("End");
+    }
+}
+
+//******************************************************************************
+
+void GraphToolsWidget::showStatistics()
+{
+    if (!ProfilingEnabled())
+        return;
+    ui->_stats->setPlainText(Profiler::instance().summary());
+}
+
+//******************************************************************************
+
+void GraphToolsWidget::saveTrace()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Save trace"), QString(), tr("Chrome trace (*.json)"));
+    if (fileName.isEmpty())
+        return;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text) || !Profiler::instance().writeChromeTrace(&file))
+    {
+        QMessageBox::warning(this, tr("Save trace"), tr("Failed to write the file %1").arg(fileName));
+    }
+}
+
+//******************************************************************************
+
+void GraphToolsWidget::toDocumentWithResults(GraphDocument * doc) const
+{
+    toDocument(doc);
+    doc->startVertexId = ui->_startVertexId->value()-1;
+    doc->endVertexId = ui->_endVertexId->value()-1;
+    doc->path = _pathVertices;
+    doc->distance = _pathDistance;
+}
+
+//******************************************************************************
+
+void GraphToolsWidget::saveGraph()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Save graph"), QString(), tr("Graph files (*.ggc)"));
+    if (fileName.isEmpty())
+        return;
+
+    GraphDocument doc;
+    toDocumentWithResults(&doc);
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly) || !WriteGraphDocument(&file, doc))
+    {
+        QMessageBox::warning(this, tr("Save graph"), tr("Failed to write the file %1").arg(fileName));
+    }
+}
+
+//******************************************************************************
+
+void GraphToolsWidget::loadGraph()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, tr("Load graph"), QString(), tr("Graph files (*.ggc)"));
+    if (fileName.isEmpty())
+        return;
+
+    GraphDocument doc;
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly) || !ReadGraphDocument(&file, &doc))
+    {
+        QMessageBox::warning(this, tr("Load graph"), tr("Failed to read the file %1").arg(fileName));
+        return;
+    }
+
+    fromDocument(doc);
+
+    // restore last results:
+    if (doc.startVertexId >= 0 && doc.startVertexId < _vertices.size())
+    {
+        ui->_startVertexId->setValue(doc.startVertexId+1);
+        addVertexOverlay(_vertices[doc.startVertexId], true);
+    }
+    if (doc.endVertexId >= 0 && doc.endVertexId < _vertices.size())
+    {
+        ui->_endVertexId->setValue(doc.endVertexId+1);
+        addVertexOverlay(_vertices[doc.endVertexId], false);
+    }
+    if (!doc.path.isEmpty())
+    {
+        _pathVertices = doc.path;
+        _pathDistance = doc.distance;
+        ui->_distance->setText(QString("%1").arg(doc.distance));
+        drawPath(doc.path);
+    }
+}
+
+//******************************************************************************
+
+void GraphToolsWidget::exportGraph()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Export graph"), QString(),
+                                                    tr("JSON (*.json);;GraphML (*.graphml)"));
+    if (fileName.isEmpty())
+        return;
+
+    GraphDocument doc;
+    toDocumentWithResults(&doc);
+
+    QFile file(fileName);
+    bool ok = file.open(QIODevice::WriteOnly | QIODevice::Text);
+    if (ok)
+    {
+        if (QFileInfo(fileName).suffix().toLower() == "graphml")
+            ok = ExportGraphML(&file, doc);
+        else
+            ok = ExportGraphJson(&file, doc);
+    }
+    if (!ok)
+    {
+        QMessageBox::warning(this, tr("Export graph"), tr("Failed to write the file %1").arg(fileName));
+    }
+}
+
+//******************************************************************************
+
 GraphToolsWidget::~GraphToolsWidget()
 {
     delete ui;
@@ -8,6 +8,11 @@
 
 // Project
 #include "GraphViewer.h"
+#include "GraphRecoloring.h"
+#include "GraphUnionFind.h"
+#include "GraphContraction.h"
+#include "GraphScheduler.h"
+#include "GraphSpanningTree.h"
 
 namespace Ui {
 class GraphToolsWidget;
@@ -32,21 +37,48 @@ public slots:
     void runCCV();
     void runMVD();
     void cleanMVD();
+    void runMST();
+    void cleanMST();
+    void runCentrality();
+    void saveGraph();
+    void loadGraph();
+    void exportGraph();
+    void saveTrace();
 
 protected:
     virtual bool eventFilter(QObject *, QEvent *);
+    virtual void onVertexAdded(int vertexIndex);
+    virtual void onEdgeAdded(int vertexIndex1, int vertexIndex2);
 
 protected slots:
     void onChooseVertexId();
 
 private:
+    void toDocumentWithResults(GT::GraphDocument * doc) const;
+    void drawPath(const QList<int> & path);
+    void drawPaths(const QList< QList<int> > & paths);
+    void drawTree(const GT::Graph & graph, const GT::SpanningForest & forest);
+    void showStatistics();
+    void addVertexOverlay(QGraphicsEllipseItem * vertex, bool isStartVertex);
+    void updateLiveColoring();
 
     Ui::GraphToolsWidget *ui;
     QGraphicsItemGroup* _path; //!< GraphicsItem contains data info : key=0 -> vertex1 number, key=1 -> vertex2 number, key=3 -> edge weight
+    QList<int> _pathVertices; //!< Last computed shortest path, saved with the graph
+    double _pathDistance;
+    QGraphicsItemGroup* _tree; //!< edges of the last minimum spanning forest
 
     bool _isChooseVertexMode;
     QObject * _chooseSender;
 
+    GT::IncrementalColoring _liveColoring; //!< coloring of the last runGGC, repaired on each edit
+    bool _isLiveColoring;
+    GT::OnlineComponents _components; //!< connected components, updated on each edit
+    GT::ContractionHierarchy _hierarchy; //!< contraction of the graph version _hierarchyVersion, empty on negative weights
+    int _hierarchyVersion;
+    GT::CancellationToken _cancellation; //!< cancels the running exact coloring
+    bool _isColoring;
+
 };
 
 //******************************************************************************
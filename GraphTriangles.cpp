@@ -0,0 +1,359 @@
+
+// STD
+#include <algorithm>
+#include <iostream>
+
+// Qt
+#include <QtAlgorithms>
+
+// System
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// Project
+#include "GraphTriangles.h"
+#include "GraphTools.h"
+#include "GraphThreadPool.h"
+#include "GraphScheduler.h"
+#include "GraphProfiler.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+/*!
+ * \brief MergeIntersection method writes the common elements of two increasing lists to out, returns their number
+ */
+inline int MergeIntersection(const int * a, int na, const int * b, int nb, int * out)
+{
+    // without branches on the comparisons, they are unpredictable
+    int i = 0, j = 0, k = 0;
+    while (i < na && j < nb)
+    {
+        int x = a[i];
+        int y = b[j];
+        out[k] = x;
+        k += x == y;
+        i += x <= y;
+        j += y <= x;
+    }
+    return k;
+}
+
+//******************************************************************************
+/*!
+ * \brief SimdIntersection method is MergeIntersection on blocks of 8 elements
+ *
+ * The block of a is compared with the 8 rotations of the block of b, the equality masks are
+ * or-ed : the set bits are the elements of a found in b. The block with the smaller last
+ * element is consumed (both if equal), the tails are merged.
+ */
+inline int SimdIntersection(const int * a, int na, const int * b, int nb, int * out)
+{
+#ifdef __AVX2__
+    int i = 0, j = 0, k = 0;
+    int blocksA = na & ~7;
+    int blocksB = nb & ~7;
+    const __m256i rotation = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+    while (i < blocksA && j < blocksB)
+    {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j));
+        __m256i equal = _mm256_cmpeq_epi32(va, vb);
+        for (int r=1; r<8; r++)
+        {
+            vb = _mm256_permutevar8x32_epi32(vb, rotation);
+            equal = _mm256_or_si256(equal, _mm256_cmpeq_epi32(va, vb));
+        }
+        uint mask = uint(_mm256_movemask_ps(_mm256_castsi256_ps(equal)));
+        while (mask)
+        {
+            out[k++] = a[i + qCountTrailingZeroBits(mask)];
+            mask &= mask - 1;
+        }
+        int lastA = a[i + 7];
+        int lastB = b[j + 7];
+        if (lastA <= lastB)
+            i += 8;
+        if (lastB <= lastA)
+            j += 8;
+    }
+    return k + MergeIntersection(a + i, na - i, b + j, nb - j, out + k);
+#else
+    return MergeIntersection(a, na, b, nb, out);
+#endif
+}
+
+//******************************************************************************
+/*!
+ * \brief OrientedGraph struct is the degree ordered orientation : arc u->v for each edge with rank(u) < rank(v)
+ *
+ * Vertices are renamed by their rank (degree, then id), the out-neighbor lists are increasing.
+ */
+struct OrientedGraph
+{
+    bool build(int n, const QVector<int> & edgeVertices, ThreadPool & pool)
+    {
+        GT_PROFILE_SCOPE("CountTriangles::orient");
+        // undirected lists with the parallel edges, without the self loops
+        int nbInputEdges = edgeVertices.size() / 2;
+        QVector<int> starts(n+1, 0);
+        for (int e=0; e<nbInputEdges; e++)
+        {
+            int a = edgeVertices[2*e];
+            int b = edgeVertices[2*e + 1];
+            if (a < 0 || a >= n || b < 0 || b >= n)
+            {
+                std::cerr << "CountTriangles : invalid edge " << e << std::endl;
+                return false;
+            }
+            if (a == b)
+                continue;
+            starts[a+1]++;
+            starts[b+1]++;
+        }
+        for (int v=0; v<n; v++)
+            starts[v+1] += starts[v];
+        QVector<int> neighbors(starts[n]);
+        QVector<int> cursor = starts;
+        for (int e=0; e<nbInputEdges; e++)
+        {
+            int a = edgeVertices[2*e];
+            int b = edgeVertices[2*e + 1];
+            if (a == b)
+                continue;
+            neighbors[cursor[a]++] = b;
+            neighbors[cursor[b]++] = a;
+        }
+
+        // each list is sorted and its duplicates removed, the degree is the length left
+        degrees.resize(n);
+        int * lists = neighbors.data();
+        int * listDegrees = degrees.data();
+        ParallelFor(pool, n, [&](int begin, int end, int)
+        {
+            for (int v=begin; v<end; v++)
+            {
+                std::sort(lists + starts[v], lists + starts[v+1]);
+                listDegrees[v] = int(std::unique(lists + starts[v], lists + starts[v+1]) - (lists + starts[v]));
+            }
+        });
+
+        // ranks by counting sort on the degree, ties by id
+        int maxDegree = 0;
+        for (int v=0; v<n; v++)
+            maxDegree = qMax(maxDegree, degrees[v]);
+        QVector<int> degreeStarts(maxDegree + 2, 0);
+        for (int v=0; v<n; v++)
+            degreeStarts[degrees[v] + 1]++;
+        for (int d=0; d<=maxDegree; d++)
+            degreeStarts[d+1] += degreeStarts[d];
+        ranks.resize(n);
+        for (int v=0; v<n; v++)
+            ranks[v] = degreeStarts[degrees[v]]++;
+
+        // out-lists in rank order : the neighbors of higher rank, renamed
+        offsets.fill(0, n+1);
+        int * outOffsets = offsets.data();
+        ParallelFor(pool, n, [&](int begin, int end, int)
+        {
+            for (int v=begin; v<end; v++)
+            {
+                int nbOut = 0;
+                for (int i=starts[v]; i<starts[v] + degrees[v]; i++)
+                    nbOut += ranks[lists[i]] > ranks[v];
+                outOffsets[ranks[v] + 1] = nbOut;
+            }
+        });
+        for (int v=0; v<n; v++)
+            offsets[v+1] += offsets[v];
+        targets.resize(offsets[n]);
+        int * outLists = targets.data();
+        ParallelFor(pool, n, [&](int begin, int end, int)
+        {
+            for (int v=begin; v<end; v++)
+            {
+                int * out = outLists + offsets[ranks[v]];
+                int nbOut = 0;
+                for (int i=starts[v]; i<starts[v] + degrees[v]; i++)
+                {
+                    if (ranks[lists[i]] > ranks[v])
+                        out[nbOut++] = ranks[lists[i]];
+                }
+                std::sort(out, out + nbOut);
+            }
+        });
+
+        maxOutDegree = 0;
+        for (int v=0; v<n; v++)
+            maxOutDegree = qMax(maxOutDegree, offsets[v+1] - offsets[v]);
+        return true;
+    }
+
+    QVector<int> degrees; //!< undirected degree of each original vertex
+    QVector<int> ranks; //!< new id of each original vertex
+    QVector<int> offsets;
+    QVector<int> targets;
+    int maxOutDegree;
+};
+
+//******************************************************************************
+/*!
+ * \brief TriangleScratch struct is the state of one worker : its triangle counts and intersection buffers
+ */
+struct TriangleScratch
+{
+    TriangleScratch() :
+        nbTriangles(0)
+    {
+    }
+
+    qint64 nbTriangles;
+    QVector<qint64> vertexTriangles; //!< by rank
+    QVector<int> marks; //!< hash kernel : marks[w] == u if w is an out-neighbor of u
+    QVector<int> matches;
+};
+
+//******************************************************************************
+
+bool CountTriangles(int nbVertices, const QVector<int> & edgeVertices, TriangleCounts * counts,
+                    IntersectionKernel kernel, ThreadPool * pool)
+{
+    GT_PROFILE_SCOPE("CountTriangles");
+    if (!counts)
+        return false;
+    *counts = TriangleCounts();
+    ThreadPool & workers = pool ? *pool : ThreadPool::instance();
+    int n = nbVertices;
+    OrientedGraph oriented;
+    if (n < 0 || edgeVertices.size() % 2 != 0 || !oriented.build(n, edgeVertices, workers))
+        return false;
+
+    TriangleScratch empty;
+    empty.vertexTriangles.fill(0, n);
+    empty.marks.fill(-1, n);
+    empty.matches.resize(qMax(1, oriented.maxOutDegree));
+    WorkerLocal<TriangleScratch> scratches(workers, empty);
+    const int * offsets = oriented.offsets.constData();
+    const int * targets = oriented.targets.constData();
+
+    // a triangle u < v < w is found once, from the arc u->v : w is in both lists, after v in the list of u
+    ParallelFor(workers, n, [&](int begin, int end, int worker)
+    {
+        TriangleScratch & scratch = scratches[worker];
+        qint64 * vertexTriangles = scratch.vertexTriangles.data();
+        int * marks = scratch.marks.data();
+        int * matches = scratch.matches.data();
+        for (int u=begin; u<end; u++)
+        {
+            const int * outU = targets + offsets[u];
+            int degreeU = offsets[u+1] - offsets[u];
+            bool isHash = kernel == INTERSECT_HASH || (kernel == INTERSECT_HYBRID && degreeU >= TRIANGLE_HASH_MIN_DEGREE);
+            if (isHash)
+            {
+                for (int i=0; i<degreeU; i++)
+                    marks[outU[i]] = u;
+            }
+            for (int i=0; i<degreeU; i++)
+            {
+                int v = outU[i];
+                const int * outV = targets + offsets[v];
+                int degreeV = offsets[v+1] - offsets[v];
+                int nbMatches = 0;
+                if (isHash)
+                {
+                    for (int j=0; j<degreeV; j++)
+                    {
+                        if (marks[outV[j]] == u)
+                            matches[nbMatches++] = outV[j];
+                    }
+                }
+                else if (kernel == INTERSECT_MERGE)
+                {
+                    nbMatches = MergeIntersection(outU + i + 1, degreeU - i - 1, outV, degreeV, matches);
+                }
+                else
+                {
+                    nbMatches = SimdIntersection(outU + i + 1, degreeU - i - 1, outV, degreeV, matches);
+                }
+                vertexTriangles[u] += nbMatches;
+                vertexTriangles[v] += nbMatches;
+                for (int m=0; m<nbMatches; m++)
+                    vertexTriangles[matches[m]]++;
+                scratch.nbTriangles += nbMatches;
+            }
+        }
+    });
+
+    counts->nbEdges = oriented.targets.size();
+    counts->vertexTriangles.fill(0, n);
+    counts->clustering.fill(0.0, n);
+    for (int worker=0; worker<scratches.size(); worker++)
+    {
+        const TriangleScratch & scratch = scratches[worker];
+        counts->nbTriangles += scratch.nbTriangles;
+        for (int v=0; v<n; v++)
+            counts->vertexTriangles[v] += scratch.vertexTriangles[oriented.ranks[v]];
+    }
+
+    double nbTriples = 0.0;
+    double sum = 0.0;
+    for (int v=0; v<n; v++)
+    {
+        double degree = oriented.degrees[v];
+        if (degree < 2.0)
+            continue;
+        double pairs = degree * (degree - 1.0) / 2.0;
+        nbTriples += pairs;
+        counts->clustering[v] = counts->vertexTriangles[v] / pairs;
+        sum += counts->clustering[v];
+    }
+    counts->averageClustering = n > 0 ? sum / n : 0.0;
+    counts->globalClustering = nbTriples > 0.0 ? 3.0 * counts->nbTriangles / nbTriples : 0.0;
+    return true;
+}
+
+//******************************************************************************
+
+bool CountTriangles(const Graph & graph, TriangleCounts * counts, IntersectionKernel kernel, ThreadPool * pool)
+{
+    const QVector<Edge> & edges = graph.getEdges();
+    QVector<int> edgeVertices(2 * edges.size());
+    for (int i=0; i<edges.size(); i++)
+    {
+        edgeVertices[2*i] = edges[i].a->id;
+        edgeVertices[2*i + 1] = edges[i].b->id;
+    }
+    return CountTriangles(graph.vertices.size(), edgeVertices, counts, kernel, pool);
+}
+
+//******************************************************************************
+
+const char * IntersectionKernelName(IntersectionKernel kernel)
+{
+    switch (kernel)
+    {
+    case INTERSECT_MERGE: return "merge";
+    case INTERSECT_SIMD: return SimdIntersectionAvailable() ? "AVX2" : "AVX2 (merge, not built)";
+    case INTERSECT_HASH: return "hash";
+    case INTERSECT_HYBRID: return "hybrid";
+    default: return "";
+    }
+}
+
+//******************************************************************************
+
+bool SimdIntersectionAvailable()
+{
+#ifdef __AVX2__
+    return true;
+#else
+    return false;
+#endif
+}
+
+//******************************************************************************
+
+}
@@ -0,0 +1,85 @@
+#ifndef GRAPHTRIANGLES_H
+#define GRAPHTRIANGLES_H
+
+// Qt
+#include <QVector>
+
+//******************************************************************************
+
+namespace GT {
+
+struct Graph;
+class ThreadPool;
+
+//******************************************************************************
+
+static const int TRIANGLE_HASH_MIN_DEGREE = 16; //!< INTERSECT_HYBRID marks the out-neighbors of vertices from this out-degree
+
+/*!
+ * Intersection of the sorted out-neighbor lists of the two ends of an arc :
+ * INTERSECT_MERGE : scalar merge
+ * INTERSECT_SIMD : AVX2 blocks of 8 x 8 compared by rotating one block (shuffle-compare), merge without AVX2
+ * INTERSECT_HASH : the out-neighbors of the first end are marked in a table indexed by vertex, the second list is probed
+ * INTERSECT_HYBRID : hash for the vertices of high out-degree, SIMD for the others
+ */
+enum IntersectionKernel
+{
+    INTERSECT_MERGE=0,
+    INTERSECT_SIMD,
+    INTERSECT_HASH,
+    INTERSECT_HYBRID,
+    INTERSECT_NB_KERNELS
+};
+
+const char * IntersectionKernelName(IntersectionKernel kernel);
+
+//! true if built with AVX2 (qmake CONFIG+=avx2)
+bool SimdIntersectionAvailable();
+
+//******************************************************************************
+/*!
+ * \brief TriangleCounts struct holds the triangles of an undirected simple graph and the clustering coefficients
+ *
+ * Edge directions, self loops and parallel edges are ignored.
+ */
+struct TriangleCounts
+{
+    TriangleCounts() :
+        nbTriangles(0),
+        nbEdges(0),
+        averageClustering(0.0),
+        globalClustering(0.0)
+    {
+    }
+
+    qint64 nbTriangles;
+    qint64 nbEdges; //!< distinct undirected edges, one list intersection each
+    QVector<qint64> vertexTriangles; //!< triangles through each vertex
+    QVector<double> clustering; //!< local coefficient : triangles / (degree (degree - 1) / 2), 0 below degree 2
+    double averageClustering; //!< mean of the local coefficients
+    double globalClustering; //!< transitivity : 3 triangles / connected triples
+};
+
+//******************************************************************************
+/*!
+ * \brief CountTriangles method counts the triangles of an edge list, in parallel over the vertices
+ *
+ * Vertices are renamed by increasing degree and each edge is kept from its lower end : every
+ * out-neighbor list is sorted and shorter than sqrt(2 nbEdges), a triangle is found once.
+ * \param edgeVertices 2 x nbEdges vertex ids, as BuildCsrGraph
+ * \param pool ThreadPool::instance() if 0
+ * \return false on invalid vertex ids
+ */
+bool CountTriangles(int nbVertices, const QVector<int> & edgeVertices, TriangleCounts * counts,
+                    IntersectionKernel kernel=INTERSECT_HYBRID, ThreadPool * pool=0);
+
+bool CountTriangles(const Graph & graph, TriangleCounts * counts, IntersectionKernel kernel=INTERSECT_HYBRID,
+                    ThreadPool * pool=0);
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHTRIANGLES_H
@@ -0,0 +1,230 @@
+
+// STD
+#include <iostream>
+
+// Qt
+
+// Project
+#include "GraphUnionFind.h"
+#include "GraphTools.h"
+#include "GraphProfiler.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+UnionFind::UnionFind(int nbElements) :
+    _nbSets(0)
+{
+    reset(nbElements);
+}
+
+//******************************************************************************
+
+void UnionFind::reset(int nbElements)
+{
+    _parents.resize(nbElements);
+    for (int i=0; i<nbElements; i++)
+        _parents[i] = i;
+    _ranks.fill(0, nbElements);
+    _nbSets = nbElements;
+}
+
+//******************************************************************************
+/*!
+ * \brief UnionFind::addElements method adds singleton sets
+ * \return the first added element
+ */
+int UnionFind::addElements(int count)
+{
+    int first = _parents.size();
+    for (int i=0; i<count; i++)
+    {
+        _parents << first + i;
+        _ranks << 0;
+    }
+    _nbSets += count;
+    return first;
+}
+
+//******************************************************************************
+/*!
+ * \brief UnionFind::find method returns the root of the set of x, each visited element is linked to its grandparent (path halving)
+ */
+int UnionFind::find(int x)
+{
+    int * parents = _parents.data();
+    while (parents[x] != x)
+    {
+        parents[x] = parents[parents[x]];
+        x = parents[x];
+    }
+    return x;
+}
+
+//******************************************************************************
+/*!
+ * \brief UnionFind::unite method merges the sets of a and b, the root of smaller rank is linked to the other one
+ * \return false if a and b were in the same set
+ */
+bool UnionFind::unite(int a, int b)
+{
+    a = find(a);
+    b = find(b);
+    if (a == b)
+        return false;
+    if (_ranks[a] < _ranks[b])
+        qSwap(a, b);
+    _parents[b] = a;
+    if (_ranks[a] == _ranks[b])
+        _ranks[a]++;
+    _nbSets--;
+    return true;
+}
+
+//******************************************************************************
+
+OnlineComponents::OnlineComponents() :
+    _isDirty(false),
+    _nbRebuilds(0)
+{
+}
+
+//******************************************************************************
+
+void OnlineComponents::clear()
+{
+    _edges.clear();
+    _sets.reset(0);
+    _isDirty = false;
+}
+
+//******************************************************************************
+
+void OnlineComponents::build(const Graph & graph)
+{
+    GT_PROFILE_SCOPE("OnlineComponents::build");
+    clear();
+    addVertices(graph.vertices.size());
+    const QVector<Edge> & edges = graph.getEdges();
+    for (int i=0; i<edges.size(); i++)
+        addEdge(edges[i].a->id, edges[i].b->id);
+}
+
+//******************************************************************************
+/*!
+ * \brief OnlineComponents::addVertices method adds isolated vertices
+ * \return id of the first added vertex
+ */
+int OnlineComponents::addVertices(int count)
+{
+    return _sets.addElements(count);
+}
+
+//******************************************************************************
+/*!
+ * \brief OnlineComponents::addEdge method adds the edge a-b, O(alpha(n))
+ * \return false if a vertex id is invalid or for a self-loop
+ */
+bool OnlineComponents::addEdge(int a, int b)
+{
+    int n = nbVertices();
+    if (a < 0 || a >= n || b < 0 || b >= n || a == b)
+        return false;
+    EdgeState & state = _edges[edgeKey(a, b)];
+    if (state.count++ > 0)
+        return true;
+    // with dirty sets the flag is recomputed by the rebuild
+    state.isForestEdge = _isDirty ? false : _sets.unite(a, b);
+    return true;
+}
+
+//******************************************************************************
+/*!
+ * \brief OnlineComponents::removeEdge method removes one copy of the edge a-b
+ * \return false if there is no such edge
+ */
+bool OnlineComponents::removeEdge(int a, int b)
+{
+    QHash<quint64, EdgeState>::iterator it = _edges.find(edgeKey(a, b));
+    if (it == _edges.end())
+        return false;
+    if (--it.value().count == 0)
+    {
+        _isDirty |= it.value().isForestEdge;
+        _edges.erase(it);
+    }
+    return true;
+}
+
+//******************************************************************************
+/*!
+ * \brief OnlineComponents::rebuild method unites the remaining edges again and finds the new spanning forest edges
+ */
+void OnlineComponents::rebuild()
+{
+    GT_PROFILE_SCOPE("OnlineComponents::rebuild");
+    _sets.reset(nbVertices());
+    for (QHash<quint64, EdgeState>::iterator it = _edges.begin(); it != _edges.end(); ++it)
+        it.value().isForestEdge = _sets.unite(int(it.key() >> 32), int(it.key() & 0xFFFFFFFF));
+    _isDirty = false;
+    _nbRebuilds++;
+}
+
+//******************************************************************************
+/*!
+ * \brief OnlineComponents::component method returns the representative vertex of the component of v
+ */
+int OnlineComponents::component(int v)
+{
+    if (_isDirty)
+        rebuild();
+    return _sets.find(v);
+}
+
+//******************************************************************************
+
+bool OnlineComponents::isConnected(int a, int b)
+{
+    return component(a) == component(b);
+}
+
+//******************************************************************************
+
+int OnlineComponents::nbComponents()
+{
+    if (_isDirty)
+        rebuild();
+    return _sets.nbSets();
+}
+
+//******************************************************************************
+/*!
+ * \brief OnlineComponents::componentLabels method labels the components in the order of their smallest vertex id
+ * \return number of components, labels are the colors ColorConnectedVertices gives
+ */
+int OnlineComponents::componentLabels(ConnectedComponents * components)
+{
+    GT_PROFILE_SCOPE("OnlineComponents::componentLabels");
+    if (_isDirty)
+        rebuild();
+    int n = nbVertices();
+    QVector<int> rootLabels(n, -1);
+    QVector<int> labels(n);
+    int nbLabels = 0;
+    for (int v=0; v<n; v++)
+    {
+        int & label = rootLabels[_sets.find(v)];
+        if (label < 0)
+            label = nbLabels++;
+        labels[v] = label;
+    }
+    components->setLabels(labels, nbLabels);
+    return nbLabels;
+}
+
+//******************************************************************************
+
+}
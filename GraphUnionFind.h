@@ -0,0 +1,110 @@
+#ifndef GRAPHUNIONFIND_H
+#define GRAPHUNIONFIND_H
+
+// Qt
+#include <QVector>
+#include <QHash>
+
+//******************************************************************************
+
+namespace GT {
+
+struct Graph;
+class ConnectedComponents;
+
+//******************************************************************************
+/*!
+ * \brief UnionFind class is a disjoint-set forest with union by rank and path halving
+ *
+ * find and unite cost O(alpha(n)) amortized.
+ */
+class UnionFind
+{
+public:
+    explicit UnionFind(int nbElements=0);
+
+    void reset(int nbElements);
+    int addElements(int count);
+
+    int find(int x);
+    //! find without path halving, threads may call it concurrently while no set is modified
+    int root(int x) const
+    {
+        while (_parents[x] != x)
+            x = _parents[x];
+        return x;
+    }
+    bool unite(int a, int b);
+    bool isConnected(int a, int b)
+    { return find(a) == find(b); }
+
+    int nbElements() const
+    { return _parents.size(); }
+    int nbSets() const
+    { return _nbSets; }
+
+private:
+    QVector<int> _parents;
+    QVector<quint8> _ranks;
+    int _nbSets;
+};
+
+//******************************************************************************
+/*!
+ * \brief OnlineComponents class maintains the connected components of a graph while vertices and edges are added or removed
+ *
+ * Added edges are united in a UnionFind. An edge which merged two sets is a spanning forest
+ * edge : removing another edge does not change the components, removing the last copy of a
+ * forest edge marks the sets dirty and they are rebuilt from the remaining edges at the next
+ * query, in O(m alpha(n)). Edges are undirected, as in ColorConnectedVertices.
+ */
+class OnlineComponents
+{
+public:
+    OnlineComponents();
+
+    void clear();
+    void build(const Graph & graph);
+
+    int addVertices(int count);
+    bool addEdge(int a, int b);
+    bool removeEdge(int a, int b);
+
+    int nbVertices() const
+    { return _sets.nbElements(); }
+    int nbEdges() const
+    { return _edges.size(); }
+    int component(int v);
+    bool isConnected(int a, int b);
+    int nbComponents();
+    int componentLabels(ConnectedComponents * components);
+    int nbRebuilds() const
+    { return _nbRebuilds; }
+
+private:
+    struct EdgeState
+    {
+        EdgeState() :
+            count(0), isForestEdge(false)
+        {}
+        int count; //!< parallel edges
+        bool isForestEdge;
+    };
+
+    static quint64 edgeKey(int a, int b)
+    { return a < b ? (quint64(a) << 32) | quint32(b) : (quint64(b) << 32) | quint32(a); }
+    void rebuild();
+
+    QHash<quint64, EdgeState> _edges;
+    UnionFind _sets;
+    bool _isDirty;
+    int _nbRebuilds;
+};
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHUNIONFIND_H
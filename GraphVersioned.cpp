@@ -0,0 +1,495 @@
+
+// STD
+#include <iostream>
+
+// Qt
+#include <QThread>
+
+// Project
+#include "GraphVersioned.h"
+#include "GraphTools.h"
+#include "GraphProfiler.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+AdjacencyBlock * NewEmptyBlock()
+{
+    AdjacencyBlock * block = new AdjacencyBlock();
+    block->offsets.fill(0, VERSION_BLOCK_SIZE + 1);
+    return block;
+}
+
+//******************************************************************************
+/*!
+ * \brief VersionEditor class collects the modified blocks of a new version, a block is copied on its first modification
+ */
+class VersionEditor
+{
+public:
+    explicit VersionEditor(QVector<const AdjacencyBlock*> & blocks) :
+        _blocks(blocks),
+        _editIndex(blocks.size(), -1)
+    {
+    }
+
+    int findArc(int a, int b) const
+    {
+        int index = _editIndex[a >> VERSION_BLOCK_BITS];
+        if (index < 0)
+        {
+            const AdjacencyBlock * block = _blocks[a >> VERSION_BLOCK_BITS];
+            int local = a & (VERSION_BLOCK_SIZE - 1);
+            for (int i=block->offsets[local]; i<block->offsets[local+1]; i++)
+            {
+                if (block->targets[i] == b)
+                    return i;
+            }
+            return -1;
+        }
+        return _edits[index].targets[a & (VERSION_BLOCK_SIZE - 1)].indexOf(b);
+    }
+
+    bool insertArc(int a, int b, double weight)
+    {
+        Edit & edit = editOf(a);
+        int local = a & (VERSION_BLOCK_SIZE - 1);
+        int arc = edit.targets[local].indexOf(b);
+        if (arc >= 0)
+        {
+            edit.weights[local][arc] = weight;
+            return false;
+        }
+        edit.targets[local] << b;
+        edit.weights[local] << weight;
+        return true;
+    }
+
+    bool removeArc(int a, int b)
+    {
+        if (findArc(a, b) < 0)
+            return false;
+        Edit & edit = editOf(a);
+        int local = a & (VERSION_BLOCK_SIZE - 1);
+        int arc = edit.targets[local].indexOf(b);
+        edit.targets[local].remove(arc);
+        edit.weights[local].remove(arc);
+        return true;
+    }
+
+    bool setArcWeight(int a, int b, double weight)
+    {
+        if (findArc(a, b) < 0)
+            return false;
+        Edit & edit = editOf(a);
+        int local = a & (VERSION_BLOCK_SIZE - 1);
+        edit.weights[local][edit.targets[local].indexOf(b)] = weight;
+        return true;
+    }
+
+    /*!
+     * \brief finish method replaces the modified blocks by new immutable blocks
+     * \return the replaced blocks
+     */
+    QVector<const AdjacencyBlock*> finish()
+    {
+        QVector<const AdjacencyBlock*> replaced;
+        for (int e=0; e<_edits.size(); e++)
+        {
+            const Edit & edit = _edits[e];
+            AdjacencyBlock * block = new AdjacencyBlock();
+            block->offsets.resize(VERSION_BLOCK_SIZE + 1);
+            block->offsets[0] = 0;
+            for (int local=0; local<VERSION_BLOCK_SIZE; local++)
+            {
+                block->targets << edit.targets[local];
+                block->weights << edit.weights[local];
+                block->offsets[local+1] = block->targets.size();
+            }
+            replaced << _blocks[edit.block];
+            _blocks[edit.block] = block;
+        }
+        return replaced;
+    }
+
+    bool isModified() const
+    { return !_edits.isEmpty(); }
+
+private:
+    struct Edit
+    {
+        int block;
+        QVector< QVector<int> > targets;
+        QVector< QVector<double> > weights;
+    };
+
+    Edit & editOf(int v)
+    {
+        int blockIndex = v >> VERSION_BLOCK_BITS;
+        int & index = _editIndex[blockIndex];
+        if (index < 0)
+        {
+            const AdjacencyBlock * block = _blocks[blockIndex];
+            Edit edit;
+            edit.block = blockIndex;
+            edit.targets.resize(VERSION_BLOCK_SIZE);
+            edit.weights.resize(VERSION_BLOCK_SIZE);
+            for (int local=0; local<VERSION_BLOCK_SIZE; local++)
+            {
+                int begin = block->offsets[local];
+                int count = block->offsets[local+1] - begin;
+                edit.targets[local] = block->targets.mid(begin, count);
+                edit.weights[local] = block->weights.mid(begin, count);
+            }
+            index = _edits.size();
+            _edits << edit;
+        }
+        return _edits[index];
+    }
+
+    QVector<const AdjacencyBlock*> & _blocks;
+    QVector<int> _editIndex; //!< index in _edits of each block, -1 if not modified
+    QVector<Edit> _edits;
+};
+
+//******************************************************************************
+
+GraphVersion::GraphVersion() :
+    _number(0),
+    _directed(false),
+    _nbVertices(0),
+    _nbArcs(0)
+{
+}
+
+//******************************************************************************
+/*!
+ * \brief GraphVersion::weight method returns the weight of the arc a->b, -1 if none
+ */
+double GraphVersion::weight(int a, int b) const
+{
+    if (a < 0 || a >= _nbVertices)
+        return -1.0;
+    for (NeighborIterator it = neighbors(a); !it.atEnd(); it.next())
+    {
+        if (it.target() == b)
+            return it.weight();
+    }
+    return -1.0;
+}
+
+//******************************************************************************
+/*!
+ * \brief GraphVersion::nbSharedBlocks method returns the number of adjacency blocks the two versions have in common
+ */
+int GraphVersion::nbSharedBlocks(const GraphVersion & other) const
+{
+    int count = 0;
+    for (int i=0; i<qMin(_blocks.size(), other._blocks.size()); i++)
+        count += _blocks[i] == other._blocks[i] ? 1 : 0;
+    return count;
+}
+
+//******************************************************************************
+/*!
+ * \brief GraphVersion::toGraph method copies the version into a GT::Graph, for the GraphTools algorithms
+ */
+void GraphVersion::toGraph(Graph * graph) const
+{
+    *graph = Graph(_directed);
+    graph->vertices.resize(_nbVertices);
+    for (int v=0; v<_nbVertices; v++)
+        graph->vertices[v].id = v;
+
+    QVector<Edge> edges;
+    edges.reserve(_directed ? _nbArcs : _nbArcs / 2);
+    for (int a=0; a<_nbVertices; a++)
+    {
+        for (NeighborIterator it = neighbors(a); !it.atEnd(); it.next())
+        {
+            int b = it.target();
+            if (!_directed && b < a)
+                continue;
+            Edge edge;
+            edge.a = &graph->vertices[a];
+            edge.b = &graph->vertices[b];
+            edge.weight = it.weight();
+            edges << edge;
+        }
+    }
+    graph->setEdges(edges);
+}
+
+//******************************************************************************
+
+VersionedGraph::ReadGuard::ReadGuard(const VersionedGraph & graph) :
+    _graph(graph),
+    _slot(graph.enterRead()),
+    _version(graph._current.loadAcquire())
+{
+}
+
+//******************************************************************************
+
+VersionedGraph::ReadGuard::~ReadGuard()
+{
+    _graph.leaveRead(_slot);
+}
+
+//******************************************************************************
+
+VersionedGraph::VersionedGraph(bool directed) :
+    _epoch(1),
+    _current(0)
+{
+    reset(directed);
+}
+
+//******************************************************************************
+/*!
+ * \brief VersionedGraph::~VersionedGraph destructor, no reader may hold a version
+ */
+VersionedGraph::~VersionedGraph()
+{
+    foreach (RetiredVersion retired, _retired)
+    {
+        qDeleteAll(retired.blocks);
+        delete retired.version;
+    }
+    GraphVersion * current = _current.loadAcquire();
+    qDeleteAll(current->_blocks);
+    delete current;
+}
+
+//******************************************************************************
+/*!
+ * \brief VersionedGraph::enterRead method announces the current epoch in a free reader slot
+ * \return the slot
+ *
+ * The epoch is read again after the announcement : if a writer closed it meanwhile, the
+ * announcement may have been missed by its reclamation, so the new epoch is announced.
+ */
+int VersionedGraph::enterRead() const
+{
+    while (true)
+    {
+        for (int slot=0; slot<VERSION_MAX_READERS; slot++)
+        {
+            int epoch = _epoch.loadAcquire();
+            if (!_readerEpochs[slot].testAndSetOrdered(0, epoch))
+                continue;
+            int current = _epoch.loadAcquire();
+            while (current != epoch)
+            {
+                epoch = current;
+                _readerEpochs[slot].fetchAndStoreOrdered(epoch);
+                current = _epoch.loadAcquire();
+            }
+            return slot;
+        }
+        // more than VERSION_MAX_READERS readers
+        QThread::yieldCurrentThread();
+    }
+}
+
+//******************************************************************************
+
+void VersionedGraph::leaveRead(int slot) const
+{
+    _readerEpochs[slot].storeRelease(0);
+}
+
+//******************************************************************************
+/*!
+ * \brief VersionedGraph::publishVersion method makes the version current and retires the previous one, the write mutex is locked
+ *
+ * A reader announcing an epoch after the increment loads the new version, so the previous
+ * version and the replaced blocks can only be held by readers of epochs <= the closed one.
+ */
+void VersionedGraph::publishVersion(GraphVersion * version, const QVector<const AdjacencyBlock*> & replaced)
+{
+    RetiredVersion retired;
+    retired.version = _current.fetchAndStoreOrdered(version);
+    retired.epoch = _epoch.fetchAndAddOrdered(1);
+    retired.blocks = replaced;
+    if (retired.version)
+        _retired << retired;
+    reclaimRetired();
+}
+
+//******************************************************************************
+/*!
+ * \brief VersionedGraph::reclaimRetired method deletes the retired versions no reader can hold, the write mutex is locked
+ * \return number of deleted versions
+ */
+int VersionedGraph::reclaimRetired()
+{
+    int minEpoch = _epoch.loadAcquire();
+    for (int slot=0; slot<VERSION_MAX_READERS; slot++)
+    {
+        int epoch = _readerEpochs[slot].loadAcquire();
+        if (epoch != 0 && epoch < minEpoch)
+            minEpoch = epoch;
+    }
+
+    int count = 0;
+    while (!_retired.isEmpty() && _retired.first().epoch < minEpoch)
+    {
+        RetiredVersion retired = _retired.takeFirst();
+        qDeleteAll(retired.blocks);
+        delete retired.version;
+        count++;
+    }
+    return count;
+}
+
+//******************************************************************************
+
+int VersionedGraph::reclaim()
+{
+    QMutexLocker locker(&_writeMutex);
+    return reclaimRetired();
+}
+
+//******************************************************************************
+
+int VersionedGraph::nbRetiredVersions() const
+{
+    QMutexLocker locker(&_writeMutex);
+    return _retired.size();
+}
+
+//******************************************************************************
+
+int VersionedGraph::currentNumber() const
+{
+    return _current.loadAcquire()->number();
+}
+
+//******************************************************************************
+/*!
+ * \brief VersionedGraph::reset method publishes an empty version
+ */
+void VersionedGraph::reset(bool directed)
+{
+    QMutexLocker locker(&_writeMutex);
+    const GraphVersion * current = _current.loadAcquire();
+    GraphVersion * version = new GraphVersion();
+    version->_directed = directed;
+    QVector<const AdjacencyBlock*> replaced;
+    if (current)
+    {
+        version->_number = current->_number + 1;
+        replaced = current->_blocks;
+    }
+    publishVersion(version, replaced);
+}
+
+//******************************************************************************
+/*!
+ * \brief VersionedGraph::build method publishes a copy of the graph and its directed mode, self-loops are dropped and parallel edges keep the last weight
+ */
+bool VersionedGraph::build(const Graph & graph)
+{
+    GT_PROFILE_SCOPE("VersionedGraph::build");
+    reset(graph.isDirected());
+    const QVector<Edge> & edges = graph.getEdges();
+    QVector<EdgeUpdate> batch;
+    batch.reserve(edges.size());
+    for (int i=0; i<edges.size(); i++)
+        batch << EdgeUpdate(EDGE_INSERT, edges[i].a->id, edges[i].b->id, edges[i].weight);
+    publish(batch, graph.vertices.size());
+    return true;
+}
+
+//******************************************************************************
+/*!
+ * \brief VersionedGraph::publish method applies the edge updates in order to a copy of the current version and publishes it
+ * \param batch
+ * \param nbNewVertices isolated vertices added before the updates
+ * \param statistics optional output
+ * \return the number of the current version, unchanged if the batch modified nothing
+ *
+ * Only the blocks of the updated vertices are copied, the cost is proportional to the number
+ * of blocks and to the size of the modified ones.
+ */
+int VersionedGraph::publish(const QVector<EdgeUpdate> & batch, int nbNewVertices, DynamicBatchStatistics * statistics)
+{
+    GT_PROFILE_SCOPE("VersionedGraph::publish");
+    QMutexLocker locker(&_writeMutex);
+    const GraphVersion * current = _current.loadAcquire();
+    GraphVersion * version = new GraphVersion(*current);
+    version->_number = current->_number + 1;
+    version->_nbVertices += qMax(0, nbNewVertices);
+    int n = version->_nbVertices;
+    int nbBlocks = (n + VERSION_BLOCK_SIZE - 1) >> VERSION_BLOCK_BITS;
+    while (version->_blocks.size() < nbBlocks)
+        version->_blocks << NewEmptyBlock();
+
+    DynamicBatchStatistics counts;
+    VersionEditor editor(version->_blocks);
+    foreach (EdgeUpdate update, batch)
+    {
+        int a = update.a;
+        int b = update.b;
+        if (a < 0 || a >= n || b < 0 || b >= n || a == b)
+        {
+            counts.nbIgnored++;
+            continue;
+        }
+
+        bool applied = false;
+        if (update.type == EDGE_INSERT)
+        {
+            if (editor.insertArc(a, b, update.weight))
+            {
+                counts.nbInserted++;
+                version->_nbArcs += version->_directed ? 1 : 2;
+            }
+            else
+            {
+                counts.nbUpdated++;
+            }
+            if (!version->_directed)
+                editor.insertArc(b, a, update.weight);
+            applied = true;
+        }
+        else if (update.type == EDGE_DELETE)
+        {
+            applied = editor.removeArc(a, b);
+            if (!version->_directed)
+                editor.removeArc(b, a);
+            if (applied)
+            {
+                counts.nbDeleted++;
+                version->_nbArcs -= version->_directed ? 1 : 2;
+            }
+        }
+        else if (update.type == EDGE_SET_WEIGHT)
+        {
+            applied = editor.setArcWeight(a, b, update.weight);
+            if (!version->_directed)
+                editor.setArcWeight(b, a, update.weight);
+            counts.nbUpdated += applied ? 1 : 0;
+        }
+        if (!applied)
+            counts.nbIgnored++;
+    }
+    if (statistics)
+        *statistics = counts;
+
+    if (!editor.isModified() && n == current->_nbVertices)
+    {
+        delete version;
+        return current->_number;
+    }
+    publishVersion(version, editor.finish());
+    return version->_number;
+}
+
+//******************************************************************************
+
+}
@@ -0,0 +1,157 @@
+#ifndef GRAPHVERSIONED_H
+#define GRAPHVERSIONED_H
+
+// Qt
+#include <QVector>
+#include <QList>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QMutex>
+
+// Project
+#include "GraphCsr.h"
+#include "GraphDynamic.h"
+
+//******************************************************************************
+
+namespace GT {
+
+struct Graph;
+
+static const int VERSION_BLOCK_BITS = 6;
+static const int VERSION_BLOCK_SIZE = 1 << VERSION_BLOCK_BITS; //!< vertices per adjacency block
+static const int VERSION_MAX_READERS = 64; //!< readers holding a version at the same time
+
+//******************************************************************************
+/*!
+ * \brief AdjacencyBlock struct holds the out-edges of VERSION_BLOCK_SIZE consecutive vertices, it is never modified once published
+ */
+struct AdjacencyBlock
+{
+    QVector<int> offsets; //!< VERSION_BLOCK_SIZE+1 offsets in targets and weights
+    QVector<int> targets;
+    QVector<double> weights;
+};
+
+//******************************************************************************
+/*!
+ * \brief GraphVersion class is an immutable state of a VersionedGraph
+ *
+ * Consecutive versions share the blocks that were not modified. Vertices are ids, there is no
+ * pointer into another version, so a version stays valid while the graph is edited.
+ */
+class GraphVersion
+{
+public:
+    typedef CsrGraph::NeighborIterator NeighborIterator;
+
+    int number() const
+    { return _number; }
+    bool isDirected() const
+    { return _directed; }
+    int nbVertices() const
+    { return _nbVertices; }
+    int nbArcs() const
+    { return _nbArcs; }
+    int degree(int v) const
+    {
+        const AdjacencyBlock * block = _blocks[v >> VERSION_BLOCK_BITS];
+        int local = v & (VERSION_BLOCK_SIZE - 1);
+        return block->offsets[local+1] - block->offsets[local];
+    }
+    NeighborIterator neighbors(int v) const
+    {
+        const AdjacencyBlock * block = _blocks[v >> VERSION_BLOCK_BITS];
+        int local = v & (VERSION_BLOCK_SIZE - 1);
+        return NeighborIterator(block->targets.constData(), block->weights.constData(),
+                                block->offsets[local], block->offsets[local+1]);
+    }
+    double weight(int a, int b) const;
+    int nbSharedBlocks(const GraphVersion & other) const;
+    void toGraph(Graph * graph) const;
+
+private:
+    friend class VersionedGraph;
+    GraphVersion();
+
+    int _number;
+    bool _directed;
+    int _nbVertices;
+    int _nbArcs;
+    QVector<const AdjacencyBlock*> _blocks;
+};
+
+//******************************************************************************
+/*!
+ * \brief VersionedGraph class publishes copy-on-write versions of a graph, readers run on a version while writers edit
+ *
+ * A writer copies the blocks touched by a batch of EdgeUpdate, builds a new version referencing
+ * the copies and the unchanged blocks, then publishes it with a single atomic pointer store.
+ * Writers are serialized, readers never wait : ReadGuard announces the current epoch in a free
+ * reader slot and pins the current version. A publication retires the previous version and the
+ * replaced blocks with the epoch it closes, they are deleted once no reader slot holds an epoch
+ * lower or equal to it (epoch-based reclamation).
+ *
+ * Edge updates have the DynamicGraph semantics : no self-loops, no parallel edges.
+ */
+class VersionedGraph
+{
+public:
+    /*!
+     * \brief ReadGuard class pins the current version for its lifetime
+     */
+    class ReadGuard
+    {
+    public:
+        explicit ReadGuard(const VersionedGraph & graph);
+        ~ReadGuard();
+        const GraphVersion & version() const
+        { return *_version; }
+
+    private:
+        Q_DISABLE_COPY(ReadGuard)
+        const VersionedGraph & _graph;
+        int _slot;
+        const GraphVersion * _version;
+    };
+
+    explicit VersionedGraph(bool directed=false);
+    ~VersionedGraph();
+
+    void reset(bool directed=false);
+    bool build(const Graph & graph);
+    int publish(const QVector<EdgeUpdate> & batch, int nbNewVertices=0, DynamicBatchStatistics * statistics=0);
+
+    int currentNumber() const;
+    int nbRetiredVersions() const;
+    int reclaim();
+
+private:
+    Q_DISABLE_COPY(VersionedGraph)
+
+    struct RetiredVersion
+    {
+        int epoch;
+        const GraphVersion * version;
+        QVector<const AdjacencyBlock*> blocks; //!< blocks replaced by the next version
+    };
+
+    int enterRead() const;
+    void leaveRead(int slot) const;
+    void publishVersion(GraphVersion * version, const QVector<const AdjacencyBlock*> & replaced);
+    int reclaimRetired();
+
+    mutable QAtomicInt _epoch;
+    mutable QAtomicInt _readerEpochs[VERSION_MAX_READERS]; //!< 0 if the slot is free
+    QAtomicPointer<GraphVersion> _current;
+    mutable QMutex _writeMutex;
+    QList<RetiredVersion> _retired;
+};
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHVERSIONED_H
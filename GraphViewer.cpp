@@ -10,6 +10,7 @@
 
 // Project
 #include "GraphTools.h"
+#include "GraphIO.h"
 #include "GraphViewer.h"
 
 namespace GT {
@@ -52,6 +53,7 @@ void GraphViewer::clear()
     _scene.clear();
     _vertices.clear();
     _edges.clear();
+    _versions.reset();
 
     _initialText = _scene.addSimpleText("Click here to add a vertex");
     _initialText->setPen(QColor(167,167,167));
@@ -69,44 +71,152 @@ bool GraphViewer::setupGraph(GT::Graph * graph)
     if (!graph)
         return false;
 
-    graph->vertices.resize(_vertices.size());
-    for (int i=0;i<graph->vertices.size();i++)
+    GraphDocument doc;
+    toDocument(&doc);
+    return SetupGraph(doc, graph);
+}
+
+//******************************************************************************
+/*!
+ * \brief GraphViewer::toDocument method copies the drawn graph into a plain document
+ * \param doc
+ *
+ * Vertex colors are the current vertex brushes, i.e. the last algorithm result.
+ */
+void GraphViewer::toDocument(GraphDocument * doc) const
+{
+    if (!doc)
+        return;
+
+    doc->positions.resize(_vertices.size());
+    doc->colors.resize(_vertices.size());
+    for (int i=0;i<_vertices.size();i++)
     {
-        graph->vertices[i].id = _vertices[i]->data(KEY_VERTEX_ID).toInt();
+        doc->positions[i] = _vertices[i]->scenePos();
+        doc->colors[i] = _vertices[i]->brush().color().rgb();
     }
 
-    // Factor 2 due to the undirected visual graph representation
-    QVector<GT::Edge> edges(2*_edges.size());
+    doc->edgeVertices.resize(2*_edges.size());
+    doc->edgeWeights.resize(_edges.size());
     for (int i=0; i< _edges.size(); i++)
     {
         QGraphicsLineItem * edge = _edges[i];
-        int vertexIndex1 = edge->data(KEY_EDGE_VERTEX1).toInt();
-        int vertexIndex2 = edge->data(KEY_EDGE_VERTEX2).toInt();
-        int weight = edge->data(KEY_EDGE_WEIGHT).toInt();
-
-        if (weight < 0)
-        {
-            std::cerr << "Weights should not negative for undirected graphs" << std::endl;
-            return false;
-        }
+        doc->edgeVertices[2*i] = edge->data(KEY_EDGE_VERTEX1).toInt();
+        doc->edgeVertices[2*i+1] = edge->data(KEY_EDGE_VERTEX2).toInt();
+        doc->edgeWeights[i] = edge->data(KEY_EDGE_WEIGHT).toDouble();
+    }
+}
 
-        edges[2*i].a = &graph->vertices[vertexIndex1];
-        edges[2*i].b = &graph->vertices[vertexIndex2];
-        edges[2*i].weight = weight;
+//******************************************************************************
+/*!
+ * \brief GraphViewer::fromDocument method replaces the drawn graph by the document graph
+ * \param doc
+ */
+void GraphViewer::fromDocument(const GraphDocument & doc)
+{
+    clear();
 
-        edges[2*i+1].a = &graph->vertices[vertexIndex2];
-        edges[2*i+1].b = &graph->vertices[vertexIndex1];
-        edges[2*i+1].weight = weight;
+    for (int i=0;i<doc.nbVertices();i++)
+    {
+        QGraphicsEllipseItem * vertex = addVertex(doc.positions[i]);
+        vertex->setBrush(QColor(doc.colors.value(i, QColor(Qt::white).rgb())));
+    }
 
+    for (int i=0; i<doc.nbEdges(); i++)
+    {
+        addEdge(doc.edgeVertices[2*i], doc.edgeVertices[2*i+1], doc.edgeWeights[i]);
     }
+}
 
+//******************************************************************************
 
-    graph->setEdges(edges);
+QGraphicsEllipseItem * GraphViewer::addVertex(const QPointF & pos)
+{
+    _initialText->setVisible(false);
+
+    QGraphicsEllipseItem * vertex = _scene.addEllipse(
+                QRectF(-VERTEX_SIZE*0.5, -VERTEX_SIZE*0.5, VERTEX_SIZE, VERTEX_SIZE),
+                QPen(Qt::black, 0),
+                QBrush(Qt::white)
+                );
+    vertex->setTransform(
+                QTransform::fromTranslate(pos.x(), pos.y())
+                );
+    vertex->setZValue(VERTEX_CIRCLE_Z);
+    _vertices << vertex;
+    int id = _vertices.size()-1;
+    vertex->setData(KEY_VERTEX_ID, id);
+    QGraphicsSimpleTextItem * vertexId = _scene.addSimpleText(QString("%1").arg(id+1));
+    vertexId->setParentItem(vertex);
+    vertexId->setTransform(
+                QTransform::fromScale(0.005, 0.005)
+                * QTransform::fromTranslate(-VERTEX_SIZE*( (id < 9) ? 0.18 : 0.28 ), -VERTEX_SIZE*0.35)
+                );
+    vertexId->setZValue(VERTEX_TEXT_Z);
+    _versions.publish(QVector<EdgeUpdate>(), 1);
+    onVertexAdded(id);
+    return vertex;
+}
 
-    if (graph->vertices.isEmpty())
-        return false;
+//******************************************************************************
+
+QGraphicsLineItem * GraphViewer::addEdge(int vertexIndex1, int vertexIndex2, double weight)
+{
+    QPointF p1 = _vertices[vertexIndex1]->scenePos();
+    QPointF p2 = _vertices[vertexIndex2]->scenePos();
+    QGraphicsLineItem * edge = _scene.addLine(0.0, 0.0, p2.x()-p1.x(), p2.y()-p1.y(), QPen(Qt::black, 0));
+    edge->setTransform(QTransform::fromTranslate(p1.x(), p1.y()));
+    edge->setZValue(EDGE_LINE_Z);
+    edge->setData(KEY_EDGE_VERTEX1, vertexIndex1);
+    edge->setData(KEY_EDGE_VERTEX2, vertexIndex2);
+    edge->setData(KEY_EDGE_WEIGHT, weight);
+    // draw edge weight
+    QGraphicsSimpleTextItem * edgeWeight = _scene.addSimpleText(QString("%1").arg(weight));
+    edgeWeight->setParentItem(edge);
+    edgeWeight->setBrush(Qt::blue);
+    QLineF line = edge->line();
+    edgeWeight->setTransform(
+                QTransform::fromScale(0.005, 0.005)
+                * QTransform::fromTranslate(line.x2()*0.5, line.y2()*0.5)
+                );
+    edgeWeight->setZValue(EDGE_TEXT_Z);
+    // add to graph edges
+    _edges << edge;
+    _versions.publish(QVector<EdgeUpdate>() << EdgeUpdate(EDGE_INSERT, vertexIndex1, vertexIndex2, weight));
+    onEdgeAdded(vertexIndex1, vertexIndex2);
+    return edge;
+}
+
+//******************************************************************************
+/*!
+ * \brief GraphViewer::findEdge method returns the index of the edge connecting the vertices (in any direction), -1 if none
+ */
+int GraphViewer::findEdge(int vertexIndex1, int vertexIndex2) const
+{
+    for (int i=0; i<_edges.size(); i++)
+    {
+        int a = _edges[i]->data(KEY_EDGE_VERTEX1).toInt();
+        int b = _edges[i]->data(KEY_EDGE_VERTEX2).toInt();
+        if ((a == vertexIndex1 && b == vertexIndex2) || (a == vertexIndex2 && b == vertexIndex1))
+            return i;
+    }
+    return -1;
+}
 
-    return true;
+//******************************************************************************
+/*!
+ * \brief GraphViewer::setVertexHeat method fills the vertices with a heat color, blue for 0 to red for the highest score
+ */
+void GraphViewer::setVertexHeat(const QVector<double> & scores)
+{
+    double maxScore = 0.0;
+    for (int i=0; i<scores.size(); i++)
+        maxScore = qMax(maxScore, scores[i]);
+    for (int i=0; i<_vertices.size(); i++)
+    {
+        double heat = maxScore > 0.0 ? qBound(0.0, scores.value(i) / maxScore, 1.0) : 0.0;
+        _vertices[i]->setBrush(QColor::fromHsvF(0.66 * (1.0 - heat), 1.0, 1.0));
+    }
 }
 
 //******************************************************************************
@@ -114,7 +224,7 @@ bool GraphViewer::setupGraph(GT::Graph * graph)
 void GraphViewer::onValueEdited()
 {
     bool ok=false;
-    int newvalue = _valueEditor.text().toInt(&ok);
+    double newvalue = _valueEditor.text().toDouble(&ok);
     if (ok)
     {
 
@@ -126,6 +236,10 @@ void GraphViewer::onValueEdited()
             if (parent)
             {
                 parent->setData(KEY_EDGE_WEIGHT, newvalue);
+                _versions.publish(QVector<EdgeUpdate>() << EdgeUpdate(EDGE_SET_WEIGHT,
+                                                                      parent->data(KEY_EDGE_VERTEX1).toInt(),
+                                                                      parent->data(KEY_EDGE_VERTEX2).toInt(),
+                                                                      newvalue));
             }
             _valueEditor.hide();
         }
@@ -148,26 +262,7 @@ void GraphViewer::onSceneMousePress(QGraphicsSceneMouseEvent *mouseEvent)
                 ).isEmpty())
     {
         // Create new vertex
-        QGraphicsEllipseItem * vertex = _scene.addEllipse(
-                    QRectF(-VERTEX_SIZE*0.5, -VERTEX_SIZE*0.5, VERTEX_SIZE, VERTEX_SIZE),
-                    QPen(Qt::black, 0),
-                    QBrush(Qt::white)
-                    );
-        vertex->setTransform(
-                    QTransform::fromTranslate(mouseEvent->scenePos().x(), mouseEvent->scenePos().y())
-                    );
-        vertex->setZValue(VERTEX_CIRCLE_Z);
-        _vertices << vertex;
-        int id = _vertices.size()-1;
-        vertex->setData(KEY_VERTEX_ID, id);
-        QGraphicsSimpleTextItem * vertexId = _scene.addSimpleText(QString("%1").arg(id+1));
-        vertexId->setParentItem(vertex);
-        vertexId->setTransform(
-                    QTransform::fromScale(0.005, 0.005)
-                    * QTransform::fromTranslate(-VERTEX_SIZE*( (id < 9) ? 0.18 : 0.28 ), -VERTEX_SIZE*0.35)
-                    );
-        vertexId->setZValue(VERTEX_TEXT_Z);
-
+        addVertex(mouseEvent->scenePos());
     }
     else
     {
@@ -224,30 +319,16 @@ void GraphViewer::onSceneMouseRelease(QGraphicsSceneMouseEvent *mouseEvent)
 
         if (vertex)
         {
-            double x = _drawingEdge->transform().dx();
-            double y = _drawingEdge->transform().dy();
-            _drawingEdge->setLine(0.0,0.0, vertex->scenePos().x()-x, vertex->scenePos().y()-y);
-            _drawingEdge->setZValue(EDGE_LINE_Z);
-
-            if (_drawingEdge->data(KEY_EDGE_VERTEX1) == vertex->data(KEY_EDGE_VERTEX1))
-                _scene.removeItem(_drawingEdge);
-            else
+            int vertexIndex1 = _drawingEdge->data(KEY_EDGE_VERTEX1).toInt();
+            int vertexIndex2 = vertex->data(KEY_VERTEX_ID).toInt();
+            _scene.removeItem(_drawingEdge);
+            delete _drawingEdge;
+
+            // no self-loops and no parallel edges
+            if (vertexIndex1 != vertexIndex2 && findEdge(vertexIndex1, vertexIndex2) < 0)
             {
                 int defaultWeight = 1;
-                _drawingEdge->setData(KEY_EDGE_VERTEX2, vertex->data(KEY_VERTEX_ID));
-                _drawingEdge->setData(KEY_EDGE_WEIGHT, defaultWeight);
-                // draw edge weight
-                QGraphicsSimpleTextItem * edgeWeight = _scene.addSimpleText(QString("%1").arg(defaultWeight));
-                edgeWeight->setParentItem(_drawingEdge);
-                edgeWeight->setBrush(Qt::blue);
-                QLineF line = _drawingEdge->line();
-                edgeWeight->setTransform(
-                            QTransform::fromScale(0.005, 0.005)
-                            * QTransform::fromTranslate(line.x2()*0.5, line.y2()*0.5)
-                            );
-                edgeWeight->setZValue(EDGE_TEXT_Z);
-                // add to graph edges
-                _edges << _drawingEdge;
+                addEdge(vertexIndex1, vertexIndex2, defaultWeight);
             }
         }
     }
@@ -275,7 +356,7 @@ void GraphViewer::onSceneMouseDoubleClick(QGraphicsSceneMouseEvent *mouseEvent)
 
             _editedItem = text;
 
-            int weight = edge->data(KEY_EDGE_WEIGHT).toInt();
+            double weight = edge->data(KEY_EDGE_WEIGHT).toDouble();
             _valueEditor.setText(QString("%1").arg(weight));
             _valueEditor.show();
             _valueEditor.resize(20,_valueEditor.height());
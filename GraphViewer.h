@@ -8,6 +8,9 @@
 #include <QResizeEvent>
 #include <QLineEdit>
 
+// Project
+#include "GraphVersioned.h"
+
 static const double VERTEX_SIZE=0.1;
 static const int KEY_EDGE_VERTEX1=0;
 static const int KEY_EDGE_VERTEX2=1;
@@ -23,6 +26,7 @@ static const double PATH_LINE_Z = 2.0;
 namespace GT {
 
 class Graph;
+struct GraphDocument;
 
 //******************************************************************************
 
@@ -32,6 +36,12 @@ class GraphViewer : public QWidget
 public:
     explicit GraphViewer(QWidget *parent = 0);
 
+    /*!
+     * \brief versions method returns the drawn graph versions, a background job pins one with VersionedGraph::ReadGuard
+     */
+    const VersionedGraph & versions() const
+    { return _versions; }
+
 public slots:
     virtual void clear();
 
@@ -40,9 +50,18 @@ protected slots:
 
 protected:
     bool setupGraph(GT::Graph * graph);
+    void toDocument(GT::GraphDocument * doc) const;
+    void fromDocument(const GT::GraphDocument & doc);
+    QGraphicsEllipseItem * addVertex(const QPointF & pos);
+    QGraphicsLineItem * addEdge(int vertexIndex1, int vertexIndex2, double weight);
+    int findEdge(int vertexIndex1, int vertexIndex2) const;
+    void setVertexHeat(const QVector<double> & scores);
     void showEvent(QShowEvent * e);
     void resizeEvent(QResizeEvent * e);
     virtual bool eventFilter(QObject *, QEvent *);
+    //! called after a vertex or an edge is added to the drawn graph
+    virtual void onVertexAdded(int) {}
+    virtual void onEdgeAdded(int, int) {}
 
     QGraphicsScene _scene;
     QGraphicsView * _view;
@@ -58,6 +77,8 @@ protected:
     QLineEdit _valueEditor;
     QGraphicsItem* _editedItem;
 
+    VersionedGraph _versions; //!< published on each vertex, edge or weight edit
+
 private:
     void onSceneMousePress(QGraphicsSceneMouseEvent* event);
     void onSceneMouseMove(QGraphicsSceneMouseEvent* event);
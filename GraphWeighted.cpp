@@ -0,0 +1,111 @@
+
+// Project
+#include "GraphWeighted.h"
+#include "GraphProfiler.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+
+WeightType SelectWeightType(const Graph & graph)
+{
+    bool unit = true;
+    bool uint8 = true;
+    bool uint32 = true;
+    bool exactFloat = true;
+    const QVector<Edge> & edges = graph.getEdges();
+    for (int i=0; i<edges.size(); i++)
+    {
+        double weight = edges[i].weight;
+        if (!(weight >= 0.0))
+            return WEIGHT_NEGATIVE;
+        unit &= weight == 1.0;
+        uint8 &= WeightTraits<quint8>::fits(weight);
+        uint32 &= WeightTraits<quint32>::fits(weight);
+        exactFloat &= WeightTraits<float>::fits(weight);
+    }
+    if (unit)
+        return WEIGHT_UNIT;
+    if (uint8)
+        return WEIGHT_UINT8;
+    if (uint32)
+        return WEIGHT_UINT32;
+    return exactFloat ? WEIGHT_FLOAT : WEIGHT_DOUBLE;
+}
+
+//******************************************************************************
+
+const char * WeightTypeName(WeightType type)
+{
+    switch (type)
+    {
+    case WEIGHT_UNIT: return "unit";
+    case WEIGHT_UINT8: return "uint8";
+    case WEIGHT_UINT32: return "uint32";
+    case WEIGHT_FLOAT: return "float";
+    case WEIGHT_DOUBLE: return "double";
+    case WEIGHT_NEGATIVE: return "negative";
+    }
+    return "";
+}
+
+//******************************************************************************
+
+BitMatrixGraph::BitMatrixGraph() :
+    _nbVertices(0),
+    _nbWords(0),
+    _nbEdges(0)
+{
+}
+
+//******************************************************************************
+/*!
+ * \brief BitMatrixGraph::build method sets bit (a, b), and (b, a) if the graph is undirected, for each edge a-b
+ *
+ * Parallel edges give one bit, nbEdges() counts the bits.
+ */
+bool BitMatrixGraph::build(const Graph & graph)
+{
+    GT_PROFILE_SCOPE("BitMatrixGraph::build");
+    int n = graph.vertices.size();
+    _bits.clear();
+    _nbVertices = 0;
+    _nbWords = 0;
+    _nbEdges = 0;
+    if (n > BIT_MATRIX_MAX_VERTICES)
+        return false;
+
+    _nbVertices = n;
+    _nbWords = (n + 63) >> 6;
+    _bits.fill(0, n * _nbWords);
+    bool undirected = !graph.isDirected();
+    const QVector<Edge> & edges = graph.getEdges();
+    for (int i=0; i<edges.size(); i++)
+    {
+        int a = edges[i].a->id;
+        int b = edges[i].b->id;
+        _bits[a * _nbWords + (b >> 6)] |= quint64(1) << (b & 63);
+        if (undirected)
+            _bits[b * _nbWords + (a >> 6)] |= quint64(1) << (a & 63);
+    }
+    for (int w=0; w<_bits.size(); w++)
+        _nbEdges += qPopulationCount(_bits[w]);
+    return true;
+}
+
+//******************************************************************************
+
+int BitMatrixGraph::degree(int v) const
+{
+    int degree = 0;
+    const quint64 * row = _bits.constData() + v * _nbWords;
+    for (int w=0; w<_nbWords; w++)
+        degree += qPopulationCount(row[w]);
+    return degree;
+}
+
+//******************************************************************************
+
+}
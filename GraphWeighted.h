@@ -0,0 +1,303 @@
+#ifndef GRAPHWEIGHTED_H
+#define GRAPHWEIGHTED_H
+
+// STD
+#include <cmath>
+#include <limits>
+
+// Qt
+#include <QVector>
+#include <QtAlgorithms>
+
+// Project
+#include "GraphTools.h"
+
+//******************************************************************************
+
+namespace GT {
+
+//******************************************************************************
+/*!
+ * \brief WeightTraits struct describes an edge weight type for the templated kernels
+ *
+ * Distance : type of the path lengths, wide enough for the sums
+ * isInteger : integer weights are searched with a bucket queue
+ * infinity() : distance of the vertices not reached
+ * fits(w) : true if the double weight w is represented exactly
+ */
+template<class W>
+struct WeightTraits;
+
+template<>
+struct WeightTraits<quint8>
+{
+    typedef quint32 Distance; //!< sums fit while paths have less than 2^24 edges
+    static const bool isInteger = true;
+    static Distance infinity()
+    { return std::numeric_limits<Distance>::max(); }
+    static bool fits(double weight)
+    { return weight >= 0.0 && weight <= 255.0 && weight == std::floor(weight); }
+};
+
+template<>
+struct WeightTraits<quint32>
+{
+    typedef quint64 Distance;
+    static const bool isInteger = true;
+    static Distance infinity()
+    { return std::numeric_limits<Distance>::max(); }
+    static bool fits(double weight)
+    { return weight >= 0.0 && weight <= 4294967295.0 && weight == std::floor(weight); }
+};
+
+template<>
+struct WeightTraits<float>
+{
+    typedef double Distance; //!< float weights halve the edge traffic, sums are kept in double
+    static const bool isInteger = false;
+    static Distance infinity()
+    { return std::numeric_limits<Distance>::max(); }
+    static bool fits(double weight)
+    { return std::fabs(weight) <= std::numeric_limits<float>::max() && double(float(weight)) == weight; }
+};
+
+template<>
+struct WeightTraits<double>
+{
+    typedef double Distance;
+    static const bool isInteger = false;
+    static Distance infinity()
+    { return std::numeric_limits<Distance>::max(); }
+    static bool fits(double weight)
+    { return weight == weight; }
+};
+
+//******************************************************************************
+/*!
+ * WEIGHT_UNIT : all weights are 1
+ * WEIGHT_UINT8, WEIGHT_UINT32 : integers in [0, 2^8), [0, 2^32)
+ * WEIGHT_FLOAT : exact in float
+ * WEIGHT_DOUBLE : other non negative weights
+ * WEIGHT_NEGATIVE : negative (or NaN) weights, not usable by the Dijkstra kernels
+ */
+enum WeightType
+{
+    WEIGHT_UNIT=0,
+    WEIGHT_UINT8,
+    WEIGHT_UINT32,
+    WEIGHT_FLOAT,
+    WEIGHT_DOUBLE,
+    WEIGHT_NEGATIVE
+};
+
+//! narrowest weight type representing all edge weights of the graph
+WeightType SelectWeightType(const Graph & graph);
+
+const char * WeightTypeName(WeightType type);
+
+//******************************************************************************
+/*!
+ * \brief WeightedCsrGraph class is a CSR copy of the graph with the weights stored as W
+ *
+ * Same layout and NeighborIterator interface as CsrGraph. Narrow weights cut the bytes read
+ * per edge : 5 with quint8 weights, 8 with quint32 or float, 12 with double.
+ */
+template<class W>
+class WeightedCsrGraph
+{
+public:
+    typedef W Weight;
+
+    class NeighborIterator
+    {
+    public:
+        NeighborIterator(const int * targets, const W * weights, int begin, int end) :
+            _targets(targets),
+            _weights(weights),
+            _edge(begin),
+            _end(end)
+        {
+        }
+        bool atEnd() const
+        { return _edge >= _end; }
+        void next()
+        { _edge++; }
+        int target() const
+        { return _targets[_edge]; }
+        W weight() const
+        { return _weights[_edge]; }
+
+    private:
+        const int * _targets;
+        const W * _weights;
+        int _edge;
+        int _end;
+    };
+
+    WeightedCsrGraph() :
+        _maxWeight(0)
+    {
+    }
+
+    /*!
+     * \brief build method copies the graph edges, edge a->b is an out-edge of a, and of b if the graph is undirected
+     * \return false if a weight is not represented exactly by W
+     */
+    bool build(const Graph & graph)
+    {
+        int n = graph.vertices.size();
+        const QVector<Edge> & edges = graph.getEdges();
+        _offsets.clear();
+        _targets.clear();
+        _weights.clear();
+        _maxWeight = 0;
+        for (int i=0; i<edges.size(); i++)
+        {
+            if (!WeightTraits<W>::fits(edges[i].weight))
+                return false;
+        }
+
+        bool undirected = !graph.isDirected();
+        _offsets.fill(0, n+1);
+        for (int i=0; i<edges.size(); i++)
+        {
+            _offsets[edges[i].a->id + 1]++;
+            if (undirected)
+                _offsets[edges[i].b->id + 1]++;
+        }
+        for (int v=0; v<n; v++)
+            _offsets[v+1] += _offsets[v];
+
+        _targets.resize(_offsets[n]);
+        _weights.resize(_offsets[n]);
+        QVector<int> cursor = _offsets;
+        for (int i=0; i<edges.size(); i++)
+        {
+            W weight = W(edges[i].weight);
+            _maxWeight = qMax(_maxWeight, weight);
+            int position = cursor[edges[i].a->id]++;
+            _targets[position] = edges[i].b->id;
+            _weights[position] = weight;
+            if (undirected)
+            {
+                position = cursor[edges[i].b->id]++;
+                _targets[position] = edges[i].a->id;
+                _weights[position] = weight;
+            }
+        }
+        return true;
+    }
+
+    int nbVertices() const
+    { return _offsets.isEmpty() ? 0 : _offsets.size() - 1; }
+    int nbEdges() const
+    { return _offsets.isEmpty() ? 0 : _offsets.last(); }
+    int degree(int v) const
+    { return _offsets[v+1] - _offsets[v]; }
+    W maxWeight() const
+    { return _maxWeight; }
+    qint64 bytes() const
+    { return qint64(_offsets.size()) * sizeof(int) + qint64(nbEdges()) * (sizeof(int) + sizeof(W)); }
+
+    NeighborIterator neighbors(int v) const
+    { return NeighborIterator(_targets.constData(), _weights.constData(), _offsets[v], _offsets[v+1]); }
+
+private:
+    QVector<int> _offsets;
+    QVector<int> _targets;
+    QVector<W> _weights;
+    W _maxWeight;
+
+    Q_DISABLE_COPY(WeightedCsrGraph)
+};
+
+//******************************************************************************
+
+static const int BIT_MATRIX_MAX_VERTICES = 1 << 15; //!< 128 MB of bits
+
+/*!
+ * \brief BitMatrixGraph class stores the adjacency as one bit row per vertex, for dense unweighted graphs
+ *
+ * Weights are dropped, every edge weighs 1. A neighbor list costs nbVertices / 8 bytes whatever
+ * the degree, less than a CSR row of 5 bytes per neighbor (target and quint8 weight) once the
+ * degree exceeds nbVertices / 40.
+ */
+class BitMatrixGraph
+{
+public:
+    typedef quint8 Weight;
+
+    class NeighborIterator
+    {
+    public:
+        NeighborIterator(const quint64 * row, int nbWords) :
+            _row(row),
+            _nbWords(nbWords),
+            _word(-1),
+            _bits(0),
+            _target(-1)
+        {
+            next();
+        }
+        bool atEnd() const
+        { return _word >= _nbWords; }
+        void next()
+        {
+            while (_bits == 0)
+            {
+                if (++_word >= _nbWords)
+                    return;
+                _bits = _row[_word];
+            }
+            _target = (_word << 6) + qCountTrailingZeroBits(_bits);
+            _bits &= _bits - 1;
+        }
+        int target() const
+        { return _target; }
+        Weight weight() const
+        { return 1; }
+
+    private:
+        const quint64 * _row;
+        int _nbWords;
+        int _word;
+        quint64 _bits;
+        int _target;
+    };
+
+    BitMatrixGraph();
+
+    //! false if the graph has more than BIT_MATRIX_MAX_VERTICES vertices
+    bool build(const Graph & graph);
+
+    int nbVertices() const
+    { return _nbVertices; }
+    int nbEdges() const
+    { return _nbEdges; }
+    int degree(int v) const;
+    Weight maxWeight() const
+    { return 1; }
+    bool hasEdge(int a, int b) const
+    { return (_bits[a * _nbWords + (b >> 6)] >> (b & 63)) & 1; }
+    qint64 bytes() const
+    { return qint64(_bits.size()) * sizeof(quint64); }
+
+    NeighborIterator neighbors(int v) const
+    { return NeighborIterator(_bits.constData() + v * _nbWords, _nbWords); }
+
+private:
+    int _nbVertices;
+    int _nbWords; //!< per row
+    int _nbEdges;
+    QVector<quint64> _bits;
+
+    Q_DISABLE_COPY(BitMatrixGraph)
+};
+
+//******************************************************************************
+
+}
+
+//******************************************************************************
+
+#endif // GRAPHWEIGHTED_H
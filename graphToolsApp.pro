@@ -4,21 +4,88 @@
 #
 #-------------------------------------------------
 
-QT       += core gui
+QT       += core gui network
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 TARGET = ggc
 TEMPLATE = app
 
+CONFIG += c++11
+
 
 SOURCES += main.cpp\
         GraphToolsWidget.cpp \
     GraphTools.cpp \
-    GraphViewer.cpp
+    GraphViewer.cpp \
+    GraphIO.cpp \
+    GraphProfiler.cpp \
+    GraphPartition.cpp \
+    GraphDistributed.cpp \
+    GraphCommandLine.cpp \
+    GraphThreadPool.cpp \
+    GraphMemory.cpp \
+    GraphCsr.cpp \
+    GraphBenchmark.cpp \
+    GraphOrdering.cpp \
+    GraphCompressed.cpp \
+    GraphBuilder.cpp \
+    GraphDynamic.cpp \
+    GraphVersioned.cpp \
+    GraphRecoloring.cpp \
+    GraphUnionFind.cpp \
+    GraphContraction.cpp \
+    GraphExactColoring.cpp \
+    GraphScheduler.cpp \
+    GraphExternal.cpp \
+    GraphServer.cpp \
+    GraphWeighted.cpp \
+    GraphSpanningTree.cpp \
+    GraphCentrality.cpp \
+    GraphKShortestPaths.cpp \
+    GraphPerfCounters.cpp \
+    GraphTriangles.cpp
 
 HEADERS  += GraphToolsWidget.h \
     GraphTools.h \
-    GraphViewer.h
+    GraphViewer.h \
+    GraphIO.h \
+    GraphProfiler.h \
+    GraphPartition.h \
+    GraphDistributed.h \
+    GraphCommandLine.h \
+    GraphThreadPool.h \
+    GraphMemory.h \
+    GraphCsr.h \
+    GraphBenchmark.h \
+    GraphOrdering.h \
+    GraphCompressed.h \
+    GraphKernels.h \
+    GraphBuilder.h \
+    GraphDynamic.h \
+    GraphVersioned.h \
+    GraphRecoloring.h \
+    GraphUnionFind.h \
+    GraphContraction.h \
+    GraphExactColoring.h \
+    GraphScheduler.h \
+    GraphExternal.h \
+    GraphServer.h \
+    GraphWeighted.h \
+    GraphSpanningTree.h \
+    GraphCentrality.h \
+    GraphKShortestPaths.h \
+    GraphPerfCounters.h \
+    GraphTriangles.h
 
 FORMS    += GraphToolsWidget.ui
+
+# Algorithm instrumentation (GT_PROFILE_* macros), enable with : qmake CONFIG+=profiling
+CONFIG(profiling) {
+    DEFINES += GT_PROFILING
+}
+
+# AVX2 set intersection for triangle counting, enable with : qmake CONFIG+=avx2
+CONFIG(avx2) {
+    QMAKE_CXXFLAGS += -mavx2
+}
@@ -4,11 +4,18 @@
 
 // Project
 #include "GraphToolsWidget.h"
+#include "GraphCommandLine.h"
 
 
 int main(int argc, char *argv[])
 {
 
+    if (GT::IsCommandLineMode(argc, argv))
+    {
+        QCoreApplication a(argc, argv);
+        return GT::RunCommandLine(a.arguments());
+    }
+
     QApplication a(argc, argv);
     GT::GraphToolsWidget g;
     g.show();